@@ -139,6 +139,9 @@ Status ScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch
   CHECK(output != nullptr);
   CHECK_EQ(static_cast<size_t>(output->num_columns()), expressions_.size());
 
+  if (function_ctx_ != nullptr) {
+    function_ctx_->NextBatch();
+  }
   for (const auto& expression : expressions_) {
     PL_RETURN_IF_ERROR(EvaluateSingleExpression(exec_state, input, *expression, output));
   }
@@ -151,6 +154,16 @@ std::string ScalarExpressionEvaluator::DebugString() {
   return absl::Substitute("ExpressionEvaluator<$0>", absl::StrJoin(debug_strs, ","));
 }
 
+udf::UDFMemoStats ScalarExpressionEvaluator::MemoStats() const {
+  udf::UDFMemoStats stats;
+  for (const auto& entry : id_to_udf_map_) {
+    if (entry.second->memo() != nullptr) {
+      stats += entry.second->memo()->stats();
+    }
+  }
+  return stats;
+}
+
 Status ScalarExpressionEvaluator::InitFuncsInExpression(
     ExecState* exec_state, std::shared_ptr<const plan::ScalarExpression> expr) {
   plan::ExpressionWalker<bool> walker;
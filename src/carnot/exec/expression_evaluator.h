@@ -114,6 +114,11 @@ class ScalarExpressionEvaluator : public ExpressionEvaluator {
                   table_store::schema::RowBatch* output) override;
   std::string DebugString() override;
 
+  /**
+   * Sums the memo stats of the deterministic UDFs in the expressions.
+   */
+  udf::UDFMemoStats MemoStats() const;
+
  protected:
   // Function called for each individual expression in expressions_.
   // Implement in derived class.
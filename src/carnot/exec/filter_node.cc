@@ -71,6 +71,11 @@ Status FilterNode::OpenImpl(ExecState* exec_state) {
 }
 
 Status FilterNode::CloseImpl(ExecState* exec_state) {
+  udf::UDFMemoStats memo_stats = evaluator_->MemoStats();
+  if (memo_stats.lookups() > 0) {
+    stats()->AddExtraMetric("udf_memo_hits", memo_stats.hits);
+    stats()->AddExtraMetric("udf_memo_hit_rate", memo_stats.hit_rate());
+  }
   PL_RETURN_IF_ERROR(evaluator_->Close(exec_state));
   return Status::OK();
 }
@@ -132,6 +137,7 @@ Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& p
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
   // Current implementation does not merge across row batches, we should
   // consider this for cases where the filter has really low selectivity.
+  function_ctx_->NextBatch();
   PL_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
                                          exec_state, rb, *plan_node_->expression()));
 
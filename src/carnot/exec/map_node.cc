@@ -58,6 +58,11 @@ Status MapNode::OpenImpl(ExecState* exec_state) {
 
 Status MapNode::CloseImpl(ExecState* exec_state) {
   stats()->AddExtraInfo("expressions", DebugString());
+  udf::UDFMemoStats memo_stats = evaluator_->MemoStats();
+  if (memo_stats.lookups() > 0) {
+    stats()->AddExtraMetric("udf_memo_hits", memo_stats.hits);
+    stats()->AddExtraMetric("udf_memo_hit_rate", memo_stats.hit_rate());
+  }
   PL_RETURN_IF_ERROR(evaluator_->Close(exec_state));
   return Status::OK();
 }
@@ -24,12 +24,15 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <absl/strings/substitute.h>
 #include "third_party/eigen3/Eigen/Core"
 
+#include "src/carnot/exec/ml/float_vector.h"
+#include "src/carnot/exec/ml/parallel.h"
 #include "src/common/base/base.h"
 
 namespace px {
@@ -72,6 +75,10 @@ class WeightedPointSet {
   }
 
   void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) {
+    if (FLAGS_ml_encode_float_vectors) {
+      ToEncodedJSON(writer);
+      return;
+    }
     writer->StartObject();
     writer->Key("points");
     writer->StartArray();
@@ -95,8 +102,12 @@ class WeightedPointSet {
   void FromJSON(const rapidjson::Document::ValueType& doc) {
     DCHECK(doc.IsObject());
     DCHECK(doc.HasMember("points"));
-    DCHECK(doc["points"].IsArray());
     DCHECK(doc.HasMember("weights"));
+    if (doc["points"].IsString()) {
+      FromEncodedJSON(doc);
+      return;
+    }
+    DCHECK(doc["points"].IsArray());
     DCHECK(doc["weights"].IsArray());
 
     const rapidjson::Value& points = doc["points"];
@@ -118,6 +129,38 @@ class WeightedPointSet {
     size_ = points.Size();
   }
 
+  /**
+   * Writes the point set to a binary UDA state writer (udf::UDAStateWriter), as packed arrays.
+   */
+  template <typename TWriter>
+  void Serialize(TWriter* writer) const {
+    int32_t point_size = size_ > 0 ? point_size_ : 0;
+    writer->Write(point_size);
+    // Copy the points, since the matrix may have more rows allocated than there are points.
+    Eigen::MatrixXf points = points_.topRows(size_);
+    writer->WriteArray(points.data(), points.size());
+    writer->WriteArray(weights_.data(), size_);
+  }
+
+  template <typename TReader>
+  Status Deserialize(TReader* reader) {
+    int32_t point_size;
+    std::vector<float> points;
+    std::vector<float> weights;
+    PL_RETURN_IF_ERROR(reader->Read(&point_size));
+    PL_RETURN_IF_ERROR(reader->ReadArray(&points));
+    PL_RETURN_IF_ERROR(reader->ReadArray(&weights));
+    if (point_size < 0 || points.size() != weights.size() * point_size) {
+      return error::InvalidArgument("Point set has $0 values for $1 points of size $2",
+                                    points.size(), weights.size(), point_size);
+    }
+    size_ = weights.size();
+    point_size_ = point_size;
+    points_ = Eigen::Map<Eigen::MatrixXf>(points.data(), size_, point_size_);
+    weights_ = Eigen::Map<Eigen::VectorXf>(weights.data(), size_);
+    return Status::OK();
+  }
+
   static std::shared_ptr<WeightedPointSet> CreateFromJSON(
       const rapidjson::Document::ValueType& doc) {
     auto set = std::make_shared<WeightedPointSet>();
@@ -131,6 +174,38 @@ class WeightedPointSet {
   int size() const { return size_; }
 
  protected:
+  // Writes the points and weights as encoded float vectors, which are much cheaper to format and
+  // parse than JSON arrays.
+  void ToEncodedJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) {
+    writer->StartObject();
+    writer->Key("point_size");
+    writer->Int(size_ > 0 ? point_size_ : 0);
+    writer->Key("points");
+    std::string points = EncodeFloatMatrix(points_.topRows(size_));
+    writer->String(points.data(), points.size());
+    writer->Key("weights");
+    std::string weights = EncodeFloatVector(weights_.data(), size_);
+    writer->String(weights.data(), weights.size());
+    writer->EndObject();
+  }
+
+  void FromEncodedJSON(const rapidjson::Document::ValueType& doc) {
+    DCHECK(doc.HasMember("point_size"));
+    DCHECK(doc["point_size"].IsInt());
+    DCHECK(doc["weights"].IsString());
+    point_size_ = doc["point_size"].GetInt();
+    bool decoded = DecodeFloatMatrix(
+        std::string_view(doc["points"].GetString(), doc["points"].GetStringLength()), point_size_,
+        &points_);
+    ECHECK(decoded) << "Invalid encoded points";
+    size_ = points_.rows();
+    weights_.resize(size_);
+    int num_weights = DecodeFloatVector(
+        std::string_view(doc["weights"].GetString(), doc["weights"].GetStringLength()),
+        weights_.data(), size_);
+    ECHECK_EQ(size_, num_weights);
+  }
+
   int size_;
   int point_size_;
   Eigen::MatrixXf points_;
@@ -207,18 +282,48 @@ class CoresetTree {
       }
     }
 
-    // Fix the r-way tree by coresetting any levels that have r or more buckets after merge.
+    // Fix the r-way tree by coresetting any levels that have r or more buckets after merge. These
+    // levels are independent of each other, so they are coresetted in parallel.
+    std::vector<size_t> full_levels;
+    int64_t work = 0;
     for (auto i = 0UL; i < levels_.size(); i++) {
       if (levels_[i].size() >= r_) {
-        auto merged =
-            TCoreset::FromWeightedPointSet(WeightedPointSet::Union(levels_[i]), coreset_size_);
-        levels_[i].clear();
-        if (i == levels_.size() - 1) {
-          levels_.emplace_back();
+        full_levels.push_back(i);
+        // Coresetting takes in the order of ten operations per value.
+        for (const auto& set : levels_[i]) {
+          work += int64_t{10} * set->size() * set->point_size();
         }
-        levels_[i + 1].push_back(std::move(merged));
       }
     }
+    std::vector<std::shared_ptr<WeightedPointSet>> merged(levels_.size());
+    ParallelFor(full_levels.size(), NumThreadsForWork(work, FLAGS_ml_num_threads),
+                [&](int64_t begin, int64_t end, int) {
+                  for (auto j = begin; j < end; j++) {
+                    auto i = full_levels[j];
+                    merged[i] = TCoreset::FromWeightedPointSet(WeightedPointSet::Union(levels_[i]),
+                                                               coreset_size_);
+                  }
+                });
+
+    // Move each coreset up a level. A level that wasn't full can become full by receiving one.
+    std::shared_ptr<WeightedPointSet> carry;
+    for (auto i = 0UL; i < levels_.size(); i++) {
+      if (merged[i] != nullptr) {
+        levels_[i].clear();
+      }
+      if (carry != nullptr) {
+        levels_[i].push_back(std::move(carry));
+      }
+      carry = std::move(merged[i]);
+      if (levels_[i].size() >= r_) {
+        carry = TCoreset::FromWeightedPointSet(WeightedPointSet::Union(levels_[i]), coreset_size_);
+        levels_[i].clear();
+      }
+    }
+    if (carry != nullptr) {
+      levels_.emplace_back();
+      levels_.back().push_back(std::move(carry));
+    }
   }
 
   void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const {
@@ -243,6 +348,43 @@ class CoresetTree {
     writer->EndObject();
   }
 
+  template <typename TWriter>
+  void Serialize(TWriter* writer) const {
+    writer->Write(static_cast<uint64_t>(coreset_size_));
+    writer->Write(static_cast<uint64_t>(r_));
+    writer->Write(static_cast<uint32_t>(levels_.size()));
+    for (const auto& level : levels_) {
+      writer->Write(static_cast<uint32_t>(level.size()));
+      for (const auto& set : level) {
+        set->Serialize(writer);
+      }
+    }
+  }
+
+  template <typename TReader>
+  Status Deserialize(TReader* reader) {
+    uint64_t coreset_size;
+    uint64_t r;
+    uint32_t num_levels;
+    PL_RETURN_IF_ERROR(reader->Read(&coreset_size));
+    PL_RETURN_IF_ERROR(reader->Read(&r));
+    PL_RETURN_IF_ERROR(reader->Read(&num_levels));
+    coreset_size_ = coreset_size;
+    r_ = r;
+    levels_.clear();
+    levels_.resize(num_levels);
+    for (auto& level : levels_) {
+      uint32_t num_sets;
+      PL_RETURN_IF_ERROR(reader->Read(&num_sets));
+      for (uint32_t i = 0; i < num_sets; ++i) {
+        auto set = std::make_shared<WeightedPointSet>();
+        PL_RETURN_IF_ERROR(set->Deserialize(reader));
+        level.push_back(std::move(set));
+      }
+    }
+    return Status::OK();
+  }
+
   void FromJSON(const rapidjson::Document::ValueType& doc) {
     DCHECK(doc.IsObject());
     DCHECK(doc.HasMember("coreset_size"));
@@ -331,6 +473,24 @@ class CoresetDriver {
     return sb.GetString();
   }
 
+  template <typename TWriter>
+  void Serialize(TWriter* writer) const {
+    CurrentSet()->Serialize(writer);
+    coreset_data_.Serialize(writer);
+  }
+
+  template <typename TReader>
+  Status Deserialize(TReader* reader) {
+    auto set = std::make_shared<WeightedPointSet>();
+    PL_RETURN_IF_ERROR(set->Deserialize(reader));
+    if (set->size() >= m_ || (set->size() > 0 && set->point_size() != d_)) {
+      return error::InvalidArgument("Base set of $0 points of size $1 doesn't fit in $2x$3",
+                                    set->size(), set->point_size(), m_, d_);
+    }
+    GatherPointsFromSet(set);
+    return coreset_data_.Deserialize(reader);
+  }
+
   void FromJSON(std::string data) {
     rapidjson::Document doc;
     doc.Parse(data.data());
@@ -19,12 +19,15 @@
 #include <benchmark/benchmark.h>
 
 #include "src/carnot/exec/ml/coreset.h"
+#include "src/carnot/udf/uda_state.h"
 #include "src/common/perf/perf.h"
 
 using px::carnot::exec::ml::CoresetDriver;
 using px::carnot::exec::ml::CoresetTree;
 using px::carnot::exec::ml::KMeansCoreset;
 using px::carnot::exec::ml::WeightedPointSet;
+using px::carnot::udf::UDAStateReader;
+using px::carnot::udf::UDAStateWriter;
 
 // NOLINTNEXTLINE : runtime/references.
 static void BM_CoresetTreeUpdate(benchmark::State& state) {
@@ -69,6 +72,31 @@ static void BM_CoresetTreeMerge(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CoresetTreeMergeThreads(benchmark::State& state) {
+  // Uses large coresets, and fills several levels of both trees so that they all need coresetting
+  // after the merge.
+  int d = 64;
+  int m = 1024;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver1(m, d, 4, m);
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver2(m, d, 4, m);
+  Eigen::VectorXf point = Eigen::VectorXf::Random(d);
+  for (int i = 0; i < m * 63; i++) {
+    driver1.Update(point);
+    driver2.Update(point);
+  }
+
+  int num_threads = FLAGS_ml_num_threads;
+  FLAGS_ml_num_threads = state.range(0);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto driver = driver1;
+    state.ResumeTiming();
+    driver.Merge(driver2);
+  }
+  FLAGS_ml_num_threads = num_threads;
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_CoresetFromWeightedPointSet(benchmark::State& state) {
   int d = 65;
@@ -111,9 +139,52 @@ static void BM_CoresetDeserialize(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CoresetSerializeBinary(benchmark::State& state) {
+  int d = 64;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
+  Eigen::VectorXf point = Eigen::VectorXf::Random(d);
+  for (int i = 0; i < 10000; i++) {
+    driver.Update(point);
+  }
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    UDAStateWriter writer(/*version*/ 1);
+    driver.Serialize(&writer);
+    auto serialized = writer.Finish();
+    bytes = serialized.size();
+    benchmark::DoNotOptimize(serialized);
+  }
+  state.counters["state_bytes"] = bytes;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CoresetDeserializeBinary(benchmark::State& state) {
+  int d = 64;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
+  Eigen::VectorXf point = Eigen::VectorXf::Random(d);
+  for (int i = 0; i < 10000; i++) {
+    driver.Update(point);
+  }
+  UDAStateWriter writer(/*version*/ 1);
+  driver.Serialize(&writer);
+  auto serialized = writer.Finish();
+
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver2(64, d, 4, 64);
+
+  for (auto _ : state) {
+    auto reader = UDAStateReader::Create(serialized, 1).ConsumeValueOrDie();
+    PL_CHECK_OK(driver2.Deserialize(&reader));
+  }
+}
+
 BENCHMARK(BM_CoresetTreeUpdate);
 BENCHMARK(BM_CoresetFromWeightedPointSet);
 BENCHMARK(BM_CoresetTreeQuery);
 BENCHMARK(BM_CoresetTreeMerge);
+BENCHMARK(BM_CoresetTreeMergeThreads)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_CoresetSerialize);
 BENCHMARK(BM_CoresetDeserialize);
+BENCHMARK(BM_CoresetSerializeBinary);
+BENCHMARK(BM_CoresetDeserializeBinary);
@@ -20,6 +20,8 @@
 #include <gtest/gtest.h>
 
 #include "src/carnot/exec/ml/coreset.h"
+#include "src/carnot/udf/uda_state.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -81,6 +83,25 @@ TEST(CoresetDriver, merge) {
   EXPECT_EQ(192, driver1.Query()->size());
 }
 
+TEST(CoresetDriver, merge_full_levels) {
+  int d = 64;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver1(64, d, 4, 64);
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver2(64, d, 4, 64);
+  Eigen::VectorXf point = Eigen::VectorXf::Random(d);
+  // Insert 3 + 3 * 4 + 3 * 16 + 3 * 64 buckets into each driver, which leaves 3 buckets on each of
+  // the first 4 levels.
+  for (int i = 0; i < 64 * 255; i++) {
+    driver1.Update(point);
+    driver2.Update(point);
+  }
+  EXPECT_EQ(12 * 64, driver1.Query()->size());
+
+  driver1.Merge(driver2);
+  // After merging, each of the first 4 levels has 6 buckets, which get coresetted into a bucket on
+  // the next level. This leaves a bucket on each of the second to fifth levels.
+  EXPECT_EQ(4 * 64, driver1.Query()->size());
+}
+
 TEST(CoresetDriver, serialization) {
   // Create a coreset driver using the Coreset R-way tree data structure, and kmeans coresets.
   // Uses base buckets of size 64, points of size 64, 4-way tree, and coresets of size 64.
@@ -105,6 +126,34 @@ TEST(CoresetDriver, serialization) {
   EXPECT_EQ(256, point_set->size());
 }
 
+TEST(CoresetDriver, binary_serialization) {
+  int d = 64;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
+  Eigen::VectorXf point = Eigen::VectorXf::Random(d);
+  // Insert 10 and a half buckets worth of points, so that the base set isn't empty.
+  for (int i = 0; i < 64 * 10 + 32; i++) {
+    driver.Update(point);
+  }
+  udf::UDAStateWriter writer(/*version*/ 1);
+  driver.Serialize(&writer);
+  std::string serialized = writer.Finish();
+  // The binary state should be much smaller than the JSON one.
+  EXPECT_LT(serialized.size(), driver.ToJSON().size());
+
+  ASSERT_OK_AND_ASSIGN(auto reader, udf::UDAStateReader::Create(serialized, 1));
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver2(64, d, 4, 64);
+  ASSERT_OK(driver2.Deserialize(&reader));
+  EXPECT_TRUE(reader.done());
+  // 4 buckets in the tree plus the 32 points in the base set.
+  EXPECT_EQ(256 + 32, driver2.Query()->size());
+
+  // A truncated state should fail to deserialize rather than produce a partial coreset.
+  ASSERT_OK_AND_ASSIGN(auto truncated, udf::UDAStateReader::Create(
+                                           std::string_view(serialized).substr(0, 100), 1));
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver3(64, d, 4, 64);
+  EXPECT_NOT_OK(driver3.Deserialize(&truncated));
+}
+
 }  // namespace ml
 }  // namespace exec
 }  // namespace carnot
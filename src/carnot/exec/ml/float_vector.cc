@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/ml/float_vector.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <absl/strings/escaping.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+DEFINE_bool(ml_encode_float_vectors, true,
+            "Pass embeddings, k-means models and coresets between funcs as base64 encoded float32 "
+            "vectors instead of JSON arrays. Disable while agents from before the encoding was "
+            "added still run, or for consumers that need JSON arrays.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+std::string EncodeFloatVector(const float* data, size_t size) {
+  std::string out(kFloatVectorPrefix);
+  out.append(absl::Base64Escape(
+      std::string_view(reinterpret_cast<const char*>(data), size * sizeof(float))));
+  return out;
+}
+
+std::string FormatFloatVector(const float* data, size_t size) {
+  if (FLAGS_ml_encode_float_vectors) {
+    return EncodeFloatVector(data, size);
+  }
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartArray();
+  for (size_t i = 0; i < size; i++) {
+    writer.Double(data[i]);
+  }
+  writer.EndArray();
+  return sb.GetString();
+}
+
+namespace {
+
+// Returns the raw float32 bytes of an encoded vector, or false if in is not a valid encoding.
+bool DecodeBytes(std::string_view in, std::string* bytes) {
+  if (!IsEncodedFloatVector(in)) {
+    return false;
+  }
+  in.remove_prefix(kFloatVectorPrefix.size());
+  if (!absl::Base64Unescape(in, bytes)) {
+    return false;
+  }
+  return bytes->size() % sizeof(float) == 0;
+}
+
+}  // namespace
+
+int DecodeFloatVector(std::string_view in, float* out, int max_num) {
+  std::string bytes;
+  if (!DecodeBytes(in, &bytes)) {
+    return 0;
+  }
+  int num = std::min<int>(max_num, bytes.size() / sizeof(float));
+  std::memcpy(out, bytes.data(), num * sizeof(float));
+  return num;
+}
+
+bool DecodeFloatMatrix(std::string_view in, int cols, Eigen::MatrixXf* out) {
+  std::string bytes;
+  if (!DecodeBytes(in, &bytes)) {
+    return false;
+  }
+  size_t size = bytes.size() / sizeof(float);
+  if (cols <= 0) {
+    out->resize(0, 0);
+    return size == 0;
+  }
+  if (size % cols != 0) {
+    return false;
+  }
+  out->resize(size / cols, cols);
+  std::memcpy(out->data(), bytes.data(), bytes.size());
+  return true;
+}
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
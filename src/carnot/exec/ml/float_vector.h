@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <absl/strings/match.h>
+
+#include "src/common/base/base.h"
+#include "third_party/eigen3/Eigen/Core"
+
+DECLARE_bool(ml_encode_float_vectors);
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+/**
+ * Float vectors, such as embeddings, are passed between funcs as strings. Formatting each float as
+ * decimal JSON costs more than the math done on the vectors, so by default they are encoded as the
+ * prefix below followed by the base64 of their float32 values. With --ml_encode_float_vectors=false
+ * they are JSON arrays, which agents from before the encoding read. Funcs read both.
+ */
+constexpr std::string_view kFloatVectorPrefix = "f32:";
+
+std::string EncodeFloatVector(const float* data, size_t size);
+
+/**
+ * Returns the floats encoded by EncodeFloatVector, or as a JSON array with
+ * --ml_encode_float_vectors=false.
+ */
+std::string FormatFloatVector(const float* data, size_t size);
+
+inline std::string EncodeFloatVector(const Eigen::VectorXf& vec) {
+  return EncodeFloatVector(vec.data(), vec.size());
+}
+
+/**
+ * Returns whether in was produced by EncodeFloatVector.
+ */
+inline bool IsEncodedFloatVector(std::string_view in) {
+  return absl::StartsWith(in, kFloatVectorPrefix);
+}
+
+/**
+ * Decodes a vector encoded by EncodeFloatVector into out, which must hold max_num floats.
+ * Returns the number of floats decoded, or 0 if in is not a valid encoding.
+ */
+int DecodeFloatVector(std::string_view in, float* out, int max_num);
+
+/**
+ * Encodes the coefficients of a matrix, in column major order. The number of columns has to be
+ * stored separately to decode it.
+ */
+inline std::string EncodeFloatMatrix(const Eigen::MatrixXf& matrix) {
+  return EncodeFloatVector(matrix.data(), matrix.size());
+}
+
+/**
+ * Decodes a matrix encoded by EncodeFloatMatrix, with the given number of columns, into out.
+ * Returns false if in is not a valid encoding.
+ */
+bool DecodeFloatMatrix(std::string_view in, int cols, Eigen::MatrixXf* out);
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/carnot/exec/ml/float_vector.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+TEST(FloatVector, roundtrip) {
+  Eigen::VectorXf vec(4);
+  vec << 1.0f, -2.5f, 3.25e-7f, 1e30f;
+  std::string encoded = EncodeFloatVector(vec);
+  EXPECT_TRUE(IsEncodedFloatVector(encoded));
+
+  Eigen::VectorXf decoded(4);
+  ASSERT_EQ(4, DecodeFloatVector(encoded, decoded.data(), 4));
+  EXPECT_EQ(vec, decoded);
+}
+
+TEST(FloatVector, decode_truncates_to_max_num) {
+  Eigen::VectorXf vec(4);
+  vec << 1.0f, 2.0f, 3.0f, 4.0f;
+  Eigen::VectorXf decoded(2);
+  ASSERT_EQ(2, DecodeFloatVector(EncodeFloatVector(vec), decoded.data(), 2));
+  EXPECT_EQ(vec.head(2), decoded);
+}
+
+TEST(FloatVector, decode_invalid) {
+  float out[4];
+  EXPECT_FALSE(IsEncodedFloatVector("[1.0, 2.0]"));
+  EXPECT_EQ(0, DecodeFloatVector("[1.0, 2.0]", out, 4));
+  EXPECT_EQ(0, DecodeFloatVector("f32:!!!", out, 4));
+  // 3 bytes is not a whole float.
+  EXPECT_EQ(0, DecodeFloatVector("f32:AAAA", out, 4));
+}
+
+TEST(FloatVector, format) {
+  const float vec[] = {1.0f, -2.5f};
+  EXPECT_EQ(EncodeFloatVector(vec, 2), FormatFloatVector(vec, 2));
+
+  FLAGS_ml_encode_float_vectors = false;
+  std::string json = FormatFloatVector(vec, 2);
+  FLAGS_ml_encode_float_vectors = true;
+  EXPECT_EQ("[1.0,-2.5]", json);
+}
+
+TEST(FloatVector, matrix_roundtrip) {
+  Eigen::MatrixXf matrix(3, 2);
+  matrix << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f;
+  Eigen::MatrixXf decoded;
+  ASSERT_TRUE(DecodeFloatMatrix(EncodeFloatMatrix(matrix), matrix.cols(), &decoded));
+  EXPECT_EQ(matrix, decoded);
+
+  EXPECT_FALSE(DecodeFloatMatrix(EncodeFloatMatrix(matrix), 4, &decoded));
+}
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
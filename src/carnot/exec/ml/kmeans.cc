@@ -18,6 +18,7 @@
 
 #include "src/carnot/exec/ml/kmeans.h"
 #include <random>
+#include <vector>
 
 #include "src/carnot/exec/ml/sampling.h"
 
@@ -31,8 +32,8 @@ void KMeans::Fit(std::shared_ptr<WeightedPointSet> set) {
     LOG(ERROR) << "Fitting KMeans on less than 2 points is currently unsupported.";
     return;
   }
-  auto points = set->points();
-  auto weights = set->weights();
+  const auto& points = set->points();
+  const auto& weights = set->weights();
 
   centroids_.resize(k_, points.cols());
   switch (init_type_) {
@@ -42,6 +43,14 @@ void KMeans::Fit(std::shared_ptr<WeightedPointSet> set) {
 
   int iter_count = 0;
   bool changed = true;
+  if (mini_batch_size_ > 0 && mini_batch_size_ < points.rows()) {
+    Eigen::ArrayXf centroid_weights = Eigen::ArrayXf::Zero(k_);
+    while (iter_count < max_iters_ && changed) {
+      changed = MiniBatchIteration(points, weights, &centroid_weights);
+      iter_count++;
+    }
+    return;
+  }
   while (iter_count < max_iters_ && changed) {
     changed = LloydsIteration(points, weights);
     iter_count++;
@@ -49,17 +58,33 @@ void KMeans::Fit(std::shared_ptr<WeightedPointSet> set) {
 }
 
 bool KMeans::LloydsIteration(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights) {
-  Eigen::MatrixXf new_centroids = Eigen::MatrixXf::Zero(centroids_.rows(), centroids_.cols());
-  Eigen::ArrayXf centroid_weights = Eigen::ArrayXf::Zero(centroids_.rows());
-
-  for (int i = 0; i < points.rows(); i++) {
-    Eigen::VectorXf::Index closest_centroid;
-    (centroids_.rowwise() - points(i, Eigen::all))
-        .rowwise()
-        .squaredNorm()
-        .minCoeff(&closest_centroid);
-    new_centroids(closest_centroid, Eigen::all) += weights(i) * points(i, Eigen::all);
-    centroid_weights(closest_centroid) += weights(i);
+  int num_threads = NumThreadsForWork(points.size() * k_, num_threads_);
+
+  // Each thread sums up its own range of points. The partial sums are then added up in a fixed
+  // order, so that the result only depends on the number of threads.
+  std::vector<Eigen::MatrixXf> partial_centroids(
+      num_threads, Eigen::MatrixXf::Zero(centroids_.rows(), centroids_.cols()));
+  std::vector<Eigen::ArrayXf> partial_weights(num_threads,
+                                              Eigen::ArrayXf::Zero(centroids_.rows()));
+  ParallelFor(points.rows(), num_threads, [&](int64_t begin, int64_t end, int thread_idx) {
+    Eigen::MatrixXf& sums = partial_centroids[thread_idx];
+    Eigen::ArrayXf& sum_weights = partial_weights[thread_idx];
+    for (int64_t i = begin; i < end; i++) {
+      Eigen::VectorXf::Index closest_centroid;
+      (centroids_.rowwise() - points(i, Eigen::all))
+          .rowwise()
+          .squaredNorm()
+          .minCoeff(&closest_centroid);
+      sums(closest_centroid, Eigen::all) += weights(i) * points(i, Eigen::all);
+      sum_weights(closest_centroid) += weights(i);
+    }
+  });
+
+  Eigen::MatrixXf new_centroids = std::move(partial_centroids[0]);
+  Eigen::ArrayXf centroid_weights = std::move(partial_weights[0]);
+  for (int i = 1; i < num_threads; i++) {
+    new_centroids += partial_centroids[i];
+    centroid_weights += partial_weights[i];
   }
 
   for (int i = 0; i < k_; i++) {
@@ -77,22 +102,63 @@ bool KMeans::LloydsIteration(const Eigen::MatrixXf& points, const Eigen::VectorX
   return true;
 }
 
+bool KMeans::MiniBatchIteration(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights,
+                                Eigen::ArrayXf* centroid_weights) {
+  std::uniform_int_distribution<> dist(0, points.rows() - 1);
+  std::vector<int> batch(mini_batch_size_);
+  for (auto& i : batch) {
+    i = dist(random_gen_);
+  }
+
+  // Assign the whole batch before moving any centroid.
+  std::vector<Eigen::VectorXf::Index> closest_centroids(batch.size());
+  int num_threads = NumThreadsForWork(int64_t{mini_batch_size_} * points.cols() * k_, num_threads_);
+  ParallelFor(batch.size(), num_threads, [&](int64_t begin, int64_t end, int) {
+    for (int64_t i = begin; i < end; i++) {
+      (centroids_.rowwise() - points(batch[i], Eigen::all))
+          .rowwise()
+          .squaredNorm()
+          .minCoeff(&closest_centroids[i]);
+    }
+  });
+
+  Eigen::MatrixXf old_centroids = centroids_;
+  for (size_t i = 0; i < batch.size(); i++) {
+    auto c = closest_centroids[i];
+    float weight = weights(batch[i]);
+    (*centroid_weights)(c) += weight;
+    if ((*centroid_weights)(c) <= 0.0f) {
+      continue;
+    }
+    // Each centroid moves towards its points with a learning rate that decreases as it gets
+    // assigned more weight, which makes it the weighted mean of all the points assigned to it.
+    float learning_rate = weight / (*centroid_weights)(c);
+    centroids_(c, Eigen::all) = (1.0f - learning_rate) * centroids_(c, Eigen::all) +
+                                learning_rate * points(batch[i], Eigen::all);
+  }
+  return !centroids_.isApprox(old_centroids);
+}
+
 void KMeans::KMeansPlusPlusInit(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights) {
   std::uniform_int_distribution<> dist(0, points.rows() - 1);
   auto firstCentroid = dist(random_gen_);
   centroids_(0, Eigen::all) = points(firstCentroid, Eigen::all);
 
+  int num_threads = NumThreadsForWork(points.size(), num_threads_);
+  // The squared distance of each point to its closest centroid so far.
+  Eigen::VectorXf minDist(points.rows());
   Eigen::VectorXf probDist(points.rows());
   for (auto i = 1; i < k_; i++) {
-    for (auto j = 0; j < probDist.rows(); j++) {
-      auto point = points(j, Eigen::all);
-      Eigen::VectorXf::Index closestCentroid;
-      auto dist = (centroids_(Eigen::seq(0, i - 1), Eigen::all).rowwise() - point)
-                      .rowwise()
-                      .squaredNorm()
-                      .minCoeff(&closestCentroid);
-      probDist(j) = weights(j) * dist;
-    }
+    // Only the distances to the centroid chosen last need to be computed.
+    ParallelFor(points.rows(), num_threads, [&](int64_t begin, int64_t end, int) {
+      for (auto j = begin; j < end; j++) {
+        float dist = (centroids_(i - 1, Eigen::all) - points(j, Eigen::all)).squaredNorm();
+        if (i == 1 || dist < minDist(j)) {
+          minDist(j) = dist;
+        }
+        probDist(j) = weights(j) * minDist(j);
+      }
+    });
     std::discrete_distribution<> pointDist(probDist.begin(), probDist.end());
     auto ind = pointDist(random_gen_);
     centroids_(i, Eigen::all) = points(ind, Eigen::all);
@@ -139,8 +205,16 @@ std::string KMeans::ToJSON() {
   writer.Int(k_);
   writer.Key("init_type");
   writer.Int(static_cast<int>(init_type_));
-  writer.Key("centroids");
-  write_matrix_to_json(&writer, centroids_);
+  if (FLAGS_ml_encode_float_vectors) {
+    writer.Key("dims");
+    writer.Int(centroids_.cols());
+    writer.Key("centroids");
+    std::string centroids = EncodeFloatMatrix(centroids_);
+    writer.String(centroids.data(), centroids.size());
+  } else {
+    writer.Key("centroids");
+    write_matrix_to_json(&writer, centroids_);
+  }
   writer.EndObject();
   return sb.GetString();
 }
@@ -157,7 +231,17 @@ void KMeans::FromJSON(std::string data) {
 
   k_ = doc["k"].GetInt();
   init_type_ = KMeans::KMeansInitType(doc["init_type"].GetInt());
-  read_matrix_from_json(doc["centroids"], &centroids_);
+  const auto& centroids = doc["centroids"];
+  if (centroids.IsString()) {
+    DCHECK(doc.HasMember("dims"));
+    DCHECK(doc["dims"].IsInt());
+    bool decoded = DecodeFloatMatrix(
+        std::string_view(centroids.GetString(), centroids.GetStringLength()),
+        doc["dims"].GetInt(), &centroids_);
+    ECHECK(decoded) << "Invalid encoded centroids";
+    return;
+  }
+  read_matrix_from_json(centroids, &centroids_);
 }
 
 }  // namespace ml
@@ -23,6 +23,7 @@
 #include <string>
 
 #include "src/carnot/exec/ml/coreset.h"
+#include "src/carnot/exec/ml/parallel.h"
 
 namespace px {
 namespace carnot {
@@ -53,11 +54,27 @@ class KMeans {
 
   const Eigen::MatrixXf& centroids() const { return centroids_; }
 
+  /**
+   * Sets the maximum number of threads used by Fit. Defaults to --ml_num_threads.
+   **/
+  void set_num_threads(int num_threads) { num_threads_ = num_threads; }
+
+  /**
+   * Makes Fit run mini-batch k-means (https://dl.acm.org/doi/10.1145/1772690.1772862), which
+   * updates the centroids from a random sample of batch_size points in each of max_iters
+   * iterations, instead of from every point. A batch_size of 0 (the default) runs Lloyd's
+   * algorithm on every point.
+   **/
+  void set_mini_batch_size(int batch_size) { mini_batch_size_ = batch_size; }
+
   std::string ToJSON();
   void FromJSON(std::string data);
 
  private:
   bool LloydsIteration(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights);
+  // centroid_weights holds the total weight of the points assigned to each centroid so far.
+  bool MiniBatchIteration(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights,
+                          Eigen::ArrayXf* centroid_weights);
   void KMeansPlusPlusInit(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights);
 
   int k_;
@@ -65,6 +82,8 @@ class KMeans {
   KMeansInitType init_type_;
   Eigen::MatrixXf centroids_;
   std::mt19937 random_gen_;
+  int num_threads_ = FLAGS_ml_num_threads;
+  int mini_batch_size_ = 0;
 };
 
 }  // namespace ml
@@ -58,5 +58,40 @@ static void BM_KMeansTransform(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_KMeansFitThreads(benchmark::State& state) {
+  int k = 16;
+  int d = 64;
+  KMeans kmeans(k);
+  kmeans.set_num_threads(state.range(0));
+
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(50000, d);
+  Eigen::VectorXf weights = Eigen::VectorXf::Ones(50000);
+  auto set = std::make_shared<WeightedPointSet>(points, weights);
+
+  for (auto _ : state) {
+    kmeans.Fit(set);
+  }
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_KMeansFitMiniBatch(benchmark::State& state) {
+  int k = 16;
+  int d = 64;
+  KMeans kmeans(k);
+  kmeans.set_num_threads(1);
+  kmeans.set_mini_batch_size(state.range(0));
+
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(50000, d);
+  Eigen::VectorXf weights = Eigen::VectorXf::Ones(50000);
+  auto set = std::make_shared<WeightedPointSet>(points, weights);
+
+  for (auto _ : state) {
+    kmeans.Fit(set);
+  }
+}
+
 BENCHMARK(BM_KMeansFit);
 BENCHMARK(BM_KMeansTransform);
+BENCHMARK(BM_KMeansFitThreads)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KMeansFitMiniBatch)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
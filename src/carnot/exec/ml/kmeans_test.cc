@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "src/carnot/exec/ml/coreset.h"
@@ -60,7 +61,11 @@ TEST(KMeans, serialize_deserialize) {
 
   kmeans.Fit(set);
 
+  // The JSON array layout, as written with the encoding disabled.
+  FLAGS_ml_encode_float_vectors = false;
   auto serialized = kmeans.ToJSON();
+  FLAGS_ml_encode_float_vectors = true;
+  EXPECT_THAT(serialized, ::testing::Not(::testing::HasSubstr(std::string(kFloatVectorPrefix))));
 
   KMeans kmeans2(k);
   kmeans2.FromJSON(serialized);
@@ -69,6 +74,30 @@ TEST(KMeans, serialize_deserialize) {
   EXPECT_THAT(kmeans2.centroids(), UnorderedRowsAre(points, 1e-6f));
 }
 
+TEST(KMeans, serialize_deserialize_encoded) {
+  Eigen::MatrixXf points(2, 2);
+  points << 1.0f, 2.0f, 3.0f, 4.0f;
+  auto set = std::make_shared<WeightedPointSet>(points, Eigen::VectorXf::Ones(2));
+  KMeans kmeans(2);
+  kmeans.Fit(set);
+
+  auto serialized = kmeans.ToJSON();
+  EXPECT_THAT(serialized, ::testing::HasSubstr(std::string(kFloatVectorPrefix)));
+
+  KMeans kmeans2(0);
+  kmeans2.FromJSON(serialized);
+  EXPECT_THAT(kmeans2.centroids(), UnorderedRowsAre(points, 1e-6f));
+}
+
+TEST(KMeans, deserialize_json_arrays) {
+  KMeans kmeans(0);
+  kmeans.FromJSON(R"({"k": 2, "init_type": 0, "centroids": [[1.0, 2.0], [3.0, 4.0]]})");
+
+  Eigen::MatrixXf expected(2, 2);
+  expected << 1.0f, 2.0f, 3.0f, 4.0f;
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected, 1e-6f));
+}
+
 TEST(KMeans, trimodal_normal_dist) {
   int k = 3;
 
@@ -96,6 +125,50 @@ TEST(KMeans, trimodal_normal_dist) {
   }
 }
 
+// Returns num_points points spread evenly over the rows of centers, each with a little noise.
+Eigen::MatrixXf clustered_points(const Eigen::MatrixXf& centers, int num_points) {
+  Eigen::MatrixXf points = 0.1f * Eigen::MatrixXf::Random(num_points, centers.cols());
+  for (int i = 0; i < num_points; i++) {
+    points(i, Eigen::all) += centers(i % centers.rows(), Eigen::all);
+  }
+  return points;
+}
+
+TEST(KMeans, parallel_fit) {
+  int k = 4;
+  int d = 16;
+  Eigen::MatrixXf centers = 10.0f * Eigen::MatrixXf::Identity(k, d);
+  // Enough points for Fit to use 4 threads.
+  Eigen::MatrixXf points = clustered_points(centers, 80000);
+  auto set = std::make_shared<WeightedPointSet>(points, Eigen::VectorXf::Ones(points.rows()));
+  ASSERT_EQ(4, NumThreadsForWork(points.size() * k, 4));
+
+  KMeans serial_kmeans(k);
+  serial_kmeans.set_num_threads(1);
+  serial_kmeans.Fit(set);
+
+  KMeans parallel_kmeans(k);
+  parallel_kmeans.set_num_threads(4);
+  parallel_kmeans.Fit(set);
+
+  EXPECT_THAT(parallel_kmeans.centroids(), UnorderedRowsAre(centers, 0.01));
+  EXPECT_THAT(parallel_kmeans.centroids(), IsApproxMatrix(serial_kmeans.centroids(), 1e-5));
+}
+
+TEST(KMeans, mini_batch) {
+  int k = 3;
+  int d = 8;
+  Eigen::MatrixXf centers = 10.0f * Eigen::MatrixXf::Identity(k, d);
+  Eigen::MatrixXf points = clustered_points(centers, 3000);
+  auto set = std::make_shared<WeightedPointSet>(points, Eigen::VectorXf::Ones(points.rows()));
+
+  KMeans kmeans(k, /*max_iters*/ 20);
+  kmeans.set_mini_batch_size(100);
+  kmeans.Fit(set);
+
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(centers, 0.01));
+}
+
 }  // namespace ml
 }  // namespace exec
 }  // namespace carnot
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "src/carnot/exec/ml/parallel.h"
+
+DEFINE_int32(ml_num_threads, 4,
+             "The maximum number of threads used to fit a k-means model or to merge coresets.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+void ParallelFor(int64_t n, int num_threads,
+                 const std::function<void(int64_t begin, int64_t end, int thread_idx)>& fn) {
+  num_threads = static_cast<int>(std::clamp<int64_t>(n, 1, std::max(1, num_threads)));
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(fn, n * i / num_threads, n * (i + 1) / num_threads, i);
+  }
+  fn(0, n / num_threads, 0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+int NumThreadsForWork(int64_t work, int max_threads) {
+  // Starting a thread costs in the order of tens of microseconds, so give each thread at least a
+  // few hundred microseconds of work.
+  constexpr int64_t kMinWorkPerThread = int64_t{1} << 20;
+  return static_cast<int>(
+      std::clamp<int64_t>(work / kMinWorkPerThread, 1, std::max(1, max_threads)));
+}
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
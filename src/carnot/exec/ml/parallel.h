@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "src/common/base/base.h"
+
+DECLARE_int32(ml_num_threads);
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+/**
+ * Splits [0, n) into num_threads contiguous ranges, and calls fn(begin, end, thread_idx) for each
+ * of them in parallel. The calling thread handles the first range, and the call returns once all
+ * ranges are done.
+ */
+void ParallelFor(int64_t n, int num_threads,
+                 const std::function<void(int64_t begin, int64_t end, int thread_idx)>& fn);
+
+/**
+ * Returns the number of threads, at most max_threads, worth splitting the given amount of work
+ * over. The work is measured in floating point operations; splitting small amounts of work isn't
+ * worth the cost of starting threads.
+ */
+int NumThreadsForWork(int64_t work, int max_threads);
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "src/carnot/exec/ml/parallel.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+TEST(ParallelFor, covers_range_once) {
+  std::vector<std::atomic<int>> counts(1001);
+  std::vector<int> range_sizes(4);
+  ParallelFor(counts.size(), 4, [&](int64_t begin, int64_t end, int thread_idx) {
+    range_sizes[thread_idx] = end - begin;
+    for (int64_t i = begin; i < end; i++) {
+      counts[i]++;
+    }
+  });
+  for (const auto& count : counts) {
+    EXPECT_EQ(1, count);
+  }
+  EXPECT_THAT(range_sizes, ::testing::ElementsAre(250, 250, 250, 251));
+}
+
+TEST(ParallelFor, fewer_items_than_threads) {
+  std::vector<int> thread_idxs;
+  ParallelFor(1, 4, [&](int64_t begin, int64_t end, int thread_idx) {
+    EXPECT_EQ(0, begin);
+    EXPECT_EQ(1, end);
+    thread_idxs.push_back(thread_idx);
+  });
+  EXPECT_THAT(thread_idxs, ::testing::ElementsAre(0));
+}
+
+TEST(NumThreadsForWork, splits_large_work) {
+  EXPECT_EQ(1, NumThreadsForWork(1000, 4));
+  EXPECT_EQ(1, NumThreadsForWork(int64_t{1} << 30, 1));
+  EXPECT_EQ(2, NumThreadsForWork(int64_t{2} << 20, 4));
+  EXPECT_EQ(4, NumThreadsForWork(int64_t{1} << 30, 4));
+}
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -18,6 +18,9 @@
 
 #include "src/carnot/exec/ml/transformer_executor.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -50,56 +53,92 @@ static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
 }
 
 void TransformerExecutor::Execute(std::string doc, std::string* out) {
-  // LOG(INFO) << "inputs: " << tf_interpreter_->inputs().size() << "\n";
-  // LOG(INFO) << "input(0) name: " << tf_interpreter_->GetInputName(0) << "\n";
-
-  // int t_size = tf_interpreter_->tensors_size();
-  // for (int i = 0; i < t_size; i++) {
-  //   if (tf_interpreter_->tensor(i)->name) {
-  //     LOG(INFO) << i << ": " << tf_interpreter_->tensor(i)->name << ", "
-  //               << tf_interpreter_->tensor(i)->bytes << ", "
-  //               << tf_interpreter_->tensor(i)->type;
-  //   }
-  // }
-  auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
-  if (input == nullptr) {
-    LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
-    *out = "";
-    return;
-  }
+  std::vector<std::string> outs;
+  ExecuteBatch({std::move(doc)}, &outs);
+  *out = std::move(outs[0]);
+}
 
-  auto count = load_ints_from_json(doc, input, max_length_);
-  if (count == 0) {
-    // Either input array was empty or there was an error parsing the json, either way don't
-    // continue.
-    *out = "";
-    return;
+int TransformerExecutor::ResizeBatch(int batch_size) {
+  if (!batching_supported_) {
+    batch_size = 1;
+  }
+  if (batch_size == batch_size_) {
+    return batch_size_;
+  }
+  auto input_index = tf_interpreter_->inputs()[0];
+  tf_interpreter_->ResizeInputTensor(input_index, {batch_size, max_length_});
+  if (tf_interpreter_->AllocateTensors() == kTfLiteOk &&
+      tf_interpreter_->output_tensor(0)->dims->data[0] == batch_size) {
+    batch_size_ = batch_size;
+    return batch_size_;
   }
 
-  // Add 1 to each token to account for pad token.
-  for (int i = 0; i < count; i++) {
-    input[i] = input[i] + 1;
+  LOG(INFO) << "Transformer model does not support batching, running one doc at a time";
+  batching_supported_ = false;
+  tf_interpreter_->ResizeInputTensor(input_index, {1, max_length_});
+  if (tf_interpreter_->AllocateTensors() != kTfLiteOk) {
+    LOG(ERROR) << "Failed to allocate tensors";
+    batch_size_ = 0;
+    return 0;
   }
+  batch_size_ = 1;
+  return batch_size_;
+}
 
-  for (int i = count; i < max_length_; i++) {
-    input[i] = 0;
+void TransformerExecutor::ExecuteBatch(const std::vector<std::string>& docs,
+                                       std::vector<std::string>* out) {
+  out->assign(docs.size(), "");
+
+  // Tokens of the docs to embed, one row of max_length_ tokens per doc.
+  std::vector<int32_t> tokens;
+  // The index in docs of each row of tokens.
+  std::vector<size_t> rows;
+  for (const auto& [i, doc] : Enumerate(docs)) {
+    tokens.resize((rows.size() + 1) * max_length_);
+    int32_t* row = tokens.data() + rows.size() * max_length_;
+    auto count = load_ints_from_json(doc, row, max_length_);
+    if (count == 0) {
+      // Either input array was empty or there was an error parsing the json, either way don't
+      // embed the doc.
+      tokens.resize(rows.size() * max_length_);
+      continue;
+    }
+
+    // Add 1 to each token to account for pad token.
+    for (int j = 0; j < count; j++) {
+      row[j] = row[j] + 1;
+    }
+
+    for (int j = count; j < max_length_; j++) {
+      row[j] = 0;
+    }
+    rows.push_back(i);
   }
 
-  const int embedding_size = 256;
+  for (size_t start = 0; start < rows.size();) {
+    int batch_size = ResizeBatch(std::min<size_t>(kMaxBatchSize, rows.size() - start));
+    if (batch_size == 0) {
+      return;
+    }
 
-  tf_interpreter_->Invoke();
+    auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
+    if (input == nullptr) {
+      LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
+      return;
+    }
+    std::copy_n(tokens.data() + start * max_length_, batch_size * max_length_, input);
 
-  auto output = tf_interpreter_->typed_output_tensor<float>(0);
+    if (tf_interpreter_->Invoke() != kTfLiteOk) {
+      LOG(ERROR) << "Failed to invoke transformer model";
+      return;
+    }
 
-  // Copy output to json array.
-  rapidjson::StringBuffer sb;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-  writer.StartArray();
-  for (int i = 0; i < embedding_size; i++) {
-    writer.Double(output[i]);
+    auto output = tf_interpreter_->typed_output_tensor<float>(0);
+    for (int b = 0; b < batch_size; ++b) {
+      (*out)[rows[start + b]] = FormatFloatVector(output + b * kEmbeddingSize, kEmbeddingSize);
+    }
+    start += batch_size;
   }
-  writer.EndArray();
-  *out = sb.GetString();
 }
 
 }  // namespace ml
@@ -26,6 +26,8 @@
 #include <tensorflow/lite/model.h>
 #include <memory>
 #include <string>
+#include <vector>
+#include "src/carnot/exec/ml/float_vector.h"
 #include "src/carnot/exec/ml/model_executor.h"
 #include "src/common/base/utils.h"
 
@@ -55,10 +57,25 @@ class TransformerExecutor : public ModelExecutor {
 
   void Execute(std::string doc, std::string* out);
 
+  /**
+   * Embeds each of the docs into the corresponding element of out. Docs are fed to the model in
+   * batches of up to kMaxBatchSize, to amortize the cost of invoking the interpreter.
+   */
+  void ExecuteBatch(const std::vector<std::string>& docs, std::vector<std::string>* out);
+
+  static constexpr int kMaxBatchSize = 64;
+  static constexpr int kEmbeddingSize = 256;
+
  private:
+  // Resizes the input of the model to hold up to batch_size docs, and returns the number of docs
+  // it now holds, or 0 on error. Models with a fixed batch size run one doc at a time.
+  int ResizeBatch(int batch_size);
+
   std::unique_ptr<tflite::Interpreter> tf_interpreter_;
   std::unique_ptr<tflite::FlatBufferModel> model_;
   int max_length_ = 64;
+  int batch_size_ = 1;
+  bool batching_supported_ = true;
 };
 
 }  // namespace ml
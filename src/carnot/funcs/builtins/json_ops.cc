@@ -18,6 +18,8 @@
 
 #include "src/carnot/funcs/builtins/json_ops.h"
 
+#include <algorithm>
+
 #include "src/carnot/udf/registry.h"
 
 namespace px {
@@ -26,6 +28,43 @@ namespace builtins {
 
 using types::StringValue;
 
+const rapidjson::Value* JSONDocumentCache::Parse(uint64_t batch_id, size_t row,
+                                                 std::string_view json) {
+  if (batch_id != batch_id_) {
+    for (auto& entries : rows_) {
+      entries.clear();
+    }
+    allocator_.Clear();
+    batch_id_ = batch_id;
+  }
+  if (row >= rows_.size()) {
+    rows_.resize(row + 1);
+  }
+
+  auto& entries = rows_[row];
+  for (const Entry& entry : entries) {
+    if (entry.json == json) {
+      return entry.valid ? &entry.doc : nullptr;
+    }
+  }
+
+  // Keep a copy of the text to tell apart the values of the row. It is much cheaper than parsing,
+  // and lives in the allocator of the documents.
+  char* text = static_cast<char*>(allocator_.Malloc(json.size()));
+  std::copy(json.begin(), json.end(), text);
+
+  Entry& entry = entries.emplace_back();
+  entry.json = std::string_view(text, json.size());
+  // Parse with the allocator of the cache, and keep only the root value. The memory of the value
+  // lives in the allocator, and the parse stack of the document is released right away.
+  rapidjson::Document parsed(&allocator_);
+  if (!parsed.Parse(text, json.size()).HasParseError()) {
+    entry.doc.Swap(parsed);
+    entry.valid = true;
+  }
+  return entry.valid ? &entry.doc : nullptr;
+}
+
 void RegisterJSONOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<PluckUDF>("pluck");
   registry->RegisterOrDie<PluckAsInt64UDF>("pluck_int64");
@@ -18,10 +18,13 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include <absl/container/inlined_vector.h>
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
@@ -33,24 +36,100 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * JSONDocumentCache keeps the JSON documents parsed from the rows of the current row batch, so that
+ * the plucks of several keys from the same JSON column parse each value only once.
+ *
+ * Funcs share the cache of their FunctionContext, i.e. of their operator. Carnot evaluates the
+ * expressions of an operator one after the other over a whole row batch, so documents are looked up
+ * by their row in the batch rather than by hashing the JSON text. A row keeps one document for
+ * each distinct JSON value plucked from it (e.g. for nested plucks), which are told apart by
+ * comparing their text. The whole cache is released when the batch changes.
+ */
+class JSONDocumentCache {
+ public:
+  /**
+   * Returns the document parsed from json at the given row of the batch, or nullptr if json is not
+   * valid JSON. The document remains valid until the next call.
+   */
+  const rapidjson::Value* Parse(uint64_t batch_id, size_t row, std::string_view json);
+
+ private:
+  struct Entry {
+    // Copy of the parsed JSON text, in allocator_.
+    std::string_view json;
+    rapidjson::Value doc;
+    bool valid = false;
+  };
+
+  uint64_t batch_id_ = 0;
+  // Holds the memory of the documents of the current batch.
+  rapidjson::MemoryPoolAllocator<> allocator_;
+  std::vector<absl::InlinedVector<Entry, 1>> rows_;
+};
+
+/**
+ * Base of the UDFs that pluck values out of JSON strings.
+ *
+ * Exec parses its input on each call. ExecBatch parses through the JSONDocumentCache of the
+ * FunctionContext, so that the plucks of an operator share the documents of a batch.
+ */
+class JSONPluckUDF : public udf::ScalarUDF {
+ protected:
+  // Parses json into doc, and returns nullptr if it is not valid JSON.
+  static const rapidjson::Value* ParseJSON(const std::string& json, rapidjson::Document* doc) {
+    if (doc->Parse(json.data(), json.size()).HasParseError()) {
+      return nullptr;
+    }
+    return doc;
+  }
+
+  // Calls pluck(doc, row) for each row of the batch, with the document parsed from in[row].
+  template <typename TPluck>
+  void ForEachDocument(FunctionContext* ctx, size_t count, const StringValue* in, TPluck pluck) {
+    JSONDocumentCache* cache = &local_cache_;
+    uint64_t batch_id = ++local_batch_id_;
+    // Without a context (e.g. in tests), parse through a cache of this instance only.
+    if (ctx != nullptr) {
+      cache = ctx->GetOrCreateSharedState<JSONDocumentCache>();
+      batch_id = ctx->batch_id();
+    }
+    for (size_t idx = 0; idx < count; ++idx) {
+      pluck(cache->Parse(batch_id, idx, in[idx]), idx);
+    }
+  }
+
+ private:
+  JSONDocumentCache local_cache_;
+  uint64_t local_batch_id_ = 0;
+};
+
 // TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
 // Revisit when we have them.
-class PluckUDF : public udf::ScalarUDF {
+class PluckUDF : public JSONPluckUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    return Pluck(ParseJSON(in, &doc), key);
+  }
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* in,
+                 const StringValue* keys) {
+    ForEachDocument(ctx, count, in, [&](const rapidjson::Value* d, size_t idx) {
+      out[idx] = Pluck(d, keys[idx]);
+    });
+  }
+  static StringValue Pluck(const rapidjson::Value* d, const StringValue& key) {
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d == nullptr) {
       return "";
     }
-    if (!d.IsObject()) {
+    if (!d->IsObject()) {
       return "";
     }
-    if (!d.HasMember(key.data())) {
+    if (!d->HasMember(key.data())) {
       return "";
     }
-    const auto& plucked_value = d[key.data()];
+    const auto& plucked_value = (*d)[key.data()];
     if (plucked_value.IsNull()) {
       return "";
     }
@@ -84,22 +163,30 @@ class PluckUDF : public udf::ScalarUDF {
   }
 };
 
-class PluckAsInt64UDF : public udf::ScalarUDF {
+class PluckAsInt64UDF : public JSONPluckUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    return Pluck(ParseJSON(in, &doc), key);
+  }
+  void ExecBatch(FunctionContext* ctx, size_t count, Int64Value* out, const StringValue* in,
+                 const StringValue* keys) {
+    ForEachDocument(ctx, count, in, [&](const rapidjson::Value* d, size_t idx) {
+      out[idx] = Pluck(d, keys[idx]);
+    });
+  }
+  static Int64Value Pluck(const rapidjson::Value* d, const StringValue& key) {
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d == nullptr) {
       return 0;
     }
-    if (!d.IsObject()) {
+    if (!d->IsObject()) {
       return 0;
     }
-    if (!d.HasMember(key.data())) {
+    if (!d->HasMember(key.data())) {
       return 0;
     }
-    const auto& plucked_value = d[key.data()];
+    const auto& plucked_value = (*d)[key.data()];
     if (plucked_value.IsNull()) {
       return 0;
     }
@@ -128,22 +215,30 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
   }
 };
 
-class PluckAsFloat64UDF : public udf::ScalarUDF {
+class PluckAsFloat64UDF : public JSONPluckUDF {
  public:
   Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    return Pluck(ParseJSON(in, &doc), key);
+  }
+  void ExecBatch(FunctionContext* ctx, size_t count, Float64Value* out, const StringValue* in,
+                 const StringValue* keys) {
+    ForEachDocument(ctx, count, in, [&](const rapidjson::Value* d, size_t idx) {
+      out[idx] = Pluck(d, keys[idx]);
+    });
+  }
+  static Float64Value Pluck(const rapidjson::Value* d, const StringValue& key) {
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d == nullptr) {
       return 0.0;
     }
-    if (!d.IsObject()) {
+    if (!d->IsObject()) {
       return 0.0;
     }
-    if (!d.HasMember(key.data())) {
+    if (!d->HasMember(key.data())) {
       return 0.0;
     }
-    const auto& plucked_value = d[key.data()];
+    const auto& plucked_value = (*d)[key.data()];
     if (plucked_value.IsNull()) {
       return 0.0;
     }
@@ -175,19 +270,27 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
   }
 };
 
-class PluckArrayUDF : public udf::ScalarUDF {
+class PluckArrayUDF : public JSONPluckUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, Int64Value index) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    return Pluck(ParseJSON(in, &doc), index);
+  }
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* in,
+                 const Int64Value* indices) {
+    ForEachDocument(ctx, count, in, [&](const rapidjson::Value* d, size_t idx) {
+      out[idx] = Pluck(d, indices[idx]);
+    });
+  }
+  static StringValue Pluck(const rapidjson::Value* d, const Int64Value& index) {
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d == nullptr) {
       return "";
     }
-    if (!d.IsArray()) {
+    if (!d->IsArray()) {
       return "";
     }
-    const auto& plucked_array = d.GetArray();
+    const auto& plucked_array = d->GetArray();
     if (index < 0 || index >= plucked_array.Size()) {
       return "";
     }
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/json_ops.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using types::Float64Value;
+using types::Int64Value;
+using types::StringValue;
+
+constexpr char kKeys[][16] = {"status_code", "latency", "path", "user_agent"};
+
+// Builds a batch of HTTP event-like JSON values, about 500 bytes each.
+static std::vector<StringValue> JSONBatch(int num_rows) {
+  std::vector<StringValue> batch;
+  batch.reserve(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    batch.push_back(absl::Substitute(
+        R"({"status_code": $0, "latency": $1.25, "path": "/api/v1/endpoint$2/items/$3",)"
+        R"( "user_agent": "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like)"
+        R"( Gecko) Chrome/96.0.4664.110 Safari/537.36", "headers": {"accept": "*/*",)"
+        R"( "content-type": "application/json", "x-request-id": "$4"},)"
+        R"( "body": "$5"})",
+        200 + i % 5, i % 1000, i % 16, i, i * 7919, std::string(200, 'a' + i % 26)));
+  }
+  return batch;
+}
+
+// Plucks the keys row by row, parsing the JSON value for each key.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckExec(benchmark::State& state) {
+  auto batch = JSONBatch(state.range(0));
+  PluckUDF pluck;
+  PluckAsInt64UDF pluck_int64;
+  PluckAsFloat64UDF pluck_float64;
+  for (auto _ : state) {
+    for (const auto& json : batch) {
+      benchmark::DoNotOptimize(pluck_int64.Exec(nullptr, json, kKeys[0]));
+      benchmark::DoNotOptimize(pluck_float64.Exec(nullptr, json, kKeys[1]));
+      benchmark::DoNotOptimize(pluck.Exec(nullptr, json, kKeys[2]));
+      benchmark::DoNotOptimize(pluck.Exec(nullptr, json, kKeys[3]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch.size());
+}
+
+// Plucks the keys one batch at a time, the way a Map evaluates its expressions, so that the
+// plucks share the documents parsed for the batch.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckExecBatch(benchmark::State& state) {
+  auto batch = JSONBatch(state.range(0));
+  std::vector<std::vector<StringValue>> keys;
+  for (const auto& key : kKeys) {
+    keys.emplace_back(batch.size(), key);
+  }
+  udf::FunctionContext function_ctx(nullptr, nullptr);
+  PluckUDF pluck;
+  PluckAsInt64UDF pluck_int64;
+  PluckAsFloat64UDF pluck_float64;
+  std::vector<Int64Value> ints(batch.size());
+  std::vector<Float64Value> floats(batch.size());
+  std::vector<StringValue> strs(batch.size());
+  for (auto _ : state) {
+    function_ctx.NextBatch();
+    pluck_int64.ExecBatch(&function_ctx, batch.size(), ints.data(), batch.data(),
+                          keys[0].data());
+    pluck_float64.ExecBatch(&function_ctx, batch.size(), floats.data(), batch.data(),
+                            keys[1].data());
+    pluck.ExecBatch(&function_ctx, batch.size(), strs.data(), batch.data(), keys[2].data());
+    pluck.ExecBatch(&function_ctx, batch.size(), strs.data(), batch.data(), keys[3].data());
+    benchmark::DoNotOptimize(strs.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batch.size());
+}
+
+// The larger batches hold well over 2MB of JSON text.
+BENCHMARK(BM_PluckExec)->Arg(1024)->Arg(8192)->Arg(32768);
+BENCHMARK(BM_PluckExecBatch)->Arg(1024)->Arg(8192)->Arg(32768);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -18,6 +18,12 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+
 #include "src/carnot/funcs/builtins/json_ops.h"
 #include "src/carnot/udf/test_utils.h"
 
@@ -25,6 +31,8 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+using types::Float64Value;
+using types::Int64Value;
 using types::StringValue;
 
 constexpr char kTestJSONStr[] = R"(
@@ -111,6 +119,85 @@ TEST(JSONOps, PluckArrayUDF_index_out_of_bound) {
   udf_tester.ForInput(kTestJSONArray, 3).Expect("");
 }
 
+TEST(JSONOps, JSONDocumentCache_parses_once_per_row) {
+  JSONDocumentCache cache;
+  const rapidjson::Value* doc = cache.Parse(1, 0, kTestJSONStr);
+  ASSERT_NE(doc, nullptr);
+  EXPECT_TRUE(doc->IsObject());
+  EXPECT_EQ(cache.Parse(1, 0, kTestJSONStr), doc);
+
+  // Another value of the same row, e.g. from a nested pluck.
+  const rapidjson::Value* array = cache.Parse(1, 0, kTestJSONArray);
+  ASSERT_NE(array, nullptr);
+  EXPECT_TRUE(array->IsArray());
+  EXPECT_TRUE(cache.Parse(1, 0, kTestJSONStr)->IsObject());
+
+  // The same value in another row of the batch is parsed again.
+  EXPECT_TRUE(cache.Parse(1, 5, kTestJSONStr)->IsObject());
+}
+
+TEST(JSONOps, JSONDocumentCache_bad_input_returns_null) {
+  JSONDocumentCache cache;
+  EXPECT_EQ(cache.Parse(1, 0, "asdad"), nullptr);
+  EXPECT_EQ(cache.Parse(1, 0, "asdad"), nullptr);
+  EXPECT_NE(cache.Parse(1, 0, kTestJSONStr), nullptr);
+}
+
+TEST(JSONOps, JSONDocumentCache_resets_on_next_batch) {
+  JSONDocumentCache cache;
+  ASSERT_TRUE(cache.Parse(1, 0, kTestJSONStr)->IsObject());
+  ASSERT_TRUE(cache.Parse(2, 0, kTestJSONArray)->IsArray());
+  const rapidjson::Value* doc = cache.Parse(2, 0, kTestJSONStr);
+  ASSERT_NE(doc, nullptr);
+  EXPECT_EQ((*doc)["str_plain"].GetString(), std::string("abc"));
+}
+
+TEST(JSONOps, plucks_share_batch_documents) {
+  udf::FunctionContext function_ctx(nullptr, nullptr);
+  function_ctx.NextBatch();
+
+  std::vector<StringValue> in(3000);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = absl::Substitute(R"({"i": $0, "f": $0.5, "s": "v$0", "a": [$0]})", i);
+  }
+  std::vector<StringValue> str_keys(in.size(), "s");
+  std::vector<StringValue> int_keys(in.size(), "i");
+  std::vector<StringValue> float_keys(in.size(), "f");
+  std::vector<StringValue> array_keys(in.size(), "a");
+  std::vector<Int64Value> indices(in.size(), 0);
+
+  PluckUDF pluck;
+  PluckAsInt64UDF pluck_int64;
+  PluckAsFloat64UDF pluck_float64;
+  PluckArrayUDF pluck_array;
+  std::vector<StringValue> strs(in.size());
+  std::vector<Int64Value> ints(in.size());
+  std::vector<Float64Value> floats(in.size());
+  std::vector<StringValue> arrays(in.size());
+  std::vector<StringValue> elements(in.size());
+  pluck.ExecBatch(&function_ctx, in.size(), strs.data(), in.data(), str_keys.data());
+  pluck_int64.ExecBatch(&function_ctx, in.size(), ints.data(), in.data(), int_keys.data());
+  pluck_float64.ExecBatch(&function_ctx, in.size(), floats.data(), in.data(), float_keys.data());
+  pluck.ExecBatch(&function_ctx, in.size(), arrays.data(), in.data(), array_keys.data());
+  pluck_array.ExecBatch(&function_ctx, in.size(), elements.data(), arrays.data(), indices.data());
+
+  for (size_t i = 0; i < in.size(); ++i) {
+    EXPECT_EQ(strs[i], absl::StrCat("v", i));
+    EXPECT_EQ(ints[i].val, static_cast<int64_t>(i));
+    EXPECT_DOUBLE_EQ(floats[i].val, i + 0.5);
+    EXPECT_EQ(arrays[i], absl::StrCat("[", i, "]"));
+    EXPECT_EQ(elements[i], absl::StrCat(i));
+  }
+
+  // The next batch does not see the documents of the previous one.
+  function_ctx.NextBatch();
+  std::vector<StringValue> next_in(in.size(), kTestJSONStr);
+  pluck_int64.ExecBatch(&function_ctx, next_in.size(), ints.data(), next_in.data(),
+                        std::vector<StringValue>(in.size(), "int64_key").data());
+  EXPECT_EQ(ints[0].val, 34243242341);
+  EXPECT_EQ(ints[next_in.size() - 1].val, 34243242341);
+}
+
 TEST(JSONOps, ScriptReferenceUDF_no_args) {
   auto udf_tester = udf::UDFTester<ScriptReferenceUDF<>>();
   auto res = udf_tester.ForInput("text", "px/script").Result();
@@ -25,6 +25,12 @@ namespace builtins {
 void RegisterMathSketchesOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<QuantilesUDA<types::Int64Value>>("quantiles");
   registry->RegisterOrDie<QuantilesUDA<types::Float64Value>>("quantiles");
+  registry->RegisterOrDie<DDSketchQuantilesUDA<types::Int64Value>>("ddsketch_quantiles");
+  registry->RegisterOrDie<DDSketchQuantilesUDA<types::Float64Value>>("ddsketch_quantiles");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Int64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Float64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::StringValue>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxTopKUDA>("approx_top_k");
 }
 
 }  // namespace builtins
@@ -21,7 +21,13 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "src/carnot/funcs/builtins/sketches.h"
 #include "src/carnot/udf/registry.h"
+#include "src/carnot/udf/uda_state.h"
 #include "src/shared/types/types.h"
 #include "tdigest/tdigest.h"
 
@@ -37,6 +43,45 @@ class QuantilesUDA : public udf::UDA {
   void Update(FunctionContext*, TArg val) { digest_.add(val.val); }
   void Merge(FunctionContext*, const QuantilesUDA& other) { digest_.merge(&other.digest_); }
 
+  /**
+   * The partial state is the compression followed by the means and weights of the centroids. The
+   * unprocessed centroids are shipped as is and get merged on the receiving side.
+   */
+  StringValue Serialize(FunctionContext*) {
+    std::vector<double> means;
+    std::vector<double> weights;
+    for (const auto* centroids : {&digest_.processed(), &digest_.unprocessed()}) {
+      for (const auto& centroid : *centroids) {
+        means.push_back(centroid.mean());
+        weights.push_back(centroid.weight());
+      }
+    }
+    udf::UDAStateWriter writer(kStateVersion);
+    writer.Write<double>(digest_.compression());
+    writer.WriteArray(means.data(), means.size());
+    writer.WriteArray(weights.data(), weights.size());
+    return writer.Finish();
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    PL_ASSIGN_OR_RETURN(auto reader, udf::UDAStateReader::Create(data, kStateVersion));
+    double compression;
+    std::vector<double> means;
+    std::vector<double> weights;
+    PL_RETURN_IF_ERROR(reader.Read(&compression));
+    PL_RETURN_IF_ERROR(reader.ReadArray(&means));
+    PL_RETURN_IF_ERROR(reader.ReadArray(&weights));
+    if (means.size() != weights.size()) {
+      return error::InvalidArgument("Quantiles state has $0 means but $1 weights", means.size(),
+                                    weights.size());
+    }
+    digest_ = tdigest::TDigest(compression);
+    for (size_t i = 0; i < means.size(); ++i) {
+      digest_.add(means[i], weights[i]);
+    }
+    return Status::OK();
+  }
+
   StringValue Finalize(FunctionContext*) {
     rapidjson::Document d;
     d.SetObject();
@@ -78,9 +123,177 @@ class QuantilesUDA : public udf::UDA {
   }
 
  protected:
+  static constexpr uint8_t kStateVersion = 1;
+
   tdigest::TDigest digest_;
 };
 
+template <typename TArg>
+class ApproxCountDistinctUDA : public udf::UDA {
+ public:
+  void Update(FunctionContext*, TArg val) {
+    if constexpr (std::is_same_v<TArg, types::StringValue>) {
+      hll_.Add(std::string_view(val));
+    } else {
+      hll_.Add(val.val);
+    }
+  }
+  void Merge(FunctionContext*, const ApproxCountDistinctUDA& other) { hll_.Merge(other.hll_); }
+  Int64Value Finalize(FunctionContext*) { return hll_.Estimate(); }
+
+  StringValue Serialize(FunctionContext*) {
+    udf::UDAStateWriter writer(kStateVersion);
+    hll_.Serialize(&writer);
+    return writer.Finish();
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    PL_ASSIGN_OR_RETURN(auto reader, udf::UDAStateReader::Create(data, kStateVersion));
+    return hll_.Deserialize(&reader);
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Approximates the number of distinct values in the aggregated data.")
+        .Details(
+            "Estimates the number of distinct values using "
+            "[HyperLogLog](https://algo.inria.fr/flajolet/Publications/FlFuGaMe07.pdf), with the "
+            "64-bit hashes and sparse representation of "
+            "[HyperLogLog++](https://research.google/pubs/pub40671/). The estimate has a standard "
+            "error of about 1.6%. Unlike grouping by the values and counting the groups, the "
+            "memory used doesn't grow with the number of distinct values.")
+        .Example(R"doc(
+        | # Count the distinct remote addresses talking to each service.
+        | df = df.groupby('service').agg(num_clients=('remote_addr', px.approx_count_distinct))
+        )doc")
+        .Arg("val", "The data to count the distinct values of.")
+        .Returns("The estimated number of distinct values.");
+  }
+
+ protected:
+  static constexpr uint8_t kStateVersion = 1;
+
+  HyperLogLog hll_;
+};
+
+template <typename TArg>
+class DDSketchQuantilesUDA : public udf::UDA {
+ public:
+  void Update(FunctionContext*, TArg val) { sketch_.Add(val.val); }
+  void Merge(FunctionContext*, const DDSketchQuantilesUDA& other) { sketch_.Merge(other.sketch_); }
+
+  StringValue Finalize(FunctionContext*) {
+    rapidjson::Document d;
+    d.SetObject();
+    for (const auto& [key, q] : kQuantiles) {
+      // An empty sketch (e.g. only NaN inputs) has no quantiles, and NaN isn't valid JSON.
+      rapidjson::Value val;
+      if (sketch_.count() > 0) {
+        val.SetDouble(sketch_.Quantile(q));
+      }
+      d.AddMember(rapidjson::StringRef(key), val, d.GetAllocator());
+    }
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    d.Accept(writer);
+    return sb.GetString();
+  }
+
+  StringValue Serialize(FunctionContext*) {
+    udf::UDAStateWriter writer(kStateVersion);
+    sketch_.Serialize(&writer);
+    return writer.Finish();
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    PL_ASSIGN_OR_RETURN(auto reader, udf::UDAStateReader::Create(data, kStateVersion));
+    return sketch_.Deserialize(&reader);
+  }
+
+  static udf::InfRuleVec SemanticInferenceRules() {
+    return {
+        udf::ExplicitRule::Create<DDSketchQuantilesUDA>(types::ST_QUANTILES, {types::ST_NONE}),
+        udf::ExplicitRule::Create<DDSketchQuantilesUDA>(types::ST_DURATION_NS_QUANTILES,
+                                                        {types::ST_DURATION_NS})};
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder(
+               "Approximates the distribution of the aggregated data with relative error bounds.")
+        .Details(
+            "Calculates the same percentiles as `px.quantiles`, using "
+            "[DDSketch](https://arxiv.org/abs/1908.10693). Every percentile is within 1% of the "
+            "true value, which keeps the tail percentiles of long tailed data, such as latencies, "
+            "accurate. Returns a serialized JSON object with the keys for 1%, 10%, 25%, 50%, 75%, "
+            "90%, and 99%.")
+        .Example(R"doc(
+        | df = df.agg(latency_dist=('latency_ms', px.ddsketch_quantiles))
+        | df.p99 = px.pluck_float64(df.latency_dist, 'p99')
+        )doc")
+        .Arg("val", "The data to calculate the quantiles distribution.")
+        .Returns("The quantiles data, serialized as a JSON dictionary.");
+  }
+
+ protected:
+  static constexpr uint8_t kStateVersion = 1;
+  static constexpr std::pair<const char*, double> kQuantiles[] = {
+      {"p01", 0.01}, {"p10", 0.10}, {"p25", 0.25}, {"p50", 0.50},
+      {"p75", 0.75}, {"p90", 0.90}, {"p99", 0.99}};
+
+  DDSketch sketch_;
+};
+
+class ApproxTopKUDA : public udf::UDA {
+ public:
+  void Update(FunctionContext*, StringValue val) { top_k_.Add(val); }
+  void Merge(FunctionContext*, const ApproxTopKUDA& other) { top_k_.Merge(other.top_k_); }
+
+  StringValue Finalize(FunctionContext*) {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    writer.StartArray();
+    for (const auto& [val, count] : top_k_.TopK()) {
+      writer.StartObject();
+      writer.Key("value");
+      writer.String(val.data(), val.size());
+      writer.Key("count");
+      writer.Uint64(count);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    return sb.GetString();
+  }
+
+  StringValue Serialize(FunctionContext*) {
+    udf::UDAStateWriter writer(kStateVersion);
+    top_k_.Serialize(&writer);
+    return writer.Finish();
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    PL_ASSIGN_OR_RETURN(auto reader, udf::UDAStateReader::Create(data, kStateVersion));
+    return top_k_.Deserialize(&reader);
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Approximates the most frequent values in the aggregated data.")
+        .Details(
+            "Tracks the 10 most frequent values using a count-min sketch. The counts never "
+            "undercount, and overcount by at most 0.3% of the total count with high probability. "
+            "Returns a serialized JSON array of objects with the value and its estimated count, "
+            "most frequent first.")
+        .Example(R"doc(
+        | df = df.groupby('service').agg(top_paths=('req_path', px.approx_top_k))
+        )doc")
+        .Arg("val", "The data to find the most frequent values of.")
+        .Returns("The most frequent values with their counts, serialized as a JSON array.");
+  }
+
+ protected:
+  static constexpr uint8_t kStateVersion = 1;
+
+  CountMinTopK top_k_;
+};
+
 void RegisterMathSketchesOrDie(udf::Registry* registry);
 
 }  // namespace builtins
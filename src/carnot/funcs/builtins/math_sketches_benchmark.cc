@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/carnot/funcs/builtins/math_sketches.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Values with a bounded number of distinct values, spread over a few orders of magnitude.
+template <typename TArg>
+TArg MakeArg(int64_t i);
+
+template <>
+types::Int64Value MakeArg(int64_t i) {
+  return (i * 7919) % 100003;
+}
+
+template <>
+types::Float64Value MakeArg(int64_t i) {
+  return 0.1 * ((i * 7919) % 100003);
+}
+
+template <>
+types::StringValue MakeArg(int64_t i) {
+  return absl::StrCat("/api/v1/endpoint", (i * 7919) % 1000);
+}
+
+// Builds the partial aggregate of num_updates values, as an agent would before serializing it.
+template <typename TUDA, typename TArg>
+TUDA MakePartial(int64_t num_updates) {
+  TUDA uda;
+  for (int64_t i = 0; i < num_updates; ++i) {
+    uda.Update(nullptr, MakeArg<TArg>(i));
+  }
+  return uda;
+}
+
+template <typename TUDA, typename TArg>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_UDASerialize(benchmark::State& state) {
+  TUDA uda = MakePartial<TUDA, TArg>(state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    types::StringValue serialized = uda.Serialize(nullptr);
+    bytes += serialized.size();
+    benchmark::DoNotOptimize(serialized);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+template <typename TUDA, typename TArg>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_UDADeserializeMerge(benchmark::State& state) {
+  types::StringValue serialized = MakePartial<TUDA, TArg>(state.range(0)).Serialize(nullptr);
+  TUDA merged = MakePartial<TUDA, TArg>(state.range(0));
+  for (auto _ : state) {
+    TUDA partial;
+    PL_CHECK_OK(partial.Deserialize(nullptr, serialized));
+    merged.Merge(nullptr, partial);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+BENCHMARK_TEMPLATE(BM_UDASerialize, QuantilesUDA<types::Float64Value>, types::Float64Value)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+BENCHMARK_TEMPLATE(BM_UDADeserializeMerge, QuantilesUDA<types::Float64Value>,
+                   types::Float64Value)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+
+BENCHMARK_TEMPLATE(BM_UDASerialize, ApproxCountDistinctUDA<types::Int64Value>, types::Int64Value)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+BENCHMARK_TEMPLATE(BM_UDADeserializeMerge, ApproxCountDistinctUDA<types::Int64Value>,
+                   types::Int64Value)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+
+BENCHMARK_TEMPLATE(BM_UDASerialize, DDSketchQuantilesUDA<types::Float64Value>,
+                   types::Float64Value)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+BENCHMARK_TEMPLATE(BM_UDADeserializeMerge, DDSketchQuantilesUDA<types::Float64Value>,
+                   types::Float64Value)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+
+BENCHMARK_TEMPLATE(BM_UDASerialize, ApproxTopKUDA, types::StringValue)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+BENCHMARK_TEMPLATE(BM_UDADeserializeMerge, ApproxTopKUDA, types::StringValue)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
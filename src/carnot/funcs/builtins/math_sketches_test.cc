@@ -19,6 +19,8 @@
 #include <gtest/gtest.h>
 #include <rapidjson/document.h>
 
+#include <cmath>
+
 #include "src/carnot/funcs/builtins/math_sketches.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
@@ -69,6 +71,82 @@ TEST(MathSketches, quantiles_int64) {
   EXPECT_DOUBLE_EQ(d["p99"].GetDouble(), 6);
 }
 
+TEST(MathSketches, approx_count_distinct) {
+  auto uda_tester = udf::UDATester<ApproxCountDistinctUDA<types::StringValue>>();
+  uda_tester.ForInput("10.0.0.1").ForInput("10.0.0.2").ForInput("10.0.0.1").Expect(2);
+
+  auto int_tester1 = udf::UDATester<ApproxCountDistinctUDA<types::Int64Value>>();
+  auto int_tester2 = udf::UDATester<ApproxCountDistinctUDA<types::Int64Value>>();
+  for (int64_t i = 0; i < 100; ++i) {
+    int_tester1.ForInput(i);
+    int_tester2.ForInput(i + 50);
+  }
+  ASSERT_OK(int_tester1.Deserialize(int_tester2.Serialize()));
+  EXPECT_NEAR(150, int_tester1.Result().val, 2);
+}
+
+TEST(MathSketches, ddsketch_quantiles) {
+  auto uda_tester = udf::UDATester<DDSketchQuantilesUDA<types::Float64Value>>();
+  for (int i = 1; i <= 100; ++i) {
+    uda_tester.ForInput(i);
+  }
+  rapidjson::Document d;
+  d.Parse(uda_tester.Result().data());
+  EXPECT_NEAR(d["p01"].GetDouble(), 1, 0.01);
+  EXPECT_NEAR(d["p50"].GetDouble(), 50, 0.5);
+  EXPECT_NEAR(d["p99"].GetDouble(), 99, 0.99);
+
+  // Partial aggregates from two agents merge into the same distribution.
+  auto partial1 = udf::UDATester<DDSketchQuantilesUDA<types::Float64Value>>();
+  auto partial2 = udf::UDATester<DDSketchQuantilesUDA<types::Float64Value>>();
+  for (int i = 1; i <= 100; ++i) {
+    (i % 2 == 0 ? partial1 : partial2).ForInput(i);
+  }
+  ASSERT_OK(partial1.Deserialize(partial2.Serialize()));
+  EXPECT_EQ(uda_tester.Result(), partial1.Result());
+}
+
+TEST(MathSketches, ddsketch_quantiles_empty) {
+  auto uda_tester = udf::UDATester<DDSketchQuantilesUDA<types::Float64Value>>();
+  uda_tester.ForInput(std::nan(""));
+  rapidjson::Document d;
+  ASSERT_FALSE(d.Parse(uda_tester.Result().data()).HasParseError());
+  EXPECT_TRUE(d["p50"].IsNull());
+  EXPECT_TRUE(d["p99"].IsNull());
+}
+
+TEST(MathSketches, approx_top_k) {
+  auto uda_tester = udf::UDATester<ApproxTopKUDA>();
+  uda_tester.ForInput("/a").ForInput("/b").ForInput("/a");
+  auto other = udf::UDATester<ApproxTopKUDA>();
+  other.ForInput("/b").ForInput("/b").ForInput("/c");
+  ASSERT_OK(uda_tester.Deserialize(other.Serialize()));
+  EXPECT_EQ(
+      R"([{"value":"/b","count":3},{"value":"/a","count":2},{"value":"/c","count":1}])",
+      uda_tester.Result());
+}
+
+TEST(MathSketches, quantiles_partial_agg) {
+  auto tester1 = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  auto tester2 = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  tester1.ForInput(1.04).ForInput(2.442).ForInput(6.333);
+  tester2.ForInput(1.234).ForInput(5.322);
+
+  auto state = tester2.Serialize();
+  EXPECT_TRUE(udf::UDAStateReader::IsUDAState(state));
+  ASSERT_OK(tester1.Deserialize(state));
+
+  rapidjson::Document d;
+  d.Parse(tester1.Result().data());
+  EXPECT_DOUBLE_EQ(d["p01"].GetDouble(), 1.04);
+  EXPECT_DOUBLE_EQ(d["p50"].GetDouble(), 2.442);
+  EXPECT_DOUBLE_EQ(d["p99"].GetDouble(), 6.333);
+
+  // States that aren't binary quantiles states should be rejected.
+  EXPECT_NOT_OK(tester1.Deserialize("{}"));
+  EXPECT_NOT_OK(tester1.Deserialize(state.substr(0, state.size() - 1)));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
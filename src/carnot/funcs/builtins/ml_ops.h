@@ -26,14 +26,19 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/exec/ml/coreset.h"
+#include "src/carnot/exec/ml/float_vector.h"
 #include "src/carnot/exec/ml/kmeans.h"
 #include "src/carnot/exec/ml/model_executor.h"
 #include "src/carnot/exec/ml/sampling.h"
 #include "src/carnot/exec/ml/transformer_executor.h"
 #include "src/carnot/udf/registry.h"
+#include "src/carnot/udf/uda_state.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
 
@@ -47,8 +52,28 @@ using exec::ml::KMeans;
 using exec::ml::KMeansCoreset;
 
 int load_floats_from_json(std::string in, Eigen::VectorXf* out, int max_num);
+// Loads a float vector either encoded by exec::ml::EncodeFloatVector or as a JSON array.
+int load_float_vector(std::string in, Eigen::VectorXf* out, int max_num);
 std::string write_ints_to_json(int* arr, int num);
 
+/**
+ * Collects the distinct values among the count values into unique, and returns the index in
+ * unique of each value. ML funcs use it to run their model once per distinct value of a batch.
+ */
+inline std::vector<size_t> DedupValues(size_t count, const types::StringValue* values,
+                                       std::vector<std::string>* unique) {
+  std::vector<size_t> indices(count);
+  absl::flat_hash_map<std::string_view, size_t> seen;
+  for (size_t i = 0; i < count; ++i) {
+    auto [it, inserted] = seen.try_emplace(values[i], unique->size());
+    if (inserted) {
+      unique->push_back(values[i]);
+    }
+    indices[i] = it->second;
+  }
+  return indices;
+}
+
 class TransformerUDF : public udf::ScalarUDF {
  public:
   TransformerUDF() : TransformerUDF("/embedding.proto") {}
@@ -61,6 +86,18 @@ class TransformerUDF : public udf::ScalarUDF {
     return output;
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* docs) {
+    std::vector<std::string> unique_docs;
+    auto indices = DedupValues(count, docs, &unique_docs);
+    auto executor =
+        ctx->model_pool()->GetModelExecutor<exec::ml::TransformerExecutor>(model_proto_path_);
+    std::vector<std::string> embeddings;
+    executor->ExecuteBatch(unique_docs, &embeddings);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = embeddings[indices[i]];
+    }
+  }
+
  private:
   std::string model_proto_path_;
 };
@@ -81,6 +118,19 @@ class SentencePieceUDF : public udf::ScalarUDF {
     return write_ints_to_json(ids.data(), ids.size());
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* in) {
+    std::vector<std::string> unique_in;
+    auto indices = DedupValues(count, in, &unique_in);
+    std::vector<StringValue> encoded;
+    encoded.reserve(unique_in.size());
+    for (const auto& str : unique_in) {
+      encoded.push_back(Exec(ctx, str));
+    }
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = encoded[indices[i]];
+    }
+  }
+
  private:
   sentencepiece::SentencePieceProcessor processor_;
 };
@@ -95,11 +145,16 @@ class KMeansUDA : public udf::UDA {
       k_ = k.val;
     }
     Eigen::VectorXf point(d_);
-    int d = load_floats_from_json(in, &point, d_);
+    int d = load_float_vector(in, &point, d_);
     DCHECK_EQ(d_, d);
     coreset_.Update(point);
   }
-  void Merge(FunctionContext*, const KMeansUDA& other) { coreset_.Merge(other.coreset_); }
+  void Merge(FunctionContext*, const KMeansUDA& other) {
+    if (k_ == -1) {
+      k_ = other.k_;
+    }
+    coreset_.Merge(other.coreset_);
+  }
   StringValue Finalize(FunctionContext*) {
     auto point_set = coreset_.Query();
     KMeans kmeans(k_);
@@ -107,14 +162,32 @@ class KMeansUDA : public udf::UDA {
     return kmeans.ToJSON();
   }
 
-  StringValue Serialize(FunctionContext*) { return coreset_.ToJSON(); }
+  StringValue Serialize(FunctionContext*) {
+    udf::UDAStateWriter writer(kStateVersion);
+    writer.Write<int64_t>(k_);
+    coreset_.Serialize(&writer);
+    return writer.Finish();
+  }
 
   Status Deserialize(FunctionContext*, const StringValue& data) {
-    coreset_.FromJSON(data);
+    if (!udf::UDAStateReader::IsUDAState(data)) {
+      // Agents that haven't been upgraded yet still send the coreset as JSON.
+      coreset_.FromJSON(data);
+      return Status::OK();
+    }
+    PL_ASSIGN_OR_RETURN(auto reader, udf::UDAStateReader::Create(data, kStateVersion));
+    int64_t k;
+    PL_RETURN_IF_ERROR(reader.Read(&k));
+    PL_RETURN_IF_ERROR(coreset_.Deserialize(&reader));
+    if (k_ == -1) {
+      k_ = k;
+    }
     return Status::OK();
   }
 
  protected:
+  static constexpr uint8_t kStateVersion = 1;
+
   int d_;
   int k_ = -1;
   CoresetDriver<CoresetTree<KMeansCoreset>> coreset_;
@@ -131,7 +204,7 @@ class KMeansUDF : public udf::ScalarUDF {
       kmeans_->FromJSON(kmeans_json);
     }
     Eigen::VectorXf point(d_);
-    int d = load_floats_from_json(embedding, &point, d_);
+    int d = load_float_vector(embedding, &point, d_);
     DCHECK_EQ(d_, d);
     return kmeans_->Transform(point);
   }
@@ -19,6 +19,7 @@
 #include <gflags/gflags.h>
 
 #include <benchmark/benchmark.h>
+#include "src/carnot/exec/ml/float_vector.h"
 #include "src/carnot/exec/ml/model_pool.h"
 #include "src/carnot/exec/ml/transformer_executor.h"
 #include "src/carnot/funcs/builtins/ml_ops.h"
@@ -83,5 +84,46 @@ static void BM_SentencePiece(benchmark::State& state) {
   }
 }
 
+// Builds the partial KMeans aggregate of num_points 64 dimensional points.
+px::carnot::builtins::KMeansUDA KMeansPartial(int64_t num_points) {
+  std::mt19937 generator(37);
+  std::normal_distribution<float> distribution(0, 1);
+  px::carnot::builtins::KMeansUDA uda;
+  std::vector<float> point(64);
+  for (int64_t i = 0; i < num_points; ++i) {
+    for (auto& x : point) {
+      x = distribution(generator) + (i % 8);
+    }
+    uda.Update(nullptr, px::carnot::exec::ml::FormatFloatVector(point.data(), point.size()), 8);
+  }
+  return uda;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_KMeansSerialize(benchmark::State& state) {
+  auto uda = KMeansPartial(state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto serialized = uda.Serialize(nullptr);
+    bytes += serialized.size();
+    benchmark::DoNotOptimize(serialized);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_KMeansDeserializeMerge(benchmark::State& state) {
+  auto merged = KMeansPartial(state.range(0));
+  auto serialized = merged.Serialize(nullptr);
+  for (auto _ : state) {
+    px::carnot::builtins::KMeansUDA partial;
+    PL_CHECK_OK(partial.Deserialize(nullptr, serialized));
+    merged.Merge(nullptr, partial);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
 BENCHMARK(BM_SentencePiece)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_TransformerModel)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KMeansSerialize)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_KMeansDeserializeMerge)->RangeMultiplier(10)->Range(100, 100000);
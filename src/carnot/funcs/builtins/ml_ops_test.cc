@@ -71,6 +71,63 @@ TEST(KMeans, basic) {
   EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected_centroids, 0.1));
 }
 
+TEST(KMeans, encoded_float_vectors) {
+  int k = 3;
+  int d = 2;
+
+  auto kmeans_uda_tester = udf::UDATester<KMeansUDA>(d);
+
+  Eigen::MatrixXf expected_centroids = kmeans_expected_centroids();
+  Eigen::MatrixXf points = kmeans_test_data();
+
+  for (int i = 0; i < points.rows(); i++) {
+    Eigen::VectorXf point = points(i, Eigen::all).transpose();
+    kmeans_uda_tester.ForInput(exec::ml::EncodeFloatVector(point), k);
+  }
+
+  auto res = kmeans_uda_tester.Result();
+  px::carnot::exec::ml::KMeans kmeans(k);
+  kmeans.FromJSON(res);
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected_centroids, 0.1));
+
+  auto kmeans_udf_tester = udf::UDFTester<KMeansUDF>(d);
+  Eigen::VectorXf centroid = expected_centroids(0, Eigen::all).transpose();
+  kmeans_udf_tester.ForInput(exec::ml::EncodeFloatVector(centroid), res)
+      .Expect(static_cast<int64_t>(kmeans.Transform(centroid)));
+}
+
+TEST(KMeans, partial_agg) {
+  int k = 3;
+  int d = 2;
+
+  KMeansUDA partial1(d);
+  KMeansUDA partial2(d);
+  Eigen::MatrixXf points = kmeans_test_data();
+  for (int i = 0; i < points.rows(); i++) {
+    Eigen::VectorXf point = points(i, Eigen::all).transpose();
+    auto* partial = i % 2 == 0 ? &partial1 : &partial2;
+    partial->Update(nullptr, exec::ml::EncodeFloatVector(point), k);
+  }
+
+  // The finalizing UDA only sees the serialized partials, so k has to travel with them.
+  KMeansUDA final_uda(d);
+  for (auto* partial : {&partial1, &partial2}) {
+    auto state = partial->Serialize(nullptr);
+    EXPECT_TRUE(udf::UDAStateReader::IsUDAState(state));
+    KMeansUDA deserialized(d);
+    ASSERT_OK(deserialized.Deserialize(nullptr, state));
+    final_uda.Merge(nullptr, deserialized);
+  }
+
+  px::carnot::exec::ml::KMeans kmeans(k);
+  kmeans.FromJSON(final_uda.Finalize(nullptr));
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(kmeans_expected_centroids(), 0.1));
+
+  // A state for points of a different size should be rejected.
+  KMeansUDA wrong_size(d + 1);
+  EXPECT_NOT_OK(wrong_size.Deserialize(nullptr, partial1.Serialize(nullptr)));
+}
+
 TEST(SentencePiece, basic) {
   auto udf_tester = udf::UDFTester<SentencePieceUDF>(FLAGS_sentencepiece_dir);
   udf_tester.ForInput("Test 123!");
@@ -83,10 +140,12 @@ TEST(Transformer, basic) {
   auto pool = exec::ml::ModelPool::Create();
   auto ctx = std::make_unique<FunctionContext>(nullptr, pool.get());
   auto udf_tester = udf::UDFTester<TransformerUDF>(std::move(ctx), FLAGS_embedding_dir);
+  FLAGS_ml_encode_float_vectors = false;
   udf_tester.ForInput("[4,197,803,195,16,5001]");
+  FLAGS_ml_encode_float_vectors = true;
   // This test is just a sanity check to see that the transformer UDF runs.
   // If the model changes this test will fail.
-  udf_tester.Expect(
+  constexpr char kExpectedEmbedding[] =
       "[8.423064231872559,1.762765645980835,17.635025024414064,15.878694534301758,-1."
       "3718032836914063,8.416397094726563,3.800554037094116,14.292364120483399,8.203149795532227,"
       "15.849493026733399,13.610809326171875,1.56343674659729,-0.3372507393360138,3."
@@ -147,7 +206,44 @@ TEST(Transformer, basic) {
       "8550132513046265,0.5778014659881592,0.1923011839389801,0.11267414689064026,0."
       "05414436757564545,0.8641302585601807,0.8690036535263062,1.4261415004730225,0.58112633228302,"
       "1.9074645042419434,-0.12592265009880067,0.6470710635185242,0.5493981838226318,-0."
-      "15099024772644044,-0.10007300972938538,1.1897741556167603]");
+      "15099024772644044,-0.10007300972938538,1.1897741556167603]";
+  udf_tester.Expect(kExpectedEmbedding);
+
+  // The same embedding, as an encoded float vector.
+  udf_tester.ForInput("[4,197,803,195,16,5001]");
+  Eigen::VectorXf expected(256);
+  ASSERT_EQ(256, load_floats_from_json(kExpectedEmbedding, &expected, 256));
+  Eigen::VectorXf embedding(256);
+  ASSERT_EQ(256, exec::ml::DecodeFloatVector(udf_tester.Result(), embedding.data(), 256));
+  EXPECT_EQ(expected, embedding);
+}
+
+TEST(Transformer, batch) {
+  auto pool = exec::ml::ModelPool::Create();
+  FunctionContext ctx(nullptr, pool.get());
+  TransformerUDF udf(FLAGS_embedding_dir);
+
+  std::vector<types::StringValue> docs = {"[4,197,803,195,16,5001]", "not json", "[16,5001]",
+                                          "[4,197,803,195,16,5001]"};
+  std::vector<types::StringValue> embeddings(docs.size());
+  udf.ExecBatch(&ctx, docs.size(), embeddings.data(), docs.data());
+
+  for (size_t i = 0; i < docs.size(); ++i) {
+    EXPECT_EQ(udf.Exec(&ctx, docs[i]), embeddings[i]);
+  }
+  EXPECT_EQ("", embeddings[1]);
+}
+
+TEST(SentencePiece, batch) {
+  FunctionContext ctx(nullptr, nullptr);
+  SentencePieceUDF udf(FLAGS_sentencepiece_dir);
+
+  std::vector<types::StringValue> in = {"Test 123!", "abc", "Test 123!"};
+  std::vector<types::StringValue> out(in.size());
+  udf.ExecBatch(&ctx, in.size(), out.data(), in.data());
+  for (size_t i = 0; i < in.size(); ++i) {
+    EXPECT_EQ(udf.Exec(&ctx, in[i]), out[i]);
+  }
 }
 
 }  // namespace builtins
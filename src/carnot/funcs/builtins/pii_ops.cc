@@ -16,7 +16,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include <algorithm>
+#include <array>
 #include <map>
+#include <string>
 #include <vector>
 
 #include "src/carnot/funcs/builtins/pii_ops.h"
@@ -246,9 +248,33 @@ Status RedactPIIUDF::Init(FunctionContext*) {
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEI>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
+
+  std::vector<std::string> patterns;
+  for (const auto& tagger : taggers_) {
+    patterns.emplace_back(tagger->pattern());
+  }
+  tagger_patterns_ = RegexCache::GetSet(patterns, RE2::UNANCHORED);
   return Status::OK();
 }
 
+// Every PII pattern matches at least one of these bytes: IP addresses, credit card and IMEI numbers
+// contain digits, IPv6 and MAC addresses contain ':' or '-', and emails contain '@' or "%40".
+// Strings without any of them can't contain PII.
+static inline bool HasCandidateBytes(std::string_view input) {
+  static constexpr auto kCandidateBytes = []() {
+    std::array<bool, 256> table{};
+    for (char c = '0'; c <= '9'; ++c) {
+      table[static_cast<uint8_t>(c)] = true;
+    }
+    for (char c : {':', '-', '@', '%'}) {
+      table[static_cast<uint8_t>(c)] = true;
+    }
+    return table;
+  }();
+  return std::any_of(input.begin(), input.end(),
+                     [](char c) { return kCandidateBytes[static_cast<uint8_t>(c)]; });
+}
+
 // Replace all tagged sequences in the string with the corresponding substitution string. For
 // overlapping tags, we take the longest tag.
 static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag>* tags) {
@@ -305,9 +331,13 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
 }
 
 StringValue RedactPIIUDF::Exec(FunctionContext*, StringValue input) {
+  if (!HasCandidateBytes(input)) {
+    return input;
+  }
   std::vector<Tag> tags;
-  for (const auto& tagger : taggers_) {
-    auto s = tagger->AddTags(&input, &tags);
+  // Only run the taggers whose pattern matches somewhere in the input.
+  for (size_t i : RegexCache::MatchingPatterns(*tagger_patterns_, input)) {
+    auto s = taggers_[i]->AddTags(&input, &tags);
     if (!s.ok()) {
       return "Invalid regex: " + s.msg();
     }
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "re2/re2.h"
+#include "src/carnot/funcs/builtins/regex_cache.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -55,6 +56,8 @@ class Tagger {
  public:
   virtual ~Tagger() = default;
   virtual Status AddTags(std::string* input, std::vector<Tag>* tags) = 0;
+  // The regex pattern of the tags.
+  virtual std::string_view pattern() const = 0;
 };
 
 class RedactPIIUDF : public udf::ScalarUDF {
@@ -78,6 +81,8 @@ class RedactPIIUDF : public udf::ScalarUDF {
 
  private:
   std::vector<std::unique_ptr<Tagger>> taggers_;
+  // The patterns of all the taggers, to find which taggers match an input in one pass.
+  std::shared_ptr<const CompiledRegexSet> tagger_patterns_;
 };
 
 void RegisterPIIOpsOrDie(udf::Registry* registry);
@@ -85,17 +90,19 @@ void RegisterPIIOpsOrDie(udf::Registry* registry);
 template <Tag::Type TTag>
 class RegexTagger : public Tagger {
  public:
-  RegexTagger() : regex_(TagTypeTraits<TTag>::BuildRegexPattern()) {
+  RegexTagger() : regex_(RegexCache::Get(TagTypeTraits<TTag>::BuildRegexPattern())) {
     // Since the regex patterns are defined at compile time, using a DCHECK is ok here.
-    DCHECK_EQ(regex_.error_code(), RE2::NoError) << regex_.error();
+    DCHECK_EQ(regex_->error_code(), RE2::NoError) << regex_->error();
   }
 
+  std::string_view pattern() const override { return TagTypeTraits<TTag>::BuildRegexPattern(); }
+
   Status AddTags(std::string* input, std::vector<Tag>* tags) {
     re2::StringPiece input_piece(input->data(), input->length());
     auto prev_length = input_piece.length();
     int curr_idx = 0;
     std::string match;
-    while (RE2::FindAndConsume(&input_piece, regex_, &match)) {
+    while (RE2::FindAndConsume(&input_piece, *regex_, &match)) {
       auto consumed = prev_length - input_piece.length();
       if (consumed == 0) {
         return Status(statuspb::Code::INVALID_ARGUMENT,
@@ -117,7 +124,7 @@ class RegexTagger : public Tagger {
   }
 
  private:
-  re2::RE2 regex_;
+  std::shared_ptr<const re2::RE2> regex_;
 };
 
 }  // namespace builtins
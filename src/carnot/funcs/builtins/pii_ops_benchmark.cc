@@ -49,7 +49,29 @@ static void BM_RedactPII(benchmark::State& state) {
                           static_cast<int64_t>(state.iterations()));
 }
 
+static constexpr std::string_view no_pii_chunk = R"input(
+        {"method": "GET", "path": "/api/users/profile", "status": "ok", "user_agent": "curl"},
+)input";
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RedactPII_no_pii(benchmark::State& state) {
+  RedactPIIUDF udf;
+  PL_UNUSED(udf.Init(nullptr));
+
+  std::string text_chunk(no_pii_chunk);
+  std::string text;
+  for (int i = 0; i < state.range(0); i++) {
+    text += text_chunk;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(udf.Exec(nullptr, text));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(text.length()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
 BENCHMARK(BM_RedactPII)->RangeMultiplier(2)->Range(1, 12);
+BENCHMARK(BM_RedactPII_no_pii)->RangeMultiplier(2)->Range(1, 12);
 
 }  // namespace builtins
 }  // namespace carnot
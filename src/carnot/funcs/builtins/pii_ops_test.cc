@@ -217,6 +217,14 @@ TEST_P(RedactionTest, basic) {
   udf::UDFTester<RedactPIIUDF>().Init().ForInput(test_case.first).Expect(test_case.second);
 }
 
+TEST(RedactPII, inputs_without_digits) {
+  auto udf_tester = udf::UDFTester<RedactPIIUDF>();
+  udf_tester.Init();
+  udf_tester.ForInput("no personal information in here.")
+      .Expect("no personal information in here.");
+  udf_tester.ForInput("mac: aa-bb-cc-dd-ee-ff.").Expect("mac: <REDACTED_MAC_ADDR>.");
+}
+
 INSTANTIATE_TEST_SUITE_P(TemplatedRedactionTest, RedactionTest,
                          ::testing::ValuesIn(TestCaseGen({IPv4Gen(), IPv6Gen(), EmailGen(), CCGen(),
                                                           IMEIGen(), NegativeExampleGen()})));
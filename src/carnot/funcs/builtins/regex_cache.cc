@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/regex_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_cat.h>
+
+#include "src/common/base/utils.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+namespace {
+
+re2::RE2::Options RegexOptions() {
+  re2::RE2::Options opts;
+  opts.set_log_errors(false);
+  return opts;
+}
+
+template <typename TValue>
+class Cache {
+ public:
+  template <typename TMakeFn>
+  std::shared_ptr<const TValue> GetOrCreate(std::string_view key, TMakeFn make_fn) {
+    {
+      absl::base_internal::SpinLockHolder lock(&lock_);
+      auto iter = entries_.find(key);
+      if (iter != entries_.end()) {
+        return iter->second;
+      }
+    }
+    // Compile outside of the lock, since compiling can take a while. Racing compilations of the
+    // same key are harmless.
+    std::shared_ptr<const TValue> value = make_fn();
+    absl::base_internal::SpinLockHolder lock(&lock_);
+    if (entries_.size() >= RegexCache::kMaxEntries) {
+      entries_.clear();
+    }
+    return entries_.try_emplace(key, std::move(value)).first->second;
+  }
+
+ private:
+  absl::base_internal::SpinLock lock_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const TValue>> entries_;
+};
+
+}  // namespace
+
+std::shared_ptr<const re2::RE2> RegexCache::Get(std::string_view pattern) {
+  static auto* cache = new Cache<re2::RE2>();
+  return cache->GetOrCreate(pattern, [&]() {
+    return std::make_shared<const re2::RE2>(re2::StringPiece(pattern.data(), pattern.size()),
+                                            RegexOptions());
+  });
+}
+
+std::shared_ptr<const CompiledRegexSet> RegexCache::GetSet(const std::vector<std::string>& patterns,
+                                                           re2::RE2::Anchor anchor) {
+  static auto* cache = new Cache<CompiledRegexSet>();
+  // Prefix each pattern with its length, so that the key is unambiguous.
+  std::string key = absl::StrCat(static_cast<int>(anchor));
+  for (const auto& pattern : patterns) {
+    absl::StrAppend(&key, ":", pattern.size(), ":", pattern);
+  }
+  return cache->GetOrCreate(key, [&]() {
+    auto regex_set = std::make_shared<CompiledRegexSet>();
+    regex_set->anchor = anchor;
+    regex_set->set = std::make_unique<re2::RE2::Set>(RegexOptions(), anchor);
+    for (const auto& [i, pattern] : Enumerate(patterns)) {
+      regex_set->regexes.push_back(Get(pattern));
+      if (regex_set->set->Add(pattern, nullptr) >= 0) {
+        regex_set->pattern_indices.push_back(i);
+      }
+    }
+    if (!regex_set->set->Compile()) {
+      regex_set->set.reset();
+    }
+    return regex_set;
+  });
+}
+
+std::vector<size_t> RegexCache::MatchingPatterns(const CompiledRegexSet& regex_set,
+                                                 std::string_view input) {
+  re2::StringPiece input_piece(input.data(), input.size());
+  std::vector<size_t> indices;
+  std::vector<int> matches;
+  re2::RE2::Set::ErrorInfo error_info;
+  if (regex_set.set == nullptr || (!regex_set.set->Match(input_piece, &matches, &error_info) &&
+                                   error_info.kind != re2::RE2::Set::kNoError)) {
+    // Without a set, or if the set ran out of memory, match the regexes one by one.
+    for (const auto& [i, regex] : Enumerate(regex_set.regexes)) {
+      if (regex->ok() &&
+          regex->Match(input_piece, 0, input_piece.size(), regex_set.anchor, nullptr, 0)) {
+        indices.push_back(i);
+      }
+    }
+    return indices;
+  }
+
+  indices.reserve(matches.size());
+  for (int match : matches) {
+    indices.push_back(regex_set.pattern_indices[match]);
+  }
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * A set of regex patterns compiled into a single automaton, which finds all the patterns that
+ * match a string in one pass over it.
+ */
+struct CompiledRegexSet {
+  re2::RE2::Anchor anchor;
+  // Null if the patterns could not be compiled into a set (e.g. it would be too large), in which
+  // case each of the regexes is matched in turn.
+  std::unique_ptr<re2::RE2::Set> set;
+  // The index, in the patterns the set was built from, of each pattern of the set. Patterns that
+  // fail to compile are left out of the set, and so never match.
+  std::vector<size_t> pattern_indices;
+  // The regex of each pattern.
+  std::vector<std::shared_ptr<const re2::RE2>> regexes;
+};
+
+/**
+ * The compiled regexes are cached process-wide and keyed by their pattern text, since every
+ * instance of the regex funcs in every query compiles the same few patterns. Compiled regexes are
+ * immutable and safe to use from several threads.
+ */
+class RegexCache {
+ public:
+  // The number of entries after which the cache is cleared.
+  static constexpr size_t kMaxEntries = 1024;
+
+  /**
+   * Returns the regex compiled from pattern, with RE2 errors logging disabled. The caller must
+   * check its error_code().
+   */
+  static std::shared_ptr<const re2::RE2> Get(std::string_view pattern);
+
+  /**
+   * Returns the set compiled from patterns, anchored as specified.
+   */
+  static std::shared_ptr<const CompiledRegexSet> GetSet(const std::vector<std::string>& patterns,
+                                                        re2::RE2::Anchor anchor);
+
+  /**
+   * Returns the sorted indices, in the patterns the set was built from, of the patterns matching
+   * input.
+   */
+  static std::vector<size_t> MatchingPatterns(const CompiledRegexSet& regex_set,
+                                              std::string_view input);
+};
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
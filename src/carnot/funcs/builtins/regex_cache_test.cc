@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/funcs/builtins/regex_cache.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(RegexCache, get_returns_cached_regex) {
+  auto regex = RegexCache::Get("a+b");
+  ASSERT_TRUE(regex->ok());
+  EXPECT_TRUE(RE2::FullMatch("aaab", *regex));
+  EXPECT_EQ(regex, RegexCache::Get("a+b"));
+  EXPECT_NE(regex, RegexCache::Get("a+c"));
+}
+
+TEST(RegexCache, get_invalid_regex) {
+  auto regex = RegexCache::Get("(a");
+  EXPECT_FALSE(regex->ok());
+}
+
+TEST(RegexCache, matching_patterns) {
+  std::vector<std::string> patterns = {"[0-9]+", "(unbalanced", "abc", "[a-z]+"};
+  auto regex_set = RegexCache::GetSet(patterns, RE2::ANCHOR_BOTH);
+  EXPECT_EQ(regex_set, RegexCache::GetSet(patterns, RE2::ANCHOR_BOTH));
+
+  EXPECT_THAT(RegexCache::MatchingPatterns(*regex_set, "abc"), ElementsAre(2, 3));
+  EXPECT_THAT(RegexCache::MatchingPatterns(*regex_set, "123"), ElementsAre(0));
+  EXPECT_THAT(RegexCache::MatchingPatterns(*regex_set, "abc123"), IsEmpty());
+
+  auto unanchored_set = RegexCache::GetSet(patterns, RE2::UNANCHORED);
+  EXPECT_NE(regex_set, unanchored_set);
+  EXPECT_THAT(RegexCache::MatchingPatterns(*unanchored_set, "abc123"), ElementsAre(0, 2, 3));
+}
+
+TEST(RegexCache, matching_patterns_without_set) {
+  std::vector<std::string> patterns = {"[0-9]+", "(unbalanced", "abc"};
+  CompiledRegexSet regex_set;
+  regex_set.anchor = RE2::UNANCHORED;
+  for (const auto& pattern : patterns) {
+    regex_set.regexes.push_back(RegexCache::Get(pattern));
+  }
+  EXPECT_THAT(RegexCache::MatchingPatterns(regex_set, "xabc1"), ElementsAre(0, 2));
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
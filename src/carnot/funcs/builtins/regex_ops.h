@@ -29,6 +29,7 @@
 #include <utility>
 #include <vector>
 #include "re2/re2.h"
+#include "src/carnot/funcs/builtins/regex_cache.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -40,9 +41,7 @@ namespace builtins {
 class RegexMatchUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, StringValue regex) {
-    re2::RE2::Options opts;
-    opts.set_log_errors(false);
-    regex_ = std::make_unique<re2::RE2>(regex, opts);
+    regex_ = RegexCache::Get(regex);
     return Status::OK();
   }
   BoolValue Exec(FunctionContext*, StringValue input) {
@@ -68,15 +67,13 @@ class RegexMatchUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::unique_ptr<re2::RE2> regex_;
+  std::shared_ptr<const re2::RE2> regex_;
 };
 
 class RegexReplaceUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, StringValue regex_pattern) {
-    re2::RE2::Options opts;
-    opts.set_log_errors(false);
-    regex_ = std::make_unique<re2::RE2>(regex_pattern, opts);
+    regex_ = RegexCache::Get(regex_pattern);
     return Status::OK();
   }
   StringValue Exec(FunctionContext*, StringValue input, StringValue sub) {
@@ -113,38 +110,37 @@ class RegexReplaceUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::unique_ptr<re2::RE2> regex_;
+  std::shared_ptr<const re2::RE2> regex_;
 };
 
 class MatchRegexRule : public udf::ScalarUDF {
  public:
-  Status Init(FunctionContext* ctx, StringValue encodedRegexRules) {
+  Status Init(FunctionContext*, StringValue encodedRegexRules) {
     // Parse encodedRegexRules as json.
     rapidjson::Document regex_rules_json;
     rapidjson::ParseResult parse_result = regex_rules_json.Parse(encodedRegexRules.data());
     if (!parse_result) {
       return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
     }
-    // Populate the parse regular expressions into self::regex_rules.
+    // Compile the rules into a single set, which matches all of them in one pass over a value.
+    rule_names_.clear();
+    std::vector<std::string> patterns;
     for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
          itr != regex_rules_json.MemberEnd(); ++itr) {
-      RegexMatchUDF regex_match_udf;
-      std::string name = itr->name.GetString();
-      std::string regex_pattern = itr->value.GetString();
-      PL_RETURN_IF_ERROR(regex_match_udf.Init(ctx, regex_pattern));
-      regex_rules.emplace_back(make_pair(name, std::move(regex_match_udf)));
-      regex_rules_length++;
+      rule_names_.push_back(itr->name.GetString());
+      patterns.push_back(itr->value.GetString());
     }
+    regex_rules_ = RegexCache::GetSet(patterns, RE2::ANCHOR_BOTH);
     return Status::OK();
   }
 
-  types::StringValue Exec(FunctionContext* ctx, StringValue value) {
-    for (int i = 0; i < regex_rules_length; i++) {
-      if (regex_rules[i].second.Exec(ctx, value).val) {
-        return regex_rules[i].first;
-      }
+  types::StringValue Exec(FunctionContext*, StringValue value) {
+    // Return the first rule that matches.
+    auto matches = RegexCache::MatchingPatterns(*regex_rules_, value);
+    if (matches.empty()) {
+      return "";
     }
-    return "";
+    return rule_names_[matches.front()];
   }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -169,8 +165,8 @@ class MatchRegexRule : public udf::ScalarUDF {
   }
 
  private:
-  int regex_rules_length = 0;
-  std::vector<std::pair<std::string, RegexMatchUDF> > regex_rules;
+  std::vector<std::string> rule_names_;
+  std::shared_ptr<const CompiledRegexSet> regex_rules_;
 };
 
 void RegisterRegexOpsOrDie(udf::Registry* registry);
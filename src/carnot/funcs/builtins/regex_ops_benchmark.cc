@@ -0,0 +1,70 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/regex_ops.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Builds rules that look for num_rules different keywords anywhere in a value.
+static std::string RegexRules(int num_rules) {
+  std::string rules = "{";
+  for (int i = 0; i < num_rules; i++) {
+    absl::SubstituteAndAppend(&rules, R"($0"rule$1": "(?i).*keyword$1.*")", i == 0 ? "" : ", ",
+                              i);
+  }
+  return rules + "}";
+}
+
+static constexpr char kValue[] =
+    "UPDATE courses SET name = '<a/+/OnpOinteRENtER+=+a=prompt,a()%0dx>v3dm0s ' WHERE id = 2";
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_MatchRegexRule(benchmark::State& state) {
+  MatchRegexRule udf;
+  PL_UNUSED(udf.Init(nullptr, RegexRules(state.range(0))));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(udf.Exec(nullptr, kValue));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(sizeof(kValue)) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RegexMatchInit(benchmark::State& state) {
+  for (auto _ : state) {
+    RegexMatchUDF udf;
+    PL_UNUSED(udf.Init(nullptr, ".*(?i)onpointerenter.*"));
+    benchmark::DoNotOptimize(udf.Exec(nullptr, kValue));
+  }
+}
+
+BENCHMARK(BM_MatchRegexRule)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_RegexMatchInit);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -60,7 +60,7 @@ double RequestPath::Similarity(const RequestPath& other) const {
   DCHECK_EQ(depth(), other.depth());
   auto num_agree = 0.0;
   for (const auto& [i, path_component] : Enumerate(path_components_)) {
-    auto other_path_component = other.path_components_[i];
+    const auto& other_path_component = other.path_components_[i];
     if (path_component == kAnyToken || other_path_component == kAnyToken ||
         path_component != other_path_component) {
       continue;
@@ -112,6 +112,23 @@ void RequestPath::ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) con
   writer->EndArray();
 }
 
+void RequestPath::Serialize(udf::UDAStateWriter* writer) const {
+  writer->Write(static_cast<uint32_t>(path_components_.size()));
+  for (const auto& path : path_components_) {
+    writer->WriteString(path);
+  }
+}
+
+StatusOr<RequestPath> RequestPath::Deserialize(udf::UDAStateReader* reader) {
+  uint32_t num_components;
+  PL_RETURN_IF_ERROR(reader->Read(&num_components));
+  RequestPath request_path;
+  for (uint32_t i = 0; i < num_components; ++i) {
+    PL_RETURN_IF_ERROR(reader->ReadString(&request_path.path_components_.emplace_back()));
+  }
+  return request_path;
+}
+
 std::string RequestPath::ToString() const { return "/" + absl::StrJoin(path_components_, "/"); }
 
 bool operator==(const RequestPath& a, const RequestPath& b) {
@@ -146,9 +163,8 @@ void RequestPathCluster::Merge(const RequestPathCluster& other_cluster) {
   MergeMembers(other_cluster.members_);
 }
 void RequestPathCluster::MergeCentroids(const RequestPath& other_centroid) {
-  auto path_components = centroid_.path_components();
-  auto other_path_components = other_centroid.path_components();
-  for (const auto& [i, path] : Enumerate(other_path_components)) {
+  const auto& path_components = centroid_.path_components();
+  for (const auto& [i, path] : Enumerate(other_centroid.path_components())) {
     if (path == path_components[i]) {
       continue;
     }
@@ -210,22 +226,69 @@ void RequestPathCluster::ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writ
   writer->EndObject();
 }
 
-double RequestPathClustering::MaxSimilarity(const RequestPath& request_path,
-                                            int64_t* max_index) const {
-  auto it = depth_to_centroid_indices_.find(request_path.depth());
+void RequestPathCluster::Serialize(udf::UDAStateWriter* writer) const {
+  centroid_.Serialize(writer);
+  writer->Write(static_cast<uint32_t>(members_.size()));
+  for (const auto& path : members_) {
+    path.Serialize(writer);
+  }
+}
+
+StatusOr<RequestPathCluster> RequestPathCluster::Deserialize(udf::UDAStateReader* reader) {
+  RequestPathCluster cluster;
+  PL_ASSIGN_OR_RETURN(cluster.centroid_, RequestPath::Deserialize(reader));
+  uint32_t num_members;
+  PL_RETURN_IF_ERROR(reader->Read(&num_members));
+  for (uint32_t i = 0; i < num_members; ++i) {
+    PL_ASSIGN_OR_RETURN(auto path, RequestPath::Deserialize(reader));
+    cluster.members_.insert(std::move(path));
+  }
+  return cluster;
+}
+
+RequestPathClustering::RequestPathClustering() {
+  token_ids_.emplace(RequestPath::kAnyToken, kAnyTokenID);
+}
+
+RequestPathClustering::Tokens RequestPathClustering::Tokenize(const RequestPath& request_path,
+                                                              bool intern) {
+  Tokens tokens;
+  tokens.reserve(request_path.depth());
+  for (const auto& path : request_path.path_components()) {
+    auto it = token_ids_.find(path);
+    if (it != token_ids_.end()) {
+      tokens.push_back(it->second);
+    } else if (intern) {
+      uint32_t id = token_ids_.size();
+      token_ids_.emplace(path, id);
+      tokens.push_back(id);
+    } else {
+      tokens.push_back(kUnknownTokenID);
+    }
+  }
+  return tokens;
+}
+
+double RequestPathClustering::MaxSimilarity(const Tokens& tokens, int64_t* max_index) const {
+  auto it = depth_to_centroid_indices_.find(tokens.size());
   *max_index = -1;
   if (it == depth_to_centroid_indices_.end()) {
     return 0.0;
   }
-  auto max_similarity = 0.0;
+  // Same metric as RequestPath::Similarity, on tokens. Centroids never hold kUnknownTokenID.
+  int64_t max_agree = 0;
   for (auto index : it->second) {
-    auto similarity = clusters_[index].Similarity(request_path);
-    if (similarity > max_similarity) {
+    const auto& centroid_tokens = centroid_tokens_[index];
+    int64_t num_agree = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      num_agree += centroid_tokens[i] == tokens[i] && tokens[i] != kAnyTokenID;
+    }
+    if (num_agree > max_agree) {
       *max_index = index;
-      max_similarity = similarity;
+      max_agree = num_agree;
     }
   }
-  return max_similarity;
+  return static_cast<double>(max_agree) / tokens.size();
 }
 
 void RequestPathClustering::AddNewCluster(const RequestPathCluster& cluster) {
@@ -235,11 +298,20 @@ void RequestPathClustering::AddNewCluster(const RequestPathCluster& cluster) {
   }
   depth_to_centroid_indices_[centroid.depth()].push_back(clusters_.size());
   clusters_.push_back(cluster);
+  centroid_tokens_.push_back(Tokenize(centroid, /*intern*/ true));
 }
 
 void RequestPathClustering::MergeCluster(int64_t cluster_index,
-                                         const RequestPathCluster& other_cluster) {
+                                         const RequestPathCluster& other_cluster,
+                                         const Tokens& other_tokens) {
   clusters_[cluster_index].Merge(other_cluster);
+  // Mirrors RequestPathCluster::MergeCentroids.
+  auto& centroid_tokens = centroid_tokens_[cluster_index];
+  for (size_t i = 0; i < centroid_tokens.size(); ++i) {
+    if (centroid_tokens[i] != other_tokens[i]) {
+      centroid_tokens[i] = kAnyTokenID;
+    }
+  }
 }
 
 StatusOr<RequestPathClustering> RequestPathClustering::FromJSON(const std::string& json) {
@@ -265,16 +337,34 @@ std::string RequestPathClustering::ToJSON() const {
   rapidjson::StringBuffer sb;
   rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
   writer.StartArray();
-  for (auto cluster : clusters_) {
+  for (const auto& cluster : clusters_) {
     cluster.ToJSON(&writer);
   }
   writer.EndArray();
   return sb.GetString();
 }
 
+void RequestPathClustering::Serialize(udf::UDAStateWriter* writer) const {
+  writer->Write(static_cast<uint32_t>(clusters_.size()));
+  for (const auto& cluster : clusters_) {
+    cluster.Serialize(writer);
+  }
+}
+
+StatusOr<RequestPathClustering> RequestPathClustering::Deserialize(udf::UDAStateReader* reader) {
+  uint32_t num_clusters;
+  PL_RETURN_IF_ERROR(reader->Read(&num_clusters));
+  RequestPathClustering clustering;
+  for (uint32_t i = 0; i < num_clusters; ++i) {
+    PL_ASSIGN_OR_RETURN(auto cluster, RequestPathCluster::Deserialize(reader));
+    clustering.AddNewCluster(cluster);
+  }
+  return clustering;
+}
+
 const RequestPath& RequestPathClustering::Predict(const RequestPath& request_path) {
   int64_t closest_cluster_index;
-  MaxSimilarity(request_path, &closest_cluster_index);
+  MaxSimilarity(Tokenize(request_path, /*intern*/ false), &closest_cluster_index);
   if (closest_cluster_index == -1) {
     DCHECK(false) << absl::Substitute("Failed to find cluster close to request path $0",
                                       request_path.ToString());
@@ -284,12 +374,13 @@ const RequestPath& RequestPathClustering::Predict(const RequestPath& request_pat
 }
 
 void RequestPathClustering::Update(const RequestPathCluster& new_cluster) {
+  auto tokens = Tokenize(new_cluster.centroid(), /*intern*/ true);
   int64_t closest_cluster_index;
-  auto similarity = MaxSimilarity(new_cluster.centroid(), &closest_cluster_index);
+  auto similarity = MaxSimilarity(tokens, &closest_cluster_index);
   if (closest_cluster_index == -1 || similarity < thresh_) {
     AddNewCluster(new_cluster);
   } else {
-    MergeCluster(closest_cluster_index, new_cluster);
+    MergeCluster(closest_cluster_index, new_cluster, tokens);
   }
 }
 
@@ -306,15 +397,12 @@ void RequestPathClustering::Merge(const RequestPathClustering& other_clustering)
     }
   }
 
-  clusters_ = new_clusters;
-  // Rebuild depth_to_cluster_indices mapping.
+  // Rebuild depth_to_cluster_indices mapping and the centroid tokens.
+  clusters_.clear();
+  centroid_tokens_.clear();
   depth_to_centroid_indices_.clear();
-  for (const auto& [cluster_idx, cluster] : Enumerate(clusters_)) {
-    auto depth = cluster.centroid().depth();
-    if (depth_to_centroid_indices_.find(depth) == depth_to_centroid_indices_.end()) {
-      depth_to_centroid_indices_.emplace(depth, std::vector<int64_t>());
-    }
-    depth_to_centroid_indices_[depth].push_back(cluster_idx);
+  for (const auto& cluster : new_clusters) {
+    AddNewCluster(cluster);
   }
 
   for (const auto& cluster : other_clustering.clusters_) {
@@ -20,12 +20,14 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <limits>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "src/carnot/udf/registry.h"
+#include "src/carnot/udf/uda_state.h"
 #include "src/shared/types/types.h"
 
 namespace px {
@@ -85,7 +87,7 @@ class RequestPath {
 
   template <typename H>
   friend H AbslHashValue(H h, const RequestPath& request_path) {
-    return H::combine(std::move(h), request_path.ToString());
+    return H::combine(std::move(h), request_path.path_components_);
   }
 
   // Serialization/Deserialization
@@ -93,6 +95,8 @@ class RequestPath {
   void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const;
   static StatusOr<RequestPath> FromJSON(std::string serialized_request_path);
   static StatusOr<RequestPath> FromJSON(const rapidjson::Document::ValueType& doc);
+  void Serialize(udf::UDAStateWriter* writer) const;
+  static StatusOr<RequestPath> Deserialize(udf::UDAStateReader* reader);
 
   int64_t depth() const { return path_components_.size(); }
   const std::vector<std::string>& path_components() const { return path_components_; }
@@ -159,6 +163,8 @@ class RequestPathCluster {
   static StatusOr<RequestPathCluster> FromJSON(const rapidjson::Document::ValueType& doc);
   std::string ToJSON() const;
   void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const;
+  void Serialize(udf::UDAStateWriter* writer) const;
+  static StatusOr<RequestPathCluster> Deserialize(udf::UDAStateReader* reader);
 
   const RequestPath& centroid() const { return centroid_; }
   const absl::flat_hash_set<RequestPath>& members() const { return members_; }
@@ -176,10 +182,18 @@ class RequestPathCluster {
 
 class RequestPathClustering {
  public:
+  RequestPathClustering();
+
   static StatusOr<RequestPathClustering> FromJSON(const std::string& json);
 
   std::string ToJSON() const;
 
+  /**
+   * The binary form of the clustering, used to ship partial clusterings between agents.
+   */
+  void Serialize(udf::UDAStateWriter* writer) const;
+  static StatusOr<RequestPathClustering> Deserialize(udf::UDAStateReader* reader);
+
   /**
    * @param request_path request path to get prediction for.
    * @return the centroid of the cluster closest to the given request path.
@@ -198,12 +212,24 @@ class RequestPathClustering {
   const std::vector<RequestPathCluster>& clusters() const { return clusters_; }
 
  private:
-  double MaxSimilarity(const RequestPath& request_path, int64_t* max_index) const;
+  // The path components of the centroids are interned into token IDs, so that finding the closest
+  // cluster for a path compares integers rather than strings.
+  using Tokens = std::vector<uint32_t>;
+  static constexpr uint32_t kAnyTokenID = 0;
+  // The ID for components of paths being predicted that no centroid has.
+  static constexpr uint32_t kUnknownTokenID = std::numeric_limits<uint32_t>::max();
+
+  Tokens Tokenize(const RequestPath& request_path, bool intern);
+  double MaxSimilarity(const Tokens& tokens, int64_t* max_index) const;
   void AddNewCluster(const RequestPathCluster& cluster);
-  void MergeCluster(int64_t cluster_index, const RequestPathCluster& other_cluster);
+  void MergeCluster(int64_t cluster_index, const RequestPathCluster& other_cluster,
+                    const Tokens& other_tokens);
   // We currently only allow request path's with the same depth to be clustered together.
   absl::flat_hash_map<int64_t, std::vector<int64_t>> depth_to_centroid_indices_;
   std::vector<RequestPathCluster> clusters_;
+  // The tokens of the centroid of each cluster.
+  std::vector<Tokens> centroid_tokens_;
+  absl::flat_hash_map<std::string, uint32_t> token_ids_;
   double thresh_ = 0.5;
 };
 
@@ -219,34 +245,67 @@ class RequestPathClusteringPredictUDF : public udf::ScalarUDF {
       clustering_ = clustering_or_s.ConsumeValueOrDie();
       clustering_init_ = true;
     }
-    auto request_path = RequestPath(request_path_str);
-    return clustering_.Predict(request_path).ToString();
+    // Requests mostly hit a small set of paths, so remember the predictions for the paths seen.
+    auto it = predictions_.find(request_path_str);
+    if (it != predictions_.end()) {
+      return it->second;
+    }
+    std::string prediction = clustering_.Predict(RequestPath(request_path_str)).ToString();
+    if (predictions_.size() < kMaxCachedPredictions) {
+      predictions_.emplace(request_path_str, prediction);
+    }
+    return prediction;
   }
 
   RequestPathClustering clustering_;
   bool clustering_init_ = false;
+
+ private:
+  static constexpr size_t kMaxCachedPredictions = 64 * 1024;
+  absl::flat_hash_map<std::string, std::string> predictions_;
 };
 
 class RequestPathClusteringFitUDA : public udf::UDA {
  public:
   void Update(FunctionContext*, StringValue request_path_str) {
-    auto request_path = RequestPath(request_path_str);
-    clustering_.Update(RequestPathCluster(request_path));
+    // Each distinct path only needs to be clustered once. Adding it again either leaves the
+    // clustering as is, or splits off a redundant cluster if its centroid generalized away from it.
+    if (seen_paths_.contains(request_path_str)) {
+      return;
+    }
+    if (seen_paths_.size() < kMaxSeenPaths) {
+      seen_paths_.emplace(request_path_str);
+    }
+    clustering_.Update(RequestPathCluster(RequestPath(request_path_str)));
   }
   void Merge(FunctionContext*, const RequestPathClusteringFitUDA& other) {
     clustering_.Merge(other.clustering_);
   }
   StringValue Finalize(FunctionContext*) { return clustering_.ToJSON(); }
 
-  StringValue Serialize(FunctionContext*) { return clustering_.ToJSON(); }
+  StringValue Serialize(FunctionContext*) {
+    udf::UDAStateWriter writer(kStateVersion);
+    clustering_.Serialize(&writer);
+    return writer.Finish();
+  }
 
   Status Deserialize(FunctionContext*, const StringValue& data) {
-    PL_ASSIGN_OR_RETURN(clustering_, RequestPathClustering::FromJSON(data));
+    if (!udf::UDAStateReader::IsUDAState(data)) {
+      // Agents that haven't been upgraded yet still send the clustering as JSON.
+      PL_ASSIGN_OR_RETURN(clustering_, RequestPathClustering::FromJSON(data));
+      return Status::OK();
+    }
+    PL_ASSIGN_OR_RETURN(auto reader, udf::UDAStateReader::Create(data, kStateVersion));
+    PL_ASSIGN_OR_RETURN(clustering_, RequestPathClustering::Deserialize(&reader));
     return Status::OK();
   }
 
  private:
+  static constexpr uint8_t kStateVersion = 1;
+  static constexpr size_t kMaxSeenPaths = 64 * 1024;
+
   RequestPathClustering clustering_;
+  absl::flat_hash_set<std::string> seen_paths_;
 };
 
 class RequestPathEndpointMatcherUDF : public udf::ScalarUDF {
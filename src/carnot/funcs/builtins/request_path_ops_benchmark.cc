@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/request_path_ops.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Builds a request log with num_distinct_paths paths, under a handful of endpoints.
+static std::vector<std::string> RequestLog(int num_requests, int num_distinct_paths) {
+  std::vector<std::string> requests;
+  requests.reserve(num_requests);
+  for (int i = 0; i < num_requests; ++i) {
+    int id = (i * 7919) % num_distinct_paths;
+    requests.push_back(absl::Substitute("/api/v1/endpoint$0/$1/details", id % 8, id));
+  }
+  return requests;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringFit(benchmark::State& state) {
+  auto requests = RequestLog(100000, state.range(0));
+  for (auto _ : state) {
+    RequestPathClusteringFitUDA uda;
+    for (const auto& request : requests) {
+      uda.Update(nullptr, request);
+    }
+    benchmark::DoNotOptimize(uda.Finalize(nullptr));
+  }
+  state.SetItemsProcessed(state.iterations() * requests.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringPredict(benchmark::State& state) {
+  auto requests = RequestLog(100000, state.range(0));
+  RequestPathClusteringFitUDA uda;
+  for (const auto& request : requests) {
+    uda.Update(nullptr, request);
+  }
+  std::string clustering = uda.Finalize(nullptr);
+  for (auto _ : state) {
+    RequestPathClusteringPredictUDF udf;
+    for (const auto& request : requests) {
+      benchmark::DoNotOptimize(udf.Exec(nullptr, request, clustering));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * requests.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringSerialize(benchmark::State& state) {
+  auto requests = RequestLog(100000, state.range(0));
+  RequestPathClusteringFitUDA uda;
+  for (const auto& request : requests) {
+    uda.Update(nullptr, request);
+  }
+  size_t bytes = 0;
+  for (auto _ : state) {
+    types::StringValue serialized = uda.Serialize(nullptr);
+    bytes += serialized.size();
+    benchmark::DoNotOptimize(serialized);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringDeserializeMerge(benchmark::State& state) {
+  auto requests = RequestLog(100000, state.range(0));
+  RequestPathClusteringFitUDA merged;
+  for (const auto& request : requests) {
+    merged.Update(nullptr, request);
+  }
+  types::StringValue serialized = merged.Serialize(nullptr);
+  for (auto _ : state) {
+    RequestPathClusteringFitUDA partial;
+    PL_CHECK_OK(partial.Deserialize(nullptr, serialized));
+    merged.Merge(nullptr, partial);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+BENCHMARK(BM_RequestPathClusteringFit)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_RequestPathClusteringPredict)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_RequestPathClusteringSerialize)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_RequestPathClusteringDeserializeMerge)->RangeMultiplier(10)->Range(10, 10000);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -19,6 +19,8 @@
 #include <algorithm>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
+
 #include "src/carnot/funcs/builtins/request_path_ops.h"
 #include "src/carnot/funcs/builtins/request_path_ops_test_utils.h"
 #include "src/carnot/udf/test_utils.h"
@@ -97,6 +99,27 @@ TEST(RequestPathEndpointMatcher, basic) {
   udf_tester.ForInput("/a/c/c", "/a/b/*").Expect(false);
 }
 
+TEST(RequestPathClusteringFit, repeated_paths) {
+  auto uda_tester = udf::UDATester<RequestPathClusteringFitUDA>();
+  for (int i = 0; i < 100; ++i) {
+    uda_tester.ForInput("/a/b/c").ForInput("/a/b/d").ForInput("/x/y");
+  }
+  ASSERT_OK_AND_ASSIGN(auto clustering, RequestPathClustering::FromJSON(uda_tester.Result()));
+  EXPECT_THAT(clustering, HasCentroids(std::vector<std::string>{"/a/b/c", "/a/b/d", "/x/y"}));
+}
+
+TEST(RequestPathClusteringPredict, unseen_components) {
+  auto uda_tester = udf::UDATester<RequestPathClusteringFitUDA>();
+  for (int i = 0; i < 6; ++i) {
+    uda_tester.ForInput(absl::StrCat("/users/", i, "/profile"));
+  }
+  auto udf_tester = udf::UDFTester<RequestPathClusteringPredictUDF>();
+  udf_tester.ForInput("/users/1234/profile", uda_tester.Result()).Expect("/users/*/profile");
+  // The second prediction for the same path comes from the cache.
+  udf_tester.ForInput("/users/1234/profile", uda_tester.Result()).Expect("/users/*/profile");
+  udf_tester.ForInput("/users/5/other", uda_tester.Result()).Expect("/users/*/profile");
+}
+
 // This tests the case where different PEMs have different clusterings of their own data, such that
 // at merge time some of the individual points in not yet fully formed clusters on one PEM should've
 // been clustered into one of the clusters on the other PEM. This should be handled by the logic in
@@ -192,6 +215,39 @@ TEST(RequestPathClusteringFit, merging_clusters_complicated) {
   } while (std::next_permutation(permutation_indices.begin(), permutation_indices.end()));
 }
 
+TEST(RequestPathClusteringFit, partial_agg) {
+  auto uda_tester1 = udf::UDATester<RequestPathClusteringFitUDA>();
+  uda_tester1.ForInput("/a/b/a")
+      .ForInput("/a/b/b")
+      .ForInput("/a/b/c")
+      .ForInput("/a/b/d")
+      .ForInput("/a/b/e")
+      .ForInput("/a/b/f");
+  auto uda_tester2 = udf::UDATester<RequestPathClusteringFitUDA>();
+  uda_tester2.ForInput("/a/b/c").ForInput("/b/b/c").ForInput("/c/b/c");
+
+  auto state = uda_tester2.Serialize();
+  EXPECT_TRUE(udf::UDAStateReader::IsUDAState(state));
+  // Partial clusterings from older agents are still JSON.
+  auto json_state = uda_tester2.Result();
+  EXPECT_FALSE(udf::UDAStateReader::IsUDAState(json_state));
+
+  auto binary_merged = udf::UDATester<RequestPathClusteringFitUDA>();
+  binary_merged.Merge(&uda_tester1);
+  ASSERT_OK(binary_merged.Deserialize(state));
+  auto json_merged = udf::UDATester<RequestPathClusteringFitUDA>();
+  json_merged.Merge(&uda_tester1);
+  ASSERT_OK(json_merged.Deserialize(json_state));
+
+  std::vector<std::string> centroids({"/a/b/*", "/b/b/c", "/c/b/c"});
+  for (auto* merged : {&binary_merged, &json_merged}) {
+    ASSERT_OK_AND_ASSIGN(auto clustering, RequestPathClustering::FromJSON(merged->Result()));
+    EXPECT_THAT(clustering, HasCentroids(centroids));
+  }
+
+  EXPECT_NOT_OK(binary_merged.Deserialize(state.substr(0, state.size() - 1)));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
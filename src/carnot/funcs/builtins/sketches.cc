@@ -0,0 +1,522 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/sketches.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// NOLINTNEXTLINE: build/include_subdir
+#include "xxhash.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+namespace {
+
+uint64_t Hash(const void* data, size_t size, uint64_t seed = 0) { return XXH64(data, size, seed); }
+
+}  // namespace
+
+/*************************************************
+ * HyperLogLog
+ *************************************************/
+
+HyperLogLog::HyperLogLog(int precision)
+    : precision_(std::clamp(precision, kMinPrecision, kMaxPrecision)) {}
+
+void HyperLogLog::Add(int64_t val) { AddHash(Hash(&val, sizeof(val))); }
+
+void HyperLogLog::Add(double val) {
+  // Make 0.0 and -0.0 count as the same value.
+  if (val == 0) {
+    val = 0;
+  }
+  AddHash(Hash(&val, sizeof(val)));
+}
+
+void HyperLogLog::Add(std::string_view val) { AddHash(Hash(val.data(), val.size())); }
+
+void HyperLogLog::AddHash(uint64_t hash) {
+  uint32_t index = hash >> (64 - precision_);
+  // The sentinel bit bounds the rank by max_rank().
+  uint64_t rest = (hash << precision_) | (uint64_t{1} << (precision_ - 1));
+  Update(index, __builtin_clzll(rest) + 1);
+}
+
+void HyperLogLog::Update(uint32_t index, uint8_t rank) {
+  if (!is_sparse()) {
+    registers_[index] = std::max(registers_[index], rank);
+    return;
+  }
+  uint32_t entry = (index << 8) | rank;
+  // Entries are sorted by index, so the first entry not below index << 8 is the one for index.
+  auto it = std::lower_bound(sparse_.begin(), sparse_.end(), index << 8);
+  if (it != sparse_.end() && (*it >> 8) == index) {
+    *it = std::max(*it, entry);
+    return;
+  }
+  sparse_.insert(it, entry);
+  if (sparse_.size() > num_registers() / 4) {
+    ToDense();
+  }
+}
+
+void HyperLogLog::ToDense() {
+  registers_.assign(num_registers(), 0);
+  for (uint32_t entry : sparse_) {
+    registers_[entry >> 8] = entry & 0xff;
+  }
+  sparse_.clear();
+  sparse_.shrink_to_fit();
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+  DCHECK_EQ(precision_, other.precision_);
+  if (other.is_sparse()) {
+    for (uint32_t entry : other.sparse_) {
+      Update(entry >> 8, entry & 0xff);
+    }
+    return;
+  }
+  if (is_sparse()) {
+    ToDense();
+  }
+  for (size_t i = 0; i < registers_.size(); ++i) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+int64_t HyperLogLog::Estimate() const {
+  double m = num_registers();
+  size_t num_zeros;
+  if (is_sparse()) {
+    num_zeros = num_registers() - sparse_.size();
+  } else {
+    num_zeros = std::count(registers_.begin(), registers_.end(), 0);
+  }
+  if (num_zeros > 0) {
+    // The raw estimate is heavily biased below about 2.5m distinct values, while linear counting
+    // is accurate up to there. This is the cutoff of the original HyperLogLog paper; the lower
+    // HLL++ thresholds would need its empirical bias correction as well.
+    double linear_count = m * std::log(m / num_zeros);
+    if (is_sparse() || linear_count <= 2.5 * m) {
+      return std::llround(linear_count);
+    }
+  }
+  double sum = 0;
+  for (uint8_t rank : registers_) {
+    sum += std::ldexp(1.0, -rank);
+  }
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  return std::llround(alpha * m * m / sum);
+}
+
+void HyperLogLog::Serialize(udf::UDAStateWriter* writer) const {
+  writer->Write(static_cast<uint8_t>(precision_));
+  if (is_sparse()) {
+    writer->Write(kSparse);
+    writer->WriteArray(sparse_.data(), sparse_.size());
+  } else {
+    writer->Write(kDense);
+    writer->WriteArray(registers_.data(), registers_.size());
+  }
+}
+
+Status HyperLogLog::Deserialize(udf::UDAStateReader* reader) {
+  uint8_t precision;
+  Encoding encoding;
+  PL_RETURN_IF_ERROR(reader->Read(&precision));
+  PL_RETURN_IF_ERROR(reader->Read(&encoding));
+  if (precision != precision_) {
+    return error::InvalidArgument("HyperLogLog precision $0 doesn't match $1",
+                                  static_cast<int>(precision), precision_);
+  }
+  std::vector<uint32_t> sparse;
+  std::vector<uint8_t> registers;
+  switch (encoding) {
+    case kSparse:
+      PL_RETURN_IF_ERROR(reader->ReadArray(&sparse));
+      if (sparse.size() > num_registers() / 4 || !std::is_sorted(sparse.begin(), sparse.end())) {
+        return error::InvalidArgument("Invalid sparse HyperLogLog state");
+      }
+      for (uint32_t entry : sparse) {
+        if ((entry >> 8) >= num_registers() || (entry & 0xff) > max_rank()) {
+          return error::InvalidArgument("Invalid sparse HyperLogLog state");
+        }
+      }
+      break;
+    case kDense:
+      PL_RETURN_IF_ERROR(reader->ReadArray(&registers));
+      if (registers.size() != num_registers() ||
+          *std::max_element(registers.begin(), registers.end()) > max_rank()) {
+        return error::InvalidArgument("Invalid dense HyperLogLog state");
+      }
+      break;
+    default:
+      return error::InvalidArgument("Unknown HyperLogLog encoding $0",
+                                    static_cast<int>(encoding));
+  }
+  sparse_ = std::move(sparse);
+  registers_ = std::move(registers);
+  return Status::OK();
+}
+
+/*************************************************
+ * DDSketch
+ *************************************************/
+
+void DDSketch::Store::Add(int32_t index, uint64_t count, int max_bins) {
+  total += count;
+  if (bins.empty()) {
+    offset = index;
+    bins.assign(1, count);
+    return;
+  }
+  int32_t hi = offset + static_cast<int32_t>(bins.size()) - 1;
+  if (index < offset || index > hi) {
+    int32_t lo = std::min(index, offset);
+    hi = std::max(index, hi);
+    if (hi - lo + 1 > max_bins) {
+      lo = hi - max_bins + 1;
+    }
+    Resize(lo, hi);
+    index = std::max(index, lo);
+  }
+  bins[index - offset] += count;
+}
+
+void DDSketch::Store::Merge(const Store& other, int max_bins) {
+  if (other.bins.empty()) {
+    return;
+  }
+  if (bins.empty()) {
+    *this = other;
+    // The other store may come from an agent that allows more bins.
+    if (bins.size() > static_cast<size_t>(max_bins)) {
+      int32_t hi = offset + static_cast<int32_t>(bins.size()) - 1;
+      Resize(hi - max_bins + 1, hi);
+    }
+    return;
+  }
+  int32_t lo = std::min(offset, other.offset);
+  int32_t hi = std::max(offset + static_cast<int32_t>(bins.size()),
+                        other.offset + static_cast<int32_t>(other.bins.size())) -
+               1;
+  if (hi - lo + 1 > max_bins) {
+    lo = hi - max_bins + 1;
+  }
+  Resize(lo, hi);
+  for (size_t i = 0; i < other.bins.size(); ++i) {
+    int32_t index = std::max(other.offset + static_cast<int32_t>(i), offset);
+    bins[index - offset] += other.bins[i];
+  }
+  total += other.total;
+}
+
+void DDSketch::Store::Resize(int32_t lo, int32_t hi) {
+  std::vector<uint64_t> new_bins(hi - lo + 1, 0);
+  for (size_t i = 0; i < bins.size(); ++i) {
+    // Bins below the new range are collapsed into its lowest bin.
+    int32_t index = std::max(offset + static_cast<int32_t>(i), lo);
+    new_bins[index - lo] += bins[i];
+  }
+  bins = std::move(new_bins);
+  offset = lo;
+}
+
+int32_t DDSketch::Store::IndexAtRank(double rank) const {
+  uint64_t seen = 0;
+  for (size_t i = 0; i < bins.size(); ++i) {
+    seen += bins[i];
+    if (seen > rank) {
+      return offset + static_cast<int32_t>(i);
+    }
+  }
+  return offset + static_cast<int32_t>(bins.size()) - 1;
+}
+
+DDSketch::DDSketch(double relative_accuracy, int max_bins)
+    : relative_accuracy_(relative_accuracy),
+      gamma_((1 + relative_accuracy) / (1 - relative_accuracy)),
+      log_gamma_(std::log(gamma_)),
+      max_bins_(max_bins),
+      min_(std::numeric_limits<double>::infinity()),
+      max_(-std::numeric_limits<double>::infinity()) {}
+
+int32_t DDSketch::Index(double val) const {
+  return static_cast<int32_t>(std::ceil(std::log(val) / log_gamma_));
+}
+
+double DDSketch::Value(int32_t index) const {
+  // The value in the bin with the lowest relative error to both of its bounds.
+  return 2 * std::pow(gamma_, index) / (gamma_ + 1);
+}
+
+void DDSketch::Add(double val) {
+  if (std::isnan(val)) {
+    return;
+  }
+  min_ = std::min(min_, val);
+  max_ = std::max(max_, val);
+  // Values this close to zero would need indexes beyond what the bins can cover.
+  constexpr double kMinIndexable = 1e-300;
+  if (val > kMinIndexable) {
+    positive_.Add(Index(val), 1, max_bins_);
+  } else if (val < -kMinIndexable) {
+    negative_.Add(Index(-val), 1, max_bins_);
+  } else {
+    ++zero_count_;
+  }
+}
+
+void DDSketch::Merge(const DDSketch& other) {
+  DCHECK_EQ(gamma_, other.gamma_);
+  negative_.Merge(other.negative_, max_bins_);
+  positive_.Merge(other.positive_, max_bins_);
+  zero_count_ += other.zero_count_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+double DDSketch::Quantile(double q) const {
+  uint64_t n = count();
+  if (n == 0 || q < 0 || q > 1) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  double rank = q * (n - 1);
+  double val;
+  if (rank < negative_.total) {
+    // The most negative values are in the highest bins of the negative store.
+    val = -Value(negative_.IndexAtRank(negative_.total - 1 - rank));
+  } else if (rank < negative_.total + zero_count_) {
+    val = 0;
+  } else {
+    val = Value(positive_.IndexAtRank(rank - negative_.total - zero_count_));
+  }
+  return std::clamp(val, min_, max_);
+}
+
+void DDSketch::Serialize(udf::UDAStateWriter* writer) const {
+  writer->Write(relative_accuracy_);
+  writer->Write(zero_count_);
+  writer->Write(min_);
+  writer->Write(max_);
+  for (const Store* store : {&negative_, &positive_}) {
+    writer->Write(store->offset);
+    writer->WriteArray(store->bins.data(), store->bins.size());
+  }
+}
+
+Status DDSketch::Deserialize(udf::UDAStateReader* reader) {
+  double relative_accuracy;
+  PL_RETURN_IF_ERROR(reader->Read(&relative_accuracy));
+  if (relative_accuracy != relative_accuracy_) {
+    return error::InvalidArgument("DDSketch relative accuracy $0 doesn't match $1",
+                                  relative_accuracy, relative_accuracy_);
+  }
+  PL_RETURN_IF_ERROR(reader->Read(&zero_count_));
+  PL_RETURN_IF_ERROR(reader->Read(&min_));
+  PL_RETURN_IF_ERROR(reader->Read(&max_));
+  for (Store* store : {&negative_, &positive_}) {
+    PL_RETURN_IF_ERROR(reader->Read(&store->offset));
+    PL_RETURN_IF_ERROR(reader->ReadArray(&store->bins));
+    store->total = 0;
+    for (uint64_t count : store->bins) {
+      store->total += count;
+    }
+  }
+  return Status::OK();
+}
+
+/*************************************************
+ * CountMinTopK
+ *************************************************/
+
+void CountMinTopK::Add(std::string_view val, uint64_t count) {
+  if (counts_.empty()) {
+    counts_.assign(depth_ * width_, 0);
+  }
+  // Derive the row hashes from two hashes, like the bloom filter does.
+  uint64_t a = Hash(val.data(), val.size());
+  uint64_t b = Hash(val.data(), val.size(), a);
+  uint64_t estimate = std::numeric_limits<uint64_t>::max();
+  for (int row = 0; row < depth_; ++row) {
+    uint32_t& counter = counts_[row * width_ + (a + row * b) % width_];
+    counter = std::min<uint64_t>(uint64_t{counter} + count, std::numeric_limits<uint32_t>::max());
+    estimate = std::min<uint64_t>(estimate, counter);
+  }
+  UpdateCandidate(val, estimate);
+}
+
+uint64_t CountMinTopK::EstimateCount(std::string_view val) const {
+  if (counts_.empty()) {
+    return 0;
+  }
+  uint64_t a = Hash(val.data(), val.size());
+  uint64_t b = Hash(val.data(), val.size(), a);
+  uint64_t estimate = std::numeric_limits<uint64_t>::max();
+  for (int row = 0; row < depth_; ++row) {
+    estimate = std::min<uint64_t>(estimate, counts_[row * width_ + (a + row * b) % width_]);
+  }
+  return estimate;
+}
+
+void CountMinTopK::UpdateCandidate(std::string_view val, uint64_t estimate) {
+  auto it = candidates_.find(val);
+  if (it != candidates_.end()) {
+    it->second = estimate;
+    return;
+  }
+  if (candidates_.size() < static_cast<size_t>(k_)) {
+    candidates_.emplace(val, estimate);
+    return;
+  }
+  auto min_it = std::min_element(candidates_.begin(), candidates_.end(),
+                                 [](const auto& a, const auto& b) { return a.second < b.second; });
+  if (estimate > min_it->second) {
+    candidates_.erase(min_it);
+    candidates_.emplace(val, estimate);
+  }
+}
+
+void CountMinTopK::Merge(const CountMinTopK& other) {
+  DCHECK_EQ(depth_, other.depth_);
+  DCHECK_EQ(width_, other.width_);
+  if (other.counts_.empty()) {
+    return;
+  }
+  if (counts_.empty()) {
+    counts_.assign(depth_ * width_, 0);
+  }
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    counts_[i] = std::min<uint64_t>(uint64_t{counts_[i]} + other.counts_[i],
+                                    std::numeric_limits<uint32_t>::max());
+  }
+  // The estimates of the existing candidates went up with the merged counts, so recompute them
+  // before letting the other sketch's candidates compete for a spot.
+  for (auto& [val, estimate] : candidates_) {
+    estimate = EstimateCount(val);
+  }
+  for (const auto& [val, estimate] : other.candidates_) {
+    UpdateCandidate(val, EstimateCount(val));
+  }
+}
+
+std::vector<std::pair<std::string, uint64_t>> CountMinTopK::TopK() const {
+  std::vector<std::pair<std::string, uint64_t>> top_k(candidates_.begin(), candidates_.end());
+  std::sort(top_k.begin(), top_k.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  return top_k;
+}
+
+void CountMinTopK::Serialize(udf::UDAStateWriter* writer) const {
+  writer->Write(static_cast<uint32_t>(depth_));
+  writer->Write(static_cast<uint32_t>(width_));
+  // Groups with few distinct values only touch a few counters, so unless most counters are set,
+  // write just the set ones as (index, count) pairs.
+  std::vector<uint32_t> set_indexes;
+  std::vector<uint32_t> set_counts;
+  for (size_t i = 0; i < counts_.size() && set_indexes.size() < counts_.size() / 2; ++i) {
+    if (counts_[i] != 0) {
+      set_indexes.push_back(i);
+      set_counts.push_back(counts_[i]);
+    }
+  }
+  if (set_indexes.size() < counts_.size() / 2) {
+    writer->Write(kSparse);
+    writer->WriteArray(set_indexes.data(), set_indexes.size());
+    writer->WriteArray(set_counts.data(), set_counts.size());
+  } else {
+    writer->Write(kDense);
+    writer->WriteArray(counts_.data(), counts_.size());
+  }
+  writer->Write(static_cast<uint32_t>(candidates_.size()));
+  for (const auto& [val, estimate] : candidates_) {
+    writer->WriteString(val);
+    writer->Write(estimate);
+  }
+}
+
+Status CountMinTopK::Deserialize(udf::UDAStateReader* reader) {
+  uint32_t depth;
+  uint32_t width;
+  PL_RETURN_IF_ERROR(reader->Read(&depth));
+  PL_RETURN_IF_ERROR(reader->Read(&width));
+  if (depth != static_cast<uint32_t>(depth_) || width != static_cast<uint32_t>(width_)) {
+    return error::InvalidArgument("Count-min sketch of $0x$1 doesn't match $2x$3", depth, width,
+                                  depth_, width_);
+  }
+  Encoding encoding;
+  PL_RETURN_IF_ERROR(reader->Read(&encoding));
+  std::vector<uint32_t> counts;
+  switch (encoding) {
+    case kSparse: {
+      std::vector<uint32_t> set_indexes;
+      std::vector<uint32_t> set_counts;
+      PL_RETURN_IF_ERROR(reader->ReadArray(&set_indexes));
+      PL_RETURN_IF_ERROR(reader->ReadArray(&set_counts));
+      if (set_indexes.size() != set_counts.size()) {
+        return error::InvalidArgument("Count-min sketch has $0 indexes but $1 counts",
+                                      set_indexes.size(), set_counts.size());
+      }
+      if (set_indexes.empty()) {
+        break;
+      }
+      counts.assign(depth_ * width_, 0);
+      for (size_t i = 0; i < set_indexes.size(); ++i) {
+        if (set_indexes[i] >= counts.size()) {
+          return error::InvalidArgument("Count-min sketch counter $0 out of range",
+                                        set_indexes[i]);
+        }
+        counts[set_indexes[i]] = set_counts[i];
+      }
+      break;
+    }
+    case kDense:
+      PL_RETURN_IF_ERROR(reader->ReadArray(&counts));
+      if (!counts.empty() && counts.size() != static_cast<size_t>(depth_ * width_)) {
+        return error::InvalidArgument("Count-min sketch has $0 counters, expected $1",
+                                      counts.size(), depth_ * width_);
+      }
+      break;
+    default:
+      return error::InvalidArgument("Unknown count-min sketch encoding $0",
+                                    static_cast<int>(encoding));
+  }
+  uint32_t num_candidates;
+  PL_RETURN_IF_ERROR(reader->Read(&num_candidates));
+  candidates_.clear();
+  for (uint32_t i = 0; i < num_candidates; ++i) {
+    std::string val;
+    uint64_t estimate;
+    PL_RETURN_IF_ERROR(reader->ReadString(&val));
+    PL_RETURN_IF_ERROR(reader->Read(&estimate));
+    UpdateCandidate(val, estimate);
+  }
+  counts_ = std::move(counts);
+  return Status::OK();
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
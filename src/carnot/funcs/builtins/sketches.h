@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/udf/uda_state.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * HyperLogLog estimates the number of distinct values added to it, using 64-bit hashes and linear
+ * counting for small cardinalities. The standard error of the estimate is 1.04 / sqrt(2^precision),
+ * so 1.6% for the default precision.
+ *
+ * Until a quarter of the registers are set, the sketch keeps the set registers in a sorted list
+ * instead of allocating all of them, which keeps groups with few distinct values small both in
+ * memory and once serialized.
+ */
+class HyperLogLog {
+ public:
+  static constexpr int kDefaultPrecision = 12;
+  static constexpr int kMinPrecision = 4;
+  static constexpr int kMaxPrecision = 18;
+
+  explicit HyperLogLog(int precision = kDefaultPrecision);
+
+  void Add(int64_t val);
+  void Add(double val);
+  void Add(std::string_view val);
+  void AddHash(uint64_t hash);
+
+  /**
+   * Merges in another sketch of the same precision.
+   */
+  void Merge(const HyperLogLog& other);
+
+  int64_t Estimate() const;
+
+  void Serialize(udf::UDAStateWriter* writer) const;
+  Status Deserialize(udf::UDAStateReader* reader);
+
+  int precision() const { return precision_; }
+  bool is_sparse() const { return registers_.empty(); }
+
+ private:
+  enum Encoding : uint8_t { kSparse = 0, kDense = 1 };
+
+  size_t num_registers() const { return size_t{1} << precision_; }
+  uint8_t max_rank() const { return 64 - precision_ + 1; }
+  void Update(uint32_t index, uint8_t rank);
+  void ToDense();
+
+  int precision_;
+  // Sparse entries are the register index shifted left by 8, or'ed with the rank.
+  std::vector<uint32_t> sparse_;
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * DDSketch is a quantile sketch with relative error guarantees: every quantile it returns is within
+ * relative_accuracy of the true value, regardless of the distribution of the data. Values are
+ * counted in logarithmically sized bins. When more than max_bins bins are needed, the bins of the
+ * values closest to zero are collapsed, which only affects the accuracy of the lowest quantiles.
+ */
+class DDSketch {
+ public:
+  static constexpr double kDefaultRelativeAccuracy = 0.01;
+  static constexpr int kDefaultMaxBins = 2048;
+
+  explicit DDSketch(double relative_accuracy = kDefaultRelativeAccuracy,
+                    int max_bins = kDefaultMaxBins);
+
+  void Add(double val);
+
+  /**
+   * Merges in another sketch with the same relative accuracy.
+   */
+  void Merge(const DDSketch& other);
+
+  /**
+   * Returns the value at quantile q, which is between 0 and 1. Returns NaN if the sketch is empty.
+   */
+  double Quantile(double q) const;
+
+  uint64_t count() const { return negative_.total + zero_count_ + positive_.total; }
+
+  void Serialize(udf::UDAStateWriter* writer) const;
+  Status Deserialize(udf::UDAStateReader* reader);
+
+ private:
+  // A contiguous range of bins, starting at the bin for index offset.
+  struct Store {
+    int32_t offset = 0;
+    uint64_t total = 0;
+    std::vector<uint64_t> bins;
+
+    void Add(int32_t index, uint64_t count, int max_bins);
+    void Merge(const Store& other, int max_bins);
+    // Returns the index of the bin holding the value of the given rank.
+    int32_t IndexAtRank(double rank) const;
+    void Resize(int32_t lo, int32_t hi);
+  };
+
+  int32_t Index(double val) const;
+  double Value(int32_t index) const;
+
+  double relative_accuracy_;
+  double gamma_;
+  double log_gamma_;
+  int max_bins_;
+  Store negative_;
+  Store positive_;
+  uint64_t zero_count_ = 0;
+  double min_;
+  double max_;
+};
+
+/**
+ * CountMinTopK tracks the approximately most frequent values, using a count-min sketch to estimate
+ * the frequency of each value and keeping the k values with the highest estimates. Estimates
+ * never undercount, and overcount by at most e / width of the total count with probability
+ * 1 - e^-depth.
+ */
+class CountMinTopK {
+ public:
+  static constexpr int kDefaultK = 10;
+  static constexpr int kDefaultDepth = 4;
+  static constexpr int kDefaultWidth = 1024;
+
+  explicit CountMinTopK(int k = kDefaultK, int depth = kDefaultDepth, int width = kDefaultWidth)
+      : k_(k), depth_(depth), width_(width) {}
+
+  void Add(std::string_view val, uint64_t count = 1);
+
+  /**
+   * Merges in another sketch with the same dimensions.
+   */
+  void Merge(const CountMinTopK& other);
+
+  uint64_t EstimateCount(std::string_view val) const;
+
+  /**
+   * Returns the top values with their estimated counts, most frequent first.
+   */
+  std::vector<std::pair<std::string, uint64_t>> TopK() const;
+
+  void Serialize(udf::UDAStateWriter* writer) const;
+  Status Deserialize(udf::UDAStateReader* reader);
+
+ private:
+  enum Encoding : uint8_t { kSparse = 0, kDense = 1 };
+
+  void UpdateCandidate(std::string_view val, uint64_t estimate);
+
+  int k_;
+  int depth_;
+  int width_;
+  // The depth_ x width_ counters, row by row. Only allocated once a value is added.
+  std::vector<uint32_t> counts_;
+  absl::flat_hash_map<std::string, uint64_t> candidates_;
+};
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
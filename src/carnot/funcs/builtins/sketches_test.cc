@@ -0,0 +1,232 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/carnot/funcs/builtins/sketches.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+template <typename TSketch>
+StatusOr<TSketch> RoundTrip(const TSketch& sketch, TSketch empty) {
+  udf::UDAStateWriter writer(/*version*/ 1);
+  sketch.Serialize(&writer);
+  std::string state = writer.Finish();
+  PL_ASSIGN_OR_RETURN(auto reader, udf::UDAStateReader::Create(state, 1));
+  PL_RETURN_IF_ERROR(empty.Deserialize(&reader));
+  if (!reader.done()) {
+    return error::Internal("Sketch state has trailing bytes");
+  }
+  return empty;
+}
+
+TEST(HyperLogLog, small_cardinalities_are_exact_enough) {
+  HyperLogLog hll;
+  EXPECT_EQ(0, hll.Estimate());
+  for (int i = 0; i < 100; ++i) {
+    // Duplicates shouldn't be counted.
+    hll.Add(absl::StrCat("10.0.0.", i % 50));
+  }
+  EXPECT_TRUE(hll.is_sparse());
+  EXPECT_NEAR(50, hll.Estimate(), 1);
+}
+
+TEST(HyperLogLog, large_cardinalities) {
+  HyperLogLog hll;
+  constexpr int64_t kNumValues = 1000000;
+  for (int64_t i = 0; i < kNumValues; ++i) {
+    hll.Add(i);
+  }
+  EXPECT_FALSE(hll.is_sparse());
+  // Well within 3 standard errors of 1.6%.
+  EXPECT_NEAR(kNumValues, hll.Estimate(), kNumValues * 0.05);
+}
+
+// Around the switch from linear counting to the raw estimate, where the raw estimate is biased.
+TEST(HyperLogLog, mid_cardinalities) {
+  for (int64_t num_values : {3000, 3200, 4096, 6000, 8000, 10000}) {
+    HyperLogLog hll;
+    for (int64_t i = 0; i < num_values; ++i) {
+      hll.Add(i);
+    }
+    EXPECT_NEAR(num_values, hll.Estimate(), num_values * 0.05) << num_values;
+  }
+}
+
+TEST(HyperLogLog, merge_and_serialize) {
+  HyperLogLog sparse;
+  HyperLogLog dense;
+  for (int64_t i = 0; i < 100; ++i) {
+    sparse.Add(i);
+  }
+  for (int64_t i = 50; i < 50000; ++i) {
+    dense.Add(i);
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto sparse_copy, RoundTrip(sparse, HyperLogLog()));
+  ASSERT_OK_AND_ASSIGN(auto dense_copy, RoundTrip(dense, HyperLogLog()));
+  EXPECT_TRUE(sparse_copy.is_sparse());
+  EXPECT_EQ(sparse.Estimate(), sparse_copy.Estimate());
+  EXPECT_EQ(dense.Estimate(), dense_copy.Estimate());
+
+  sparse_copy.Merge(dense_copy);
+  dense.Merge(sparse);
+  EXPECT_EQ(dense.Estimate(), sparse_copy.Estimate());
+  EXPECT_NEAR(50000, dense.Estimate(), 50000 * 0.05);
+
+  EXPECT_NOT_OK(RoundTrip(sparse, HyperLogLog(HyperLogLog::kDefaultPrecision + 1)));
+}
+
+TEST(DDSketch, relative_accuracy) {
+  DDSketch sketch;
+  std::vector<double> values;
+  std::mt19937 rng(0);
+  std::lognormal_distribution<double> dist(0, 2);
+  for (int i = 0; i < 100000; ++i) {
+    values.push_back(dist(rng));
+    sketch.Add(values.back());
+  }
+  std::sort(values.begin(), values.end());
+  for (double q : {0.0, 0.01, 0.25, 0.5, 0.9, 0.99, 1.0}) {
+    double expected = values[static_cast<size_t>(q * (values.size() - 1))];
+    EXPECT_NEAR(expected, sketch.Quantile(q), expected * DDSketch::kDefaultRelativeAccuracy)
+        << "q=" << q;
+  }
+}
+
+TEST(DDSketch, negative_and_zero_values) {
+  DDSketch sketch;
+  for (double val : {-100.0, -10.0, 0.0, 0.0, 10.0, 100.0, 1000.0}) {
+    sketch.Add(val);
+  }
+  EXPECT_EQ(7, sketch.count());
+  EXPECT_DOUBLE_EQ(-100, sketch.Quantile(0));
+  EXPECT_NEAR(-10, sketch.Quantile(1.0 / 6), 0.1);
+  EXPECT_EQ(0, sketch.Quantile(0.5));
+  EXPECT_NEAR(100, sketch.Quantile(5.0 / 6), 1);
+  EXPECT_DOUBLE_EQ(1000, sketch.Quantile(1));
+  EXPECT_TRUE(std::isnan(DDSketch().Quantile(0.5)));
+}
+
+TEST(DDSketch, collapses_lowest_bins) {
+  DDSketch sketch(DDSketch::kDefaultRelativeAccuracy, /*max_bins*/ 64);
+  for (int i = -200; i < 200; ++i) {
+    sketch.Add(std::pow(10, i / 10.0));
+  }
+  // 64 bins only cover about half a decade, so only the highest quantiles keep their accuracy and
+  // everything below is collapsed into the lowest bin.
+  EXPECT_NEAR(std::pow(10, 19.9), sketch.Quantile(1), std::pow(10, 19.9) * 0.01);
+  EXPECT_NEAR(std::pow(10, 19.7), sketch.Quantile(0.995), std::pow(10, 19.7) * 0.01);
+  EXPECT_GT(sketch.Quantile(0.5), std::pow(10, 19));
+}
+
+TEST(DDSketch, merge_and_serialize) {
+  DDSketch sketch1;
+  DDSketch sketch2;
+  DDSketch all;
+  for (int i = -500; i < 1000; ++i) {
+    (i % 2 == 0 ? sketch1 : sketch2).Add(i);
+    all.Add(i);
+  }
+  ASSERT_OK_AND_ASSIGN(auto copy1, RoundTrip(sketch1, DDSketch()));
+  ASSERT_OK_AND_ASSIGN(auto copy2, RoundTrip(sketch2, DDSketch()));
+  copy1.Merge(copy2);
+  EXPECT_EQ(all.count(), copy1.count());
+  for (double q : {0.0, 0.1, 0.5, 0.9, 1.0}) {
+    EXPECT_DOUBLE_EQ(all.Quantile(q), copy1.Quantile(q));
+  }
+
+  EXPECT_NOT_OK(RoundTrip(sketch1, DDSketch(0.05)));
+}
+
+TEST(CountMinTopK, heavy_hitters) {
+  CountMinTopK top_k(/*k*/ 3);
+  for (int i = 0; i < 10000; ++i) {
+    top_k.Add(absl::StrCat("rare", i));
+    if (i % 10 == 0) {
+      top_k.Add("a");
+    }
+    if (i % 20 == 0) {
+      top_k.Add("b");
+    }
+    if (i % 40 == 0) {
+      top_k.Add("c");
+    }
+  }
+  auto result = top_k.TopK();
+  ASSERT_EQ(3, result.size());
+  EXPECT_EQ("a", result[0].first);
+  EXPECT_EQ("b", result[1].first);
+  EXPECT_EQ("c", result[2].first);
+  // Count-min never undercounts.
+  EXPECT_GE(result[0].second, 1000);
+  EXPECT_LE(result[0].second, 1000 + 20000 * 3 / CountMinTopK::kDefaultWidth);
+}
+
+TEST(CountMinTopK, merge_and_serialize) {
+  CountMinTopK pem1(/*k*/ 2);
+  CountMinTopK pem2(/*k*/ 2);
+  // Each PEM sees a different local top 2, but "b" is the most frequent overall.
+  pem1.Add("a", 10);
+  pem1.Add("b", 8);
+  pem1.Add("c", 1);
+  pem2.Add("c", 10);
+  pem2.Add("b", 8);
+
+  ASSERT_OK_AND_ASSIGN(auto copy1, RoundTrip(pem1, CountMinTopK(2)));
+  ASSERT_OK_AND_ASSIGN(auto copy2, RoundTrip(pem2, CountMinTopK(2)));
+  copy1.Merge(copy2);
+  EXPECT_THAT(copy1.TopK(), ElementsAre(Pair("b", 16), Pair("c", 11)));
+
+  EXPECT_NOT_OK(RoundTrip(pem1, CountMinTopK(2, /*depth*/ 2)));
+}
+
+TEST(CountMinTopK, serialized_size_follows_distinct_values) {
+  CountMinTopK few;
+  few.Add("a", 100);
+  udf::UDAStateWriter few_writer(/*version*/ 1);
+  few.Serialize(&few_writer);
+  // Only the counters set by "a" are written, not the whole table.
+  EXPECT_LT(few_writer.Finish().size(), 128);
+
+  CountMinTopK many;
+  for (int i = 0; i < 100000; ++i) {
+    many.Add(absl::StrCat("v", i));
+  }
+  ASSERT_OK_AND_ASSIGN(auto many_copy, RoundTrip(many, CountMinTopK()));
+  EXPECT_EQ(many.TopK(), many_copy.TopK());
+  ASSERT_OK_AND_ASSIGN(auto few_copy, RoundTrip(few, CountMinTopK()));
+  EXPECT_EQ(100, few_copy.EstimateCount("a"));
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -17,12 +17,19 @@
  */
 
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
 
 #include "mysql_parser/MySQLLexer.h"
 #include "mysql_parser/MySQLParser.h"
 #include "pgsql_parser/PostgresSQLLexer.h"
 #include "pgsql_parser/PostgresSQLParser.h"
 #include "src/carnot/funcs/builtins/sql_parsing/normalization.h"
+#include "src/carnot/funcs/builtins/sql_parsing/normalization_cache.h"
 #include "src/common/base/logging.h"
 #include "src/common/base/statusor.h"
 
@@ -124,16 +131,216 @@ void SQLFragmentHandler::ReplaceFragmentWithPlaceholder(const SQLFragment& fragm
   state_->n_shift_query += fragment.text.length() - placeholder.length();
 }
 
+namespace {
+
+// The statements the fast path handles.
+constexpr std::string_view kFastPathStatements[] = {"SELECT", "INSERT", "UPDATE", "DELETE"};
+
+// Keywords after which both grammars parse a number or a string as a constant. A literal after any
+// other identifier might be part of special syntax (e.g. LIMIT 10, or a typed literal like
+// date '2021-01-01'), so the fast path gives up on it.
+constexpr std::string_view kLiteralContextKeywords[] = {
+    "SELECT", "WHERE", "AND", "OR", "LIKE", "THEN", "ELSE", "WHEN", "CASE", "HAVING", "BETWEEN",
+    "BY", "DISTINCT", "ON"};
+
+// Keywords that are constants themselves in one of the grammars, or that introduce syntax whose
+// literals aren't parsed as constants.
+constexpr std::string_view kUnsupportedKeywords[] = {
+    "NULL", "TRUE", "FALSE", "DEFAULT", "INTERVAL", "CAST", "CONVERT", "COLLATE", "CHAR", "EXTRACT",
+    "SUBSTRING", "SUBSTR", "TRIM", "POSITION", "OVERLAY", "MATCH", "AGAINST", "SEPARATOR", "DATE",
+    "TIME", "TIMESTAMP", "ARRAY", "WITH"};
+
+template <size_t N>
+bool IsOneOf(std::string_view word, const std::string_view (&keywords)[N]) {
+  for (const auto& keyword : keywords) {
+    if (absl::EqualsIgnoreCase(word, keyword)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsIdentifierChar(char c) { return absl::ascii_isalnum(c) || c == '_'; }
+
+// Finds the end of the single-quoted string starting at sql[start], or returns 0 if the string
+// isn't one the fast path handles.
+size_t ScanString(std::string_view sql, size_t start) {
+  for (size_t i = start + 1; i < sql.size(); ++i) {
+    char c = sql[i];
+    // Backslash escapes depend on the dialect and server settings. Non-ascii characters are
+    // counted differently by the ANTLR lexers than by byte offsets.
+    if (c == '\\' || !absl::ascii_isascii(c)) {
+      return 0;
+    }
+    if (c == '\'') {
+      if (i + 1 < sql.size() && sql[i + 1] == '\'') {
+        ++i;
+        continue;
+      }
+      return i + 1;
+    }
+  }
+  // Unterminated string.
+  return 0;
+}
+
+// Finds the end of the unsigned number starting at sql[start], or returns 0 if the number isn't
+// one the fast path handles (e.g. 1e10 or 0x1F).
+size_t ScanNumber(std::string_view sql, size_t start) {
+  size_t i = start;
+  while (i < sql.size() && absl::ascii_isdigit(sql[i])) {
+    ++i;
+  }
+  if (i < sql.size() && sql[i] == '.') {
+    ++i;
+    if (i == sql.size() || !absl::ascii_isdigit(sql[i])) {
+      return 0;
+    }
+    while (i < sql.size() && absl::ascii_isdigit(sql[i])) {
+      ++i;
+    }
+  }
+  if (i < sql.size() && (IsIdentifierChar(sql[i]) || sql[i] == '.')) {
+    return 0;
+  }
+  return i;
+}
+
+}  // namespace
+
+bool FindLiteralsFastPath(std::string_view sql, std::vector<std::pair<size_t, size_t>>* literals) {
+  enum class PrevToken {
+    // Nothing, a closing parenthesis, a literal, or an identifier a literal can't follow.
+    kOther,
+    // An operator, an opening parenthesis or a comma.
+    kOperator,
+    // One of kLiteralContextKeywords.
+    kLiteralContext,
+  };
+
+  literals->clear();
+  PrevToken prev = PrevToken::kOther;
+  bool seen_statement = false;
+  bool seen_semicolon = false;
+  size_t i = 0;
+  while (i < sql.size()) {
+    char c = sql[i];
+    if (absl::ascii_isspace(c)) {
+      ++i;
+      continue;
+    }
+    // Only a single statement is handled.
+    if (seen_semicolon) {
+      return false;
+    }
+    if (absl::ascii_isalpha(c) || c == '_') {
+      size_t start = i;
+      while (i < sql.size() && IsIdentifierChar(sql[i])) {
+        ++i;
+      }
+      // Prefixed strings, e.g. E'...', X'...' or _utf8'...', and quoted identifiers.
+      if (i < sql.size() && (sql[i] == '\'' || sql[i] == '"')) {
+        return false;
+      }
+      std::string_view word = sql.substr(start, i - start);
+      if (!seen_statement) {
+        if (!IsOneOf(word, kFastPathStatements)) {
+          return false;
+        }
+        seen_statement = true;
+      } else if (IsOneOf(word, kUnsupportedKeywords)) {
+        return false;
+      }
+      prev =
+          IsOneOf(word, kLiteralContextKeywords) ? PrevToken::kLiteralContext : PrevToken::kOther;
+      continue;
+    }
+    if (!seen_statement) {
+      return false;
+    }
+    if (c == '\'' || absl::ascii_isdigit(c)) {
+      if (prev == PrevToken::kOther) {
+        return false;
+      }
+      size_t end = c == '\'' ? ScanString(sql, i) : ScanNumber(sql, i);
+      if (end == 0) {
+        return false;
+      }
+      literals->emplace_back(i, end - i);
+      prev = PrevToken::kOther;
+      i = end;
+      continue;
+    }
+    switch (c) {
+      case '(':
+      case ',':
+      case '=':
+      case '<':
+      case '>':
+      case '+':
+      case '*':
+      case '%':
+        prev = PrevToken::kOperator;
+        break;
+      case '!':
+        if (i + 1 == sql.size() || sql[i + 1] != '=') {
+          return false;
+        }
+        prev = PrevToken::kOperator;
+        break;
+      case ')':
+      case '.':
+        prev = PrevToken::kOther;
+        break;
+      case ';':
+        seen_semicolon = true;
+        break;
+      default:
+        // Everything else, e.g. comments, placeholders, casts, negative numbers, quoted
+        // identifiers or non-ascii characters, goes through the parser.
+        return false;
+    }
+    ++i;
+  }
+  return seen_statement;
+}
+
 StatusOr<NormalizeResult> normalize_pgsql(std::string sql,
                                           const std::vector<std::string>& param_values) {
-  return normalize_sql<pgsql_parser::PostgresSQLParser, pgsql_parser::PostgresSQLLexer>(
-      sql, param_values);
+  auto* cache = NormalizationCache::Global();
+  std::string key = NormalizationCache::Key(NormalizationCache::kPgSQL, sql, param_values);
+  StatusOr<NormalizeResult> result;
+  if (cache->Lookup(key, &result)) {
+    return result;
+  }
+  NormalizeResult fast_result;
+  if (fast_normalize_sql<pgsql_parser::PostgresSQLParser>(sql, param_values, &fast_result)) {
+    result = std::move(fast_result);
+  } else {
+    result = normalize_sql<pgsql_parser::PostgresSQLParser, pgsql_parser::PostgresSQLLexer>(
+        sql, param_values);
+  }
+  cache->Insert(std::move(key), result);
+  return result;
 }
 
 StatusOr<NormalizeResult> normalize_mysql(std::string sql,
                                           const std::vector<std::string>& param_values) {
-  return normalize_sql<mysql_parser::MySQLParser, mysql_parser::MySQLLexer, UpperCaseCharStream>(
-      sql, param_values);
+  auto* cache = NormalizationCache::Global();
+  std::string key = NormalizationCache::Key(NormalizationCache::kMySQL, sql, param_values);
+  StatusOr<NormalizeResult> result;
+  if (cache->Lookup(key, &result)) {
+    return result;
+  }
+  NormalizeResult fast_result;
+  if (fast_normalize_sql<mysql_parser::MySQLParser>(sql, param_values, &fast_result)) {
+    result = std::move(fast_result);
+  } else {
+    result = normalize_sql<mysql_parser::MySQLParser, mysql_parser::MySQLLexer,
+                           UpperCaseCharStream>(sql, param_values);
+  }
+  cache->Insert(std::move(key), result);
+  return result;
 }
 
 std::ostream& operator<<(std::ostream& os, const NormalizeResult& result) {
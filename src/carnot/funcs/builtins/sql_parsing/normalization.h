@@ -33,6 +33,7 @@
 #include <numeric>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -266,6 +267,54 @@ StatusOr<NormalizeResult> normalize_sql(std::string sql,
   return result;
 }
 
+/**
+ * FindLiteralsFastPath finds the constants in a sql query with a hand-written tokenizer instead of
+ * the ANTLR parser. It only accepts plain SELECT/INSERT/UPDATE/DELETE statements whose constants
+ * are unsigned numbers or single-quoted strings in positions where both grammars parse them as
+ * constants. For anything else it returns false, and the query has to go through normalize_sql.
+ * @param sql: Unnormalized SQL query.
+ * @param literals: The (offset, length) of each constant, in the order they appear in the query.
+ * @return whether the query could be handled by the fast path.
+ */
+bool FindLiteralsFastPath(std::string_view sql, std::vector<std::pair<size_t, size_t>>* literals);
+
+/**
+ * fast_normalize_sql normalizes the queries accepted by FindLiteralsFastPath, producing the same
+ * result as normalize_sql would.
+ * @return whether the query could be handled by the fast path, result is only set if it could.
+ */
+template <typename TParser>
+bool fast_normalize_sql(std::string_view sql, const std::vector<std::string>& param_values,
+                        NormalizeResult* result) {
+  // Queries with parameters have placeholders in them, which the fast path doesn't handle.
+  if (!param_values.empty()) {
+    return false;
+  }
+  std::vector<std::pair<size_t, size_t>> literals;
+  if (!FindLiteralsFastPath(sql, &literals)) {
+    return false;
+  }
+  result->normalized_query.clear();
+  result->normalized_query.reserve(sql.size());
+  result->params.clear();
+  result->errmsg.clear();
+  std::string placeholder = ParserTypeTraits<TParser>::FirstPlaceholder();
+  size_t pos = 0;
+  for (const auto& [start, length] : literals) {
+    result->normalized_query.append(sql.substr(pos, start - pos));
+    result->normalized_query.append(placeholder);
+    result->params.emplace_back(sql.substr(start, length));
+    placeholder = ParserTypeTraits<TParser>::NextPlaceholder(placeholder);
+    pos = start + length;
+  }
+  result->normalized_query.append(sql.substr(pos));
+  return true;
+}
+
+/**
+ * normalize_pgsql and normalize_mysql normalize a query of the respective dialect. Results are
+ * memoized in the process-wide NormalizationCache, and common query shapes skip the ANTLR parser.
+ */
 StatusOr<NormalizeResult> normalize_pgsql(std::string sql,
                                           const std::vector<std::string>& param_values);
 
@@ -18,24 +18,103 @@
 
 #include <gflags/gflags.h>
 
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
 #include <benchmark/benchmark.h>
 #include "src/carnot/funcs/builtins/sql_parsing/normalization.h"
 #include "src/common/perf/perf.h"
 
+using px::carnot::builtins::sql_parsing::normalize_mysql;
+using px::carnot::builtins::sql_parsing::normalize_pgsql;
+using px::carnot::builtins::sql_parsing::normalize_sql;
+
+// These benchmarks measure the ANTLR parser alone, without the cache or the fast path.
 // NOLINTNEXTLINE : runtime/references.
 static void BM_NormalizePgSQL(benchmark::State& state, std::string query) {
   for (auto _ : state) {
-    benchmark::DoNotOptimize(px::carnot::builtins::sql_parsing::normalize_pgsql(query, {}));
+    benchmark::DoNotOptimize(
+        normalize_sql<pgsql_parser::PostgresSQLParser, pgsql_parser::PostgresSQLLexer>(query, {}));
   }
 }
 
 // NOLINTNEXTLINE : runtime/references.
 static void BM_NormalizeMySQL(benchmark::State& state, std::string query) {
   for (auto _ : state) {
-    benchmark::DoNotOptimize(px::carnot::builtins::sql_parsing::normalize_mysql(query, {}));
+    benchmark::DoNotOptimize(
+        normalize_sql<mysql_parser::MySQLParser, mysql_parser::MySQLLexer,
+                      px::carnot::builtins::sql_parsing::UpperCaseCharStream>(query, {}));
+  }
+}
+
+// A stream of queries like the one an application sends: a few statement shapes, with literals
+// drawn from a small set of values, so most query strings repeat many times.
+static std::vector<std::string> RepeatedQueryWorkload() {
+  const std::vector<std::string> templates = {
+      "SELECT * FROM users WHERE id=$0",
+      "SELECT name, email FROM users WHERE org_id=$0 AND status='active'",
+      "UPDATE sessions SET last_seen=$0 WHERE session_id='s$0'",
+      "INSERT INTO events (user_id, kind, value) VALUES ($0, 'click', 1.5)",
+      "DELETE FROM carts WHERE user_id=$0",
+      "SELECT count(*) FROM orders WHERE user_id=$0 GROUP BY status",
+      // Shapes the fast path doesn't handle.
+      "SELECT * FROM orders WHERE user_id=$0 LIMIT 10",
+      "BEGIN;",
+  };
+  constexpr int kNumQueries = 4096;
+  constexpr int kNumValues = 64;
+  std::mt19937 gen(37);
+  std::uniform_int_distribution<size_t> template_dist(0, templates.size() - 1);
+  std::uniform_int_distribution<int> value_dist(0, kNumValues - 1);
+  std::vector<std::string> queries;
+  queries.reserve(kNumQueries);
+  for (int i = 0; i < kNumQueries; ++i) {
+    queries.push_back(absl::Substitute(templates[template_dist(gen)], value_dist(gen)));
   }
+  return queries;
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_NormalizeRepeatedPgSQL(benchmark::State& state) {
+  auto queries = RepeatedQueryWorkload();
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(normalize_pgsql(query, {}));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_NormalizeRepeatedPgSQL_parser(benchmark::State& state) {
+  auto queries = RepeatedQueryWorkload();
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(
+          normalize_sql<pgsql_parser::PostgresSQLParser, pgsql_parser::PostgresSQLLexer>(query,
+                                                                                         {}));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_NormalizeRepeatedMySQL(benchmark::State& state) {
+  auto queries = RepeatedQueryWorkload();
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(normalize_mysql(query, {}));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+BENCHMARK(BM_NormalizeRepeatedPgSQL);
+BENCHMARK(BM_NormalizeRepeatedPgSQL_parser);
+BENCHMARK(BM_NormalizeRepeatedMySQL);
+
 BENCHMARK_CAPTURE(BM_NormalizePgSQL, select,
                   "SELECT * FROM test WHERE property=1234 AND property2='abcd'");
 BENCHMARK_CAPTURE(BM_NormalizePgSQL, select_1, "SELECT 1");
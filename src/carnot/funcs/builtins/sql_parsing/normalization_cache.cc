@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/sql_parsing/normalization_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace px {
+namespace carnot {
+namespace builtins {
+namespace sql_parsing {
+
+NormalizationCache* NormalizationCache::Global() {
+  static auto* cache = new NormalizationCache();
+  return cache;
+}
+
+std::string NormalizationCache::Key(Dialect dialect, std::string_view sql,
+                                    const std::vector<std::string>& param_values) {
+  size_t length = sql.size() + 1;
+  for (const auto& param : param_values) {
+    length += param.size() + 1;
+  }
+  if (length > kMaxQueryLength) {
+    return "";
+  }
+  std::string key;
+  key.reserve(length);
+  key.push_back(dialect);
+  key.append(sql);
+  // Separate the params with NUL characters, which can't appear in a query.
+  for (const auto& param : param_values) {
+    key.push_back('\0');
+    key.append(param);
+  }
+  return key;
+}
+
+bool NormalizationCache::Lookup(const std::string& key, StatusOr<NormalizeResult>* result) {
+  if (key.empty()) {
+    return false;
+  }
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *result = it->second->second;
+  return true;
+}
+
+void NormalizationCache::Insert(std::string key, StatusOr<NormalizeResult> result) {
+  if (key.empty() || capacity_ == 0) {
+    return;
+  }
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  if (index_.contains(key)) {
+    // Another thread normalized the same query concurrently.
+    return;
+  }
+  if (entries_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(std::move(key), std::move(result));
+  // The index refers to the key owned by the list node, which doesn't move.
+  index_.emplace(entries_.front().first, entries_.begin());
+}
+
+size_t NormalizationCache::size() const {
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  return entries_.size();
+}
+
+}  // namespace sql_parsing
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
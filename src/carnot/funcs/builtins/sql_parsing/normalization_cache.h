@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/funcs/builtins/sql_parsing/normalization.h"
+#include "src/common/base/statusor.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+namespace sql_parsing {
+
+/**
+ * NormalizationCache is a bounded LRU cache from a raw query (and its parameters) to the result of
+ * normalizing it. Applications send the same few query strings over and over again, so the global
+ * instance is shared by all the queries running on an agent. Errors are cached too, so that a query
+ * the parser can't handle is only parsed once.
+ */
+class NormalizationCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 4096;
+  // Longer queries are not cached, to bound the memory used by the cache.
+  static constexpr size_t kMaxQueryLength = 4096;
+
+  enum Dialect : char {
+    kPgSQL = 'p',
+    kMySQL = 'm',
+  };
+
+  explicit NormalizationCache(size_t capacity = kDefaultCapacity) : capacity_(capacity) {}
+
+  static NormalizationCache* Global();
+
+  /**
+   * Returns the cache key of a query, or an empty key if the query should not be cached.
+   */
+  static std::string Key(Dialect dialect, std::string_view sql,
+                         const std::vector<std::string>& param_values);
+
+  /**
+   * Looks up the result for key, and marks it as the most recently used.
+   * @return whether the key was in the cache.
+   */
+  bool Lookup(const std::string& key, StatusOr<NormalizeResult>* result);
+
+  /**
+   * Inserts the result for key, evicting the least recently used entry if the cache is full.
+   */
+  void Insert(std::string key, StatusOr<NormalizeResult> result);
+
+  size_t size() const;
+
+ private:
+  using Entry = std::pair<std::string, StatusOr<NormalizeResult>>;
+
+  const size_t capacity_;
+  mutable absl::base_internal::SpinLock lock_;
+  // Most recently used entries first.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<std::string_view, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace sql_parsing
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
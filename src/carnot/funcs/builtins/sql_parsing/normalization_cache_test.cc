@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/sql_parsing/normalization_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+namespace sql_parsing {
+
+TEST(NormalizationCacheTest, lookup_insert) {
+  NormalizationCache cache(2);
+  auto key = NormalizationCache::Key(NormalizationCache::kPgSQL, "SELECT 1", {});
+  StatusOr<NormalizeResult> result;
+  EXPECT_FALSE(cache.Lookup(key, &result));
+
+  cache.Insert(key, NormalizeResult{"SELECT $1", {"1"}});
+  ASSERT_TRUE(cache.Lookup(key, &result));
+  ASSERT_OK(result);
+  EXPECT_EQ(result.ValueOrDie().normalized_query, "SELECT $1");
+  EXPECT_EQ(result.ValueOrDie().params, std::vector<std::string>{"1"});
+}
+
+TEST(NormalizationCacheTest, caches_errors) {
+  NormalizationCache cache(2);
+  auto key = NormalizationCache::Key(NormalizationCache::kMySQL, "SELEC 1", {});
+  cache.Insert(key, error::InvalidArgument("parse error"));
+
+  StatusOr<NormalizeResult> result;
+  ASSERT_TRUE(cache.Lookup(key, &result));
+  EXPECT_NOT_OK(result);
+}
+
+TEST(NormalizationCacheTest, keys_distinguish_dialect_and_params) {
+  std::vector<std::string> keys = {
+      NormalizationCache::Key(NormalizationCache::kPgSQL, "SELECT $1", {"1"}),
+      NormalizationCache::Key(NormalizationCache::kPgSQL, "SELECT $1", {"2"}),
+      NormalizationCache::Key(NormalizationCache::kPgSQL, "SELECT $1", {}),
+      NormalizationCache::Key(NormalizationCache::kMySQL, "SELECT $1", {"1"}),
+  };
+  for (size_t i = 0; i < keys.size(); ++i) {
+    for (size_t j = i + 1; j < keys.size(); ++j) {
+      EXPECT_NE(keys[i], keys[j]);
+    }
+  }
+}
+
+TEST(NormalizationCacheTest, evicts_least_recently_used) {
+  NormalizationCache cache(2);
+  auto key1 = NormalizationCache::Key(NormalizationCache::kPgSQL, "SELECT 1", {});
+  auto key2 = NormalizationCache::Key(NormalizationCache::kPgSQL, "SELECT 2", {});
+  auto key3 = NormalizationCache::Key(NormalizationCache::kPgSQL, "SELECT 3", {});
+  cache.Insert(key1, NormalizeResult{"SELECT $1", {"1"}});
+  cache.Insert(key2, NormalizeResult{"SELECT $1", {"2"}});
+
+  // Using key1 makes key2 the least recently used entry.
+  StatusOr<NormalizeResult> result;
+  ASSERT_TRUE(cache.Lookup(key1, &result));
+  cache.Insert(key3, NormalizeResult{"SELECT $1", {"3"}});
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup(key1, &result));
+  EXPECT_FALSE(cache.Lookup(key2, &result));
+  EXPECT_TRUE(cache.Lookup(key3, &result));
+}
+
+TEST(NormalizationCacheTest, long_queries_not_cached) {
+  NormalizationCache cache(2);
+  std::string query = "SELECT '" + std::string(NormalizationCache::kMaxQueryLength, 'a') + "'";
+  auto key = NormalizationCache::Key(NormalizationCache::kPgSQL, query, {});
+  EXPECT_TRUE(key.empty());
+
+  cache.Insert(key, NormalizeResult{"SELECT $1", {}});
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace sql_parsing
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -54,6 +54,32 @@ TEST_P(NormPGSQLTest, basic) {
   EXPECT_EQ(result.errmsg, test_case.expected_result.errmsg);
 }
 
+// The fast path must either give up on a query, or normalize it the same way the parser does.
+TEST_P(NormPGSQLTest, fast_path) {
+  auto test_case = GetParam();
+
+  NormalizeResult result;
+  if (!fast_normalize_sql<pgsql_parser::PostgresSQLParser>(test_case.input_sql_str,
+                                                           test_case.input_params, &result)) {
+    return;
+  }
+  EXPECT_EQ(result.normalized_query, test_case.expected_result.normalized_query);
+  EXPECT_EQ(result.params, test_case.expected_result.params);
+  EXPECT_EQ(result.errmsg, test_case.expected_result.errmsg);
+}
+
+TEST_P(NormPGSQLTest, cached) {
+  auto test_case = GetParam();
+
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto result, normalize_pgsql(test_case.input_sql_str,
+                                                      test_case.input_params));
+    EXPECT_EQ(result.normalized_query, test_case.expected_result.normalized_query);
+    EXPECT_EQ(result.params, test_case.expected_result.params);
+    EXPECT_EQ(result.errmsg, test_case.expected_result.errmsg);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     NormPGSQLVariants, NormPGSQLTest,
     ::testing::Values(
@@ -158,6 +184,31 @@ TEST_P(NormMySQLTest, basic) {
   EXPECT_EQ(result.errmsg, test_case.expected_result.errmsg);
 }
 
+TEST_P(NormMySQLTest, fast_path) {
+  auto test_case = GetParam();
+
+  NormalizeResult result;
+  if (!fast_normalize_sql<mysql_parser::MySQLParser>(test_case.input_sql_str,
+                                                     test_case.input_params, &result)) {
+    return;
+  }
+  EXPECT_EQ(result.normalized_query, test_case.expected_result.normalized_query);
+  EXPECT_EQ(result.params, test_case.expected_result.params);
+  EXPECT_EQ(result.errmsg, test_case.expected_result.errmsg);
+}
+
+TEST_P(NormMySQLTest, cached) {
+  auto test_case = GetParam();
+
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto result, normalize_mysql(test_case.input_sql_str,
+                                                      test_case.input_params));
+    EXPECT_EQ(result.normalized_query, test_case.expected_result.normalized_query);
+    EXPECT_EQ(result.params, test_case.expected_result.params);
+    EXPECT_EQ(result.errmsg, test_case.expected_result.errmsg);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     NormMySQLVariants, NormMySQLTest,
     ::testing::Values(
@@ -237,6 +288,43 @@ INSTANTIATE_TEST_SUITE_P(
             },
         }));
 
+class FastPathTest : public ::testing::TestWithParam<std::string> {};
+
+TEST(FastPath, handles_common_statements) {
+  std::vector<std::pair<size_t, size_t>> literals;
+  EXPECT_TRUE(FindLiteralsFastPath("SELECT 1", &literals));
+  EXPECT_THAT(literals, ::testing::ElementsAre(std::make_pair(7, 1)));
+  EXPECT_TRUE(
+      FindLiteralsFastPath("SELECT * FROM test WHERE prop=1234 AND prop2='ab''cd';", &literals));
+  EXPECT_THAT(literals, ::testing::ElementsAre(std::make_pair(30, 4), std::make_pair(45, 8)));
+  EXPECT_TRUE(FindLiteralsFastPath("UPDATE test SET age=10 where name='abcd'", &literals));
+  EXPECT_THAT(literals, ::testing::ElementsAre(std::make_pair(20, 2), std::make_pair(34, 6)));
+  EXPECT_TRUE(FindLiteralsFastPath("INSERT INTO test (a, b) VALUES (1.5, 'x')", &literals));
+  EXPECT_THAT(literals, ::testing::ElementsAre(std::make_pair(32, 3), std::make_pair(37, 3)));
+  EXPECT_TRUE(FindLiteralsFastPath("delete from test where id in (1, 2)", &literals));
+  EXPECT_THAT(literals, ::testing::ElementsAre(std::make_pair(30, 1), std::make_pair(33, 1)));
+}
+
+TEST_P(FastPathTest, falls_back_to_parser) {
+  std::vector<std::pair<size_t, size_t>> literals;
+  EXPECT_FALSE(FindLiteralsFastPath(GetParam(), &literals));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    FastPathFallbacks, FastPathTest,
+    ::testing::Values("", "BEGIN;", "CREATE TABLE test (name varchar(20))",
+                      "WITH t AS (SELECT 1) SELECT * FROM t", "SELECT * FROM test WHERE a=$1",
+                      "SELECT * FROM test WHERE a=?", "SELECT * FROM test LIMIT 10",
+                      "SELECT * FROM test WHERE a=-1", "SELECT * FROM test WHERE a=1e10",
+                      "SELECT * FROM test WHERE a=0x1F", "SELECT * FROM test WHERE a=NULL",
+                      "SELECT * FROM test WHERE a=true", "SELECT 1::text",
+                      "SELECT 1 -- comment", "SELECT 1 /* comment */",
+                      "SELECT * FROM test WHERE a=E'\\x00'", "SELECT * FROM test WHERE a='a\\'b'",
+                      "SELECT * FROM test WHERE a='unterminated", "SELECT \"a\" FROM test",
+                      "SELECT * FROM test WHERE a=date '2021-01-01'", "SELECT 1 AS 'one'",
+                      "SELECT 'a' 'b'", "SELECT 1; SELECT 2",
+                      "SELECT * FROM test WHERE a='\xc3\xa9'"));
+
 }  // namespace sql_parsing
 }  // namespace builtins
 }  // namespace carnot
@@ -76,6 +76,8 @@ class URIParseUDF : public udf::ScalarUDF {
     return sb.GetString();
   }
 
+  static constexpr bool Deterministic() { return true; }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Parses the URI into it's component parts and returns the parts "
@@ -159,6 +161,8 @@ class URIRecomposeUDF : public udf::ScalarUDF {
     return output;
   }
 
+  static constexpr bool Deterministic() { return true; }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Recomposes the URI parts int a URI.")
         .Example(R"doc(
@@ -23,7 +23,10 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+
+#include <absl/container/flat_hash_map.h>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -62,6 +65,57 @@ inline const px::md::AgentMetadataState* GetMetadataState(px::carnot::udf::Funct
   return md;
 }
 
+/**
+ * K8sNameIndex memoizes the "<namespace>/<name>" names of the pods and services looked up by the
+ * metadata funcs, so that each name is formatted once per query instead of once per row. The
+ * metadata state of a FunctionContext is a snapshot of one epoch, so the index is kept in the
+ * shared state of the context. Names are keyed by the UID of the object, which never changes name.
+ */
+class K8sNameIndex {
+ public:
+  static K8sNameIndex* Get(FunctionContext* ctx) {
+    return ctx->GetOrCreateSharedState<K8sNameIndex>();
+  }
+
+  const std::string& Name(const md::K8sMetadataObject* object) {
+    auto [it, inserted] = names_.try_emplace(object->uid());
+    if (inserted) {
+      it->second = absl::Substitute("$0/$1", object->ns(), object->name());
+    }
+    return it->second;
+  }
+
+ private:
+  absl::flat_hash_map<md::UID, std::string> names_;
+};
+
+namespace internal {
+inline absl::uint128 DistinctKey(const types::UInt128Value& value) { return value.val; }
+inline std::string_view DistinctKey(const types::StringValue& value) { return value; }
+}  // namespace internal
+
+/**
+ * ExecDistinct implements ExecBatch for the metadata funcs: it calls exec once for each distinct
+ * input of the batch, and copies the result to the other rows with the same input. A batch
+ * usually holds only a handful of distinct UPIDs or IDs, so this saves most of the metadata
+ * lookups.
+ */
+template <typename TOutput, typename TInput, typename TExecFn>
+void ExecDistinct(size_t count, TOutput* out, const TInput* in, TExecFn exec) {
+  using TKey = decltype(internal::DistinctKey(in[0]));
+  // The row index at which each distinct input first appears.
+  absl::flat_hash_map<TKey, size_t> first_rows;
+  for (size_t i = 0; i < count; ++i) {
+    // Rows from the same process are usually adjacent, so check the previous row first.
+    if (i > 0 && in[i] == in[i - 1]) {
+      out[i] = out[i - 1];
+      continue;
+    }
+    auto [it, inserted] = first_rows.try_emplace(internal::DistinctKey(in[i]), i);
+    out[i] = inserted ? exec(in[i]) : out[it->second];
+  }
+}
+
 class ASIDUDF : public ScalarUDF {
  public:
   Int64Value Exec(FunctionContext* ctx) {
@@ -104,11 +158,16 @@ class PodIDToPodNameUDF : public ScalarUDF {
 
     const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
     if (pod_info != nullptr) {
-      return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
+      return std::string(K8sNameIndex::Get(ctx)->Name(pod_info));
     }
 
     return "";
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* pod_ids) {
+    ExecDistinct(count, out, pod_ids, [&](const StringValue& pod_id) { return Exec(ctx, pod_id); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodIDToPodNameUDF>(types::ST_POD_NAME, {types::ST_NONE})};
   }
@@ -177,6 +236,11 @@ class PodIDToNamespaceUDF : public ScalarUDF {
 
     return "";
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* pod_ids) {
+    ExecDistinct(count, out, pod_ids, [&](const StringValue& pod_id) { return Exec(ctx, pod_id); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<PodIDToNamespaceUDF>(types::ST_NAMESPACE_NAME, {types::ST_NONE})};
@@ -225,6 +289,11 @@ class UPIDToContainerIDUDF : public ScalarUDF {
     return pid->cid();
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes container ID from a UPID.")
         .Details(
@@ -263,6 +332,11 @@ class UPIDToContainerNameUDF : public ScalarUDF {
     return std::string(container_info->name());
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToContainerNameUDF>(types::ST_CONTAINER_NAME,
                                                               {types::ST_NONE})};
@@ -328,6 +402,11 @@ class UPIDToNamespaceUDF : public ScalarUDF {
     return pod_info->ns();
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<UPIDToNamespaceUDF>(types::ST_NAMESPACE_NAME, {types::ST_NONE})};
@@ -360,6 +439,11 @@ class UPIDToPodIDUDF : public ScalarUDF {
     return std::string(container_info->pod_id());
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes Pod ID from a UPID.")
         .Details(
@@ -384,7 +468,12 @@ class UPIDToPodNameUDF : public ScalarUDF {
     if (pod_info == nullptr) {
       return "";
     }
-    return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
+    return std::string(K8sNameIndex::Get(ctx)->Name(pod_info));
+  }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
   }
 
   static udf::InfRuleVec SemanticInferenceRules() {
@@ -414,11 +503,18 @@ class ServiceIDToServiceNameUDF : public ScalarUDF {
 
     const auto* service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
     if (service_info != nullptr) {
-      return absl::Substitute("$0/$1", service_info->ns(), service_info->name());
+      return std::string(K8sNameIndex::Get(ctx)->Name(service_info));
     }
 
     return "";
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out,
+                 const StringValue* service_ids) {
+    ExecDistinct(count, out, service_ids,
+                 [&](const StringValue& service_id) { return Exec(ctx, service_id); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<ServiceIDToServiceNameUDF>(types::ST_SERVICE_NAME,
                                                                  {types::ST_NONE})};
@@ -557,6 +653,11 @@ class UPIDToServiceIDUDF : public ScalarUDF {
     return StringifyVector(running_service_ids);
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Service ID from a UPID.")
         .Details(
@@ -592,12 +693,17 @@ class UPIDToServiceNameUDF : public ScalarUDF {
         continue;
       }
       if (service_info->stop_time_ns() == 0) {
-        running_service_names.push_back(
-            absl::Substitute("$0/$1", service_info->ns(), service_info->name()));
+        running_service_names.push_back(K8sNameIndex::Get(ctx)->Name(service_info));
       }
     }
     return StringifyVector(running_service_names);
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<UPIDToServiceNameUDF>(types::ST_SERVICE_NAME, {types::ST_NONE})};
@@ -634,6 +740,12 @@ class UPIDToNodeNameUDF : public ScalarUDF {
     std::string foo = std::string(pod_info->node_name());
     return foo;
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToNodeNameUDF>(types::ST_NODE_NAME, {types::ST_NONE})};
   }
@@ -665,6 +777,12 @@ class UPIDToHostnameUDF : public ScalarUDF {
     }
     return pod_info->hostname();
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Hostname from a UPID.")
         .Details(
@@ -700,12 +818,16 @@ class PodIDToServiceNameUDF : public ScalarUDF {
         continue;
       }
       if (service_info->stop_time_ns() == 0) {
-        running_service_names.push_back(
-            absl::Substitute("$0/$1", service_info->ns(), service_info->name()));
+        running_service_names.push_back(K8sNameIndex::Get(ctx)->Name(service_info));
       }
     }
     return StringifyVector(running_service_names);
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* pod_ids) {
+    ExecDistinct(count, out, pod_ids, [&](const StringValue& pod_id) { return Exec(ctx, pod_id); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::ExplicitRule::Create<PodIDToServiceNameUDF>(types::ST_SERVICE_NAME, {types::ST_NONE})};
@@ -773,6 +895,11 @@ class PodIDToNodeNameUDF : public ScalarUDF {
     std::string foo = std::string(pod_info->node_name());
     return foo;
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* pod_ids) {
+    ExecDistinct(count, out, pod_ids, [&](const StringValue& pod_id) { return Exec(ctx, pod_id); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodIDToNodeNameUDF>(types::ST_NODE_NAME, {types::ST_NONE})};
   }
@@ -811,12 +938,18 @@ class PodNameToServiceNameUDF : public ScalarUDF {
         continue;
       }
       if (service_info->stop_time_ns() == 0) {
-        running_service_names.push_back(
-            absl::Substitute("$0/$1", service_info->ns(), service_info->name()));
+        running_service_names.push_back(K8sNameIndex::Get(ctx)->Name(service_info));
       }
     }
     return StringifyVector(running_service_names);
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out,
+                 const StringValue* pod_names) {
+    ExecDistinct(count, out, pod_names,
+                 [&](const StringValue& pod_name) { return Exec(ctx, pod_name); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<PodNameToServiceNameUDF>(types::ST_SERVICE_NAME,
                                                                {types::ST_POD_NAME})};
@@ -1331,6 +1464,11 @@ class UPIDToPodStatusUDF : public ScalarUDF {
     return PodInfoToPodStatus(UPIDtoPod(md, upid_value));
   }
 
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<UPIDToPodStatusUDF>(types::ST_POD_STATUS, {types::ST_NONE})};
   }
@@ -1410,6 +1548,12 @@ class UPIDToPodQoSUDF : public ScalarUDF {
     auto md = GetMetadataState(ctx);
     return PodInfoToPodQoS(UPIDtoPod(md, upid_value));
   }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const UInt128Value* upids) {
+    ExecDistinct(count, out, upids,
+                 [&](const UInt128Value& upid_value) { return Exec(ctx, upid_value); });
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Get the Kubernetes QOS class for the UPID.")
         .Details(
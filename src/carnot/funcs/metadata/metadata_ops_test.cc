@@ -134,6 +134,39 @@ TEST_F(MetadataOpsTest, upid_to_pod_name_test) {
   udf_tester.ForInput(upid3).Expect("");
 }
 
+TEST_F(MetadataOpsTest, upid_to_pod_name_batch_test) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  UPIDToPodNameUDF udf;
+  auto upid1 = types::UInt128Value(528280977975, 89101);
+  auto upid2 = types::UInt128Value(528280977975, 468);
+  auto upid3 = types::UInt128Value(528280977975, 123);
+  std::vector<types::UInt128Value> upids = {upid1, upid1, upid2, upid3, upid1, upid2};
+  std::vector<types::StringValue> out(upids.size());
+  udf.ExecBatch(function_ctx.get(), upids.size(), out.data(), upids.data());
+  EXPECT_THAT(out, ::testing::ElementsAre("pl/running_pod", "pl/running_pod", "pl/terminating_pod",
+                                          "", "pl/running_pod", "pl/terminating_pod"));
+}
+
+TEST_F(MetadataOpsTest, pod_id_to_pod_name_batch_test) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  PodIDToPodNameUDF udf;
+  std::vector<types::StringValue> pod_ids = {"1_uid", "missing", "2_uid", "1_uid", "1_uid"};
+  std::vector<types::StringValue> out(pod_ids.size());
+  udf.ExecBatch(function_ctx.get(), pod_ids.size(), out.data(), pod_ids.data());
+  EXPECT_THAT(out, ::testing::ElementsAre("pl/running_pod", "", "pl/terminating_pod",
+                                          "pl/running_pod", "pl/running_pod"));
+}
+
+TEST_F(MetadataOpsTest, service_id_to_service_name_batch_test) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  ServiceIDToServiceNameUDF udf;
+  std::vector<types::StringValue> service_ids = {"3_uid", "4_uid", "3_uid", "missing"};
+  std::vector<types::StringValue> out(service_ids.size());
+  udf.ExecBatch(function_ctx.get(), service_ids.size(), out.data(), service_ids.data());
+  EXPECT_THAT(out, ::testing::ElementsAre("pl/running_service", "pl/terminating_service",
+                                          "pl/running_service", ""));
+}
+
 TEST_F(MetadataOpsTest, upid_to_namespace_test) {
   auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
   auto udf_tester = px::carnot::udf::UDFTester<UPIDToNamespaceUDF>(std::move(function_ctx));
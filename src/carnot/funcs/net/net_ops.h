@@ -44,6 +44,8 @@ class NSLookupUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue addr) { return cache_.Lookup(addr); }
 
+  static constexpr bool Deterministic() { return true; }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Perform a DNS lookup for the value (experimental).")
         .Details("Experimental UDF to perform a DNS lookup for a given value.")
@@ -19,8 +19,11 @@
 #pragma once
 
 #include <memory>
+#include <typeindex>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/exec/ml/model_pool.h"
 #include "src/shared/metadata/metadata_state.h"
 #include "src/shared/types/types.h"
@@ -41,9 +44,31 @@ class FunctionContext {
   const px::md::AgentMetadataState* metadata_state() const { return metadata_state_.get(); }
   exec::ml::ModelPool* model_pool() { return model_pool_; }
 
+  /**
+   * Returns the state of type T shared by all the funcs that execute with this context, and
+   * creates it on first use. Funcs use it to share work, such as parsing the same input twice.
+   */
+  template <typename T>
+  T* GetOrCreateSharedState() {
+    std::shared_ptr<void>& state = shared_states_[std::type_index(typeid(T))];
+    if (state == nullptr) {
+      state = std::make_shared<T>();
+    }
+    return static_cast<T*>(state.get());
+  }
+
+  /**
+   * Identifies the row batch that the funcs execute on, so that shared state can be kept per batch.
+   * The operator calls NextBatch before evaluating its expressions over each row batch.
+   */
+  uint64_t batch_id() const { return batch_id_; }
+  void NextBatch() { ++batch_id_; }
+
  private:
   std::shared_ptr<const px::md::AgentMetadataState> metadata_state_;
   exec::ml::ModelPool* model_pool_;
+  absl::flat_hash_map<std::type_index, std::shared_ptr<void>> shared_states_;
+  uint64_t batch_id_ = 0;
 };
 
 /**
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/udf/uda_state.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+StatusOr<UDAStateReader> UDAStateReader::Create(std::string_view data, uint8_t max_version) {
+  if (!IsUDAState(data)) {
+    return error::InvalidArgument("UDA state is not in the binary format");
+  }
+  uint8_t version = static_cast<uint8_t>(data[1]);
+  if (version > max_version) {
+    return error::InvalidArgument(
+        "UDA state has version $0, but only up to version $1 is supported", version, max_version);
+  }
+  return UDAStateReader(data.substr(2), version);
+}
+
+Status UDAStateReader::ReadArrayBytes(size_t value_size, std::string_view* bytes) {
+  uint32_t count;
+  PL_RETURN_IF_ERROR(Read(&count));
+  if (data_.size() / value_size < count) {
+    return Truncated();
+  }
+  *bytes = data_.substr(0, count * value_size);
+  data_.remove_prefix(count * value_size);
+  return Status::OK();
+}
+
+Status UDAStateReader::Truncated() { return error::InvalidArgument("UDA state is truncated"); }
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+/**
+ * UDAStateWriter writes the partial state of a UDA, which is shipped from the PEMs to the Kelvins
+ * to be merged, in a compact binary form. The state starts with a header holding a tag, which tells
+ * it apart from the JSON states written by older agents, and the version of the layout of the
+ * UDA's state. The UDA then writes its fields, with arrays packed. Values are written in host byte
+ * order.
+ */
+class UDAStateWriter {
+ public:
+  static constexpr char kTag = '\xb5';
+
+  explicit UDAStateWriter(uint8_t version) {
+    state_.push_back(kTag);
+    state_.push_back(static_cast<char>(version));
+  }
+
+  template <typename T>
+  void Write(T value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be written");
+    state_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /**
+   * Writes the number of values followed by the packed values.
+   */
+  template <typename T>
+  void WriteArray(const T* values, size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be written");
+    Write(static_cast<uint32_t>(count));
+    state_.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+  }
+
+  void WriteString(std::string_view str) { WriteArray(str.data(), str.size()); }
+
+  types::StringValue Finish() { return std::move(state_); }
+
+ private:
+  std::string state_;
+};
+
+/**
+ * UDAStateReader reads a state written by UDAStateWriter, in the same order it was written.
+ */
+class UDAStateReader {
+ public:
+  UDAStateReader() = default;
+
+  /**
+   * Returns whether the data was written by UDAStateWriter.
+   */
+  static bool IsUDAState(std::string_view data) {
+    return data.size() >= 2 && data[0] == UDAStateWriter::kTag;
+  }
+
+  /**
+   * Creates a reader for the state in data. Fails if the state was written with a layout newer than
+   * max_version, which this agent doesn't know how to read.
+   */
+  static StatusOr<UDAStateReader> Create(std::string_view data, uint8_t max_version);
+
+  uint8_t version() const { return version_; }
+
+  /**
+   * Returns whether the whole state was read.
+   */
+  bool done() const { return data_.empty(); }
+
+  template <typename T>
+  Status Read(T* value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be read");
+    if (data_.size() < sizeof(T)) {
+      return Truncated();
+    }
+    std::memcpy(value, data_.data(), sizeof(T));
+    data_.remove_prefix(sizeof(T));
+    return Status::OK();
+  }
+
+  /**
+   * Reads an array written by WriteArray.
+   */
+  template <typename T>
+  Status ReadArray(std::vector<T>* values) {
+    std::string_view bytes;
+    PL_RETURN_IF_ERROR(ReadArrayBytes(sizeof(T), &bytes));
+    values->resize(bytes.size() / sizeof(T));
+    std::memcpy(values->data(), bytes.data(), bytes.size());
+    return Status::OK();
+  }
+
+  Status ReadString(std::string* str) {
+    std::string_view bytes;
+    PL_RETURN_IF_ERROR(ReadArrayBytes(1, &bytes));
+    str->assign(bytes);
+    return Status::OK();
+  }
+
+ private:
+  UDAStateReader(std::string_view data, uint8_t version) : data_(data), version_(version) {}
+
+  Status ReadArrayBytes(size_t value_size, std::string_view* bytes);
+  static Status Truncated();
+
+  std::string_view data_;
+  uint8_t version_ = 0;
+};
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/udf/uda_state.h"
+
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+TEST(UDAState, round_trip) {
+  UDAStateWriter writer(/*version*/ 2);
+  writer.Write<int64_t>(-12);
+  writer.Write(0.5);
+  std::vector<float> floats = {1.0f, 2.5f, -3.0f};
+  writer.WriteArray(floats.data(), floats.size());
+  writer.WriteString("abc");
+  writer.WriteArray<double>(nullptr, 0);
+  auto state = writer.Finish();
+
+  ASSERT_TRUE(UDAStateReader::IsUDAState(state));
+  ASSERT_OK_AND_ASSIGN(auto reader, UDAStateReader::Create(state, /*max_version*/ 2));
+  EXPECT_EQ(reader.version(), 2);
+  int64_t i;
+  ASSERT_OK(reader.Read(&i));
+  EXPECT_EQ(i, -12);
+  double d;
+  ASSERT_OK(reader.Read(&d));
+  EXPECT_EQ(d, 0.5);
+  std::vector<float> read_floats;
+  ASSERT_OK(reader.ReadArray(&read_floats));
+  EXPECT_EQ(read_floats, floats);
+  std::string str;
+  ASSERT_OK(reader.ReadString(&str));
+  EXPECT_EQ(str, "abc");
+  std::vector<double> empty;
+  ASSERT_OK(reader.ReadArray(&empty));
+  EXPECT_TRUE(empty.empty());
+  EXPECT_TRUE(reader.done());
+}
+
+TEST(UDAState, rejects_json_and_newer_versions) {
+  EXPECT_FALSE(UDAStateReader::IsUDAState("{\"a\": 1}"));
+  EXPECT_NOT_OK(UDAStateReader::Create("{\"a\": 1}", 1));
+
+  auto state = UDAStateWriter(/*version*/ 3).Finish();
+  EXPECT_NOT_OK(UDAStateReader::Create(state, /*max_version*/ 2));
+}
+
+TEST(UDAState, truncated) {
+  UDAStateWriter writer(/*version*/ 1);
+  std::vector<double> values = {1, 2, 3};
+  writer.WriteArray(values.data(), values.size());
+  auto state = writer.Finish();
+  state.pop_back();
+
+  ASSERT_OK_AND_ASSIGN(auto reader, UDAStateReader::Create(state, /*max_version*/ 1));
+  std::vector<double> read_values;
+  EXPECT_NOT_OK(reader.ReadArray(&read_values));
+
+  ASSERT_OK_AND_ASSIGN(reader, UDAStateReader::Create(state, /*max_version*/ 1));
+  // The state holds the 4 byte count and 23 bytes of values.
+  uint64_t value;
+  ASSERT_OK(reader.Read(&value));
+  ASSERT_OK(reader.Read(&value));
+  ASSERT_OK(reader.Read(&value));
+  EXPECT_NOT_OK(reader.Read(&value));
+}
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
@@ -31,6 +31,7 @@
 #include <functional>
 
 #include "src/carnot/udf/base.h"
+#include "src/carnot/udf/udf_memo.h"
 #include "src/carnot/udfspb/udfs.pb.h"
 #include "src/common/base/base.h"
 #include "src/shared/metadata/metadata_state.h"
@@ -74,10 +75,31 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * The ScalarUDF can also _optionally_ implement the following function:
+ *      void ExecBatch(FunctionContext *ctx, size_t count, UDFValue* out, const UDFValue*... values)
+ *  When it exists, it is called instead of Exec with whole columns of values, so that the UDF can
+ *  amortize expensive work (such as model inference) across the rows of a batch. It must
+ *  produce the same output as calling Exec on each row, and Exec is still used to type the UDF.
+ *
+ * A ScalarUDF whose output depends only on its Init and Exec arguments can declare so with:
+ *      static constexpr bool Deterministic() { return true; }
+ *  Each instance then memoizes the results of Exec by its arguments (see udf_memo.h), so that
+ *  repeated values across rows and batches are computed once. UDFs with an ExecBatch function
+ *  are not memoized.
  */
 class ScalarUDF : public AnyUDF {
  public:
   ~ScalarUDF() override = default;
+
+  /**
+   * The memo of Exec results, which is null unless the UDF is deterministic and has executed.
+   */
+  UDFMemoBase* memo() const { return memo_.get(); }
+  void set_memo(std::unique_ptr<UDFMemoBase> memo) { memo_ = std::move(memo); }
+
+ private:
+  std::unique_ptr<UDFMemoBase> memo_;
 };
 
 /**
@@ -98,6 +120,8 @@ class ScalarUDF : public AnyUDF {
  * To support partial aggregation to UDAs must also implement:
  *     StringValue Serialize(FunctionContext*) {}
  *     Status DeSerialize(FunctionContext*, const StringValue& data) {}
+ * UDAs with more than a fixed size value of state should write it with UDAStateWriter (see
+ * uda_state.h), which versions the state and packs arrays.
  *
  * All argument types must me valid UDFValueTypes.
  */
@@ -188,6 +212,55 @@ static constexpr types::DataType ReturnTypeHelper(ReturnType (TUDF::*)(Types...)
   return types::ValueTypeTraits<ReturnType>::data_type;
 }
 
+/**
+ * Checks to see if a valid looking ExecBatch function exists.
+ */
+template <typename ReturnType, typename TUDF, typename... Types>
+static constexpr bool IsValidExecBatchFn(ReturnType (TUDF::*)(Types...)) {
+  return false;
+}
+
+template <typename TUDF, typename TOutput, typename... Types>
+static constexpr bool IsValidExecBatchFn(void (TUDF::*)(FunctionContext*, size_t, TOutput*,
+                                                        const Types*...)) {
+  return true;
+}
+
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {
+  static_assert(IsValidExecBatchFn(&T::ExecBatch),
+                "If an ExecBatch function exists, it must have the form: void "
+                "ExecBatch(FunctionContext*, size_t, UDFValue*, const UDFValue*...)");
+};
+
+/**
+ * Checks to see if a valid looking Deterministic function exists.
+ */
+template <typename ReturnType>
+constexpr bool IsValidDeterministicFn(ReturnType (*)()) {
+  return false;
+}
+
+template <>
+constexpr bool IsValidDeterministicFn(bool (*)()) {
+  return true;
+}
+
+// SFINAE test for Deterministic fn.
+template <typename T, typename = void>
+struct has_udf_deterministic_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_deterministic_fn<T, std::void_t<decltype(&T::Deterministic)>> : std::true_type {
+  static_assert(IsValidDeterministicFn(&T::Deterministic),
+                "If a Deterministic function exists, it must have the form: static constexpr "
+                "bool Deterministic()");
+};
+
 template <typename T, typename = void>
 struct check_init_fn {};
 
@@ -228,6 +301,24 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF has an ExecBatch function, which executes a whole batch at once.
+   * @return true if it has an ExecBatch function.
+   */
+  static constexpr bool HasExecBatch() { return has_udf_exec_batch_fn<T>::value; }
+
+  /**
+   * Checks if the UDF declares that its output depends only on its arguments.
+   * @return true if the results of Exec may be memoized.
+   */
+  static constexpr bool IsDeterministic() {
+    if constexpr (has_udf_deterministic_fn<T>::value) {
+      return T::Deterministic();
+    } else {
+      return false;
+    }
+  }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
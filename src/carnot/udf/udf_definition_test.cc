@@ -67,6 +67,35 @@ class InitArgUDF : public ScalarUDF {
   int64_t i_;
 };
 
+// Adds its arguments, and counts the batches it executed.
+class BatchAddUDF : public ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val + v2.val;
+  }
+  void ExecBatch(FunctionContext* ctx, size_t count, types::Int64Value* out,
+                 const types::Int64Value* v1, const types::Int64Value* v2) {
+    ++batch_count;
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = Exec(ctx, v1[i], v2[i]);
+    }
+  }
+
+  int batch_count = 0;
+};
+
+// Prefixes its argument, and counts the rows it executed.
+class DeterministicPrefixUDF : public ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::StringValue str, types::Int64Value i) {
+    ++exec_count;
+    return absl::Substitute("$0:$1", i.val, str);
+  }
+  static constexpr bool Deterministic() { return true; }
+
+  int exec_count = 0;
+};
+
 TEST(UDFDefinition, no_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("noargudf");
@@ -136,6 +165,135 @@ TEST(UDFDefinition, arrow_write) {
   EXPECT_EQ(6, resArr->Value(1));
 }
 
+TEST(UDFDefinition, exec_batch) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("batch_add");
+  EXPECT_OK(def.Init<BatchAddUDF>());
+  EXPECT_THAT(def.exec_arguments(), ElementsAre(types::INT64, types::INT64));
+
+  types::Int64ValueColumnWrapper v1({1, 2, 3});
+  types::Int64ValueColumnWrapper v2({3, 4, 5});
+
+  types::Int64ValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ(1, static_cast<BatchAddUDF*>(u.get())->batch_count);
+  EXPECT_EQ(4, out[0].val);
+  EXPECT_EQ(6, out[1].val);
+  EXPECT_EQ(8, out[2].val);
+}
+
+TEST(UDFDefinition, exec_batch_arrow) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::Int64Value> v1 = {1, 2, 3};
+  std::vector<types::Int64Value> v2 = {3, 4, 5};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::Int64Builder>();
+  auto u = std::make_shared<BatchAddUDF>();
+  EXPECT_OK(ScalarUDFWrapper<BatchAddUDF>::ExecBatchArrow(u.get(), &ctx, {v1a.get(), v2a.get()},
+                                                          output_builder.get(), 3));
+  EXPECT_EQ(1, u->batch_count);
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* resArr = static_cast<arrow::Int64Array*>(res.get());
+  EXPECT_EQ(4, resArr->Value(0));
+  EXPECT_EQ(6, resArr->Value(1));
+  EXPECT_EQ(8, resArr->Value(2));
+}
+
+TEST(UDFDefinition, deterministic_memo) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("prefix");
+  EXPECT_OK(def.Init<DeterministicPrefixUDF>());
+  auto u = def.Make();
+  auto* udf = static_cast<DeterministicPrefixUDF*>(u.get());
+
+  types::StringValueColumnWrapper v1({"a", "b", "a", "a"});
+  types::Int64ValueColumnWrapper v2({1, 1, 1, 2});
+  types::StringValueColumnWrapper out(v1.Size());
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ(3, udf->exec_count);
+  EXPECT_EQ("1:a", out[0]);
+  EXPECT_EQ("1:b", out[1]);
+  EXPECT_EQ("1:a", out[2]);
+  EXPECT_EQ("2:a", out[3]);
+
+  // The memo carries over to the next batch.
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ(3, udf->exec_count);
+  EXPECT_EQ("1:b", out[1]);
+
+  ASSERT_NE(nullptr, u->memo());
+  EXPECT_EQ(5, u->memo()->stats().hits);
+  EXPECT_EQ(3, u->memo()->stats().misses);
+}
+
+TEST(UDFDefinition, deterministic_memo_arrow) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::StringValue> v1 = {"a", "a", "b"};
+  std::vector<types::Int64Value> v2 = {1, 1, 1};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::StringBuilder>();
+  auto u = std::make_shared<DeterministicPrefixUDF>();
+  EXPECT_OK(ScalarUDFWrapper<DeterministicPrefixUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(), 3));
+  EXPECT_EQ(2, u->exec_count);
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* resArr = static_cast<arrow::StringArray*>(res.get());
+  EXPECT_EQ("1:a", resArr->GetString(0));
+  EXPECT_EQ("1:a", resArr->GetString(1));
+  EXPECT_EQ("1:b", resArr->GetString(2));
+}
+
+TEST(UDFMemo, disables_when_inputs_do_not_repeat) {
+  using Memo = UDFMemo<types::Int64Value, types::Int64Value>;
+  Memo memo;
+  int calls = 0;
+  auto square = [&](const types::Int64Value& v) -> types::Int64Value {
+    ++calls;
+    return v.val * v.val;
+  };
+  for (int64_t i = 0; i < 2 * Memo::kProbeLookups; ++i) {
+    EXPECT_EQ(i * i, memo.GetOrCompute(square, types::Int64Value(i)).val);
+  }
+  EXPECT_TRUE(memo.disabled());
+  EXPECT_EQ(2 * Memo::kProbeLookups, calls);
+}
+
+TEST(UDFMemo, disables_when_probe_ends_on_a_hit) {
+  using Memo = UDFMemo<types::Int64Value, types::Int64Value>;
+  Memo memo;
+  auto square = [](const types::Int64Value& v) -> types::Int64Value { return v.val * v.val; };
+  for (int64_t i = 0; i < Memo::kProbeLookups - 1; ++i) {
+    memo.GetOrCompute(square, types::Int64Value(i));
+  }
+  // The last lookup of the probe hits, which must not skip the hit rate check.
+  memo.GetOrCompute(square, types::Int64Value(0));
+  EXPECT_FALSE(memo.disabled());
+  EXPECT_EQ(9, memo.GetOrCompute(square, types::Int64Value(3)).val);
+  EXPECT_TRUE(memo.disabled());
+}
+
+TEST(UDFMemo, stays_enabled_when_inputs_repeat) {
+  using Memo = UDFMemo<types::Int64Value, types::Int64Value>;
+  Memo memo;
+  auto square = [](const types::Int64Value& v) -> types::Int64Value { return v.val * v.val; };
+  for (int64_t i = 0; i < 2 * Memo::kProbeLookups; ++i) {
+    EXPECT_EQ((i % 10) * (i % 10), memo.GetOrCompute(square, types::Int64Value(i % 10)).val);
+  }
+  EXPECT_FALSE(memo.disabled());
+  EXPECT_EQ(10, memo.stats().misses);
+}
+
 TEST(UDFDefinition, init_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("initargudf");
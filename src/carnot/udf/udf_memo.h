@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/hash/hash.h>
+
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+struct UDFMemoStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+
+  int64_t lookups() const { return hits + misses; }
+  double hit_rate() const { return lookups() == 0 ? 0 : static_cast<double>(hits) / lookups(); }
+
+  UDFMemoStats& operator+=(const UDFMemoStats& other) {
+    hits += other.hits;
+    misses += other.misses;
+    return *this;
+  }
+};
+
+/**
+ * The type erased base of UDFMemo, so that a ScalarUDF can own the memo of its results.
+ */
+class UDFMemoBase {
+ public:
+  virtual ~UDFMemoBase() = default;
+  const UDFMemoStats& stats() const { return stats_; }
+
+ protected:
+  UDFMemoStats stats_;
+};
+
+namespace internal {
+
+// The key a UDF value is memoized by, and the view of it that lookups use, so that looking up
+// a string argument doesn't copy it.
+template <typename T>
+struct MemoKeyTraits {
+  using type = decltype(T::val);
+  using view_type = type;
+  static view_type View(const T& value) { return value.val; }
+};
+
+template <>
+struct MemoKeyTraits<types::StringValue> {
+  using type = std::string;
+  using view_type = std::string_view;
+  static view_type View(const types::StringValue& value) { return value; }
+};
+
+}  // namespace internal
+
+/**
+ * UDFMemo remembers the results of a deterministic scalar UDF by its arguments, so that each
+ * distinct input is executed once rather than once per row. The memo holds at most kMaxEntries
+ * results, and starts over when it is full. If less than a quarter of the first kProbeLookups
+ * lookups hit, the inputs are too diverse for the memo to pay for hashing them, and it turns
+ * itself off.
+ */
+template <typename TResult, typename... TArgs>
+class UDFMemo : public UDFMemoBase {
+ public:
+  static constexpr size_t kMaxEntries = 4096;
+  static constexpr int64_t kProbeLookups = 1024;
+
+  /**
+   * Returns the memoized result for args, calling compute(args...) if there is none.
+   */
+  template <typename TFn>
+  TResult GetOrCompute(TFn compute, const TArgs&... args) {
+    if (!probe_done_ && stats_.lookups() >= kProbeLookups) {
+      probe_done_ = true;
+      if (stats_.hits * 4 < stats_.lookups()) {
+        disabled_ = true;
+        results_.clear();
+      }
+    }
+    if (disabled_) {
+      return compute(args...);
+    }
+    ViewKey view_key(internal::MemoKeyTraits<TArgs>::View(args)...);
+    auto it = results_.find(view_key);
+    if (it != results_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    ++stats_.misses;
+    TResult result = compute(args...);
+    if (results_.size() >= kMaxEntries) {
+      results_.clear();
+    }
+    results_.emplace(Key(view_key), result);
+    return result;
+  }
+
+  bool disabled() const { return disabled_; }
+
+ private:
+  using Key = std::tuple<typename internal::MemoKeyTraits<TArgs>::type...>;
+  using ViewKey = std::tuple<typename internal::MemoKeyTraits<TArgs>::view_type...>;
+
+  // Hashes keys through their views, which absl hashes the same way as the owned keys.
+  struct KeyHash {
+    using is_transparent = void;
+    template <typename K>
+    size_t operator()(const K& key) const {
+      return absl::Hash<ViewKey>()(ViewKey(key));
+    }
+  };
+  struct KeyEq {
+    using is_transparent = void;
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+      return a == b;
+    }
+  };
+
+  absl::flat_hash_map<Key, TResult, KeyHash, KeyEq> results_;
+  // Whether the hit rate of the first kProbeLookups lookups was checked.
+  bool probe_done_ = false;
+  bool disabled_ = false;
+};
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
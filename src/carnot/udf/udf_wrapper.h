@@ -48,6 +48,22 @@ constexpr auto CastToUDFValueType(const types::BaseValueType* arg) {
   // return static_cast<types::Int64Value*>(arg);
   return static_cast<const typename types::DataTypeTraits<TExecArgType>::value_type*>(arg);
 }
+/**
+ * Returns the memo of a deterministic UDF, creating it on first use. The memo is keyed by the
+ * value types of the Exec arguments.
+ */
+template <typename TUDF, std::size_t... I>
+auto* GetOrCreateUDFMemo(TUDF* udf, std::index_sequence<I...>) {
+  static constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  static constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using TMemo = UDFMemo<typename types::DataTypeTraits<return_type>::value_type,
+                        typename types::DataTypeTraits<exec_argument_types[I]>::value_type...>;
+  if (udf->memo() == nullptr) {
+    udf->set_memo(std::make_unique<TMemo>());
+  }
+  return static_cast<TMemo*>(udf->memo());
+}
+
 /**
  * This is the inner wrapper which expands the arguments an performs type casts
  * based on the type and arity of the input arguments.
@@ -62,6 +78,18 @@ Status ExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
                    const std::vector<const types::BaseValueType*>& args,
                    std::index_sequence<I...>) {
   [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+    udf->ExecBatch(ctx, count, out, CastToUDFValueType<exec_argument_types[I]>(args[I])...);
+    return Status::OK();
+  } else if constexpr (ScalarUDFTraits<TUDF>::IsDeterministic()) {
+    auto* memo = GetOrCreateUDFMemo(udf, std::index_sequence<I...>{});
+    auto exec = [&](const auto&... values) { return udf->Exec(ctx, values...); };
+    for (size_t idx = 0; idx < count; ++idx) {
+      out[idx] =
+          memo->GetOrCompute(exec, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx]...);
+    }
+    return Status::OK();
+  }
   for (size_t idx = 0; idx < count; ++idx) {
     out[idx] = udf->Exec(ctx, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx]...);
   }
@@ -113,10 +141,7 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
     CHECK(out->ReserveData(reserved).ok());
   }
-  for (size_t idx = 0; idx < count; ++idx) {
-    auto res = UnWrap(
-        udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
-
+  auto append = [&](const auto& res) -> Status {
     // We use doubling to make sure we minimize the number of allocations.
     // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
     if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
@@ -128,6 +153,39 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
     }
     // This function is "safe" now because we manually allocated memory.
     out->UnsafeAppend(res);
+    return Status::OK();
+  };
+
+  if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+    // Copy the inputs out of arrow, so that the UDF can process the whole batch at once.
+    std::tuple<std::vector<typename types::DataTypeTraits<exec_argument_types[I]>::value_type>...>
+        inputs;
+    (std::get<I>(inputs).reserve(count), ...);
+    for (size_t idx = 0; idx < count; ++idx) {
+      (std::get<I>(inputs).emplace_back(
+           types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)),
+       ...);
+    }
+    constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+    std::vector<typename types::DataTypeTraits<return_type>::value_type> results(count);
+    udf->ExecBatch(ctx, count, results.data(), std::get<I>(inputs).data()...);
+    for (const auto& res : results) {
+      PL_RETURN_IF_ERROR(append(UnWrap(res)));
+    }
+    return Status::OK();
+  } else if constexpr (ScalarUDFTraits<TUDF>::IsDeterministic()) {
+    auto* memo = GetOrCreateUDFMemo(udf, std::index_sequence<I...>{});
+    auto exec = [&](const auto&... values) { return udf->Exec(ctx, values...); };
+    for (size_t idx = 0; idx < count; ++idx) {
+      PL_RETURN_IF_ERROR(append(UnWrap(memo->GetOrCompute(
+          exec, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...))));
+    }
+    return Status::OK();
+  }
+
+  for (size_t idx = 0; idx < count; ++idx) {
+    PL_RETURN_IF_ERROR(append(UnWrap(
+        udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...))));
   }
   return Status::OK();
 }
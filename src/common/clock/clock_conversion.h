@@ -25,6 +25,8 @@
 #include <memory>
 #include <thread>
 
+#include <absl/types/span.h>
+
 #include "src/common/clock/interpolating_lookup_table.h"
 
 namespace px {
@@ -38,6 +40,13 @@ class ClockConverter {
  public:
   virtual ~ClockConverter() = default;
   virtual uint64_t Convert(uint64_t monotonic_time) const = 0;
+  // Converts each of the times in place. Converters should make this cheaper than calling
+  // Convert() on each time, particularly when the times are sorted.
+  virtual void ConvertBatch(absl::Span<uint64_t> monotonic_times) const {
+    for (uint64_t& t : monotonic_times) {
+      t = Convert(t);
+    }
+  }
   virtual void Update() = 0;
   virtual std::chrono::milliseconds UpdatePeriod() const = 0;
   // The max history is chosen as an even multiple of the default polling period, and longer than 5
@@ -69,6 +78,7 @@ class DefaultMonoToRealtimeConverter : public ClockConverter {
   DefaultMonoToRealtimeConverter();
 
   uint64_t Convert(uint64_t monotonic_time) const override;
+  void ConvertBatch(absl::Span<uint64_t> monotonic_times) const override;
   void Update() override;
   std::chrono::milliseconds UpdatePeriod() const override { return kUpdatePeriod; }
 
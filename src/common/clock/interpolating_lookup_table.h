@@ -17,9 +17,13 @@
  */
 #pragma once
 
-#include <deque>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <utility>
-#include "absl/base/internal/spinlock.h"
+
+#include <absl/base/internal/spinlock.h>
+#include <absl/types/span.h>
 
 #include "src/common/base/base.h"
 
@@ -30,73 +34,156 @@ namespace clock {
  * InterpolatingLookupTable stores sorted key,value pairs in a circular buffer.
  * When accessing the map, if the key is not in the map, the closest key,value pairs are
  * interpolated to get a corresponding value.
+ *
+ * Readers never take a lock. The buffer is guarded by a sequence number, which Emplace() makes odd
+ * while it modifies the buffer; readers retry if they observe an odd or changed sequence number.
+ * Concurrent calls to Emplace() are serialized by a spinlock.
  */
 template <size_t TCapacity>
 class InterpolatingLookupTable {
   // The Map stores a mapping from key to offset (i.e from key to (value - key))
   using MapPairType = std::pair<uint64_t, int64_t>;
-  using CircularMap = std::deque<MapPairType>;
+
+  // The buffer holds TCapacity pairs, plus the one being added.
+  static constexpr size_t kBufferSize = TCapacity + 1;
 
  public:
   void Emplace(uint64_t key, uint64_t val) {
-    absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-    if (buffer_.size() > TCapacity) {
-      buffer_.pop_front();
+    absl::base_internal::SpinLockHolder lock(&writer_lock_);
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t size = size_.load(std::memory_order_relaxed);
+    if (size == kBufferSize) {
+      head = (head + 1) % kBufferSize;
+      --size;
     }
-    buffer_.push_back(std::make_pair(key, static_cast<int64_t>(val) - key));
+    Entry& entry = buffer_[(head + size) % kBufferSize];
+    entry.key.store(key, std::memory_order_relaxed);
+    entry.offset.store(static_cast<int64_t>(val) - key, std::memory_order_relaxed);
+    head_.store(head, std::memory_order_relaxed);
+    size_.store(size + 1, std::memory_order_relaxed);
+
+    seq_.store(seq + 2, std::memory_order_release);
   }
 
   uint64_t Get(uint64_t key) const {
-    {
-      absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-      if (buffer_.size() == 0) {
-        return key;
+    int64_t offset;
+    ReadConsistent([&]() {
+      const size_t head = head_.load(std::memory_order_relaxed);
+      const size_t size = size_.load(std::memory_order_relaxed);
+      auto at = [&](size_t i) { return Load(buffer_[(head + i) % kBufferSize]); };
+      offset = Offset(at, size, LowerBound(at, 0, size, key), key);
+    });
+    return key + offset;
+  }
+
+  /**
+   * Replaces each key in keys with its value, as Get() would, from a single snapshot of the table.
+   * Keys are expected to be mostly sorted: the search for each key resumes from where the previous
+   * key was found, so sorted keys are converted in a single pass over the table.
+   */
+  void GetBatch(absl::Span<uint64_t> keys) const {
+    std::array<MapPairType, kBufferSize> entries;
+    size_t size;
+    ReadConsistent([&]() {
+      const size_t head = head_.load(std::memory_order_relaxed);
+      size = size_.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < size; ++i) {
+        entries[i] = Load(buffer_[(head + i) % kBufferSize]);
       }
-    }
+    });
 
-    MapPairType a;
-    MapPairType b;
-    auto found_two_points = GetLeftRightInterpolationPoints(key, &a, &b);
-    if (!found_two_points) {
-      // If we are before or after the history we have stored we just use the closest offset we can.
-      return key + a.second;
+    auto at = [&](size_t i) { return entries[i]; };
+    size_t pos = 0;
+    uint64_t prev_key = 0;
+    for (uint64_t& key : keys) {
+      if (key < prev_key) {
+        pos = LowerBound(at, 0, pos, key);
+      }
+      while (pos < size && entries[pos].first < key) {
+        ++pos;
+      }
+      prev_key = key;
+      key += Offset(at, size, pos, key);
     }
-    return key + LinearInterpolate(a.first, b.first, a.second, b.second, key);
   }
 
   size_t size() const {
-    absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-    return buffer_.size();
+    size_t size;
+    ReadConsistent([&]() { size = size_.load(std::memory_order_relaxed); });
+    return size;
   }
 
  private:
-  mutable absl::base_internal::SpinLock buffer_lock_;
-  CircularMap buffer_ ABSL_GUARDED_BY(buffer_lock_);
-
-  bool GetLeftRightInterpolationPoints(uint64_t key, MapPairType* left, MapPairType* right) const {
-    absl::base_internal::SpinLockHolder lock(&buffer_lock_);
-    if (buffer_.size() == 1) {
-      *left = *buffer_.begin();
-      return false;
+  struct Entry {
+    std::atomic<uint64_t> key{0};
+    std::atomic<int64_t> offset{0};
+  };
+
+  static MapPairType Load(const Entry& entry) {
+    return {entry.key.load(std::memory_order_relaxed),
+            entry.offset.load(std::memory_order_relaxed)};
+  }
+
+  // Runs read_fn until it completes without a concurrent Emplace().
+  template <typename TReadFn>
+  void ReadConsistent(TReadFn read_fn) const {
+    while (true) {
+      const uint64_t seq = seq_.load(std::memory_order_acquire);
+      if (seq % 2 == 1) {
+        continue;
+      }
+      read_fn();
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == seq) {
+        return;
+      }
     }
-    auto cmp = [](MapPairType a, uint64_t b) { return a.first < b; };
-    auto it = std::lower_bound(buffer_.begin(), buffer_.end(), key, cmp);
-    if (it == buffer_.end()) {
-      *left = *std::prev(buffer_.end());
-      return false;
+  }
+
+  // Returns the index of the first of the entries in [begin, end) whose key is not less than key.
+  template <typename TAtFn>
+  static size_t LowerBound(TAtFn at, size_t begin, size_t end, uint64_t key) {
+    while (begin < end) {
+      const size_t mid = begin + (end - begin) / 2;
+      if (at(mid).first < key) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
     }
-    if (it == buffer_.begin()) {
-      *left = *buffer_.begin();
-      return false;
+    return begin;
+  }
+
+  // Returns the offset for key, given the index of its lower bound among the size entries.
+  template <typename TAtFn>
+  static int64_t Offset(TAtFn at, size_t size, size_t pos, uint64_t key) {
+    if (size == 0) {
+      return 0;
+    }
+    // If we are before or after the history we have stored we just use the closest offset we can.
+    if (size == 1 || pos == 0) {
+      return at(0).second;
     }
-    if (it->first == key) {
-      *left = *it;
-      return false;
+    if (pos >= size) {
+      return at(size - 1).second;
     }
-    *left = *std::prev(it);
-    *right = *it;
-    return true;
+    const MapPairType b = at(pos);
+    if (b.first == key) {
+      return b.second;
+    }
+    const MapPairType a = at(pos - 1);
+    return LinearInterpolate(a.first, b.first, a.second, b.second, key);
   }
+
+  absl::base_internal::SpinLock writer_lock_;
+  std::atomic<uint64_t> seq_{0};
+  std::array<Entry, kBufferSize> buffer_;
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace clock
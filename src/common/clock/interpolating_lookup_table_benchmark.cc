@@ -18,6 +18,10 @@
 
 #include <benchmark/benchmark.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "src/common/clock/clock_conversion.h"
 
 namespace {
@@ -58,8 +62,87 @@ void BM_InterpolatingLookupTableEmplace(benchmark::State& state) {
   }
 }
 
+// Converts a sorted batch of keys, one key at a time.
+// NOLINTNEXTLINE : runtime/references.
+void BM_InterpolatingLookupTableGetSorted(benchmark::State& state) {
+  constexpr size_t capacity =
+      ClockConverter::BufferCapacity(DefaultMonoToRealtimeConverter::kUpdatePeriod);
+  uint64_t base_val = 1640000000271885073;
+  auto table = InitTable<capacity>(base_val);
+  std::vector<uint64_t> keys(state.range(0));
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = table->Get(base_val + 100 * capacity * i / keys.size());
+    }
+    benchmark::DoNotOptimize(keys.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// Converts the same sorted batch of keys as BM_InterpolatingLookupTableGetSorted, with GetBatch().
+// NOLINTNEXTLINE : runtime/references.
+void BM_InterpolatingLookupTableGetBatch(benchmark::State& state) {
+  constexpr size_t capacity =
+      ClockConverter::BufferCapacity(DefaultMonoToRealtimeConverter::kUpdatePeriod);
+  uint64_t base_val = 1640000000271885073;
+  auto table = InitTable<capacity>(base_val);
+  std::vector<uint64_t> keys(state.range(0));
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = base_val + 100 * capacity * i / keys.size();
+    }
+    table->GetBatch(absl::MakeSpan(keys));
+    benchmark::DoNotOptimize(keys.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// Readers on all benchmark threads share one table.
+// NOLINTNEXTLINE : runtime/references.
+void BM_InterpolatingLookupTableConcurrentGet(benchmark::State& state) {
+  constexpr size_t capacity =
+      ClockConverter::BufferCapacity(DefaultMonoToRealtimeConverter::kUpdatePeriod);
+  static constexpr uint64_t base_val = 1640000000271885073;
+  static const auto table = InitTable<capacity>(base_val);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table->Get(base_val + 100 * capacity / 2));
+  }
+}
+
+// Same as BM_InterpolatingLookupTableGet, while another thread continuously updates the table.
+// NOLINTNEXTLINE : runtime/references.
+void BM_InterpolatingLookupTableGetWithWriter(benchmark::State& state) {
+  constexpr size_t capacity =
+      ClockConverter::BufferCapacity(DefaultMonoToRealtimeConverter::kUpdatePeriod);
+  uint64_t base_val = 1640000000271885073;
+  auto table = InitTable<capacity>(base_val);
+
+  std::atomic<bool> done = false;
+  std::thread writer([&]() {
+    uint64_t i = 0;
+    while (!done) {
+      table->Emplace(base_val + 100 * (capacity + i), base_val + 100 * (capacity + i) + 100);
+      ++i;
+    }
+  });
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table->Get(base_val + 100 * capacity / 2));
+  }
+
+  done = true;
+  writer.join();
+}
+
 BENCHMARK(BM_InterpolatingLookupTableGet);
 BENCHMARK(BM_InterpolatingLookupTableEmplace);
+BENCHMARK(BM_InterpolatingLookupTableGetSorted)->RangeMultiplier(8)->Range(1, 4096);
+BENCHMARK(BM_InterpolatingLookupTableGetBatch)->RangeMultiplier(8)->Range(1, 4096);
+BENCHMARK(BM_InterpolatingLookupTableConcurrentGet)->ThreadRange(1, 8);
+BENCHMARK(BM_InterpolatingLookupTableGetWithWriter);
 
 }  // namespace clock
 }  // namespace px
@@ -16,6 +16,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <thread>
+#include <vector>
+
 #include "src/common/testing/testing.h"
 
 #include "src/common/clock/clock_conversion.h"
@@ -86,5 +89,91 @@ TEST(InterpolatingLookupTable, mono_and_realtime) {
   EXPECT_EQ(offset, table.Get(query) - query);
 }
 
+TEST(InterpolatingLookupTable, batch) {
+  InterpolatingLookupTable<64> table;
+
+  std::vector<uint64_t> empty_keys = {0, 5};
+  table.GetBatch(absl::MakeSpan(empty_keys));
+  EXPECT_THAT(empty_keys, ::testing::ElementsAre(0, 5));
+
+  table.Emplace(0, 0);
+  table.Emplace(150, 200);
+  table.Emplace(250, 350);
+  table.Emplace(300, 300);
+
+  // Sorted keys, with keys outside of the table, and keys that repeat.
+  std::vector<uint64_t> keys = {0, 50, 100, 100, 150, 200, 250, 300, 350};
+  std::vector<uint64_t> expected;
+  for (uint64_t key : keys) {
+    expected.push_back(table.Get(key));
+  }
+  table.GetBatch(absl::MakeSpan(keys));
+  EXPECT_EQ(keys, expected);
+
+  // Unsorted keys.
+  keys = {300, 50, 250, 0, 350, 150, 100};
+  expected.clear();
+  for (uint64_t key : keys) {
+    expected.push_back(table.Get(key));
+  }
+  table.GetBatch(absl::MakeSpan(keys));
+  EXPECT_EQ(keys, expected);
+}
+
+TEST(InterpolatingLookupTable, wraparound) {
+  InterpolatingLookupTable<4> table;
+
+  for (uint64_t i = 0; i < 10; ++i) {
+    table.Emplace(100 * i, 100 * i + 10 * i);
+  }
+  ASSERT_EQ(5, table.size());
+
+  // The oldest entries were dropped, so earlier keys use the offset of the oldest entry left.
+  EXPECT_EQ(100 + 50, table.Get(100));
+  EXPECT_EQ(550 + 55, table.Get(550));
+  EXPECT_EQ(1000 + 90, table.Get(1000));
+
+  std::vector<uint64_t> keys = {100, 550, 1000};
+  table.GetBatch(absl::MakeSpan(keys));
+  EXPECT_THAT(keys, ::testing::ElementsAre(100 + 50, 550 + 55, 1000 + 90));
+}
+
+// Readers must always observe a consistent table, even while it is being updated. Every entry has
+// the same offset, so any other result means a reader saw a partial update.
+TEST(InterpolatingLookupTable, concurrent_readers) {
+  constexpr int64_t kOffset = 1000;
+  constexpr uint64_t kNumUpdates = 100000;
+  InterpolatingLookupTable<16> table;
+  table.Emplace(0, kOffset);
+
+  std::atomic<bool> done = false;
+  std::atomic<int> num_inconsistent = 0;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      std::vector<uint64_t> keys(8);
+      while (!done) {
+        for (size_t j = 0; j < keys.size(); ++j) {
+          keys[j] = 1000 * j;
+        }
+        table.GetBatch(absl::MakeSpan(keys));
+        for (size_t j = 0; j < keys.size(); ++j) {
+          num_inconsistent += (keys[j] != 1000 * j + kOffset);
+        }
+        num_inconsistent += (table.Get(12345) != 12345 + kOffset);
+      }
+    });
+  }
+
+  for (uint64_t i = 1; i <= kNumUpdates; ++i) {
+    table.Emplace(i, i + kOffset);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_inconsistent, 0);
+}
+
 }  // namespace clock
 }  // namespace px
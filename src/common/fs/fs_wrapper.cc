@@ -16,6 +16,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
 #include <system_error>
 
 #include "src/common/fs/fs_wrapper.h"
@@ -246,6 +252,44 @@ StatusOr<std::filesystem::path> GetChildRelPath(std::filesystem::path child,
   return res;
 }
 
+Status WriteFileAtomically(const std::filesystem::path& path, std::string_view contents) {
+  // mkstemp() picks a name no other writer is using, so concurrent writers never interleave
+  // their contents in the same temporary file.
+  std::string tmp_path = absl::StrCat(path.string(), ".tmp.XXXXXX");
+  int fd = mkstemp(tmp_path.data());
+  if (fd < 0) {
+    return error::System("Failed to create temporary file for $0. Message: $1", path.string(),
+                         std::strerror(errno));
+  }
+  bool tmp_renamed = false;
+  DEFER(if (!tmp_renamed) { unlink(tmp_path.c_str()); });
+
+  {
+    DEFER(close(fd));
+    // mkstemp() creates the file as owner-only; the file is meant to be shared with readers.
+    if (fchmod(fd, 0644) != 0) {
+      return error::System("Failed to chmod $0. Message: $1", tmp_path, std::strerror(errno));
+    }
+    while (!contents.empty()) {
+      ssize_t n = write(fd, contents.data(), contents.size());
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return error::System("Failed to write $0. Message: $1", tmp_path, std::strerror(errno));
+      }
+      contents.remove_prefix(n);
+    }
+  }
+
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    return error::System("Failed to rename $0 to $1. Message: $2", tmp_path, path.string(),
+                         std::strerror(errno));
+  }
+  tmp_renamed = true;
+  return Status::OK();
+}
+
 std::vector<PathSplit> EnumerateParentPaths(const std::filesystem::path& path) {
   std::vector<PathSplit> res;
 
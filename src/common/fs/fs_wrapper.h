@@ -22,6 +22,7 @@
 
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/common/base/base.h"
@@ -88,6 +89,12 @@ StatusOr<bool> Equivalent(const std::filesystem::path& p1, const std::filesystem
 StatusOr<std::filesystem::path> GetChildRelPath(std::filesystem::path parent,
                                                 std::filesystem::path child);
 
+/**
+ * Writes the contents to a uniquely named temporary file next to path, and renames it to path.
+ * Readers opening path, from any process or thread, only ever see a complete file.
+ */
+Status WriteFileAtomically(const std::filesystem::path& path, std::string_view contents);
+
 struct PathSplit {
   std::filesystem::path parent;
   std::filesystem::path child;
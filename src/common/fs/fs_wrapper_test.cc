@@ -145,6 +145,22 @@ bool operator==(const PathSplit& lhs, const PathSplit& rhs) {
   return lhs.parent == rhs.parent && lhs.child == rhs.child;
 }
 
+TEST_F(FSWrapperTest, WriteFileAtomically) {
+  const std::filesystem::path path = tmp_dir_.path() / "file";
+  ASSERT_OK(WriteFileAtomically(path, "foo"));
+  EXPECT_OK_AND_EQ(ReadFileToString(path), "foo");
+
+  // Replaces the existing file, and leaves no temporary files behind.
+  ASSERT_OK(WriteFileAtomically(path, "bar"));
+  EXPECT_OK_AND_EQ(ReadFileToString(path), "bar");
+  EXPECT_THAT(std::vector<std::filesystem::directory_entry>(
+                  std::filesystem::directory_iterator(tmp_dir_.path()), {}),
+              ElementsAre(std::filesystem::directory_entry(path)));
+
+  EXPECT_THAT(WriteFileAtomically(tmp_dir_.path() / "missing_dir" / "file", "foo"),
+              StatusIs(statuspb::SYSTEM, HasSubstr("Failed to create temporary file")));
+}
+
 TEST_F(FSWrapperTest, EnumerateParentPaths) {
   EXPECT_THAT(EnumerateParentPaths("a/b/c/d"),
               ElementsAre(PathSplit{"a/b/c/d", ""}, PathSplit{"a/b/c", "d"},
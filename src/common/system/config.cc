@@ -60,6 +60,10 @@ class ConfigImpl final : public Config {
     return clock_converter_->Convert(monotonic_time);
   }
 
+  void ConvertToRealTime(absl::Span<uint64_t> monotonic_times) const override {
+    clock_converter_->ConvertBatch(monotonic_times);
+  }
+
   const std::filesystem::path& sysfs_path() const override { return sysfs_path_; }
 
   const std::filesystem::path& host_path() const override { return host_path_; }
@@ -80,6 +80,11 @@ class Config : public NotCopyable {
    */
   virtual uint64_t ConvertToRealTime(uint64_t monotonic_time) const = 0;
 
+  /**
+   * Converts a batch of monotonic times into realtime, in place.
+   */
+  virtual void ConvertToRealTime(absl::Span<uint64_t> monotonic_times) const = 0;
+
   /**
    * Get the sysfs path.
    */
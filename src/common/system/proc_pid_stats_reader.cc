@@ -0,0 +1,378 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_pid_stats_reader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <utility>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/strip.h>
+
+namespace px {
+namespace system {
+
+namespace {
+
+constexpr std::string_view kFileNames[] = {"stat", "io", "status"};
+
+// The index of a file in kFileNames and PIDFiles::fds.
+int FileIndex(ProcPIDStatsReader::File file) { return __builtin_ctz(file); }
+
+/*************************************************
+ * Constants for the /proc/<pid>/stat file
+ *************************************************/
+constexpr int kProcStatProcessNameField = 1;
+
+constexpr int kProcStatMinorFaultsField = 9;
+constexpr int kProcStatMajorFaultsField = 11;
+
+constexpr int kProcStatUTimeField = 13;
+constexpr int kProcStatKTimeField = 14;
+constexpr int kProcStatNumThreadsField = 19;
+
+constexpr int kProcStatVSizeField = 22;
+constexpr int kProcStatRSSField = 23;
+
+bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+
+// Parses a decimal integer surrounded by blanks, like absl::SimpleAtoi, but without copying
+// or allocating.
+template <typename TInt>
+bool ScanInt(std::string_view str, TInt* out) {
+  const char* begin = str.data();
+  const char* end = str.data() + str.size();
+  while (begin != end && IsBlank(*begin)) {
+    ++begin;
+  }
+  auto [ptr, ec] = std::from_chars(begin, end, *out);
+  if (ec != std::errc() || ptr == begin) {
+    return false;
+  }
+  for (; ptr != end; ++ptr) {
+    if (!IsBlank(*ptr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status ScanStat(std::string_view content, int64_t page_size_bytes, int64_t kernel_tick_time_ns,
+                ProcParser::ProcessStats* out) {
+  // The process name is surrounded by (), and may itself contain spaces and parentheses,
+  // so the fields that follow it are found from the last ')'.
+  const size_t name_begin = content.find('(');
+  const size_t name_end = content.rfind(')');
+  if (name_begin == std::string_view::npos || name_end == std::string_view::npos ||
+      name_end <= name_begin + 1) {
+    return error::Internal("Malformed process name in stat file");
+  }
+
+  bool ok = ScanInt(content.substr(0, name_begin), &out->pid);
+  out->process_name.assign(content.data() + name_begin + 1, name_end - name_begin - 1);
+
+  // Only scan up to the last field that we need.
+  std::string_view fields = content.substr(name_end + 1);
+  for (int field = kProcStatProcessNameField + 1; field <= kProcStatRSSField; ++field) {
+    while (!fields.empty() && IsBlank(fields.front())) {
+      fields.remove_prefix(1);
+    }
+    if (fields.empty()) {
+      return error::Internal("Incorrect number of fields in stat file");
+    }
+    const std::string_view value = fields.substr(0, fields.find(' '));
+    fields.remove_prefix(value.size());
+
+    switch (field) {
+      case kProcStatMinorFaultsField:
+        ok &= ScanInt(value, &out->minor_faults);
+        break;
+      case kProcStatMajorFaultsField:
+        ok &= ScanInt(value, &out->major_faults);
+        break;
+      case kProcStatUTimeField:
+        ok &= ScanInt(value, &out->utime_ns);
+        break;
+      case kProcStatKTimeField:
+        ok &= ScanInt(value, &out->ktime_ns);
+        break;
+      case kProcStatNumThreadsField:
+        ok &= ScanInt(value, &out->num_threads);
+        break;
+      case kProcStatVSizeField:
+        ok &= ScanInt(value, &out->vsize_bytes);
+        break;
+      case kProcStatRSSField:
+        ok &= ScanInt(value, &out->rss_bytes);
+        break;
+      default:
+        break;
+    }
+  }
+  if (!ok) {
+    return error::Internal("Failed to parse stat file. ATOI failed.");
+  }
+
+  // The kernel tracks utime and ktime in kernel ticks, and RSS in pages.
+  out->utime_ns *= kernel_tick_time_ns;
+  out->ktime_ns *= kernel_tick_time_ns;
+  out->rss_bytes *= page_size_bytes;
+  return Status::OK();
+}
+
+template <typename TStruct>
+using FieldMap = absl::flat_hash_map<std::string_view, int64_t TStruct::*>;
+
+// Scans the "key: value [kB]" lines of a file into the fields of out. Values in kB are
+// converted to bytes, and values that do not parse are set to -1.
+template <typename TStruct>
+void ScanKeyValues(std::string_view content, const FieldMap<TStruct>& fields, TStruct* out) {
+  size_t num_found = 0;
+  while (!content.empty() && num_found < fields.size()) {
+    const size_t eol = content.find('\n');
+    const std::string_view line = content.substr(0, eol);
+    content.remove_prefix(eol == std::string_view::npos ? content.size() : eol + 1);
+
+    const size_t colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    const auto it = fields.find(line.substr(0, colon));
+    if (it == fields.end()) {
+      continue;
+    }
+    ++num_found;
+
+    std::string_view value = line.substr(colon + 1);
+    int64_t* value_ptr = &(out->*(it->second));
+    const int64_t multiplier = absl::ConsumeSuffix(&value, " kB") ? 1024 : 1;
+    if (ScanInt(value, value_ptr)) {
+      *value_ptr *= multiplier;
+    } else {
+      *value_ptr = -1;
+    }
+  }
+}
+
+const FieldMap<ProcParser::ProcessStats>& IOFields() {
+  static const auto* fields = new FieldMap<ProcParser::ProcessStats>{
+      {"rchar", &ProcParser::ProcessStats::rchar_bytes},
+      {"wchar", &ProcParser::ProcessStats::wchar_bytes},
+      {"read_bytes", &ProcParser::ProcessStats::read_bytes},
+      {"write_bytes", &ProcParser::ProcessStats::write_bytes},
+  };
+  return *fields;
+}
+
+const FieldMap<ProcParser::ProcessStatus>& StatusFields() {
+  using ProcessStatus = ProcParser::ProcessStatus;
+  // clang-format off
+  static const auto* fields = new FieldMap<ProcessStatus>{
+      {"VmPeak", &ProcessStatus::vm_peak_bytes},
+      {"VmSize", &ProcessStatus::vm_size_bytes},
+      {"VmLck", &ProcessStatus::vm_lck_bytes},
+      {"VmPin", &ProcessStatus::vm_pin_bytes},
+      {"VmHWM", &ProcessStatus::vm_hwm_bytes},
+      {"VmRSS", &ProcessStatus::vm_rss_bytes},
+      {"RssAnon", &ProcessStatus::rss_anon_bytes},
+      {"RssFile", &ProcessStatus::rss_file_bytes},
+      {"RssShmem", &ProcessStatus::rss_shmem_bytes},
+      {"VmData", &ProcessStatus::vm_data_bytes},
+      {"VmStk", &ProcessStatus::vm_stk_bytes},
+      {"VmExe", &ProcessStatus::vm_exe_bytes},
+      {"VmLib", &ProcessStatus::vm_lib_bytes},
+      {"VmPTE", &ProcessStatus::vm_pte_bytes},
+      {"VmSwap", &ProcessStatus::vm_swap_bytes},
+      {"HugetlbPages", &ProcessStatus::hugetlb_pages_bytes},
+      {"voluntary_ctxt_switches", &ProcessStatus::voluntary_ctxt_switches},
+      {"nonvoluntary_ctxt_switches", &ProcessStatus::nonvoluntary_ctxt_switches},
+  };
+  // clang-format on
+  return *fields;
+}
+
+// Reads fd from the start into buf, growing buf if the file doesn't fit.
+// Returns the number of bytes read, or -1 on error.
+ssize_t ReadFromStart(int fd, std::string* buf) {
+  size_t size = 0;
+  while (true) {
+    const ssize_t n = pread(fd, buf->data() + size, buf->size() - size, size);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    size += n;
+    // /proc files are generated whole on each read, so a read that doesn't fill the buffer has
+    // reached the end of the file.
+    if (size < buf->size()) {
+      return size;
+    }
+    buf->resize(2 * buf->size());
+  }
+}
+
+constexpr size_t kInitialBufferSize = 4096;
+
+}  // namespace
+
+ProcPIDStatsReader::ProcPIDStatsReader(const system::Config& cfg, int max_open_files)
+    : ProcPIDStatsReader(cfg.proc_path(), cfg.PageSizeBytes(), cfg.KernelTickTimeNS(),
+                         max_open_files) {}
+
+ProcPIDStatsReader::ProcPIDStatsReader(std::string proc_path, int64_t page_size_bytes,
+                                       int64_t kernel_tick_time_ns, int max_open_files)
+    : proc_base_path_(std::move(proc_path)),
+      page_size_bytes_(page_size_bytes),
+      kernel_tick_time_ns_(kernel_tick_time_ns),
+      max_open_files_(max_open_files) {
+  buf_.resize(kInitialBufferSize);
+}
+
+ProcPIDStatsReader::~ProcPIDStatsReader() {
+  for (auto& [pid, pid_files] : pid_files_) {
+    PL_UNUSED(pid);
+    ClosePIDFiles(&pid_files);
+  }
+}
+
+void ProcPIDStatsReader::ClosePIDFiles(PIDFiles* pid_files) {
+  for (int& fd : pid_files->fds) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+      --num_open_files_;
+    }
+  }
+}
+
+StatusOr<std::string_view> ProcPIDStatsReader::ReadFile(int32_t pid, File file) {
+  const int idx = FileIndex(file);
+  auto it = pid_files_.find(pid);
+  int fd = it == pid_files_.end() ? -1 : it->second.fds[idx];
+  const bool was_open = fd >= 0;
+
+  if (!was_open) {
+    path_.clear();
+    absl::StrAppend(&path_, proc_base_path_, "/", pid, "/", kFileNames[idx]);
+    fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return error::Internal("Failed to open file $0", path_);
+    }
+  }
+
+  const ssize_t size = ReadFromStart(fd, &buf_);
+  if (size < 0) {
+    // The process is gone. Any other files still open for it are stale too.
+    close(fd);
+    if (was_open) {
+      it->second.fds[idx] = -1;
+      --num_open_files_;
+    }
+    if (it != pid_files_.end()) {
+      ClosePIDFiles(&it->second);
+      pid_files_.erase(it);
+    }
+    return error::Internal("Failed to read file $0/$1/$2", proc_base_path_, pid,
+                           kFileNames[idx]);
+  }
+
+  if (!was_open) {
+    if (num_open_files_ < max_open_files_) {
+      if (it == pid_files_.end()) {
+        it = pid_files_.try_emplace(pid).first;
+        it->second.batch = batch_;
+      }
+      it->second.fds[idx] = fd;
+      ++num_open_files_;
+    } else {
+      close(fd);
+    }
+  }
+  return std::string_view(buf_.data(), size);
+}
+
+Status ProcPIDStatsReader::ReadStat(int32_t pid, ProcParser::ProcessStats* out) {
+  DCHECK(out != nullptr);
+  PL_ASSIGN_OR_RETURN(std::string_view content, ReadFile(pid, kStat));
+  return ScanStat(content, page_size_bytes_, kernel_tick_time_ns_, out);
+}
+
+Status ProcPIDStatsReader::ReadIO(int32_t pid, ProcParser::ProcessStats* out) {
+  DCHECK(out != nullptr);
+  PL_ASSIGN_OR_RETURN(std::string_view content, ReadFile(pid, kIO));
+  ScanKeyValues(content, IOFields(), out);
+  return Status::OK();
+}
+
+Status ProcPIDStatsReader::ReadStatus(int32_t pid, ProcParser::ProcessStatus* out) {
+  DCHECK(out != nullptr);
+  PL_ASSIGN_OR_RETURN(std::string_view content, ReadFile(pid, kStatus));
+  ScanKeyValues(content, StatusFields(), out);
+  return Status::OK();
+}
+
+void ProcPIDStatsReader::ReadBatch(absl::Span<const int32_t> pids, uint32_t files,
+                                   std::vector<Sample>* out) {
+  DCHECK(out != nullptr);
+  ++batch_;
+  for (size_t i = 0; i < pids.size(); ++i) {
+    const int32_t pid = pids[i];
+    auto it = pid_files_.find(pid);
+    if (it != pid_files_.end()) {
+      it->second.batch = batch_;
+    }
+
+    Sample& sample = out->emplace_back();
+    sample.pid = pid;
+    sample.index = i;
+    Status s;
+    if (files & kStat) {
+      s = ReadStat(pid, &sample.stats);
+    }
+    if (s.ok() && (files & kIO)) {
+      s = ReadIO(pid, &sample.stats);
+    }
+    if (s.ok() && (files & kStatus)) {
+      s = ReadStatus(pid, &sample.status);
+    }
+    if (!s.ok()) {
+      VLOG(1) << absl::Substitute("Failed to sample PID ($0). Error=\"$1\" skipping.", pid,
+                                  s.msg());
+      out->pop_back();
+    }
+  }
+
+  // Close the files of PIDs that are no longer sampled.
+  for (auto it = pid_files_.begin(); it != pid_files_.end();) {
+    if (it->second.batch != batch_) {
+      ClosePIDFiles(&it->second);
+      pid_files_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
+
+#include "src/common/base/base.h"
+#include "src/common/system/config.h"
+#include "src/common/system/proc_parser.h"
+
+namespace px {
+namespace system {
+
+/**
+ * ProcPIDStatsReader samples the stat, io and status files of many processes, as the stats
+ * connectors do every sampling period. Unlike ProcParser, it keeps the files of the PIDs it
+ * samples open, re-reads them with pread into one reusable buffer, and scans the fields it needs
+ * in place, so that sampling a process it has seen before neither opens files nor allocates.
+ *
+ * Keeping the files open is safe against PID reuse: an open /proc/<pid> file stays bound to
+ * the process it was opened for, and reading it fails once that process is gone, at which point
+ * the reader closes it. At most max_open_files files are kept open; files of PIDs beyond that
+ * are opened and closed on every read.
+ */
+class ProcPIDStatsReader {
+ public:
+  // The files of a PID that ReadBatch can sample, as bits of a mask.
+  enum File : uint32_t {
+    kStat = 1 << 0,
+    kIO = 1 << 1,
+    kStatus = 1 << 2,
+  };
+
+  struct Sample {
+    int32_t pid = -1;
+    // The position of the PID in the pids passed to ReadBatch. Callers that sample the same PID
+    // for several processes (e.g. a reused PID) use it to map the sample back to their own entry.
+    size_t index = 0;
+    // Populated by the stat and io files.
+    ProcParser::ProcessStats stats;
+    // Populated by the status file.
+    ProcParser::ProcessStatus status;
+  };
+
+  static constexpr int kDefaultMaxOpenFiles = 1024;
+
+  explicit ProcPIDStatsReader(const system::Config& cfg,
+                              int max_open_files = kDefaultMaxOpenFiles);
+  ProcPIDStatsReader(std::string proc_path, int64_t page_size_bytes, int64_t kernel_tick_time_ns,
+                     int max_open_files = kDefaultMaxOpenFiles);
+  ~ProcPIDStatsReader();
+
+  ProcPIDStatsReader(const ProcPIDStatsReader&) = delete;
+  ProcPIDStatsReader& operator=(const ProcPIDStatsReader&) = delete;
+
+  /**
+   * Reads /proc/<pid>/stat, like ProcParser::ParseProcPIDStat.
+   */
+  Status ReadStat(int32_t pid, ProcParser::ProcessStats* out);
+
+  /**
+   * Reads /proc/<pid>/io, like ProcParser::ParseProcPIDStatIO.
+   */
+  Status ReadIO(int32_t pid, ProcParser::ProcessStats* out);
+
+  /**
+   * Reads /proc/<pid>/status, like ProcParser::ParseProcPIDStatus.
+   */
+  Status ReadStatus(int32_t pid, ProcParser::ProcessStatus* out);
+
+  /**
+   * Reads the given files of each of the PIDs in one pass, and appends a sample for each PID
+   * whose files were all read, in the order of pids. Files kept open for PIDs that are not in pids are closed, so pids
+   * should hold every PID that the caller samples.
+   *
+   * @param pids The PIDs to sample.
+   * @param files A mask of File values.
+   * @param out The vector to append the samples to.
+   */
+  void ReadBatch(absl::Span<const int32_t> pids, uint32_t files, std::vector<Sample>* out);
+
+  int num_open_files() const { return num_open_files_; }
+
+ private:
+  static constexpr int kNumFiles = 3;
+
+  struct PIDFiles {
+    int fds[kNumFiles] = {-1, -1, -1};
+    // The ReadBatch call that last read the PID.
+    uint64_t batch = 0;
+  };
+
+  // Reads the whole file into buf_, through the PID's open descriptor if it has one.
+  StatusOr<std::string_view> ReadFile(int32_t pid, File file);
+  void ClosePIDFiles(PIDFiles* pid_files);
+
+  std::string proc_base_path_;
+  int64_t page_size_bytes_;
+  int64_t kernel_tick_time_ns_;
+  int max_open_files_;
+
+  int num_open_files_ = 0;
+  uint64_t batch_ = 0;
+  absl::flat_hash_map<int32_t, PIDFiles> pid_files_;
+
+  // Reused across reads, so that they don't allocate.
+  std::string buf_;
+  std::string path_;
+};
+
+}  // namespace system
+}  // namespace px
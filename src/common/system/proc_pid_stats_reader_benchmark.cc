@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_pid_stats_reader.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/test_environment.h"
+
+using px::system::ProcParser;
+using px::system::ProcPIDStatsReader;
+
+constexpr int kBytesPerPage = 4096;
+constexpr int kKernelTickTimeNS = 100;
+
+// Builds a /proc tree of num_pids processes, whose stat, io and status files are copies of
+// those in testdata.
+std::vector<int32_t> MakeProcTree(const std::filesystem::path& proc_path, int num_pids) {
+  const std::filesystem::path testdata =
+      px::testing::TestFilePath("src/common/system/testdata/proc");
+  std::vector<int32_t> pids;
+  for (int32_t pid = 1000; pid < 1000 + num_pids; ++pid) {
+    const std::filesystem::path pid_path = proc_path / std::to_string(pid);
+    std::filesystem::create_directory(pid_path);
+    std::filesystem::copy_file(testdata / "123/stat", pid_path / "stat");
+    std::filesystem::copy_file(testdata / "123/io", pid_path / "io");
+    std::filesystem::copy_file(testdata / "789/status", pid_path / "status");
+    pids.push_back(pid);
+  }
+  return pids;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ProcParser(benchmark::State& state) {
+  px::testing::TempDir proc_dir;
+  const std::vector<int32_t> pids = MakeProcTree(proc_dir.path(), state.range(0));
+  ProcParser parser(proc_dir.path());
+
+  for (auto _ : state) {
+    for (int32_t pid : pids) {
+      ProcParser::ProcessStats stats;
+      ProcParser::ProcessStatus status;
+      PL_CHECK_OK(parser.ParseProcPIDStat(pid, kBytesPerPage, kKernelTickTimeNS, &stats));
+      PL_CHECK_OK(parser.ParseProcPIDStatIO(pid, &stats));
+      PL_CHECK_OK(parser.ParseProcPIDStatus(pid, &status));
+      benchmark::DoNotOptimize(stats);
+      benchmark::DoNotOptimize(status);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * pids.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ProcPIDStatsReader(benchmark::State& state) {
+  px::testing::TempDir proc_dir;
+  const std::vector<int32_t> pids = MakeProcTree(proc_dir.path(), state.range(0));
+  ProcPIDStatsReader reader(proc_dir.path(), kBytesPerPage, kKernelTickTimeNS,
+                            /*max_open_files*/ 3 * pids.size());
+  std::vector<ProcPIDStatsReader::Sample> samples;
+
+  for (auto _ : state) {
+    samples.clear();
+    reader.ReadBatch(pids,
+                     ProcPIDStatsReader::kStat | ProcPIDStatsReader::kIO |
+                         ProcPIDStatsReader::kStatus,
+                     &samples);
+    CHECK_EQ(samples.size(), pids.size());
+    benchmark::DoNotOptimize(samples);
+  }
+  state.SetItemsProcessed(state.iterations() * pids.size());
+}
+
+BENCHMARK(BM_ProcParser)->Arg(100)->Arg(2000);
+BENCHMARK(BM_ProcPIDStatsReader)->Arg(100)->Arg(2000);
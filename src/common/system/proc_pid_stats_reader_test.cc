@@ -0,0 +1,177 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_pid_stats_reader.h"
+
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "src/common/testing/test_environment.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace system {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+
+class ProcPIDStatsReaderTest : public ::testing::Test {
+ protected:
+  ProcPIDStatsReaderTest()
+      : proc_path_(testing::TestFilePath("src/common/system/testdata/proc")),
+        parser_(proc_path_),
+        reader_(proc_path_, kBytesPerPage, kKernelTickTimeNS) {}
+
+  static constexpr int kBytesPerPage = 4096;
+  static constexpr int kKernelTickTimeNS = 100;
+
+  std::string proc_path_;
+  ProcParser parser_;
+  ProcPIDStatsReader reader_;
+};
+
+TEST_F(ProcPIDStatsReaderTest, ReadStatMatchesProcParser) {
+  for (int32_t pid : {123, 456}) {
+    ProcParser::ProcessStats expected;
+    ASSERT_OK(parser_.ParseProcPIDStat(pid, kBytesPerPage, kKernelTickTimeNS, &expected));
+    ProcParser::ProcessStats stats;
+    ASSERT_OK(reader_.ReadStat(pid, &stats));
+
+    EXPECT_EQ(expected.pid, stats.pid);
+    EXPECT_EQ(expected.process_name, stats.process_name);
+    EXPECT_EQ(expected.minor_faults, stats.minor_faults);
+    EXPECT_EQ(expected.major_faults, stats.major_faults);
+    EXPECT_EQ(expected.utime_ns, stats.utime_ns);
+    EXPECT_EQ(expected.ktime_ns, stats.ktime_ns);
+    EXPECT_EQ(expected.num_threads, stats.num_threads);
+    EXPECT_EQ(expected.vsize_bytes, stats.vsize_bytes);
+    EXPECT_EQ(expected.rss_bytes, stats.rss_bytes);
+  }
+}
+
+TEST_F(ProcPIDStatsReaderTest, ReadIO) {
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader_.ReadIO(123, &stats));
+  EXPECT_EQ(5405203, stats.rchar_bytes);
+  EXPECT_EQ(1239158, stats.wchar_bytes);
+  EXPECT_EQ(17838080, stats.read_bytes);
+  EXPECT_EQ(634880, stats.write_bytes);
+}
+
+TEST_F(ProcPIDStatsReaderTest, ReadStatus) {
+  ProcParser::ProcessStatus status;
+  ASSERT_OK(reader_.ReadStatus(789, &status));
+  EXPECT_EQ(24612 * 1024, status.vm_peak_bytes);
+  EXPECT_EQ(9900 * 1024, status.vm_rss_bytes);
+  EXPECT_EQ(76 * 1024, status.vm_pte_bytes);
+  EXPECT_EQ(2, status.voluntary_ctxt_switches);
+  EXPECT_EQ(2, status.nonvoluntary_ctxt_switches);
+
+  // Bad units and missing keys are treated as ProcParser treats them.
+  ProcParser::ProcessStatus bad_status;
+  ASSERT_OK(reader_.ReadStatus(1, &bad_status));
+  EXPECT_EQ(-1, bad_status.vm_peak_bytes);
+  EXPECT_EQ(-1, bad_status.vm_size_bytes);
+  EXPECT_EQ(0, bad_status.vm_lck_bytes);
+  EXPECT_EQ(1 * 1024, bad_status.vm_pin_bytes);
+  EXPECT_EQ(123, bad_status.voluntary_ctxt_switches);
+}
+
+TEST_F(ProcPIDStatsReaderTest, ReadBatch) {
+  std::vector<ProcPIDStatsReader::Sample> samples;
+  // PID 456 has no io file, and PID 1000 does not exist.
+  reader_.ReadBatch({123, 456, 1000}, ProcPIDStatsReader::kStat | ProcPIDStatsReader::kIO,
+                    &samples);
+  ASSERT_THAT(samples, ElementsAre(Field(&ProcPIDStatsReader::Sample::pid, 123)));
+  EXPECT_EQ(0, samples[0].index);
+  EXPECT_EQ("ibazel", samples[0].stats.process_name);
+  EXPECT_EQ(5405203, samples[0].stats.rchar_bytes);
+  // The files of PID 123 and the stat file of PID 456 are kept open.
+  EXPECT_EQ(3, reader_.num_open_files());
+
+  // Sampling again reads through the open files.
+  samples.clear();
+  reader_.ReadBatch({123}, ProcPIDStatsReader::kStat | ProcPIDStatsReader::kIO, &samples);
+  ASSERT_THAT(samples, ElementsAre(Field(&ProcPIDStatsReader::Sample::pid, 123)));
+  EXPECT_EQ(17838080, samples[0].stats.read_bytes);
+  EXPECT_EQ(2, reader_.num_open_files());
+
+  samples.clear();
+  reader_.ReadBatch({}, ProcPIDStatsReader::kStat, &samples);
+  EXPECT_THAT(samples, IsEmpty());
+  EXPECT_EQ(0, reader_.num_open_files());
+}
+
+TEST_F(ProcPIDStatsReaderTest, MaxOpenFiles) {
+  ProcPIDStatsReader reader(proc_path_, kBytesPerPage, kKernelTickTimeNS, /*max_open_files*/ 1);
+  std::vector<ProcPIDStatsReader::Sample> samples;
+  for (int i = 0; i < 2; ++i) {
+    reader.ReadBatch({123, 456}, ProcPIDStatsReader::kStat, &samples);
+    EXPECT_EQ(1, reader.num_open_files());
+  }
+  ASSERT_EQ(4, samples.size());
+  EXPECT_EQ(1, samples[3].index);
+  EXPECT_EQ("at-spi2-registr", samples[3].stats.process_name);
+}
+
+// A process name may contain spaces and parentheses.
+TEST(ProcPIDStatsReaderScanTest, ProcessNameWithSpaces) {
+  ASSERT_EQ(0, prctl(PR_SET_NAME, "a (b) c", 0, 0, 0));
+  ProcPIDStatsReader reader("/proc", 4096, 100);
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader.ReadStat(getpid(), &stats));
+  EXPECT_EQ(getpid(), stats.pid);
+  EXPECT_EQ("a (b) c", stats.process_name);
+  EXPECT_GT(stats.num_threads, 0);
+  EXPECT_GT(stats.rss_bytes, 0);
+}
+
+// Files kept open for a process fail to read once it exits, rather than reading another
+// process that reuses its PID.
+TEST(ProcPIDStatsReaderScanTest, ExitedProcess) {
+  const pid_t child = fork();
+  ASSERT_NE(-1, child);
+  if (child == 0) {
+    pause();
+    _exit(0);
+  }
+
+  ProcPIDStatsReader reader("/proc", 4096, 100);
+  std::vector<ProcPIDStatsReader::Sample> samples;
+  reader.ReadBatch({child}, ProcPIDStatsReader::kStat | ProcPIDStatsReader::kStatus, &samples);
+  ASSERT_EQ(1, samples.size());
+  EXPECT_EQ(child, samples[0].stats.pid);
+  EXPECT_EQ(2, reader.num_open_files());
+
+  ASSERT_EQ(0, kill(child, SIGKILL));
+  ASSERT_EQ(child, waitpid(child, nullptr, 0));
+
+  samples.clear();
+  reader.ReadBatch({child}, ProcPIDStatsReader::kStat | ProcPIDStatsReader::kStatus, &samples);
+  EXPECT_THAT(samples, IsEmpty());
+  EXPECT_EQ(0, reader.num_open_files());
+}
+
+}  // namespace system
+}  // namespace px
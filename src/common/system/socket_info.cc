@@ -78,13 +78,13 @@ NetlinkSocketProber::~NetlinkSocketProber() {
 }
 
 template <typename TDiagReqType>
-Status NetlinkSocketProber::SendDiagReq(const TDiagReqType& msg_req) {
+Status NetlinkSocketProber::SendDiagReq(const TDiagReqType& msg_req, bool dump) {
   ssize_t msg_len = sizeof(struct nlmsghdr) + sizeof(TDiagReqType);
 
   struct nlmsghdr msg_header = {};
   msg_header.nlmsg_len = msg_len;
   msg_header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
-  msg_header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  msg_header.nlmsg_flags = dump ? (NLM_F_REQUEST | NLM_F_DUMP) : NLM_F_REQUEST;
 
   struct iovec iov[2];
   iov[0].iov_base = &msg_header;
@@ -117,7 +117,7 @@ Status NetlinkSocketProber::SendDiagReq(const TDiagReqType& msg_req) {
 namespace {
 
 Status ProcessDiagMsg(const struct inet_diag_msg& diag_msg, unsigned int len,
-                      std::map<int, SocketInfo>* socket_info_entries) {
+                      SocketInfoEntries* socket_info_entries) {
   if (len < NLMSG_LENGTH(sizeof(diag_msg))) {
     return error::Internal("Not enough bytes");
   }
@@ -160,7 +160,7 @@ Status ProcessDiagMsg(const struct inet_diag_msg& diag_msg, unsigned int len,
 }
 
 Status ProcessDiagMsg(const struct unix_diag_msg& diag_msg, unsigned int len,
-                      std::map<int, SocketInfo>* socket_info_entries) {
+                      SocketInfoEntries* socket_info_entries) {
   if (len < NLMSG_LENGTH(sizeof(diag_msg))) {
     return error::Internal("Not enough bytes");
   }
@@ -211,7 +211,7 @@ Status ProcessDiagMsg(const struct unix_diag_msg& diag_msg, unsigned int len,
 }  // namespace
 
 template <typename TDiagMsgType>
-Status NetlinkSocketProber::RecvDiagResp(std::map<int, SocketInfo>* socket_info_entries) {
+Status NetlinkSocketProber::RecvDiagResp(SocketInfoEntries* socket_info_entries, bool dump) {
   static constexpr int kBufSize = 8192;
   uint8_t buf[kBufSize];
 
@@ -231,7 +231,14 @@ Status NetlinkSocketProber::RecvDiagResp(std::map<int, SocketInfo>* socket_info_
       }
 
       if (msg_header->nlmsg_type == NLMSG_ERROR) {
-        return error::Internal("Netlink error");
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+        const auto* err = reinterpret_cast<const struct nlmsgerr*>(NLMSG_DATA(msg_header));
+#pragma GCC diagnostic pop
+        if (err->error == -ENOENT) {
+          return error::NotFound("Socket not found");
+        }
+        return error::Internal("Netlink error [errno=$0]", -err->error);
       }
 
       if (msg_header->nlmsg_type != SOCK_DIAG_BY_FAMILY) {
@@ -243,6 +250,12 @@ Status NetlinkSocketProber::RecvDiagResp(std::map<int, SocketInfo>* socket_info_
       TDiagMsgType* diag_msg = reinterpret_cast<TDiagMsgType*>(NLMSG_DATA(msg_header));
 #pragma GCC diagnostic pop
       PL_RETURN_IF_ERROR(ProcessDiagMsg(*diag_msg, msg_header->nlmsg_len, socket_info_entries));
+
+      // A non-dump request is answered with a single message, without a terminating NLMSG_DONE.
+      if (!dump) {
+        done = true;
+        break;
+      }
     }
   }
 
@@ -250,7 +263,7 @@ Status NetlinkSocketProber::RecvDiagResp(std::map<int, SocketInfo>* socket_info_
 }
 
 namespace {
-void ClassifySocketRoles(std::map<int, SocketInfo>* socket_info_entries) {
+void ClassifySocketRoles(SocketInfoEntries* socket_info_entries) {
   absl::flat_hash_set<SockAddrIPv4, SockAddrIPv4HashFn, SockAddrIPv4EqFn> ipv4_listening_sockets;
   absl::flat_hash_set<SockAddrIPv6, SockAddrIPv6HashFn, SockAddrIPv6EqFn> ipv6_listening_sockets;
 
@@ -302,7 +315,7 @@ void ClassifySocketRoles(std::map<int, SocketInfo>* socket_info_entries) {
 }
 }  // namespace
 
-Status NetlinkSocketProber::InetConnections(std::map<int, SocketInfo>* socket_info_entries,
+Status NetlinkSocketProber::InetConnections(SocketInfoEntries* socket_info_entries,
                                             int conn_states) {
   struct inet_diag_req_v2 msg_req = {};
   msg_req.sdiag_protocol = IPPROTO_TCP;
@@ -326,7 +339,7 @@ Status NetlinkSocketProber::InetConnections(std::map<int, SocketInfo>* socket_in
   return Status::OK();
 }
 
-Status NetlinkSocketProber::UnixConnections(std::map<int, SocketInfo>* socket_info_entries,
+Status NetlinkSocketProber::UnixConnections(SocketInfoEntries* socket_info_entries,
                                             int conn_states) {
   struct unix_diag_req msg_req = {};
   msg_req.sdiag_family = AF_UNIX;
@@ -338,6 +351,31 @@ Status NetlinkSocketProber::UnixConnections(std::map<int, SocketInfo>* socket_in
   return Status::OK();
 }
 
+Status NetlinkSocketProber::UnixConnection(uint32_t inode_num,
+                                           SocketInfoEntries* socket_info_entries,
+                                           int conn_states) {
+  struct unix_diag_req msg_req = {};
+  msg_req.sdiag_family = AF_UNIX;
+  msg_req.udiag_ino = inode_num;
+  msg_req.udiag_show = UDIAG_SHOW_PEER;
+  // The socket is identified by its inode alone, so tell the kernel to skip the cookie check.
+  msg_req.udiag_cookie[0] = INET_DIAG_NOCOOKIE;
+  msg_req.udiag_cookie[1] = INET_DIAG_NOCOOKIE;
+
+  // Exact lookups ignore udiag_states, so the state filter is applied here instead.
+  SocketInfoEntries entries;
+  PL_RETURN_IF_ERROR(SendDiagReq(msg_req, /* dump */ false));
+  PL_RETURN_IF_ERROR(RecvDiagResp<struct unix_diag_msg>(&entries, /* dump */ false));
+
+  auto iter = entries.find(inode_num);
+  if (iter == entries.end() || (conn_states & (1 << static_cast<int>(iter->second.state))) == 0) {
+    return error::NotFound("No Unix domain socket with inode=$0 in the requested states",
+                           inode_num);
+  }
+  socket_info_entries->insert(*iter);
+  return Status::OK();
+}
+
 //-----------------------------------------------------------------------------
 // PIDsByNetNamespace
 //-----------------------------------------------------------------------------
@@ -468,63 +506,121 @@ StatusOr<std::unique_ptr<SocketInfoManager>> SocketInfoManager::Create(
   return socket_info_db_ptr;
 }
 
-StatusOr<std::map<int, SocketInfo>*> SocketInfoManager::GetNamespaceConns(uint32_t pid) {
-  PL_ASSIGN_OR_RETURN(uint32_t net_ns, NetNamespace(cfg_proc_path_, pid));
+StatusOr<SocketInfoManager::NamespaceConns*> SocketInfoManager::GetNamespace(uint32_t pid,
+                                                                            uint32_t* net_ns) {
+  PL_ASSIGN_OR_RETURN(*net_ns, NetNamespace(cfg_proc_path_, pid));
 
-  // Step 1: Get the map of connections for this network namespace.
-  // Create the map if it doesn't already exist.
-  std::map<int, SocketInfo>* namespace_conns;
+  NamespaceConns* ns_conns = &connections_[*net_ns];
+  ns_conns->access_round = current_round_;
+  return ns_conns;
+}
 
-  auto ns_iter = connections_.find(net_ns);
-  if (ns_iter != connections_.end()) {
-    // Found a map of connections for this network namespace, so use it.
-    namespace_conns = &ns_iter->second;
-  } else {
-    // No map of connections for this network namespace, so use a socker prober to populate one.
-    PL_ASSIGN_OR_RETURN(NetlinkSocketProber * socket_prober,
-                        socket_probers_->GetOrCreateSocketProber(net_ns, {static_cast<int>(pid)}));
-    DCHECK(socket_prober != nullptr);
+Status SocketInfoManager::DumpNamespaceConns(uint32_t net_ns, uint32_t pid, bool include_unix,
+                                             NamespaceConns* ns_conns) {
+  PL_ASSIGN_OR_RETURN(NetlinkSocketProber * socket_prober,
+                      socket_probers_->GetOrCreateSocketProber(net_ns, {static_cast<int>(pid)}));
+  DCHECK(socket_prober != nullptr);
 
-    ns_iter = connections_.insert(ns_iter, {net_ns, {}});
-    namespace_conns = &ns_iter->second;
+  // Dump into a fresh map, so connections that have since closed are dropped from the snapshot.
+  SocketInfoEntries conns;
+  conns.reserve(ns_conns->conns.size());
 
-    Status s;
+  Status s;
 
-    s = socket_prober->InetConnections(namespace_conns, cfg_conn_states_);
-    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe InetConnections [net_ns=$0 msg=$1]",
-                                               net_ns, s.msg());
+  s = socket_prober->InetConnections(&conns, cfg_conn_states_);
+  LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe InetConnections [net_ns=$0 msg=$1]",
+                                             net_ns, s.msg());
 
-    s = socket_prober->UnixConnections(namespace_conns, cfg_conn_states_);
-    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe UnixConnections [net_ns=$0 msg=$1]",
-                                               net_ns, s.msg());
+  if (include_unix) {
+    s = socket_prober->UnixConnections(&conns, cfg_conn_states_);
+    LOG_IF(ERROR, !s.ok()) << absl::Substitute(
+        "Failed to probe UnixConnections [net_ns=$0 msg=$1]", net_ns, s.msg());
+  }
 
-    ++num_socket_prober_calls_;
+  ++num_socket_prober_calls_;
+
+  ns_conns->conns = std::move(conns);
+  ns_conns->dump_round = current_round_;
+  ns_conns->unix_dumped = include_unix;
+
+  return Status::OK();
+}
+
+StatusOr<SocketInfoEntries*> SocketInfoManager::GetNamespaceConns(uint32_t pid) {
+  uint32_t net_ns;
+  PL_ASSIGN_OR_RETURN(NamespaceConns * ns_conns, GetNamespace(pid, &net_ns));
+
+  // All connections are requested, so make sure the snapshot is current and includes the
+  // Unix domain sockets, which Lookup() otherwise queries individually.
+  if (ns_conns->dump_round != current_round_ || !ns_conns->unix_dumped) {
+    PL_RETURN_IF_ERROR(DumpNamespaceConns(net_ns, pid, /* include_unix */ true, ns_conns));
   }
 
-  return namespace_conns;
+  return &ns_conns->conns;
 }
 
 StatusOr<SocketInfo*> SocketInfoManager::Lookup(uint32_t pid, uint32_t inode_num) {
-  // Step 1: Get the map of connections for this network namespace.
-  // Create the map if it doesn't already exist.
-  std::map<int, SocketInfo>* namespace_conns;
-  PL_ASSIGN_OR_RETURN(namespace_conns, GetNamespaceConns(pid));
+  // Step 1: Get the snapshot of connections for this network namespace.
+  uint32_t net_ns;
+  PL_ASSIGN_OR_RETURN(NamespaceConns * ns_conns, GetNamespace(pid, &net_ns));
+  SocketInfoEntries* namespace_conns = &ns_conns->conns;
 
-  // Step 2: Lookup the inode.
+  // Step 2: Lookup the inode. Entries from earlier rounds are still valid, since socket inode
+  // numbers are not reused while the socket is open.
   auto iter = namespace_conns->find(inode_num);
-  if (iter == namespace_conns->end()) {
-    return error::NotFound(
-        "Likely not a TCP/Unix connection (might be some other socket type). Alternatively, might "
-        "be looking in the wrong net namespace, which can happen if the target PID has connections "
-        "in multiple namespaces.");
+  if (iter != namespace_conns->end()) {
+    return &iter->second;
+  }
+
+  // Step 3: On a miss, re-dump the TCP connections, unless that was already done this round.
+  if (ns_conns->dump_round != current_round_) {
+    PL_RETURN_IF_ERROR(DumpNamespaceConns(net_ns, pid, /* include_unix */ false, ns_conns));
+    iter = namespace_conns->find(inode_num);
+    if (iter != namespace_conns->end()) {
+      return &iter->second;
+    }
+  }
+
+  // Step 4: Otherwise it may be a Unix domain socket, which can be queried by its inode directly.
+  if (!ns_conns->unix_dumped) {
+    PL_ASSIGN_OR_RETURN(NetlinkSocketProber * socket_prober,
+                        socket_probers_->GetOrCreateSocketProber(net_ns, {static_cast<int>(pid)}));
+    Status s = socket_prober->UnixConnection(inode_num, namespace_conns, cfg_conn_states_);
+    ++num_socket_prober_calls_;
+    if (s.ok()) {
+      return &namespace_conns->find(inode_num)->second;
+    }
+    if (!error::IsNotFound(s)) {
+      LOG(ERROR) << absl::Substitute("Failed to probe UnixConnection [net_ns=$0 msg=$1]", net_ns,
+                                     s.msg());
+    }
   }
 
-  return &iter->second;
+  return error::NotFound(
+      "Likely not a TCP/Unix connection (might be some other socket type). Alternatively, might "
+      "be looking in the wrong net namespace, which can happen if the target PID has connections "
+      "in multiple namespaces.");
 }
 
 void SocketInfoManager::Flush() {
   socket_probers_->Update();
-  connections_.clear();
+
+  // Discard snapshots of namespaces that were not accessed in the round that just ended.
+  auto iter = connections_.begin();
+  while (iter != connections_.end()) {
+    bool remove = (iter->second.access_round < current_round_);
+
+    VLOG_IF(2, remove) << absl::Substitute("SocketInfoManager: Removing entry [ns=$0]",
+                                           iter->first);
+
+    if (remove) {
+      connections_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+
+  ++current_round_;
   num_socket_prober_calls_ = 0;
 }
 
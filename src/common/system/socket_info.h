@@ -27,6 +27,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/fs/inode_utils.h"
 
@@ -83,6 +85,9 @@ struct SocketInfo {
   ClientServerRole role = ClientServerRole::kUnknown;
 };
 
+// Socket information keyed by socket inode number.
+using SocketInfoEntries = absl::flat_hash_map<int, SocketInfo>;
+
 /**
  * The NetlinkSocketProber class uses NetLink to probe the Linux kernel about active connections.
  */
@@ -114,7 +119,7 @@ class NetlinkSocketProber {
    *
    * @return error if connection information could not be obtained from kernel.
    */
-  Status InetConnections(std::map<int, SocketInfo>* socket_info_entries,
+  Status InetConnections(SocketInfoEntries* socket_info_entries,
                          int conn_states = kTCPEstablishedState);
 
   /**
@@ -126,19 +131,34 @@ class NetlinkSocketProber {
    *
    * @return error if connection information could not be obtained from kernel.
    */
-  Status UnixConnections(std::map<int, SocketInfo>* socket_info_entries,
+  Status UnixConnections(SocketInfoEntries* socket_info_entries,
                          int conn_states = kTCPEstablishedState);
 
+  /**
+   * Finds a single Unix domain socket by its inode number, without dumping all the sockets in the
+   * network namespace. Note that the kernel only supports such targeted queries for Unix domain
+   * sockets; inet_diag requires the full socket tuple instead of an inode.
+   *
+   * @param inode_num The inode number of the socket.
+   * @param socket_info_entries map of inode to SocketInfoEntry that the socket will be added to.
+   * @param conn_states bit vector of connection states to accept.
+   *
+   * @return NotFound if there is no Unix domain socket with the inode number in the requested
+   * states, or error if connection information could not be obtained from kernel.
+   */
+  Status UnixConnection(uint32_t inode_num, SocketInfoEntries* socket_info_entries,
+                        int conn_states = kTCPEstablishedState);
+
  private:
   NetlinkSocketProber() = default;
 
   Status Connect();
 
   template <typename TDiagReqType>
-  Status SendDiagReq(const TDiagReqType& msg_req);
+  Status SendDiagReq(const TDiagReqType& msg_req, bool dump = true);
 
   template <typename TDiagMsgType>
-  Status RecvDiagResp(std::map<int, SocketInfo>* socket_info_entries);
+  Status RecvDiagResp(SocketInfoEntries* socket_info_entries, bool dump = true);
 
   int fd_ = -1;
 };
@@ -248,12 +268,15 @@ class SocketProberManager {
  * There is a primary Lookup interface to query for information on a socket, by inode number.
  *
  * SocketInfoManager manages its cache at the network namespace level. If a query is made to a new
- * network namespace, the information is gathered and then cached. Future queries will operate off
+ * network namespace, the TCP connections are dumped and then cached. Future queries operate off
  * that snapshot of the known connections, for efficiency.
  *
- * Note that no attempt is made to check if new connections have been created after the snapshot is
- * established. This responsibility is on the user, who must explicitly call Flush(), so that new
- * connections can be discovered.
+ * Time is divided into rounds by calls to Flush(). A snapshot is kept across rounds, since a socket
+ * inode number uniquely identifies a socket and the endpoints of a connection do not change.
+ * A lookup that misses a snapshot from an earlier round re-dumps the namespace, so that new
+ * connections can be discovered; a snapshot is dumped at most once per round. Unix domain sockets
+ * are not dumped, but are instead queried individually by inode number on a miss.
+ * Snapshots of namespaces that were not accessed in the last round are discarded by Flush().
  */
 class SocketInfoManager {
  public:
@@ -275,7 +298,7 @@ class SocketInfoManager {
    * @return A map with inode number as key, and socket information as value. Returns error if
    * information could not be queried.
    */
-  StatusOr<std::map<int, system::SocketInfo>*> GetNamespaceConns(uint32_t pid);
+  StatusOr<SocketInfoEntries*> GetNamespaceConns(uint32_t pid);
 
   /**
    * Search for the socket info of a given inode number.
@@ -288,7 +311,8 @@ class SocketInfoManager {
   StatusOr<SocketInfo*> Lookup(uint32_t pid, uint32_t inode_num);
 
   /**
-   * Flushes the cache so new connections can be discovered.
+   * Starts a new round, so new connections can be discovered, and discards the snapshots of
+   * network namespaces that were not accessed in the last round.
    */
   void Flush();
 
@@ -303,6 +327,21 @@ class SocketInfoManager {
   SocketInfoManager(std::filesystem::path proc_path, int conn_states)
       : cfg_proc_path_(proc_path), cfg_conn_states_(conn_states) {}
 
+  // Snapshot of the connections of one network namespace.
+  struct NamespaceConns {
+    SocketInfoEntries conns;
+    // Round in which conns was last dumped from the kernel, or -1 if never.
+    int64_t dump_round = -1;
+    // Whether the last dump included Unix domain sockets.
+    bool unix_dumped = false;
+    // Round in which the namespace was last accessed.
+    int64_t access_round = -1;
+  };
+
+  StatusOr<NamespaceConns*> GetNamespace(uint32_t pid, uint32_t* net_ns);
+  Status DumpNamespaceConns(uint32_t net_ns, uint32_t pid, bool include_unix,
+                            NamespaceConns* ns_conns);
+
   const std::filesystem::path cfg_proc_path_;
 
   // The connection states that are considered this SocketInfoManager.
@@ -312,7 +351,10 @@ class SocketInfoManager {
 
   // Two-level to socket information:
   // First key is namespace inode; second key is socket inode.
-  std::map<int, std::map<int, SocketInfo>> connections_;
+  absl::flat_hash_map<uint32_t, NamespaceConns> connections_;
+
+  // The current round, advanced by Flush().
+  int64_t current_round_ = 0;
 
   // Portal through which new connection information is gathered,
   // and populated into connections_.
@@ -49,7 +49,7 @@ TEST_F(NetNamespaceTest, NetlinkSocketProber) {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
 
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     int num_conns = socket_info_entries.size();
@@ -63,7 +63,7 @@ TEST_F(NetNamespaceTest, NetlinkSocketProber) {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create(container_.process_pid()));
 
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     int num_conns = socket_info_entries.size();
@@ -75,7 +75,7 @@ TEST_F(NetNamespaceTest, NetlinkSocketProber) {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
 
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     int num_conns = socket_info_entries.size();
@@ -146,12 +146,19 @@ TEST_F(NetNamespaceTest, SocketInfoManager) {
   {
     // Non-existent inode should return nullptr.
     // 3 is very unlikely to be used as an inode number.
+    // Expect one dump of the TCP connections, and one targeted Unix domain socket query.
     const uint32_t kUnusedInode = 3;
     ASSERT_NOT_OK(socket_info_db->Lookup(kPID, kUnusedInode));
-    EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 1);
+    EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 2);
+
+    // The namespace was already dumped in this round, so only the targeted query is repeated.
+    ASSERT_NOT_OK(socket_info_db->Lookup(kPID, kUnusedInode));
+    EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 3);
   }
 
   {
+    socket_info_db->Flush();
+
     // Hacky: For the container in question, FD 6 is a valid socket FD.
     // If container is changed, or if the container is found to have races, this needs to be
     // updated. TOOD(oazizi): Make this more programmatic.
@@ -164,18 +171,16 @@ TEST_F(NetNamespaceTest, SocketInfoManager) {
     ASSERT_NE(socket_info, nullptr);
     EXPECT_EQ(socket_info->family, AF_INET);
 
-    // Expecting caching to be in effect.
-    EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 1);
+    // The snapshot from the previous round already had the connection.
+    EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 0);
 
+    socket_info_db->Flush();
     socket_info_db->Flush();
 
-    // Flush resets counter
-    EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 0);
+    // The namespace was not accessed in the last round, so its snapshot was discarded.
     ASSERT_OK_AND_ASSIGN(socket_info, socket_info_db->Lookup(kPID, inode_num));
     ASSERT_NE(socket_info, nullptr);
     EXPECT_EQ(socket_info->family, AF_INET);
-
-    // After flush, we should have made one more call.
     EXPECT_EQ(socket_info_db->num_socket_prober_calls(), 1);
   }
 }
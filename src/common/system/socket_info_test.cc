@@ -17,6 +17,7 @@
  */
 
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <unistd.h>
@@ -86,7 +87,7 @@ TEST(NetlinkSocketProberTest, EstablishedInetConnection) {
 
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                        NetlinkSocketProber::Create());
-  std::map<int, SocketInfo> socket_info_entries;
+  SocketInfoEntries socket_info_entries;
   ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPEstablishedState));
 
   EXPECT_THAT(socket_info_entries, Contains(HasLocalIPEndpoint(client_endpoint)));
@@ -137,7 +138,7 @@ TEST(NetlinkSocketProberTest, EstablishedUnixConnection) {
   // Now begin the test of NetlinkSocketProber.
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                        NetlinkSocketProber::Create());
-  std::map<int, SocketInfo> socket_info_entries;
+  SocketInfoEntries socket_info_entries;
   ASSERT_OK(socket_prober->UnixConnections(&socket_info_entries));
 
   EXPECT_THAT(socket_info_entries, Contains(HasLocalUnixEndpoint(client_socket_id)));
@@ -148,6 +149,42 @@ TEST(NetlinkSocketProberTest, EstablishedUnixConnection) {
   close(server_listen_fd);
 }
 
+TEST(NetlinkSocketProberTest, UnixConnectionByInode) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+      << absl::Substitute("socketpair() failed with errno=$0", errno);
+
+  struct stat stat_buf[2];
+  ASSERT_EQ(0, fstat(fds[0], &stat_buf[0]));
+  ASSERT_EQ(0, fstat(fds[1], &stat_buf[1]));
+  const int inode_num = stat_buf[0].st_ino;
+  const int peer_inode_num = stat_buf[1].st_ino;
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
+                       NetlinkSocketProber::Create());
+  SocketInfoEntries socket_info_entries;
+  ASSERT_OK(socket_prober->UnixConnection(inode_num, &socket_info_entries));
+
+  ASSERT_EQ(socket_info_entries.size(), 1);
+  ASSERT_TRUE(socket_info_entries.contains(inode_num));
+  const SocketInfo& socket_info = socket_info_entries[inode_num];
+  EXPECT_EQ(socket_info.family, AF_UNIX);
+  EXPECT_EQ(socket_info.local_port, inode_num);
+  EXPECT_EQ(socket_info.remote_port, peer_inode_num);
+  EXPECT_EQ(socket_info.state, TCPConnState::kEstablished);
+
+  // Not in the requested states.
+  EXPECT_NOT_OK(socket_prober->UnixConnection(peer_inode_num, &socket_info_entries,
+                                              kTCPListeningState));
+
+  close(fds[0]);
+  close(fds[1]);
+
+  // The socket no longer exists.
+  EXPECT_NOT_OK(socket_prober->UnixConnection(peer_inode_num, &socket_info_entries));
+  EXPECT_EQ(socket_info_entries.size(), 1);
+}
+
 TEST(NetlinkSocketProberTest, ListeningInetConnection) {
   TCPSocket server;
   server.BindAndListen();
@@ -158,7 +195,7 @@ TEST(NetlinkSocketProberTest, ListeningInetConnection) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPEstablishedState));
     EXPECT_THAT(socket_info_entries, Not(Contains(HasLocalIPEndpoint(server_endpoint))));
   }
@@ -167,7 +204,7 @@ TEST(NetlinkSocketProberTest, ListeningInetConnection) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPListeningState));
     EXPECT_THAT(socket_info_entries, Contains(HasLocalIPEndpoint(server_endpoint)));
   }
@@ -176,7 +213,7 @@ TEST(NetlinkSocketProberTest, ListeningInetConnection) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     EXPECT_THAT(socket_info_entries, Contains(HasLocalIPEndpoint(server_endpoint)));
@@ -195,7 +232,7 @@ TEST(NetlinkSocketProberTest, DetectRole) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
 
@@ -224,7 +261,7 @@ TEST(NetlinkSocketProberTest, DetectRole) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
 
@@ -250,7 +287,7 @@ TEST(NetlinkSocketProberTest, DetectRole) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoEntries socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPEstablishedState));
 
     int server_socket_count = 0;
@@ -290,7 +327,7 @@ TEST(NetlinkSocketProberTest, ClosedInetConnection) {
 
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                        NetlinkSocketProber::Create());
-  std::map<int, SocketInfo> socket_info_entries;
+  SocketInfoEntries socket_info_entries;
   ASSERT_OK(socket_prober->InetConnections(&socket_info_entries));
 
   EXPECT_THAT(socket_info_entries, Not(Contains(HasLocalIPEndpoint(client_endpoint))));
@@ -42,6 +42,7 @@ using ::px::Status;
 using ::px::system::kTCPEstablishedState;
 using ::px::system::kTCPListeningState;
 using ::px::system::SocketInfo;
+using ::px::system::SocketInfoEntries;
 using ::px::system::SocketInfoManager;
 
 std::string IPv4AddrToString(struct in_addr addr, in_port_t port) {
@@ -110,7 +111,7 @@ int main(int argc, char** argv) {
   if (fd == -1) {
     std::cout << absl::Substitute("Querying network namespace of pid=$0 (all connections):", pid)
               << std::endl;
-    std::map<int, SocketInfo>* namespace_conns;
+    SocketInfoEntries* namespace_conns;
     PL_ASSIGN_OR_EXIT(namespace_conns, socket_info_db->GetNamespaceConns(pid));
 
     int i = 0;
@@ -101,6 +101,14 @@ uint64_t GRPCClockConverter::Convert(uint64_t mono_time) const {
   return reftime;
 }
 
+void GRPCClockConverter::ConvertBatch(absl::Span<uint64_t> mono_times) const {
+  mono_to_realtime_->ConvertBatch(mono_times);
+  if (disable_grpc_offsets_.load()) {
+    return;
+  }
+  realtime_to_reftime_.GetBatch(mono_times);
+}
+
 }  // namespace grpc_clocksync
 }  // namespace integrations
 }  // namespace px
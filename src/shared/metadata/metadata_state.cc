@@ -67,6 +67,16 @@ const ContainerInfo* K8sMetadataState::ContainerInfoByID(CIDView id) const {
   return it->second.get();
 }
 
+ContainerInfo* K8sMetadataState::MutableContainerInfo(CIDView id) {
+  ContainerInfoSPtr* cinfo = containers_by_id_.FindMutable(id);
+
+  if (cinfo == nullptr) {
+    return nullptr;
+  }
+
+  return CopyOnWrite(cinfo);
+}
+
 UID K8sMetadataState::PodIDByName(K8sNameIdentView pod_name) const {
   auto it = pods_by_name_.find(pod_name);
   return (it == pods_by_name_.end()) ? "" : it->second;
@@ -103,15 +113,9 @@ std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
   other->pod_cidrs_ = pod_cidrs_;
   other->service_cidr_ = service_cidr_;
 
-  other->k8s_objects_by_id_.reserve(k8s_objects_by_id_.size());
-  for (const auto& [k, v] : k8s_objects_by_id_) {
-    other->k8s_objects_by_id_[k] = v->Clone();
-  }
-
-  other->containers_by_id_.reserve(containers_by_id_.size());
-  for (const auto& [k, v] : containers_by_id_) {
-    other->containers_by_id_[k] = v->Clone();
-  }
+  // The maps and objects are only copied when they are modified.
+  other->k8s_objects_by_id_ = k8s_objects_by_id_;
+  other->containers_by_id_ = containers_by_id_;
 
   other->pods_by_name_ = pods_by_name_;
   other->services_by_name_ = services_by_name_;
@@ -159,13 +163,13 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(object_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_.contains(object_uid)) {
     auto pod = std::make_unique<PodInfo>(update);
     VLOG(1) << "Adding Pod: " << pod->DebugString();
-    it = k8s_objects_by_id_.try_emplace(object_uid, std::move(pod)).first;
+    k8s_objects_by_id_.Set(object_uid, std::move(pod));
   }
-  auto pod_info = static_cast<PodInfo*>(it->second.get());
+  auto pod_info =
+      static_cast<PodInfo*>(CopyOnWrite(k8s_objects_by_id_.FindMutable(object_uid)));
 
   // We always just add to the container set even if the container is stopped.
   // We expect all cleanup to happen periodically to allow stale objects to be queried for some
@@ -174,7 +178,8 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   // state might be periodically inconsistent.
 
   for (const auto& cid : update.container_ids()) {
-    if (containers_by_id_.find(cid) == containers_by_id_.end()) {
+    ContainerInfo* container_info = MutableContainerInfo(cid);
+    if (container_info == nullptr) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
@@ -183,7 +188,7 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     }
 
     pod_info->AddContainer(cid);
-    containers_by_id_[cid]->set_pod_id(object_uid);
+    container_info->set_pod_id(object_uid);
   }
 
   pod_info->set_start_time_ns(update.start_timestamp_ns());
@@ -196,10 +201,10 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   pod_info->set_phase_message(update.message());
   pod_info->set_phase_reason(update.reason());
 
-  pods_by_name_[{ns, name}] = object_uid;
+  pods_by_name_.Set({ns, name}, object_uid);
   // Filter out daemonsets which don't have their own, unique podIP.
   if (update.host_ip() != update.pod_ip() && update.pod_ip() != "") {
-    pods_by_ip_[update.pod_ip()] = object_uid;
+    pods_by_ip_.Set(update.pod_ip(), object_uid);
   }
 
   return Status::OK();
@@ -208,21 +213,20 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
 Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
   const CID& cid = update.cid();
 
-  auto it = containers_by_id_.find(cid);
-  if (it == containers_by_id_.end()) {
+  if (!containers_by_id_.contains(cid)) {
     auto container = std::make_unique<ContainerInfo>(update);
     VLOG(1) << "Adding Container: " << container->DebugString();
-    it = containers_by_id_.try_emplace(cid, std::move(container)).first;
+    containers_by_id_.Set(cid, std::move(container));
   }
   VLOG(1) << "container update: " << update.name();
 
-  auto* container_info = it->second.get();
+  auto* container_info = MutableContainerInfo(cid);
   container_info->set_stop_time_ns(update.stop_timestamp_ns());
   container_info->set_state(ConvertToContainerState(update.container_state()));
   container_info->set_state_message(update.message());
   container_info->set_state_reason(update.reason());
 
-  containers_by_name_[update.name()] = cid;
+  containers_by_name_.Set(update.name(), cid);
 
   return Status::OK();
 }
@@ -232,25 +236,26 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(service_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_.contains(service_uid)) {
     auto service = std::make_unique<ServiceInfo>(service_uid, ns, name);
     VLOG(1) << "Adding Service: " << service->DebugString();
-    it = k8s_objects_by_id_.try_emplace(service_uid, std::move(service)).first;
+    k8s_objects_by_id_.Set(service_uid, std::move(service));
   }
-  auto service_info = static_cast<ServiceInfo*>(it->second.get());
+  auto service_info =
+      static_cast<ServiceInfo*>(CopyOnWrite(k8s_objects_by_id_.FindMutable(service_uid)));
 
   for (const auto& uid : update.pod_ids()) {
-    if (k8s_objects_by_id_.find(uid) == k8s_objects_by_id_.end()) {
+    K8sMetadataObjectSPtr* pod = k8s_objects_by_id_.FindMutable(uid);
+    if (pod == nullptr) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
       LOG(INFO) << absl::Substitute("Didn't find pod UID $0 for service $1/$2", uid, ns, name);
       continue;
     }
-    ECHECK(k8s_objects_by_id_[uid]->type() == K8sObjectType::kPod);
+    ECHECK((*pod)->type() == K8sObjectType::kPod);
     // We add the service uid to the pod. Lifetime of service still handled by the service object.
-    PodInfo* pod_info = static_cast<PodInfo*>(k8s_objects_by_id_[uid].get());
+    PodInfo* pod_info = static_cast<PodInfo*>(CopyOnWrite(pod));
     pod_info->AddService(service_uid);
   }
   if (update.start_timestamp_ns() != 0) {
@@ -260,7 +265,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
     service_info->set_stop_time_ns(update.stop_timestamp_ns());
   }
   if (update.cluster_ip() != "") {
-    services_by_cluster_ip_[update.cluster_ip()] = service_uid;
+    services_by_cluster_ip_.Set(update.cluster_ip(), service_uid);
     service_info->set_cluster_ip(update.cluster_ip());
   }
   if (update.external_ips().size()) {
@@ -270,7 +275,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   }
 
   VLOG(1) << "service update: " << update.name();
-  services_by_name_[{ns, name}] = service_uid;
+  services_by_name_.Set({ns, name}, service_uid);
   return Status::OK();
 }
 
@@ -279,20 +284,20 @@ Status K8sMetadataState::HandleNamespaceUpdate(const NamespaceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.name();
 
-  auto it = k8s_objects_by_id_.find(namespace_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  if (!k8s_objects_by_id_.contains(namespace_uid)) {
     auto ns_obj = std::make_unique<NamespaceInfo>(namespace_uid, ns, name);
     VLOG(1) << "Adding Namespace: " << ns_obj->DebugString();
-    it = k8s_objects_by_id_.try_emplace(namespace_uid, std::move(ns_obj)).first;
+    k8s_objects_by_id_.Set(namespace_uid, std::move(ns_obj));
   }
-  auto ns_info = static_cast<NamespaceInfo*>(it->second.get());
+  auto ns_info =
+      static_cast<NamespaceInfo*>(CopyOnWrite(k8s_objects_by_id_.FindMutable(namespace_uid)));
 
   ns_info->set_start_time_ns(update.start_timestamp_ns());
   ns_info->set_stop_time_ns(update.stop_timestamp_ns());
 
   VLOG(1) << "namespace update: " << update.name();
 
-  namespaces_by_name_[{ns, name}] = namespace_uid;
+  namespaces_by_name_.Set({ns, name}, namespace_uid);
   return Status::OK();
 }
 
@@ -317,19 +322,18 @@ bool IsExpired(const T& obj, int64_t retention_time, int64_t now) {
 Status K8sMetadataState::CleanupExpiredMetadata(int64_t retention_time_ns) {
   int64_t now = CurrentTimeNS();
 
-  for (auto iter = k8s_objects_by_id_.begin(); iter != k8s_objects_by_id_.end();) {
-    const auto& k8s_object = iter->second;
+  k8s_objects_by_id_.EraseIf([&](const auto& entry) {
+    const auto& k8s_object = entry.second;
 
     if (!IsExpired(*k8s_object, retention_time_ns, now)) {
-      ++iter;
-      continue;
+      return false;
     }
 
     switch (k8s_object->type()) {
       case K8sObjectType::kPod:
         if (PodIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          pods_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          pods_by_name_.erase(std::make_pair(k8s_object->ns(), k8s_object->name()));
         }
         if (PodIDByIP(static_cast<PodInfo*>(k8s_object.get())->pod_ip()) ==
             k8s_object
@@ -341,13 +345,13 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t retention_time_ns) {
       case K8sObjectType::kNamespace:
         if (NamespaceIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          namespaces_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          namespaces_by_name_.erase(std::make_pair(k8s_object->ns(), k8s_object->name()));
         }
         break;
       case K8sObjectType::kService:
         if (ServiceIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
             k8s_object->uid()) {
-          services_by_name_.erase({k8s_object->ns(), k8s_object->name()});
+          services_by_name_.erase(std::make_pair(k8s_object->ns(), k8s_object->name()));
         }
         break;
       default:
@@ -355,20 +359,19 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t retention_time_ns) {
                                         static_cast<int>(k8s_object->type()));
     }
 
-    k8s_objects_by_id_.erase(iter++);
-  }
+    return true;
+  });
 
-  for (auto iter = containers_by_id_.begin(); iter != containers_by_id_.end();) {
-    const auto& cinfo = iter->second;
+  containers_by_id_.EraseIf([&](const auto& entry) {
+    const auto& cinfo = entry.second;
 
     if (!IsExpired(*cinfo, retention_time_ns, now)) {
-      ++iter;
-      continue;
+      return false;
     }
 
     containers_by_name_.erase(cinfo->name());
-    containers_by_id_.erase(iter++);
-  }
+    return true;
+  });
 
   return Status::OK();
 }
@@ -379,10 +382,7 @@ std::shared_ptr<AgentMetadataState> AgentMetadataState::CloneToShared() const {
   state->last_update_ts_ns_ = last_update_ts_ns_;
   state->epoch_id_ = epoch_id_;
   state->k8s_metadata_state_ = k8s_metadata_state_->Clone();
-  state->pids_by_upid_.reserve(pids_by_upid_.size());
-  for (const auto& [k, v] : pids_by_upid_) {
-    state->pids_by_upid_[k] = v->Clone();
-  }
+  state->pids_by_upid_ = pids_by_upid_;
   state->upids_ = upids_;
   return state;
 }
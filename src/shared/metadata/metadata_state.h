@@ -31,6 +31,7 @@
 #include "src/shared/k8s/metadatapb/metadata.pb.h"
 #include "src/shared/metadata/k8s_objects.h"
 #include "src/shared/metadata/pids.h"
+#include "src/shared/metadata/sharded_copy_on_write_map.h"
 #include "src/shared/upid/upid.h"
 
 namespace px {
@@ -41,6 +42,21 @@ using ContainerInfoUPtr = std::unique_ptr<ContainerInfo>;
 using PIDInfoUPtr = std::unique_ptr<PIDInfo>;
 using AgentID = sole::uuid;
 
+// Metadata objects are shared by successive metadata states, and copied when they are modified.
+// See CopyOnWrite().
+using K8sMetadataObjectSPtr = std::shared_ptr<K8sMetadataObject>;
+using ContainerInfoSPtr = std::shared_ptr<ContainerInfo>;
+using PIDInfoSPtr = std::shared_ptr<PIDInfo>;
+
+/**
+ * Returns a pointer through which the metadata object owned by obj can be modified. If the object
+ * is shared with another metadata state, obj is first replaced by a clone of it.
+ */
+template <typename T>
+T* CopyOnWrite(std::shared_ptr<T>* obj) {
+  return CopyOnWrite(obj, [](T& o) { return std::shared_ptr<T>(o.Clone()); });
+}
+
 /**
  * This class contains all kubernetes relate metadata.
  */
@@ -92,15 +108,19 @@ class K8sMetadataState : NotCopyable {
       }
     };
   };
+  // The maps are shared by successive metadata states, and copied shard by shard when they are
+  // modified. See ShardedCopyOnWriteMap.
+  using K8sObjectsByIDMap = ShardedCopyOnWriteMap<UID, K8sMetadataObjectSPtr>;
+  using ContainersByIDMap = ShardedCopyOnWriteMap<CID, ContainerInfoSPtr>;
   using K8sEntityByNameMap =
-      absl::flat_hash_map<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
+      ShardedCopyOnWriteMap<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
 
   using PodsByNameMap = K8sEntityByNameMap;
   using ServicesByNameMap = K8sEntityByNameMap;
   using NamespacesByNameMap = K8sEntityByNameMap;
-  using ContainersByNameMap = absl::flat_hash_map<std::string, CID>;
-  using PodsByPodIpMap = absl::flat_hash_map<std::string, UID>;
-  using ServicesByServiceIpMap = absl::flat_hash_map<std::string, UID>;
+  using ContainersByNameMap = ShardedCopyOnWriteMap<std::string, CID>;
+  using PodsByPodIpMap = ShardedCopyOnWriteMap<std::string, UID>;
+  using ServicesByServiceIpMap = ShardedCopyOnWriteMap<std::string, UID>;
 
   void set_service_cidr(CIDRBlock cidr) {
     if (!service_cidr_.has_value() || service_cidr_.value() != cidr) {
@@ -189,6 +209,10 @@ class K8sMetadataState : NotCopyable {
    */
   UID NamespaceIDByName(K8sNameIdentView namespace_name) const;
 
+  /**
+   * Returns a copy of this state, which shares all metadata objects with this state until either
+   * state modifies them.
+   */
   std::unique_ptr<K8sMetadataState> Clone() const;
 
   Status HandlePodUpdate(const PodUpdate& update);
@@ -199,7 +223,13 @@ class K8sMetadataState : NotCopyable {
 
   Status CleanupExpiredMetadata(int64_t retention_time_ns);
 
-  absl::flat_hash_map<CID, ContainerInfoUPtr>& containers_by_id() { return containers_by_id_; }
+  const ContainersByIDMap& containers_by_id() const { return containers_by_id_; }
+
+  /**
+   * Returns the container info with the given ID for modification, or nullptr if not found.
+   */
+  ContainerInfo* MutableContainerInfo(CIDView id);
+
   std::string DebugString(int indent_level = 0) const;
 
  private:
@@ -212,10 +242,10 @@ class K8sMetadataState : NotCopyable {
   std::vector<CIDRBlock> pod_cidrs_;
 
   // This stores K8s native objects (services, pods, etc).
-  absl::flat_hash_map<UID, K8sMetadataObjectUPtr> k8s_objects_by_id_;
+  K8sObjectsByIDMap k8s_objects_by_id_;
 
   // This stores container objects, complementing k8s_objects_by_id_.
-  absl::flat_hash_map<CID, ContainerInfoUPtr> containers_by_id_;
+  ContainersByIDMap containers_by_id_;
 
   /**
    * Mapping of pods by name.
@@ -285,9 +315,13 @@ class AgentMetadataState : NotCopyable {
   K8sMetadataState* k8s_metadata_state() { return k8s_metadata_state_.get(); }
   const K8sMetadataState& k8s_metadata_state() const { return *k8s_metadata_state_; }
 
+  /**
+   * Returns a copy of this state, which shares all metadata objects with this state until either
+   * state modifies them. See K8sMetadataState::Clone().
+   */
   std::shared_ptr<AgentMetadataState> CloneToShared() const;
 
-  PIDInfo* GetPIDByUPID(UPID upid) const {
+  const PIDInfo* GetPIDByUPID(UPID upid) const {
     auto it = pids_by_upid_.find(upid);
     if (it != pids_by_upid_.end()) {
       return it->second.get();
@@ -304,16 +338,16 @@ class AgentMetadataState : NotCopyable {
   }
 
   void MarkUPIDAsStopped(UPID upid, int64_t ts) {
-    auto* pid_info = GetPIDByUPID(upid);
-    if (pid_info != nullptr) {
-      pid_info->set_stop_time_ns(ts);
+    auto it = pids_by_upid_.find(upid);
+    if (it != pids_by_upid_.end()) {
+      CopyOnWrite(&it->second)->set_stop_time_ns(ts);
       upids_.erase(upid);
     } else {
       DCHECK(!upids_.contains(upid));
     }
   }
 
-  const absl::flat_hash_map<UPID, PIDInfoUPtr>& pids_by_upid() const { return pids_by_upid_; }
+  const absl::flat_hash_map<UPID, PIDInfoSPtr>& pids_by_upid() const { return pids_by_upid_; }
 
   const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
 
@@ -347,7 +381,7 @@ class AgentMetadataState : NotCopyable {
   /**
    * Mapping of PIDs by UPID for active pods on the system.
    */
-  absl::flat_hash_map<UPID, PIDInfoUPtr> pids_by_upid_;
+  absl::flat_hash_map<UPID, PIDInfoSPtr> pids_by_upid_;
 
   /**
    * All active UPIDs. Unlike pids_by_upid_, this does not contain stopped pids.
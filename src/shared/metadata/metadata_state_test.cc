@@ -169,6 +169,50 @@ TEST(K8sMetadataStateTest, CloneCopiedCIDR) {
   EXPECT_EQ(service_cidr.prefix_length, state_copy->service_cidr()->prefix_length);
 }
 
+// Clones share the metadata objects, until one of the states modifies them.
+TEST(K8sMetadataStateTest, CloneSharesUnmodifiedObjects) {
+  auto state = std::make_unique<K8sMetadataState>();
+
+  K8sMetadataState::ContainerUpdate container_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kContainer0UpdatePbTxt, &container_update));
+  K8sMetadataState::PodUpdate pod0_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod0UpdatePbTxt, &pod0_update));
+  K8sMetadataState::PodUpdate pod2_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod2UpdatePbTxt, &pod2_update));
+
+  ASSERT_OK(state->HandleContainerUpdate(container_update));
+  ASSERT_OK(state->HandlePodUpdate(pod0_update));
+  ASSERT_OK(state->HandlePodUpdate(pod2_update));
+
+  auto state_copy = state->Clone();
+  EXPECT_EQ(state->PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ(state->PodInfoByID("pod2_uid"), state_copy->PodInfoByID("pod2_uid"));
+  EXPECT_EQ(state->ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  pod0_update.set_message("an updated pod message");
+  ASSERT_OK(state_copy->HandlePodUpdate(pod0_update));
+  state_copy->MutableContainerInfo("container0_uid")->set_stop_time_ns(200);
+
+  // The modified objects were copied, leaving the original state unchanged.
+  EXPECT_NE(state->PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ("a pod message", state->PodInfoByID("pod0_uid")->phase_message());
+  EXPECT_EQ("an updated pod message", state_copy->PodInfoByID("pod0_uid")->phase_message());
+  EXPECT_EQ(102, state->ContainerInfoByID("container0_uid")->stop_time_ns());
+  EXPECT_EQ(200, state_copy->ContainerInfoByID("container0_uid")->stop_time_ns());
+
+  // The other objects are still shared.
+  EXPECT_EQ(state->PodInfoByID("pod2_uid"), state_copy->PodInfoByID("pod2_uid"));
+
+  // Once the original state is gone, objects are modified in place.
+  state.reset();
+  const PodInfo* pod2_info = state_copy->PodInfoByID("pod2_uid");
+  pod2_update.set_message("an updated pod message");
+  ASSERT_OK(state_copy->HandlePodUpdate(pod2_update));
+  EXPECT_EQ(pod2_info, state_copy->PodInfoByID("pod2_uid"));
+  EXPECT_EQ("an updated pod message", pod2_info->phase_message());
+}
+
 TEST(K8sMetadataStateTest, HandleContainerUpdate) {
   K8sMetadataState state;
 
@@ -421,5 +465,24 @@ TEST(K8sMetadataStateTest, CleanupExpiredMetadata) {
   }
 }
 
+TEST(AgentMetadataStateTest, CloneToSharedSharesUnmodifiedPIDs) {
+  AgentMetadataState state(/* asid */ 1, /* pid */ 2);
+  UPID upid0(1, 100, 1000);
+  UPID upid1(1, 101, 1001);
+  state.AddUPID(upid0, std::make_unique<PIDInfo>(upid0, "/bin/exe", "exe", "container0_uid"));
+  state.AddUPID(upid1, std::make_unique<PIDInfo>(upid1, "/bin/exe", "exe", "container0_uid"));
+
+  std::shared_ptr<AgentMetadataState> state_copy = state.CloneToShared();
+  EXPECT_EQ(state.GetPIDByUPID(upid0), state_copy->GetPIDByUPID(upid0));
+
+  state_copy->MarkUPIDAsStopped(upid0, 5000);
+
+  EXPECT_EQ(0, state.GetPIDByUPID(upid0)->stop_time_ns());
+  EXPECT_THAT(state.upids(), UnorderedElementsAre(upid0, upid1));
+  EXPECT_EQ(5000, state_copy->GetPIDByUPID(upid0)->stop_time_ns());
+  EXPECT_THAT(state_copy->upids(), UnorderedElementsAre(upid1));
+  EXPECT_EQ(state.GetPIDByUPID(upid1), state_copy->GetPIDByUPID(upid1));
+}
+
 }  // namespace md
 }  // namespace px
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace md {
+
+/**
+ * Returns a pointer through which the object owned by obj can be modified. If the object is shared
+ * with another owner, obj is first replaced by a copy made with copy_fn, so that the other owners
+ * are unaffected.
+ */
+template <typename T, typename TCopyFn>
+T* CopyOnWrite(std::shared_ptr<T>* obj, TCopyFn copy_fn) {
+  if (obj->use_count() == 1) {
+    // The other owners may only just have released the object. This pairs with the release of
+    // their references, so that their reads happen before the caller's writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } else {
+    *obj = copy_fn(**obj);
+  }
+  return obj->get();
+}
+
+/**
+ * A hash map whose copies share its entries, until they are modified.
+ *
+ * The entries are divided into a fixed number of shards, each of which is shared by all copies of
+ * the map that have not modified it. Copying the map therefore only copies a pointer per shard, and
+ * each modification of a copy copies at most one shard.
+ *
+ * Lookups accept any key type that THash and TEq accept. Iterators remain valid while the map is
+ * modified, but do not observe the modifications made to shards that were shared.
+ */
+template <typename TKey, typename TValue,
+          typename THash = typename absl::flat_hash_map<TKey, TValue>::hasher,
+          typename TEq = typename absl::flat_hash_map<TKey, TValue, THash>::key_equal>
+class ShardedCopyOnWriteMap {
+  using Shard = absl::flat_hash_map<TKey, TValue, THash, TEq>;
+
+  static constexpr int kNumShardBits = 6;
+  static constexpr size_t kNumShards = size_t{1} << kNumShardBits;
+
+ public:
+  using key_type = TKey;
+  using mapped_type = TValue;
+  using value_type = typename Shard::value_type;
+  using size_type = size_t;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename Shard::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const_iterator() = default;
+
+    reference operator*() const { return *iter_; }
+    pointer operator->() const { return &*iter_; }
+
+    const_iterator& operator++() {
+      ++iter_;
+      SkipShardEnds();
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return shard_idx_ == other.shard_idx_ && (shard_ == nullptr || iter_ == other.iter_);
+    }
+    bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class ShardedCopyOnWriteMap<TKey, TValue, THash, TEq>;
+
+    // Positions the iterator at the first entry of the shard, or of a later shard.
+    const_iterator(const ShardedCopyOnWriteMap* map, size_t shard_idx)
+        : map_(map), shard_idx_(shard_idx) {
+      if (shard_idx_ < kNumShards) {
+        shard_ = map_->shards_[shard_idx_];
+        iter_ = shard_ != nullptr ? shard_->begin() : typename Shard::const_iterator();
+        SkipShardEnds();
+      }
+    }
+
+    const_iterator(const ShardedCopyOnWriteMap* map, size_t shard_idx,
+                   typename Shard::const_iterator iter)
+        : map_(map), shard_idx_(shard_idx), shard_(map->shards_[shard_idx]), iter_(iter) {}
+
+    void SkipShardEnds() {
+      while (shard_ == nullptr || iter_ == shard_->end()) {
+        if (++shard_idx_ == kNumShards) {
+          shard_ = nullptr;
+          return;
+        }
+        shard_ = map_->shards_[shard_idx_];
+        if (shard_ != nullptr) {
+          iter_ = shard_->begin();
+        }
+      }
+    }
+
+    const ShardedCopyOnWriteMap* map_ = nullptr;
+    size_t shard_idx_ = kNumShards;
+    // Holds the shard, in case the map replaces it while it is being iterated.
+    std::shared_ptr<const Shard> shard_;
+    typename Shard::const_iterator iter_;
+  };
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(); }
+
+  template <typename TKeyLike>
+  const_iterator find(const TKeyLike& key) const {
+    const size_t shard_idx = ShardIndex(key);
+    const Shard* shard = shards_[shard_idx].get();
+    if (shard == nullptr) {
+      return end();
+    }
+    auto iter = shard->find(key);
+    if (iter == shard->end()) {
+      return end();
+    }
+    return const_iterator(this, shard_idx, iter);
+  }
+
+  template <typename TKeyLike>
+  bool contains(const TKeyLike& key) const {
+    const Shard* shard = shards_[ShardIndex(key)].get();
+    return shard != nullptr && shard->contains(key);
+  }
+
+  /**
+   * Returns a pointer through which the value of the key can be modified, or nullptr if the key is
+   * not in the map.
+   */
+  template <typename TKeyLike>
+  TValue* FindMutable(const TKeyLike& key) {
+    const size_t shard_idx = ShardIndex(key);
+    if (!contains(key)) {
+      return nullptr;
+    }
+    Shard* shard = MutableShard(shard_idx);
+    return &shard->find(key)->second;
+  }
+
+  /**
+   * Maps the key to the value. The map is left untouched if it already maps the key to an equal
+   * value, so that a shared shard is not copied.
+   */
+  void Set(TKey key, TValue value) {
+    const size_t shard_idx = ShardIndex(key);
+    if (const Shard* shard = shards_[shard_idx].get(); shard != nullptr) {
+      auto iter = shard->find(key);
+      if (iter != shard->end() && iter->second == value) {
+        return;
+      }
+    }
+    auto [iter, inserted] =
+        MutableShard(shard_idx)->insert_or_assign(std::move(key), std::move(value));
+    size_ += inserted;
+  }
+
+  template <typename TKeyLike>
+  size_t erase(const TKeyLike& key) {
+    const size_t shard_idx = ShardIndex(key);
+    if (!contains(key)) {
+      return 0;
+    }
+    MutableShard(shard_idx)->erase(shards_[shard_idx]->find(key));
+    --size_;
+    return 1;
+  }
+
+  /**
+   * Erases the entries for which pred returns true. pred is called once for each entry, and may
+   * modify other maps. Only the shards that contain matching entries are modified.
+   */
+  template <typename TPred>
+  void EraseIf(TPred pred) {
+    std::vector<TKey> keys;
+    for (size_t i = 0; i < kNumShards; ++i) {
+      if (shards_[i] == nullptr) {
+        continue;
+      }
+      keys.clear();
+      for (const auto& entry : *shards_[i]) {
+        if (pred(entry)) {
+          keys.push_back(entry.first);
+        }
+      }
+      if (keys.empty()) {
+        continue;
+      }
+      Shard* shard = MutableShard(i);
+      for (const auto& key : keys) {
+        shard->erase(key);
+      }
+      size_ -= keys.size();
+    }
+  }
+
+ private:
+  template <typename TKeyLike>
+  static size_t ShardIndex(const TKeyLike& key) {
+    // Use the high bits of the hash, since the shards' own tables select slots with the low bits.
+    return THash{}(key) >> (sizeof(size_t) * 8 - kNumShardBits);
+  }
+
+  Shard* MutableShard(size_t shard_idx) {
+    std::shared_ptr<Shard>& shard = shards_[shard_idx];
+    if (shard == nullptr) {
+      shard = std::make_shared<Shard>();
+      return shard.get();
+    }
+    return CopyOnWrite(&shard, [](const Shard& s) { return std::make_shared<Shard>(s); });
+  }
+
+  // A null shard is empty.
+  std::array<std::shared_ptr<Shard>, kNumShards> shards_;
+  size_t size_ = 0;
+};
+
+}  // namespace md
+}  // namespace px
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/shared/metadata/sharded_copy_on_write_map.h"
+
+namespace px {
+namespace md {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(ShardedCopyOnWriteMapTest, Basic) {
+  ShardedCopyOnWriteMap<std::string, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+
+  map.Set("a", 1);
+  map.Set("b", 2);
+  map.Set("a", 3);
+  EXPECT_EQ(2, map.size());
+  EXPECT_THAT(map, UnorderedElementsAre(Pair("a", 3), Pair("b", 2)));
+
+  std::string_view key = "b";
+  ASSERT_NE(map.find(key), map.end());
+  EXPECT_EQ(2, map.find(key)->second);
+  EXPECT_TRUE(map.contains("a"));
+  EXPECT_EQ(map.find("c"), map.end());
+  EXPECT_EQ(nullptr, map.FindMutable("c"));
+
+  *map.FindMutable("b") = 4;
+  EXPECT_EQ(4, map.find("b")->second);
+
+  EXPECT_EQ(1, map.erase("a"));
+  EXPECT_EQ(0, map.erase("a"));
+  EXPECT_THAT(map, UnorderedElementsAre(Pair("b", 4)));
+}
+
+TEST(ShardedCopyOnWriteMapTest, CopiesAreIndependent) {
+  ShardedCopyOnWriteMap<int, int> map;
+  for (int i = 0; i < 1000; ++i) {
+    map.Set(i, i);
+  }
+
+  ShardedCopyOnWriteMap<int, int> copy = map;
+  const int* value_in_map = &map.find(1)->second;
+  EXPECT_EQ(value_in_map, &copy.find(1)->second);
+
+  *copy.FindMutable(1) = -1;
+  copy.Set(1001, 1001);
+  copy.erase(2);
+  copy.EraseIf([](const auto& entry) { return entry.first % 100 == 0; });
+
+  EXPECT_EQ(1000, map.size());
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_NE(map.find(i), map.end());
+    EXPECT_EQ(i, map.find(i)->second);
+  }
+  EXPECT_EQ(value_in_map, &map.find(1)->second);
+
+  EXPECT_EQ(-1, copy.find(1)->second);
+  EXPECT_FALSE(copy.contains(0));
+  EXPECT_FALSE(copy.contains(2));
+  EXPECT_TRUE(copy.contains(1001));
+  EXPECT_EQ(990, copy.size());
+
+  int num_entries = 0;
+  for (const auto& [k, v] : copy) {
+    EXPECT_EQ(k == 1 ? -1 : k, v);
+    ++num_entries;
+  }
+  EXPECT_EQ(990, num_entries);
+}
+
+TEST(ShardedCopyOnWriteMapTest, SetSameValueKeepsShardShared) {
+  ShardedCopyOnWriteMap<std::string, int> map;
+  map.Set("a", 1);
+
+  ShardedCopyOnWriteMap<std::string, int> copy = map;
+  copy.Set("a", 1);
+  EXPECT_EQ(&map.find("a")->second, &copy.find("a")->second);
+
+  copy.Set("a", 2);
+  EXPECT_NE(&map.find("a")->second, &copy.find("a")->second);
+  EXPECT_EQ(1, map.find("a")->second);
+}
+
+// Iterators keep visiting the entries they started with, while the map is modified.
+TEST(ShardedCopyOnWriteMapTest, ModifyWhileIterating) {
+  ShardedCopyOnWriteMap<int, int> map;
+  for (int i = 0; i < 1000; ++i) {
+    map.Set(i, i);
+  }
+  ShardedCopyOnWriteMap<int, int> copy = map;
+  map = ShardedCopyOnWriteMap<int, int>();
+
+  std::vector<int> keys;
+  for (const auto& [k, v] : copy) {
+    keys.push_back(k);
+    *copy.FindMutable(k) = v + 1;
+  }
+  EXPECT_EQ(1000, keys.size());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i + 1, copy.find(i)->second);
+  }
+}
+
+}  // namespace md
+}  // namespace px
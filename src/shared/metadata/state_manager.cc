@@ -169,6 +169,19 @@ StatusOr<UPID> InitUPID(const system::ProcParser& proc_parser, uint32_t asid, ui
   return UPID(asid, pid, pid_start_time);
 }
 
+// Returns true if the PIDs of upids are exactly pids.
+bool SamePIDs(const StartTimeOrderedUPIDSet& upids, const absl::flat_hash_set<uint32_t>& pids) {
+  if (upids.size() != pids.size()) {
+    return false;
+  }
+  for (const auto& upid : upids) {
+    if (!pids.contains(upid.pid())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 void ProcessContainerPIDUpdates(
@@ -256,7 +269,7 @@ Status ProcessPIDUpdates(
     if (pod_info->stop_time_ns() != 0) {
       VLOG(1) << absl::Substitute("Found a running container in a deleted pod [cid=$0, pod_id=$1]",
                                   cid, pod_id);
-      cinfo->set_stop_time_ns(pod_info->stop_time_ns());
+      k8s_md_state->MutableContainerInfo(cid)->set_stop_time_ns(pod_info->stop_time_ns());
       continue;
     }
 
@@ -274,16 +287,24 @@ Status ProcessPIDUpdates(
       // NOTE: Currently, MDS sends pods that do no belong to this Agent, so this is actually
       // required to avoid repeatedly printing out the warning message above.
       if (error::IsNotFound(s)) {
-        cinfo->set_stop_time_ns(ts);
-        for (const auto& upid : cinfo->active_upids()) {
+        ContainerInfo* mutable_cinfo = k8s_md_state->MutableContainerInfo(cid);
+        mutable_cinfo->set_stop_time_ns(ts);
+        for (const auto& upid : mutable_cinfo->active_upids()) {
           md->MarkUPIDAsStopped(upid, ts);
         }
-        cinfo->mutable_active_upids()->clear();
+        mutable_cinfo->mutable_active_upids()->clear();
       }
       continue;
     }
 
-    ProcessContainerPIDUpdates(cid, ts, proc_parser, md, cinfo->mutable_active_upids(),
+    // Most containers have the same PIDs as in the previous update. Leave them untouched, so that
+    // they remain shared with the previous state rather than being copied.
+    if (SamePIDs(cinfo->active_upids(), cgroups_active_pids)) {
+      continue;
+    }
+
+    ProcessContainerPIDUpdates(cid, ts, proc_parser, md,
+                               k8s_md_state->MutableContainerInfo(cid)->mutable_active_upids(),
                                &cgroups_active_pids, pid_updates);
   }
 
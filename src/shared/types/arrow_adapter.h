@@ -19,6 +19,7 @@
 #pragma once
 
 #include <arrow/array.h>
+#include <arrow/buffer.h>
 #include <arrow/memory_pool.h>
 
 #include <algorithm>
@@ -26,6 +27,7 @@
 #include <memory>
 #include <numeric>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -98,6 +100,82 @@ inline std::shared_ptr<arrow::Array> ToArrow<StringValue>(const std::vector<Stri
   return arr;
 }
 
+namespace internal {
+
+template <typename T>
+struct VectorHolder {
+  std::vector<T> vec;
+};
+
+/**
+ * An arrow::Buffer that owns the std::vector backing it. The holder base is initialized before
+ * arrow::Buffer, so the buffer can point into the already moved-in vector.
+ */
+template <typename T>
+class VectorBuffer : private VectorHolder<T>, public arrow::Buffer {
+ public:
+  explicit VectorBuffer(std::vector<T>&& data)
+      : VectorHolder<T>{std::move(data)},
+        arrow::Buffer(reinterpret_cast<const uint8_t*>(this->vec.data()),
+                      static_cast<int64_t>(this->vec.size() * sizeof(T))) {}
+};
+
+template <typename TUDFValue>
+inline std::shared_ptr<arrow::Array> WrapVectorAsArrow(std::vector<TUDFValue>&& data,
+                                                       std::shared_ptr<arrow::DataType> type) {
+  using NativeType = typename ValueTypeTraits<TUDFValue>::native_type;
+  static_assert(sizeof(TUDFValue) == sizeof(NativeType));
+  static_assert(std::is_standard_layout_v<TUDFValue>);
+
+  // The buffer keeps the whole allocation alive, while memory accounting only sees the values.
+  // Release the unused capacity of over-reserved vectors, so the two stay close.
+  if (data.capacity() - data.size() > data.size() / 4) {
+    data.shrink_to_fit();
+  }
+
+  auto length = static_cast<int64_t>(data.size());
+  auto buffer = std::make_shared<VectorBuffer<TUDFValue>>(std::move(data));
+  return arrow::MakeArray(arrow::ArrayData::Make(std::move(type), length, {nullptr, buffer},
+                                                 /* null_count */ 0));
+}
+
+}  // namespace internal
+
+// Whether MoveToArrow hands the storage of a column of the given type over to arrow without a copy.
+inline bool MovesToArrowWithoutCopy(DataType data_type) {
+  return data_type == DataType::INT64 || data_type == DataType::FLOAT64 ||
+         data_type == DataType::TIME64NS;
+}
+
+// MoveToArrow is like ToArrow, but consumes the input vector. Types whose in-memory layout
+// matches arrow's (int64, float64, time64) hand their storage over to the arrow::Array without a
+// copy. The remaining types are converted with ToArrow and the input is released.
+template <typename TUDFValue>
+inline std::shared_ptr<arrow::Array> MoveToArrow(std::vector<TUDFValue>&& data,
+                                                 arrow::MemoryPool* mem_pool) {
+  auto arr = ToArrow(data, mem_pool);
+  std::vector<TUDFValue>().swap(data);
+  return arr;
+}
+
+template <>
+inline std::shared_ptr<arrow::Array> MoveToArrow<Int64Value>(std::vector<Int64Value>&& data,
+                                                             arrow::MemoryPool*) {
+  return internal::WrapVectorAsArrow(std::move(data), arrow::int64());
+}
+
+template <>
+inline std::shared_ptr<arrow::Array> MoveToArrow<Float64Value>(std::vector<Float64Value>&& data,
+                                                               arrow::MemoryPool*) {
+  return internal::WrapVectorAsArrow(std::move(data), arrow::float64());
+}
+
+template <>
+inline std::shared_ptr<arrow::Array> MoveToArrow<Time64NSValue>(
+    std::vector<Time64NSValue>&& data, arrow::MemoryPool*) {
+  return internal::WrapVectorAsArrow(std::move(data), arrow::time64(arrow::TimeUnit::NANO));
+}
+
 /**
  * Find the UDFDataType for a given arrow type.
  * @param arrow_type The arrow type.
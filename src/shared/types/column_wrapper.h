@@ -67,9 +67,13 @@ class ColumnWrapper {
   virtual int64_t Bytes() const = 0;
 
   virtual void Reserve(size_t size) = 0;
+  virtual void Resize(size_t size) = 0;
   virtual void Clear() = 0;
   virtual void ShrinkToFit() = 0;
   virtual std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* mem_pool) = 0;
+  // Like ConvertToArrow, but moves the data into the arrow::Array where the layouts allow it.
+  // The wrapper is left empty, so it should only be called by the wrapper's sole owner.
+  virtual std::shared_ptr<arrow::Array> MoveToArrow(arrow::MemoryPool* mem_pool) = 0;
   // GetView returns an empty string view for all non-string columns.
   virtual std::string_view GetView(size_t idx) const = 0;
 
@@ -125,6 +129,10 @@ class ColumnWrapperTmpl : public ColumnWrapper {
     return ToArrow(data_, mem_pool);
   }
 
+  std::shared_ptr<arrow::Array> MoveToArrow(arrow::MemoryPool* mem_pool) override {
+    return types::MoveToArrow(std::move(data_), mem_pool);
+  }
+
   T operator[](size_t idx) const { return data_[idx]; }
 
   T& operator[](size_t idx) { return data_[idx]; }
@@ -135,7 +143,7 @@ class ColumnWrapperTmpl : public ColumnWrapper {
 
   void ShrinkToFit() override { data_.shrink_to_fit(); }
 
-  void Resize(size_t size) { data_.resize(size); }
+  void Resize(size_t size) override { data_.resize(size); }
 
   void Clear() override { data_.clear(); }
 
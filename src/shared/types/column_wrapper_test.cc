@@ -200,6 +200,55 @@ TEST(ColumnWrapperTest, FromVectorString) {
   EXPECT_TRUE(actual_arr->Equals(expected_arr));
 }
 
+TEST(ColumnWrapperTest, MoveToArrowInt64) {
+  auto wrapper = ColumnWrapper::Make(DataType::INT64, 0);
+  wrapper->AppendFromVector(std::vector<types::Int64Value>{4, 2, 3, 1});
+  const auto* raw_data = wrapper->UnsafeRawData();
+
+  auto actual_arr = wrapper->MoveToArrow(arrow::default_memory_pool());
+  EXPECT_EQ(DataTypeTraits<DataType::INT64>::arrow_type_id, actual_arr->type_id());
+  EXPECT_TRUE(actual_arr->Equals(
+      ToArrow(std::vector<types::Int64Value>{4, 2, 3, 1}, arrow::default_memory_pool())));
+
+  // The arrow array should take over the wrapper's storage, rather than copy it.
+  auto* int_arr = static_cast<arrow::Int64Array*>(actual_arr.get());
+  EXPECT_EQ(reinterpret_cast<const int64_t*>(raw_data), int_arr->raw_values());
+  EXPECT_EQ(0, wrapper->Size());
+}
+
+TEST(ColumnWrapperTest, MoveToArrowOverReserved) {
+  auto wrapper = ColumnWrapper::Make(DataType::FLOAT64, 0);
+  wrapper->Reserve(1024);
+  wrapper->AppendFromVector(std::vector<types::Float64Value>{1.5, 2.5});
+
+  auto actual_arr = wrapper->MoveToArrow(arrow::default_memory_pool());
+  EXPECT_TRUE(actual_arr->Equals(
+      ToArrow(std::vector<types::Float64Value>{1.5, 2.5}, arrow::default_memory_pool())));
+  EXPECT_EQ(0, wrapper->Size());
+}
+
+TEST(ColumnWrapperTest, MoveToArrowTime64NS) {
+  auto wrapper = ColumnWrapper::Make(DataType::TIME64NS, 0);
+  wrapper->AppendFromVector(std::vector<types::Time64NSValue>{1, 2, 3});
+
+  auto actual_arr = wrapper->MoveToArrow(arrow::default_memory_pool());
+  EXPECT_EQ(DataTypeTraits<DataType::TIME64NS>::arrow_type_id, actual_arr->type_id());
+  EXPECT_TRUE(actual_arr->Equals(
+      ToArrow(std::vector<types::Time64NSValue>{1, 2, 3}, arrow::default_memory_pool())));
+  EXPECT_EQ(0, wrapper->Size());
+}
+
+TEST(ColumnWrapperTest, MoveToArrowString) {
+  auto wrapper = ColumnWrapper::Make(DataType::STRING, 0);
+  std::vector<types::StringValue> string_vector({"abc", "def", "ghi", "jkl"});
+  wrapper->AppendFromVector(string_vector);
+
+  auto actual_arr = wrapper->MoveToArrow(arrow::default_memory_pool());
+  EXPECT_EQ(DataTypeTraits<DataType::STRING>::arrow_type_id, actual_arr->type_id());
+  EXPECT_TRUE(actual_arr->Equals(ToArrow(string_vector, arrow::default_memory_pool())));
+  EXPECT_EQ(0, wrapper->Size());
+}
+
 TEST(ColumnWrapperTest, CopyIndexes) {
   using ::testing::ElementsAreArray;
 
@@ -18,6 +18,8 @@
 
 #include "src/stirling/core/connector_context.h"
 
+#include <dirent.h>
+
 namespace px {
 namespace stirling {
 
@@ -57,46 +59,112 @@ Status StandaloneContext::SetClusterCIDR(std::string_view cidr_str) {
   return Status::OK();
 }
 
+namespace {
+
+md::PIDInfoUPtr ReadPIDInfo(const system::ProcParser& proc_parser, const md::UPID& upid) {
+  std::string exe_path = proc_parser.GetExePath(upid.pid()).ValueOr("");
+  std::string cmdline = proc_parser.GetPIDCmdline(upid.pid());
+  return std::make_unique<md::PIDInfo>(upid, std::move(exe_path), std::move(cmdline),
+                                       /*cid*/ md::CID{});
+}
+
+std::shared_ptr<const StandaloneProcesses> ReadProcesses(absl::flat_hash_set<md::UPID> upids,
+                                                         const std::filesystem::path& proc_path) {
+  auto processes = std::make_shared<StandaloneProcesses>();
+  system::ProcParser proc_parser(proc_path);
+  for (const auto& upid : upids) {
+    processes->pid_info_by_upid[upid] = ReadPIDInfo(proc_parser, upid);
+  }
+  processes->upids = std::move(upids);
+  return processes;
+}
+
+}  // namespace
+
 StandaloneContext::StandaloneContext(absl::flat_hash_set<md::UPID> upids,
                                      const std::filesystem::path& proc_path)
-    : upids_(std::move(upids)) {
+    : StandaloneContext(ReadProcesses(std::move(upids), proc_path)) {}
+
+StandaloneContext::StandaloneContext(std::shared_ptr<const StandaloneProcesses> processes)
+    : processes_(std::move(processes)) {
+  DCHECK(processes_ != nullptr);
   // Cannot be empty, otherwise stirling will wait indefinitely. Since StandaloneContext is used
   // for local environment, set it such that localhost (127.0.0.1) will be treated as outside of
   // cluster, and --treat_loopback_as_in_cluster in conn_tracker.cc will take effect.
   // TODO(yzhao): Might need to include IPv6 version when tests for IPv6 are added.
   PL_CHECK_OK(SetClusterCIDR("0.0.0.1/32"));
+}
 
-  system::ProcParser proc_parser(proc_path);
-  for (auto upid : upids_) {
-    std::string exe_path = proc_parser.GetExePath(upid.pid()).ValueOr("");
-    std::string cmdline = proc_parser.GetPIDCmdline(upid.pid());
-    auto pid_info = std::make_unique<md::PIDInfo>(upid, std::move(exe_path), std::move(cmdline),
-                                                  /*cid*/ md::CID{});
-    upid_pidinfo_map_[upid] = std::move(pid_info);
+ProcUPIDScanner::ProcUPIDScanner(std::filesystem::path proc_path, uint32_t asid)
+    : proc_path_(std::move(proc_path)), asid_(asid) {}
+
+std::shared_ptr<const StandaloneProcesses> ProcUPIDScanner::Scan() {
+  absl::MutexLock lock(&mu_);
+
+  DIR* dir = opendir(proc_path_.c_str());
+  if (dir == nullptr) {
+    LOG(ERROR) << absl::Substitute("Could not list $0.", proc_path_.string());
+    return processes_ != nullptr ? processes_ : std::make_shared<StandaloneProcesses>();
   }
-}
 
-// Returns the list of processes from the proc filesystem. Used by StandaloneContext.
-absl::flat_hash_set<md::UPID> ListUPIDs(const std::filesystem::path& proc_path, uint32_t asid) {
-  absl::flat_hash_set<md::UPID> pids;
-  for (const auto& p : std::filesystem::directory_iterator(proc_path)) {
+  absl::flat_hash_map<uint32_t, PIDEntry> pid_entries;
+  pid_entries.reserve(pid_entries_.size());
+  bool changed = false;
+  for (struct dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
     uint32_t pid = 0;
-    if (!absl::SimpleAtoi(p.path().filename().string(), &pid)) {
+    if (!absl::SimpleAtoi(entry->d_name, &pid)) {
       continue;
     }
-    StatusOr<int64_t> pid_start_time = system::GetPIDStartTimeTicks(p.path());
+
+    auto iter = pid_entries_.find(pid);
+    if (iter != pid_entries_.end() && iter->second.ino == entry->d_ino) {
+      pid_entries.emplace(pid, iter->second);
+      continue;
+    }
+
+    StatusOr<int64_t> pid_start_time = system::GetPIDStartTimeTicks(proc_path_ / entry->d_name);
     if (!pid_start_time.ok()) {
       VLOG(1) << absl::Substitute("Could not get PID start time for pid $0. Likely already dead.",
-                                  p.path().string());
+                                  pid);
       continue;
     }
-    pids.emplace(asid, pid, pid_start_time.ValueOrDie());
+    md::UPID upid(asid_, pid, pid_start_time.ValueOrDie());
+    changed |= iter == pid_entries_.end() || iter->second.upid != upid;
+    pid_entries.emplace(pid, PIDEntry{entry->d_ino, upid});
   }
-  return pids;
+  closedir(dir);
+
+  // Any process that exited leaves the scan with fewer PIDs than it would otherwise have.
+  changed |= pid_entries.size() != pid_entries_.size();
+  pid_entries_ = std::move(pid_entries);
+  if (!changed && processes_ != nullptr) {
+    return processes_;
+  }
+
+  auto processes = std::make_shared<StandaloneProcesses>();
+  system::ProcParser proc_parser(proc_path_);
+  for (const auto& entry : pid_entries_) {
+    const md::UPID& upid = entry.second.upid;
+    processes->upids.insert(upid);
+    // Processes from the previous scan share their PID info, rather than re-reading it.
+    if (processes_ != nullptr) {
+      auto pid_info_iter = processes_->pid_info_by_upid.find(upid);
+      if (pid_info_iter != processes_->pid_info_by_upid.end()) {
+        processes->pid_info_by_upid[upid] = pid_info_iter->second;
+        continue;
+      }
+    }
+    processes->pid_info_by_upid[upid] = ReadPIDInfo(proc_parser, upid);
+  }
+  processes_ = std::move(processes);
+  return processes_;
 }
 
 SystemWideStandaloneContext::SystemWideStandaloneContext(const std::filesystem::path& proc_path)
-    : StandaloneContext(ListUPIDs(proc_path, /*asid*/ 0), proc_path) {}
+    : StandaloneContext(ProcUPIDScanner(proc_path).Scan()) {}
+
+SystemWideStandaloneContext::SystemWideStandaloneContext(ProcUPIDScanner* scanner)
+    : StandaloneContext(scanner->Scan()) {}
 
 }  // namespace stirling
 }  // namespace px
@@ -18,11 +18,15 @@
 
 #pragma once
 
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/common/base/base.h"
 #include "src/shared/metadata/metadata_state.h"
 #include "src/shared/types/types.h"
@@ -52,7 +56,7 @@ class ConnectorContext {
   /**
    * Return detailed information on UPIDs.
    */
-  virtual const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const = 0;
+  virtual const absl::flat_hash_map<md::UPID, md::PIDInfoSPtr>& GetPIDInfoMap() const = 0;
 
   /**
    * Return K8s information (Pod and container information)
@@ -89,7 +93,7 @@ class AgentContext : public ConnectorContext {
     return agent_metadata_state_->upids();
   }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
+  const absl::flat_hash_map<md::UPID, md::PIDInfoSPtr>& GetPIDInfoMap() const override {
     return agent_metadata_state_->pids_by_upid();
   }
 
@@ -103,6 +107,47 @@ class AgentContext : public ConnectorContext {
   std::shared_ptr<const md::AgentMetadataState> agent_metadata_state_;
 };
 
+/**
+ * The processes of a StandaloneContext.
+ */
+struct StandaloneProcesses {
+  absl::flat_hash_set<md::UPID> upids;
+  absl::flat_hash_map<md::UPID, md::PIDInfoSPtr> pid_info_by_upid;
+};
+
+/**
+ * Tracks the processes in a proc filesystem across repeated scans, for contexts that are built
+ * on every iteration. A scan lists the PID directories, but only reads the start time, exe and
+ * cmdline of processes that are new since the previous scan: a PID whose directory entry has the
+ * same inode as before is the same process, since procfs gives the directory of each new process
+ * a new inode.
+ */
+class ProcUPIDScanner : NotCopyMoveable {
+ public:
+  explicit ProcUPIDScanner(
+      std::filesystem::path proc_path = system::Config::GetInstance().proc_path(),
+      uint32_t asid = 0);
+
+  /**
+   * Scans the proc filesystem. Returns the same processes as the previous scan did if no process
+   * started or exited since. Thread-safe.
+   */
+  std::shared_ptr<const StandaloneProcesses> Scan();
+
+ private:
+  struct PIDEntry {
+    ino_t ino;
+    md::UPID upid;
+  };
+
+  const std::filesystem::path proc_path_;
+  const uint32_t asid_;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<uint32_t, PIDEntry> pid_entries_ ABSL_GUARDED_BY(mu_);
+  std::shared_ptr<const StandaloneProcesses> processes_ ABSL_GUARDED_BY(mu_);
+};
+
 /**
  * This context is used when Stirling is running stand-alone, not as part of PEM.
  * See specific variants below.
@@ -115,10 +160,10 @@ class StandaloneContext : public ConnectorContext {
 
   uint32_t GetASID() const override { return 0; }
 
-  const absl::flat_hash_set<md::UPID>& GetUPIDs() const override { return upids_; }
+  const absl::flat_hash_set<md::UPID>& GetUPIDs() const override { return processes_->upids; }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
-    return upid_pidinfo_map_;
+  const absl::flat_hash_map<md::UPID, md::PIDInfoSPtr>& GetPIDInfoMap() const override {
+    return processes_->pid_info_by_upid;
   }
 
   const md::K8sMetadataState& GetK8SMetadata() override {
@@ -131,10 +176,10 @@ class StandaloneContext : public ConnectorContext {
   Status SetClusterCIDR(std::string_view cidr_str);
 
  protected:
-  absl::flat_hash_set<md::UPID> upids_;
-  absl::flat_hash_map<md::UPID, md::PIDInfoUPtr> upid_pidinfo_map_;
+  explicit StandaloneContext(std::shared_ptr<const StandaloneProcesses> processes);
 
  private:
+  std::shared_ptr<const StandaloneProcesses> processes_;
   std::vector<CIDRBlock> cidrs_;
 };
 
@@ -145,6 +190,12 @@ class SystemWideStandaloneContext : public StandaloneContext {
  public:
   explicit SystemWideStandaloneContext(
       const std::filesystem::path& proc_path = system::Config::GetInstance().proc_path());
+
+  /**
+   * Uses the scanner to find the processes, which only reads the processes that are new since
+   * its previous scan.
+   */
+  explicit SystemWideStandaloneContext(ProcUPIDScanner* scanner);
 };
 
 }  // namespace stirling
@@ -20,6 +20,7 @@
 
 #include "src/stirling/core/connector_context.h"
 
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/testing.h"
 
 using ::px::testing::TestFilePath;
@@ -37,5 +38,43 @@ TEST(SystemWideStandaloneContextTest, ListUPIDs) {
                                    md::UPID{0, 456, 17594622}, md::UPID{0, 789, 46120203}));
 }
 
+// Tests that the scanner only reads the processes that are new since its previous scan.
+TEST(ProcUPIDScannerTest, IncrementalScan) {
+  const std::filesystem::path testdata_path = TestFilePath("src/common/system/testdata/proc");
+  px::testing::TempDir proc_dir;
+  auto add_pid = [&](std::string_view pid) {
+    std::filesystem::create_directory(proc_dir.path() / pid);
+    std::filesystem::copy_file(testdata_path / pid / "stat", proc_dir.path() / pid / "stat");
+  };
+
+  ProcUPIDScanner scanner(proc_dir.path());
+  add_pid("123");
+  std::shared_ptr<const StandaloneProcesses> processes = scanner.Scan();
+  EXPECT_THAT(processes->upids, UnorderedElementsAre(md::UPID{0, 123, 14329}));
+  ASSERT_EQ(processes->pid_info_by_upid.size(), 1);
+
+  // Nothing changed, so the previous scan is returned as is.
+  EXPECT_EQ(scanner.Scan(), processes);
+
+  // A known PID is not re-read, so a rewritten stat file goes unnoticed.
+  std::filesystem::copy_file(testdata_path / "456/stat", proc_dir.path() / "123/stat",
+                             std::filesystem::copy_options::overwrite_existing);
+  EXPECT_EQ(scanner.Scan(), processes);
+
+  add_pid("789");
+  processes = scanner.Scan();
+  EXPECT_THAT(processes->upids,
+              UnorderedElementsAre(md::UPID{0, 123, 14329}, md::UPID{0, 789, 46120203}));
+  EXPECT_EQ(processes->pid_info_by_upid.size(), 2);
+
+  std::filesystem::remove_all(proc_dir.path() / "123");
+  processes = scanner.Scan();
+  EXPECT_THAT(processes->upids, UnorderedElementsAre(md::UPID{0, 789, 46120203}));
+  EXPECT_EQ(processes->pid_info_by_upid.size(), 1);
+
+  SystemWideStandaloneContext ctx(&scanner);
+  EXPECT_THAT(ctx.GetUPIDs(), UnorderedElementsAre(md::UPID{0, 789, 46120203}));
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -59,68 +60,107 @@ Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   return &tablet;
 }
 
+namespace {
+
+// Reorders the records of the tablet by time. Each column is moved exactly once.
+void SortByTime(Tablet* tablet) {
+  std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet->times);
+  for (auto& col : tablet->records) {
+    col = col->MoveIndexes(sort_indexes);
+  }
+
+  std::vector<uint64_t> times(sort_indexes.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    times[i] = tablet->times[sort_indexes[i]];
+  }
+  tablet->times = std::move(times);
+  tablet->times_sorted = true;
+}
+
+// Returns the indexes {begin, begin + 1, ..., end - 1}.
+std::vector<size_t> IndexRange(size_t begin, size_t end) {
+  std::vector<size_t> indexes(end - begin);
+  std::iota(indexes.begin(), indexes.end(), begin);
+  return indexes;
+}
+
+}  // namespace
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
   uint64_t next_start_time = start_time_;
 
+  // End time is cutoff time + 1, so the binary searches below produce the following
+  // classification:
+  //   expired < start_time
+  //   pushable < end_time
+  uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
+                                               : std::numeric_limits<uint64_t>::max();
+
   for (auto& [tablet_id, tablet] : tablets_) {
-    // Sort based on times.
-    std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
-
-    // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
-    // classification: which classified according to:
-    //   expired < start_time
-    //   pushable <= end_time
-    uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
-                                                 : std::numeric_limits<uint64_t>::max();
-
-    // Split the indexes into three groups:
-    // 1) Expired indexes: these are too old to return.
-    // 2) Pushable indexes: these are the ones that we return.
-    // 3) Carryover indexes: these are too new to return, so hold on to them until the next round.
-    auto positions =
-        utils::SplitSortedVector<2>(tablet.times, sort_indexes, {start_time_, end_time});
-    int num_expired = positions[0];
-    int num_pushable = positions[1] - positions[0];
-    int num_carryover = tablet.times.size() - positions[1];
+    if (tablet.times.empty()) {
+      continue;
+    }
+
+    // Most sources append records in time order, in which case there is nothing to reorder.
+    if (!tablet.times_sorted) {
+      SortByTime(&tablet);
+    }
+    const std::vector<uint64_t>& times = tablet.times;
+
+    // Split the records into three contiguous ranges:
+    // 1) Expired records: these are too old to return.
+    // 2) Pushable records: these are the ones that we return.
+    // 3) Carryover records: these are too new to return, so hold on to them until the next round.
+    size_t pushable_begin =
+        std::lower_bound(times.begin(), times.end(), start_time_) - times.begin();
+    size_t carryover_begin =
+        std::lower_bound(times.begin() + pushable_begin, times.end(), end_time) - times.begin();
+    size_t num_expired = pushable_begin;
+    size_t num_pushable = carryover_begin - pushable_begin;
+    size_t num_carryover = times.size() - carryover_begin;
 
     // Case 1: Expired records. Just print a message.
     VLOG_IF(1, num_expired > 0) << absl::Substitute(
         "$0 records for table $1 dropped due to late arrival [cutoff time=$2, oldest event "
         "time=$3].",
-        num_expired, table_schema_.name(), end_time, tablet.times[sort_indexes[0]]);
-
-    // Case 2: Pushable records. Copy to output.
-    if (num_pushable > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
-                                       sort_indexes.end() - num_carryover);
-      types::ColumnWrapperRecordBatch pushable_records;
-      for (auto& col : tablet.records) {
-        pushable_records.push_back(col->MoveIndexes(push_indexes));
-      }
-      uint64_t last_time = tablet.times[push_indexes.back()];
-      next_start_time = std::max(next_start_time, last_time);
-      tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
-    }
+        num_expired, table_schema_.name(), end_time, times[0]);
 
-    // Case 3: Carryover records.
+    // Case 3: Carryover records. These are moved out first, so that the columns end with the
+    // pushable records.
     if (num_carryover > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> carryover_indexes(sort_indexes.begin() + num_pushable,
-                                            sort_indexes.end());
-      types::ColumnWrapperRecordBatch carryover_records;
+      std::vector<size_t> carryover_indexes = IndexRange(carryover_begin, times.size());
+      Tablet& carryover_tablet = carryover_tablets[tablet_id];
+      carryover_tablet.tablet_id = tablet_id;
+      carryover_tablet.times.assign(times.begin() + carryover_begin, times.end());
       for (auto& col : tablet.records) {
-        carryover_records.push_back(col->MoveIndexes(carryover_indexes));
+        carryover_tablet.records.push_back(col->MoveIndexes(carryover_indexes));
+        col->Resize(carryover_begin);
       }
+    }
 
-      std::vector<uint64_t> times(carryover_indexes.size());
-      for (size_t i = 0; i < times.size(); ++i) {
-        times[i] = tablet.times[carryover_indexes[i]];
+    // Case 2: Pushable records. Without expired records, the columns now hold exactly the
+    // pushable records, so they are handed over without a copy.
+    if (num_pushable > 0) {
+      types::ColumnWrapperRecordBatch pushable_records;
+      if (num_expired == 0) {
+        pushable_records = std::move(tablet.records);
+        // The columns were reserved for kTargetCapacity records. Don't hand the unused capacity
+        // of a small batch over to the table store, which only accounts for the records.
+        if (num_pushable < kTargetCapacity / 2) {
+          for (auto& col : pushable_records) {
+            col->ShrinkToFit();
+          }
+        }
+      } else {
+        std::vector<size_t> push_indexes = IndexRange(pushable_begin, carryover_begin);
+        for (auto& col : tablet.records) {
+          pushable_records.push_back(col->MoveIndexes(push_indexes));
+        }
       }
-      carryover_tablets[tablet_id] =
-          Tablet{tablet_id, std::move(times), std::move(carryover_records)};
+      next_start_time = std::max(next_start_time, times[carryover_begin - 1]);
+      tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
     }
   }
   tablets_ = std::move(carryover_tablets);
@@ -43,9 +43,17 @@ struct TaggedRecordBatch {
 
 struct Tablet {
   types::TabletID tablet_id;
-  // TODO(oazizi): Convert this vector into a heap of {time, index} objects.
   std::vector<uint64_t> times;
   types::ColumnWrapperRecordBatch records;
+
+  // Records are stored in arrival order, which for most sources is also time order.
+  // Tracks whether that is still the case, so ConsumeRecords() only reorders when it has to.
+  bool times_sorted = true;
+
+  void AppendTime(uint64_t time) {
+    times_sorted = times_sorted && (times.empty() || times.back() <= time);
+    times.push_back(time);
+  }
 };
 
 class DataTable : public NotCopyable {
@@ -191,7 +199,7 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema->elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
     }
 
     Tablet& tablet_;
@@ -247,7 +255,7 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema_.elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
       LOG_IF(DFATAL, schema_.elements().size() > kMaxSupportedColumns) << absl::Substitute(
           "Tables with more than $0 columns are not supported.", kMaxSupportedColumns);
     }
@@ -314,6 +314,61 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+// Records that are expired, pushable and carried over, all in the same round.
+// The carried over records should be exactly the ones beyond the cutoff time.
+TEST_F(DataTableTest, CarryoverWithExpiry) {
+  auto append = [this](int t) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), t);
+    r.Append<r.ColIndex("time_")>(t);
+    r.Append<r.ColIndex("x")>(t / 10);
+    r.Append<r.ColIndex("s")>(std::to_string(t));
+  };
+
+  {
+    for (int t : {0, 10, 20, 30}) {
+      append(t);
+    }
+
+    data_table_->SetConsumeRecordsCutoffTime(20);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    ASSERT_EQ(tablets[0].records[0]->Size(), 3);
+  }
+
+  // Time 15 is expired, times 30 and 40 are pushable, and time 50 is carried over.
+  {
+    for (int t : {40, 15, 50}) {
+      append(t);
+    }
+
+    data_table_->SetConsumeRecordsCutoffTime(40);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+
+    ASSERT_EQ(rb[0]->Size(), 2);
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(0), 30);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "30");
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(1), 40);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(1), "40");
+  }
+
+  {
+    data_table_->SetConsumeRecordsCutoffTime(100);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+
+    ASSERT_EQ(rb[0]->Size(), 1);
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(0), 50);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 5);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "50");
+  }
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
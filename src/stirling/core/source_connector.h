@@ -105,6 +105,14 @@ class SourceConnector : public NotCopyable {
     return sysconfig_.ConvertToRealTime(monotonic_time);
   }
 
+  /**
+   * Converts a batch of monotonic times to real time, in place. Cheaper than converting the times
+   * one at a time, particularly when they are sorted.
+   */
+  void ConvertToRealTime(absl::Span<uint64_t> monotonic_times) const {
+    sysconfig_.ConvertToRealTime(monotonic_times);
+  }
+
   // Use this version of the clock, instead of CurrentTimeNS(), when generating a timestamp
   // for comparison against BPF event timestamps. This is to make sure the clocks are generated
   // in the exact same way.
@@ -0,0 +1,446 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/dwarf_index.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "src/common/fs/fs_wrapper.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Value encoding
+//-----------------------------------------------------------------------------
+
+// Values are encoded as a status code, followed by either the error message or the lookup result.
+// Integers are fixed-width and in host byte order; strings are length-prefixed.
+
+class ValueWriter {
+ public:
+  explicit ValueWriter(std::string* out) : out_(out) {}
+
+  template <typename TIntType>
+  void Int(TIntType val) {
+    out_->append(reinterpret_cast<const char*>(&val), sizeof(val));
+  }
+
+  void Str(std::string_view str) {
+    Int<uint64_t>(str.size());
+    out_->append(str);
+  }
+
+ private:
+  std::string* out_;
+};
+
+class ValueReader {
+ public:
+  explicit ValueReader(std::string_view buf) : buf_(buf) {}
+
+  template <typename TIntType>
+  StatusOr<TIntType> Int() {
+    if (buf_.size() < sizeof(TIntType)) {
+      return error::ResourceUnavailable("Truncated DWARF index value.");
+    }
+    TIntType val;
+    std::memcpy(&val, buf_.data(), sizeof(val));
+    buf_.remove_prefix(sizeof(val));
+    return val;
+  }
+
+  StatusOr<std::string_view> Str() {
+    PL_ASSIGN_OR_RETURN(uint64_t size, Int<uint64_t>());
+    if (buf_.size() < size) {
+      return error::ResourceUnavailable("Truncated DWARF index value.");
+    }
+    std::string_view str = buf_.substr(0, size);
+    buf_.remove_prefix(size);
+    return str;
+  }
+
+ private:
+  std::string_view buf_;
+};
+
+void Encode(uint64_t val, ValueWriter* w) { w->Int(val); }
+
+Status Decode(ValueReader* r, uint64_t* val) {
+  PL_ASSIGN_OR_RETURN(*val, r->Int<uint64_t>());
+  return Status::OK();
+}
+
+void Encode(const TypeInfo& val, ValueWriter* w) {
+  w->Int(static_cast<uint8_t>(val.type));
+  w->Str(val.type_name);
+  w->Str(val.decl_type);
+}
+
+Status Decode(ValueReader* r, TypeInfo* val) {
+  PL_ASSIGN_OR_RETURN(uint8_t type, r->Int<uint8_t>());
+  val->type = static_cast<VarType>(type);
+  PL_ASSIGN_OR_RETURN(val->type_name, r->Str());
+  PL_ASSIGN_OR_RETURN(val->decl_type, r->Str());
+  return Status::OK();
+}
+
+void Encode(const VarLocation& val, ValueWriter* w) {
+  w->Int(static_cast<uint8_t>(val.loc_type));
+  w->Int(val.offset);
+  w->Int<uint64_t>(val.registers.size());
+  for (RegisterName reg : val.registers) {
+    w->Int(static_cast<int32_t>(reg));
+  }
+}
+
+Status Decode(ValueReader* r, VarLocation* val) {
+  PL_ASSIGN_OR_RETURN(uint8_t loc_type, r->Int<uint8_t>());
+  val->loc_type = static_cast<LocationType>(loc_type);
+  PL_ASSIGN_OR_RETURN(val->offset, r->Int<int64_t>());
+  PL_ASSIGN_OR_RETURN(uint64_t num_registers, r->Int<uint64_t>());
+  val->registers.clear();
+  for (uint64_t i = 0; i < num_registers; ++i) {
+    PL_ASSIGN_OR_RETURN(int32_t reg, r->Int<int32_t>());
+    val->registers.push_back(static_cast<RegisterName>(reg));
+  }
+  return Status::OK();
+}
+
+void Encode(const StructMemberInfo& val, ValueWriter* w) {
+  w->Int(val.offset);
+  Encode(val.type_info, w);
+}
+
+Status Decode(ValueReader* r, StructMemberInfo* val) {
+  PL_ASSIGN_OR_RETURN(val->offset, r->Int<uint64_t>());
+  return Decode(r, &val->type_info);
+}
+
+void Encode(const std::vector<StructSpecEntry>& val, ValueWriter* w) {
+  w->Int<uint64_t>(val.size());
+  for (const StructSpecEntry& entry : val) {
+    w->Int(entry.offset);
+    w->Int(entry.size);
+    Encode(entry.type_info, w);
+    w->Str(entry.path);
+  }
+}
+
+Status Decode(ValueReader* r, std::vector<StructSpecEntry>* val) {
+  PL_ASSIGN_OR_RETURN(uint64_t num_entries, r->Int<uint64_t>());
+  val->clear();
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    StructSpecEntry entry;
+    PL_ASSIGN_OR_RETURN(entry.offset, r->Int<uint64_t>());
+    PL_ASSIGN_OR_RETURN(entry.size, r->Int<uint64_t>());
+    PL_RETURN_IF_ERROR(Decode(r, &entry.type_info));
+    PL_ASSIGN_OR_RETURN(entry.path, r->Str());
+    val->push_back(std::move(entry));
+  }
+  return Status::OK();
+}
+
+void Encode(const std::map<std::string, ArgInfo>& val, ValueWriter* w) {
+  w->Int<uint64_t>(val.size());
+  for (const auto& [name, arg] : val) {
+    w->Str(name);
+    Encode(arg.type_info, w);
+    Encode(arg.location, w);
+    w->Int<uint8_t>(arg.retarg);
+  }
+}
+
+Status Decode(ValueReader* r, std::map<std::string, ArgInfo>* val) {
+  PL_ASSIGN_OR_RETURN(uint64_t num_args, r->Int<uint64_t>());
+  val->clear();
+  for (uint64_t i = 0; i < num_args; ++i) {
+    PL_ASSIGN_OR_RETURN(std::string_view name, r->Str());
+    ArgInfo& arg = (*val)[std::string(name)];
+    PL_RETURN_IF_ERROR(Decode(r, &arg.type_info));
+    PL_RETURN_IF_ERROR(Decode(r, &arg.location));
+    PL_ASSIGN_OR_RETURN(uint8_t retarg, r->Int<uint8_t>());
+    arg.retarg = retarg != 0;
+  }
+  return Status::OK();
+}
+
+void Encode(const RetValInfo& val, ValueWriter* w) {
+  Encode(val.type_info, w);
+  w->Int<uint64_t>(val.byte_size);
+}
+
+Status Decode(ValueReader* r, RetValInfo* val) {
+  PL_RETURN_IF_ERROR(Decode(r, &val->type_info));
+  PL_ASSIGN_OR_RETURN(val->byte_size, r->Int<uint64_t>());
+  return Status::OK();
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+// DwarfIndex
+//-----------------------------------------------------------------------------
+
+std::unique_ptr<DwarfIndex> DwarfIndex::Create() {
+  return std::unique_ptr<DwarfIndex>(new DwarfIndex);
+}
+
+StatusOr<std::unique_ptr<DwarfIndex>> DwarfIndex::Open(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to open DWARF index file $0 ($1)", path.string(),
+                           std::strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Failed to stat DWARF index file $0 ($1)", path.string(),
+                           std::strerror(errno));
+  }
+  const size_t length = st.st_size;
+  if (length < sizeof(DwarfIndexFileHeader)) {
+    return error::Internal("DWARF index file $0 is truncated", path.string());
+  }
+
+  void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Failed to mmap DWARF index file $0 ($1)", path.string(),
+                           std::strerror(errno));
+  }
+
+  auto index = std::unique_ptr<DwarfIndex>(new DwarfIndex);
+  index->addr_ = addr;
+  index->length_ = length;
+
+  const auto* base = static_cast<const char*>(addr);
+  const auto* header = reinterpret_cast<const DwarfIndexFileHeader*>(base);
+  if (std::memcmp(header->magic, DwarfIndexFileHeader::kMagic, sizeof(header->magic)) != 0 ||
+      header->version != DwarfIndexFileHeader::kVersion ||
+      header->lookup_version != DwarfIndexFileHeader::kLookupVersion) {
+    return error::Internal("DWARF index file $0 has an unexpected format", path.string());
+  }
+
+  const size_t entries_bytes = header->num_entries * sizeof(DwarfIndexFileEntry);
+  if (sizeof(DwarfIndexFileHeader) + entries_bytes + header->data_size != length ||
+      header->compiler_size > header->data_size) {
+    return error::Internal("DWARF index file $0 has an inconsistent size", path.string());
+  }
+
+  index->entries_ =
+      reinterpret_cast<const DwarfIndexFileEntry*>(base + sizeof(DwarfIndexFileHeader));
+  index->num_mapped_entries_ = header->num_entries;
+  index->data_ = base + sizeof(DwarfIndexFileHeader) + entries_bytes;
+  index->source_language_ = static_cast<llvm::dwarf::SourceLanguage>(header->source_language);
+  index->compiler_ = std::string_view(index->data_, header->compiler_size);
+
+  // Validate references once here, so that lookups can trust the offsets.
+  for (size_t i = 0; i < index->num_mapped_entries_; ++i) {
+    const DwarfIndexFileEntry& e = index->entries_[i];
+    if (e.key_offset > header->data_size || e.key_size > header->data_size - e.key_offset ||
+        e.value_offset > header->data_size || e.value_size > header->data_size - e.value_offset) {
+      return error::Internal("DWARF index file $0 has an out-of-range entry $1", path.string(),
+                             i);
+    }
+  }
+
+  return index;
+}
+
+DwarfIndex::~DwarfIndex() {
+  if (addr_ != nullptr) {
+    munmap(addr_, length_);
+  }
+}
+
+std::string DwarfIndex::Key(DwarfLookupType type, std::initializer_list<std::string_view> parts) {
+  std::string key(1, static_cast<char>(type));
+  for (std::string_view part : parts) {
+    key.append(part);
+    key.push_back('\0');
+  }
+  return key;
+}
+
+std::optional<std::string_view> DwarfIndex::FindEncoded(std::string_view key) const {
+  const DwarfIndexFileEntry* end = entries_ + num_mapped_entries_;
+  auto key_of = [this](const DwarfIndexFileEntry& e) {
+    return std::string_view(data_ + e.key_offset, e.key_size);
+  };
+  const DwarfIndexFileEntry* iter = std::lower_bound(
+      entries_, end, key,
+      [&key_of](const DwarfIndexFileEntry& e, std::string_view k) { return key_of(e) < k; });
+  if (iter != end && key_of(*iter) == key) {
+    return std::string_view(data_ + iter->value_offset, iter->value_size);
+  }
+
+  auto inserted_iter = inserted_.find(key);
+  if (inserted_iter != inserted_.end()) {
+    return inserted_iter->second;
+  }
+  return std::nullopt;
+}
+
+template <typename TValueType>
+std::optional<StatusOr<TValueType>> DwarfIndex::Find(std::string_view key) const {
+  std::optional<std::string_view> encoded = FindEncoded(key);
+  if (!encoded.has_value()) {
+    return std::nullopt;
+  }
+
+  ValueReader r(encoded.value());
+  StatusOr<int32_t> code = r.Int<int32_t>();
+  if (!code.ok()) {
+    return std::nullopt;
+  }
+  if (code.ValueOrDie() != statuspb::OK) {
+    StatusOr<std::string_view> msg = r.Str();
+    if (!msg.ok()) {
+      return std::nullopt;
+    }
+    return StatusOr<TValueType>(Status(static_cast<statuspb::Code>(code.ValueOrDie()),
+                                       std::string(msg.ValueOrDie())));
+  }
+
+  TValueType value;
+  if (!Decode(&r, &value).ok()) {
+    // A corrupt entry is treated as a miss, so the caller falls back to reading DWARF.
+    return std::nullopt;
+  }
+  return StatusOr<TValueType>(std::move(value));
+}
+
+bool DwarfIndex::IsRecordable(const Status& status) {
+  switch (status.code()) {
+    case statuspb::OK:
+    case statuspb::INVALID_ARGUMENT:
+    case statuspb::NOT_FOUND:
+    case statuspb::UNIMPLEMENTED:
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <typename TValueType>
+void DwarfIndex::Insert(std::string key, const StatusOr<TValueType>& value) {
+  std::string encoded;
+  ValueWriter w(&encoded);
+  w.Int<int32_t>(value.code());
+  if (value.ok()) {
+    Encode(value.ValueOrDie(), &w);
+  } else {
+    w.Str(value.msg());
+  }
+  inserted_.emplace(std::move(key), std::move(encoded));
+}
+
+#define INSTANTIATE_DWARF_INDEX_VALUE_TYPE(TValueType)                                        \
+  template std::optional<StatusOr<TValueType>> DwarfIndex::Find<TValueType>(std::string_view) \
+      const;                                                                                  \
+  template void DwarfIndex::Insert<TValueType>(std::string, const StatusOr<TValueType>&);
+
+// The macro would split a template argument containing a comma.
+using ArgInfoMap = std::map<std::string, ArgInfo>;
+
+INSTANTIATE_DWARF_INDEX_VALUE_TYPE(uint64_t)
+INSTANTIATE_DWARF_INDEX_VALUE_TYPE(StructMemberInfo)
+INSTANTIATE_DWARF_INDEX_VALUE_TYPE(std::vector<StructSpecEntry>)
+INSTANTIATE_DWARF_INDEX_VALUE_TYPE(VarLocation)
+INSTANTIATE_DWARF_INDEX_VALUE_TYPE(ArgInfoMap)
+INSTANTIATE_DWARF_INDEX_VALUE_TYPE(RetValInfo)
+
+#undef INSTANTIATE_DWARF_INDEX_VALUE_TYPE
+
+Status DwarfIndex::Persist(const std::filesystem::path& path,
+                           llvm::dwarf::SourceLanguage source_language,
+                           std::string_view compiler) const {
+  std::string data(compiler);
+  std::vector<DwarfIndexFileEntry> entries;
+  entries.reserve(num_entries());
+
+  auto append_entry = [&data, &entries](std::string_view key, std::string_view value) {
+    DwarfIndexFileEntry entry;
+    entry.key_offset = data.size();
+    entry.key_size = key.size();
+    data.append(key);
+    entry.value_offset = data.size();
+    entry.value_size = value.size();
+    data.append(value);
+    entries.push_back(entry);
+  };
+
+  // Merge the mapped and inserted entries, which are both sorted by key.
+  size_t i = 0;
+  auto inserted_iter = inserted_.begin();
+  while (i < num_mapped_entries_ || inserted_iter != inserted_.end()) {
+    std::string_view mapped_key;
+    if (i < num_mapped_entries_) {
+      mapped_key = std::string_view(data_ + entries_[i].key_offset, entries_[i].key_size);
+    }
+    if (inserted_iter == inserted_.end() ||
+        (i < num_mapped_entries_ && mapped_key < inserted_iter->first)) {
+      append_entry(mapped_key,
+                   std::string_view(data_ + entries_[i].value_offset, entries_[i].value_size));
+      ++i;
+    } else {
+      append_entry(inserted_iter->first, inserted_iter->second);
+      ++inserted_iter;
+    }
+  }
+
+  DwarfIndexFileHeader header = {};
+  std::memcpy(header.magic, DwarfIndexFileHeader::kMagic, sizeof(header.magic));
+  header.version = DwarfIndexFileHeader::kVersion;
+  header.lookup_version = DwarfIndexFileHeader::kLookupVersion;
+  header.source_language = source_language;
+  header.num_entries = entries.size();
+  header.compiler_size = compiler.size();
+  header.data_size = data.size();
+
+  std::string contents;
+  contents.reserve(sizeof(header) + entries.size() * sizeof(DwarfIndexFileEntry) + data.size());
+  contents.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  contents.append(reinterpret_cast<const char*>(entries.data()),
+                  entries.size() * sizeof(DwarfIndexFileEntry));
+  contents.append(data);
+
+  return fs::WriteFileAtomically(path, contents);
+}
+
+std::filesystem::path DwarfIndexFilePath(const std::filesystem::path& index_dir,
+                                         std::string_view build_id) {
+  return index_dir / absl::StrCat(build_id, ".v", DwarfIndexFileHeader::kVersion, ".",
+                                  DwarfIndexFileHeader::kLookupVersion, ".dwarfidx");
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <llvm/BinaryFormat/Dwarf.h>
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/stirling/obj_tools/dwarf_reader.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * On-disk layout of a persisted DWARF index (see DwarfIndex::Persist()).
+ *
+ *   DwarfIndexFileHeader
+ *   DwarfIndexFileEntry[num_entries]   (sorted by key)
+ *   char[data_size]                    (compiler string, followed by keys and encoded values)
+ *
+ * All fields are in host byte order; the file is only meant to be read back on the same node.
+ */
+struct DwarfIndexFileHeader {
+  static constexpr char kMagic[8] = {'P', 'X', 'D', 'W', 'I', 'D', 'X', '\0'};
+  static constexpr uint32_t kVersion = 2;
+  // Version of the DwarfReader lookup logic whose results are recorded. Bump it with any change
+  // to DwarfReader that can change the result or error of a lookup, so that indexes recorded by
+  // the old logic are no longer used.
+  static constexpr uint32_t kLookupVersion = 2;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t lookup_version;
+  uint32_t source_language;
+  uint32_t reserved;
+  uint64_t num_entries;
+  uint64_t compiler_size;
+  uint64_t data_size;
+};
+
+struct DwarfIndexFileEntry {
+  uint64_t key_offset;
+  uint64_t key_size;
+  uint64_t value_offset;
+  uint64_t value_size;
+};
+
+/**
+ * The DwarfReader lookups whose results are recorded in a DwarfIndex.
+ */
+enum class DwarfLookupType : uint8_t {
+  kStructByteSize = 1,
+  kStructMemberInfo,
+  kStructSpec,
+  kArgumentTypeByteSize,
+  kArgumentLocation,
+  kFunctionArgInfo,
+  kFunctionRetValInfo,
+};
+
+/**
+ * A compact record of the results of DwarfReader lookups for a single binary.
+ *
+ * Rather than indexing every DIE up front, entries are added on demand, as lookups are issued.
+ * Successful results and definite errors, such as NotFound, are recorded, since the answer for a
+ * given build-ID never changes as long as the lookup logic does not (see
+ * DwarfIndexFileHeader::kLookupVersion).
+ * Recorded entries can be persisted to a file keyed by the build-ID of the binary and the index
+ * versions, which is memory-mapped on subsequent opens. A warm index answers lookups with a binary
+ * search over the mapped file, without parsing any DWARF information.
+ *
+ * Not thread-safe.
+ */
+class DwarfIndex : public NotCopyMoveable {
+ public:
+  /**
+   * Creates an empty index.
+   */
+  static std::unique_ptr<DwarfIndex> Create();
+
+  /**
+   * Opens an index file produced by Persist().
+   */
+  static StatusOr<std::unique_ptr<DwarfIndex>> Open(const std::filesystem::path& path);
+
+  ~DwarfIndex();
+
+  /**
+   * Builds the key for a lookup of the given type. The parts are the arguments of the lookup.
+   */
+  static std::string Key(DwarfLookupType type, std::initializer_list<std::string_view> parts);
+
+  /**
+   * Returns the recorded result for the key, or std::nullopt if the lookup was never recorded.
+   * Supported value types are the return types of the DwarfReader lookups listed in
+   * DwarfLookupType.
+   */
+  template <typename TValueType>
+  std::optional<StatusOr<TValueType>> Find(std::string_view key) const;
+
+  /**
+   * Whether a lookup result can be recorded. Only values and errors that describe the binary
+   * itself (not found, invalid or unsupported DWARF information) are. Internal errors, which can
+   * come from transient failures such as I/O errors, and resource or system errors may not recur
+   * on a retry, so they are not recorded, since the index is persisted.
+   */
+  template <typename TValueType>
+  static bool IsRecordable(const StatusOr<TValueType>& value) {
+    return IsRecordable(value.status());
+  }
+  static bool IsRecordable(const Status& status);
+
+  /**
+   * Records the result of a lookup that is not yet in the index.
+   * The result must be recordable, see IsRecordable().
+   */
+  template <typename TValueType>
+  void Insert(std::string key, const StatusOr<TValueType>& value);
+
+  /**
+   * Writes all entries, both mapped and newly inserted, to the specified file.
+   * The file is replaced atomically, so concurrent readers only ever see a complete index.
+   */
+  Status Persist(const std::filesystem::path& path, llvm::dwarf::SourceLanguage source_language,
+                 std::string_view compiler) const;
+
+  /**
+   * Whether entries were inserted since the index was created or opened.
+   */
+  bool modified() const { return !inserted_.empty(); }
+
+  size_t num_entries() const { return num_mapped_entries_ + inserted_.size(); }
+
+  // The source language and compiler recorded in the index file.
+  // Only meaningful for an index returned by Open().
+  llvm::dwarf::SourceLanguage source_language() const { return source_language_; }
+  std::string_view compiler() const { return compiler_; }
+
+ private:
+  DwarfIndex() = default;
+
+  std::optional<std::string_view> FindEncoded(std::string_view key) const;
+
+  void* addr_ = nullptr;
+  size_t length_ = 0;
+
+  const DwarfIndexFileEntry* entries_ = nullptr;
+  size_t num_mapped_entries_ = 0;
+  const char* data_ = nullptr;
+
+  llvm::dwarf::SourceLanguage source_language_ = {};
+  std::string_view compiler_;
+
+  // Entries inserted since open; ordered so Persist() can merge them with the mapped entries.
+  std::map<std::string, std::string, std::less<>> inserted_;
+};
+
+/**
+ * Returns the location of the persisted DWARF index for the binary with the given build-ID.
+ * The path includes the file format and lookup versions, so that agents running different
+ * versions never read or replace each other's indexes.
+ */
+std::filesystem::path DwarfIndexFilePath(const std::filesystem::path& index_dir,
+                                         std::string_view build_id);
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -26,9 +26,15 @@
 
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 #include "src/stirling/obj_tools/abi_model.h"
+#include "src/stirling/obj_tools/dwarf_index.h"
 #include "src/stirling/obj_tools/dwarf_utils.h"
+#include "src/stirling/obj_tools/elf_reader.h"
 #include "src/stirling/obj_tools/init.h"
 
+DEFINE_string(stirling_dwarf_index_dir, "",
+              "If not empty, the directory where indexes of DWARF lookups are persisted, keyed by "
+              "build-ID, so that they can be reused across processes and restarts.");
+
 namespace px {
 namespace stirling {
 namespace obj_tools {
@@ -58,11 +64,20 @@ uint8_t kAddressSize = sizeof(void*);
 
 StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithoutIndexing(
     const std::filesystem::path& path) {
+  auto dwarf_reader = std::unique_ptr<DwarfReader>(new DwarfReader(path));
+
+  PL_RETURN_IF_ERROR(dwarf_reader->LoadDwarfContext());
+  PL_RETURN_IF_ERROR(dwarf_reader->DetectSourceLanguage());
+
+  return dwarf_reader;
+}
+
+Status DwarfReader::LoadDwarfContext() {
   using llvm::MemoryBuffer;
 
   std::error_code ec;
 
-  std::string obj_filename = path.string();
+  std::string obj_filename = path_.string();
 
   llvm::ErrorOr<std::unique_ptr<MemoryBuffer>> buff_or_err =
       MemoryBuffer::getFileOrSTDIN(obj_filename);
@@ -84,12 +99,10 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithoutIndexing(
     return error::Internal("Could not create DWARFContext.");
   }
 
-  auto dwarf_reader = std::unique_ptr<DwarfReader>(
-      new DwarfReader(std::move(buffer), DWARFContext::create(*obj_file)));
+  dwarf_context_ = DWARFContext::create(*obj_file);
+  memory_buffer_ = std::move(buffer);
 
-  PL_RETURN_IF_ERROR(dwarf_reader->DetectSourceLanguage());
-
-  return dwarf_reader;
+  return Status::OK();
 }
 
 StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateIndexingAll(
@@ -106,13 +119,83 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithSelectiveIndexing(
   return dwarf_reader;
 }
 
-DwarfReader::DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
-                         std::unique_ptr<llvm::DWARFContext> dwarf_context)
-    : memory_buffer_(std::move(buffer)), dwarf_context_(std::move(dwarf_context)) {
+StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithPersistentIndex(
+    const std::filesystem::path& path, const std::filesystem::path& index_dir) {
+  if (index_dir.empty()) {
+    return CreateIndexingAll(path);
+  }
+
+  std::string build_id = ElfReader::ReadBuildID(path).ValueOr("");
+  if (build_id.empty()) {
+    return CreateIndexingAll(path);
+  }
+  std::filesystem::path index_path = DwarfIndexFilePath(index_dir, build_id);
+
+  StatusOr<std::unique_ptr<DwarfIndex>> index_or = DwarfIndex::Open(index_path);
+  if (index_or.ok()) {
+    // Warm path: the DWARF information is only read if a lookup misses the index.
+    auto dwarf_reader = std::unique_ptr<DwarfReader>(new DwarfReader(path));
+    dwarf_reader->index_ = index_or.ConsumeValueOrDie();
+    dwarf_reader->index_path_ = std::move(index_path);
+    dwarf_reader->source_language_ = dwarf_reader->index_->source_language();
+    dwarf_reader->compiler_ = std::string(dwarf_reader->index_->compiler());
+    return dwarf_reader;
+  }
+  VLOG(1) << absl::Substitute("No usable DWARF index for $0: $1", path.string(),
+                              index_or.msg());
+
+  PL_ASSIGN_OR_RETURN(auto dwarf_reader, CreateIndexingAll(path));
+  dwarf_reader->index_ = DwarfIndex::Create();
+  dwarf_reader->index_path_ = std::move(index_path);
+  return dwarf_reader;
+}
+
+DwarfReader::DwarfReader(std::filesystem::path path) : path_(std::move(path)) {
   // Only very first call will actually perform initialization.
   InitLLVMOnce();
 }
 
+DwarfReader::~DwarfReader() = default;
+
+Status DwarfReader::EnsureDwarfContext() {
+  if (dwarf_context_ != nullptr) {
+    return Status::OK();
+  }
+  PL_RETURN_IF_ERROR(LoadDwarfContext());
+  IndexDIEs(std::nullopt);
+  return Status::OK();
+}
+
+Status DwarfReader::PersistIndex() {
+  if (index_ == nullptr || !index_->modified()) {
+    return Status::OK();
+  }
+  PL_RETURN_IF_ERROR(index_->Persist(index_path_, source_language_, compiler_));
+  // Re-open the index just written, so the recorded entries are served from the mapped file.
+  PL_ASSIGN_OR_RETURN(index_, DwarfIndex::Open(index_path_));
+  return Status::OK();
+}
+
+template <typename TValueType, typename TLookupFn>
+StatusOr<TValueType> DwarfReader::IndexedLookup(std::string key, TLookupFn lookup_fn) {
+  if (index_ == nullptr) {
+    return lookup_fn();
+  }
+
+  std::optional<StatusOr<TValueType>> indexed = index_->Find<TValueType>(key);
+  if (indexed.has_value()) {
+    return std::move(indexed.value());
+  }
+
+  // Failing to read the DWARF information says nothing about the lookup, so it is not recorded.
+  PL_RETURN_IF_ERROR(EnsureDwarfContext());
+  StatusOr<TValueType> result = lookup_fn();
+  if (DwarfIndex::IsRecordable(result)) {
+    index_->Insert(std::move(key), result);
+  }
+  return result;
+}
+
 namespace {
 
 bool IsMatchingDIE(std::string_view name, std::optional<llvm::dwarf::Tag> tag,
@@ -253,7 +336,7 @@ void DwarfReader::IndexDIEs(
 
 StatusOr<std::vector<DWARFDie>> DwarfReader::GetMatchingDIEs(
     std::string_view name, std::optional<llvm::dwarf::Tag> type_opt) {
-  DCHECK(dwarf_context_ != nullptr);
+  PL_RETURN_IF_ERROR(EnsureDwarfContext());
 
   // Special case for types that are indexed.
   if (type_opt.has_value() && IsIndexedType(type_opt.value()) && !die_map_.empty()) {
@@ -283,7 +366,7 @@ StatusOr<DWARFDie> DwarfReader::GetMatchingDIE(std::string_view name,
                                                std::optional<llvm::dwarf::Tag> type) {
   PL_ASSIGN_OR_RETURN(std::vector<DWARFDie> dies, GetMatchingDIEs(name, type));
   if (dies.empty()) {
-    return error::Internal("Could not locate symbol name=$0", name);
+    return error::NotFound("Could not locate symbol name=$0", name);
   }
   if (dies.size() > 1) {
     return error::Internal("Found $0 matches, expect only 1.", dies.size());
@@ -624,6 +707,11 @@ bool IsDeclaration(const llvm::DWARFDie& die) {
 }  // namespace
 
 StatusOr<uint64_t> DwarfReader::GetStructByteSize(std::string_view struct_name) {
+  return IndexedLookup<uint64_t>(DwarfIndex::Key(DwarfLookupType::kStructByteSize, {struct_name}),
+                                 [&]() { return GetStructByteSizeFromDIEs(struct_name); });
+}
+
+StatusOr<uint64_t> DwarfReader::GetStructByteSizeFromDIEs(std::string_view struct_name) {
   PL_ASSIGN_OR_RETURN(const DWARFDie& struct_die,
                       GetMatchingDIE(struct_name, llvm::dwarf::DW_TAG_structure_type));
 
@@ -634,6 +722,18 @@ StatusOr<StructMemberInfo> DwarfReader::GetStructMemberInfo(std::string_view str
                                                             llvm::dwarf::Tag tag,
                                                             std::string_view member_name,
                                                             llvm::dwarf::Tag member_tag) {
+  const std::string tag_str = std::to_string(tag);
+  const std::string member_tag_str = std::to_string(member_tag);
+  return IndexedLookup<StructMemberInfo>(
+      DwarfIndex::Key(DwarfLookupType::kStructMemberInfo,
+                      {struct_name, tag_str, member_name, member_tag_str}),
+      [&]() { return GetStructMemberInfoFromDIEs(struct_name, tag, member_name, member_tag); });
+}
+
+StatusOr<StructMemberInfo> DwarfReader::GetStructMemberInfoFromDIEs(std::string_view struct_name,
+                                                                    llvm::dwarf::Tag tag,
+                                                                    std::string_view member_name,
+                                                                    llvm::dwarf::Tag member_tag) {
   StructMemberInfo member_info;
 
   PL_ASSIGN_OR_RETURN(std::vector<DWARFDie> dies, GetMatchingDIEs(struct_name, {tag}));
@@ -666,10 +766,17 @@ StatusOr<StructMemberInfo> DwarfReader::GetStructMemberInfo(std::string_view str
     return member_info;
   }
 
-  return error::Internal("Could not find member $0 in struct $1.", member_name, struct_name);
+  return error::NotFound("Could not find member $0 in struct $1.", member_name, struct_name);
 }
 
 StatusOr<std::vector<StructSpecEntry>> DwarfReader::GetStructSpec(std::string_view struct_name) {
+  return IndexedLookup<std::vector<StructSpecEntry>>(
+      DwarfIndex::Key(DwarfLookupType::kStructSpec, {struct_name}),
+      [&]() { return GetStructSpecFromDIEs(struct_name); });
+}
+
+StatusOr<std::vector<StructSpecEntry>> DwarfReader::GetStructSpecFromDIEs(
+    std::string_view struct_name) {
   StructMemberInfo member_info;
 
   PL_ASSIGN_OR_RETURN(const DWARFDie& struct_die,
@@ -753,6 +860,13 @@ StatusOr<TypeInfo> DwarfReader::DereferencePointerType(std::string type_name) {
 
 StatusOr<uint64_t> DwarfReader::GetArgumentTypeByteSize(std::string_view function_symbol_name,
                                                         std::string_view arg_name) {
+  return IndexedLookup<uint64_t>(
+      DwarfIndex::Key(DwarfLookupType::kArgumentTypeByteSize, {function_symbol_name, arg_name}),
+      [&]() { return GetArgumentTypeByteSizeFromDIEs(function_symbol_name, arg_name); });
+}
+
+StatusOr<uint64_t> DwarfReader::GetArgumentTypeByteSizeFromDIEs(
+    std::string_view function_symbol_name, std::string_view arg_name) {
   PL_ASSIGN_OR_RETURN(const DWARFDie& function_die,
                       GetMatchingDIE(function_symbol_name, llvm::dwarf::DW_TAG_subprogram));
 
@@ -762,7 +876,7 @@ StatusOr<uint64_t> DwarfReader::GetArgumentTypeByteSize(std::string_view functio
       return GetTypeByteSize(type_die);
     }
   }
-  return error::Internal("Could not find argument.");
+  return error::NotFound("Could not find argument.");
 }
 
 namespace {
@@ -861,6 +975,13 @@ StatusOr<VarLocation> GetDieLocationAttr(const DWARFDie& die) {
 
 StatusOr<VarLocation> DwarfReader::GetArgumentLocation(std::string_view function_symbol_name,
                                                        std::string_view arg_name) {
+  return IndexedLookup<VarLocation>(
+      DwarfIndex::Key(DwarfLookupType::kArgumentLocation, {function_symbol_name, arg_name}),
+      [&]() { return GetArgumentLocationFromDIEs(function_symbol_name, arg_name); });
+}
+
+StatusOr<VarLocation> DwarfReader::GetArgumentLocationFromDIEs(
+    std::string_view function_symbol_name, std::string_view arg_name) {
   PL_ASSIGN_OR_RETURN(const DWARFDie& function_die,
                       GetMatchingDIE(function_symbol_name, llvm::dwarf::DW_TAG_subprogram));
 
@@ -869,7 +990,7 @@ StatusOr<VarLocation> DwarfReader::GetArgumentLocation(std::string_view function
       return GetDieLocationAttr(die);
     }
   }
-  return error::Internal("Could not find argument.");
+  return error::NotFound("Could not find argument.");
 }
 
 namespace {
@@ -900,6 +1021,13 @@ ABI LanguageToABI(llvm::dwarf::SourceLanguage lang, const std::string& compiler)
 
 StatusOr<std::map<std::string, ArgInfo>> DwarfReader::GetFunctionArgInfo(
     std::string_view function_symbol_name) {
+  return IndexedLookup<std::map<std::string, ArgInfo>>(
+      DwarfIndex::Key(DwarfLookupType::kFunctionArgInfo, {function_symbol_name}),
+      [&]() { return GetFunctionArgInfoFromDIEs(function_symbol_name); });
+}
+
+StatusOr<std::map<std::string, ArgInfo>> DwarfReader::GetFunctionArgInfoFromDIEs(
+    std::string_view function_symbol_name) {
   std::map<std::string, ArgInfo> arg_info;
 
   // Ideally, we'd use DW_AT_location directly from DWARF, (via GetDieLocationAttr(die),
@@ -968,6 +1096,13 @@ StatusOr<std::map<std::string, ArgInfo>> DwarfReader::GetFunctionArgInfo(
 }
 
 StatusOr<RetValInfo> DwarfReader::GetFunctionRetValInfo(std::string_view function_symbol_name) {
+  return IndexedLookup<RetValInfo>(
+      DwarfIndex::Key(DwarfLookupType::kFunctionRetValInfo, {function_symbol_name}),
+      [&]() { return GetFunctionRetValInfoFromDIEs(function_symbol_name); });
+}
+
+StatusOr<RetValInfo> DwarfReader::GetFunctionRetValInfoFromDIEs(
+    std::string_view function_symbol_name) {
   PL_ASSIGN_OR_RETURN(const DWARFDie& function_die,
                       GetMatchingDIE(function_symbol_name, llvm::dwarf::DW_TAG_subprogram));
 
@@ -35,6 +35,8 @@
 #include "src/stirling/obj_tools/abi_model.h"
 #include "src/stirling/obj_tools/utils.h"
 
+DECLARE_string(stirling_dwarf_index_dir);
+
 namespace px {
 namespace stirling {
 namespace obj_tools {
@@ -141,6 +143,8 @@ inline bool operator==(const StructSpecEntry& a, const StructSpecEntry& b) {
   return a.offset == b.offset && a.size == b.size && a.type_info == b.type_info && a.path == b.path;
 }
 
+class DwarfIndex;
+
 /**
  * Accepts an executable and reads DWARF information from it.
  * APIs are provided for accessing the needed data.
@@ -161,6 +165,28 @@ class DwarfReader {
   static StatusOr<std::unique_ptr<DwarfReader>> CreateWithSelectiveIndexing(
       const std::filesystem::path& path, const std::vector<SymbolSearchPattern>& symbol_patterns);
 
+  /**
+   * Creates a DwarfReader whose lookups are served from a persistent DwarfIndex, stored in
+   * index_dir and keyed by the build-ID of the binary. The index is shared by all processes
+   * running the same binary, and survives restarts.
+   *
+   * If an index file exists, no DWARF information is read until a lookup misses the index;
+   * DIEs are then indexed as with CreateIndexingAll(). Otherwise, this is equivalent to
+   * CreateIndexingAll(), with lookup results recorded for PersistIndex().
+   *
+   * Falls back to CreateIndexingAll() if index_dir is empty, or the binary has no build-ID.
+   */
+  static StatusOr<std::unique_ptr<DwarfReader>> CreateWithPersistentIndex(
+      const std::filesystem::path& path, const std::filesystem::path& index_dir);
+
+  ~DwarfReader();
+
+  /**
+   * Writes the lookup results recorded since creation to the persistent index.
+   * No-op if the reader was not created with a persistent index, or nothing new was recorded.
+   */
+  Status PersistIndex();
+
   /**
    * Searches the debug information for Debugging information entries (DIEs)
    * that match the name.
@@ -289,14 +315,47 @@ class DwarfReader {
    */
   StatusOr<RetValInfo> GetFunctionRetValInfo(std::string_view function_symbol_name);
 
-  bool IsValid() const { return dwarf_context_->getNumCompileUnits() != 0; }
+  bool IsValid() const {
+    // A reader opened from a persistent index has not read any DWARF information yet;
+    // the index is only ever written for valid DWARF information.
+    if (dwarf_context_ == nullptr) {
+      return index_ != nullptr;
+    }
+    return dwarf_context_->getNumCompileUnits() != 0;
+  }
 
   const llvm::dwarf::SourceLanguage& source_language() const { return source_language_; }
   const std::string& compiler() const { return compiler_; }
 
  private:
-  DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
-              std::unique_ptr<llvm::DWARFContext> dwarf_context);
+  explicit DwarfReader(std::filesystem::path path);
+
+  // Opens the object file and creates the DWARFContext.
+  Status LoadDwarfContext();
+
+  // Used by a reader opened from a persistent index to read the DWARF information when a lookup
+  // misses the index. No-op if the DWARF information was already read.
+  Status EnsureDwarfContext();
+
+  // Returns the result of a lookup from index_ if it was recorded; otherwise performs the lookup
+  // with lookup_fn and records its result. Without an index, this simply calls lookup_fn.
+  template <typename TValueType, typename TLookupFn>
+  StatusOr<TValueType> IndexedLookup(std::string key, TLookupFn lookup_fn);
+
+  // The lookups that read DWARF information, behind the public methods of the same name.
+  StatusOr<uint64_t> GetStructByteSizeFromDIEs(std::string_view struct_name);
+  StatusOr<StructMemberInfo> GetStructMemberInfoFromDIEs(std::string_view struct_name,
+                                                         llvm::dwarf::Tag tag,
+                                                         std::string_view member_name,
+                                                         llvm::dwarf::Tag member_tag);
+  StatusOr<std::vector<StructSpecEntry>> GetStructSpecFromDIEs(std::string_view struct_name);
+  StatusOr<uint64_t> GetArgumentTypeByteSizeFromDIEs(std::string_view function_symbol_name,
+                                                     std::string_view arg_name);
+  StatusOr<VarLocation> GetArgumentLocationFromDIEs(std::string_view function_symbol_name,
+                                                    std::string_view arg_name);
+  StatusOr<std::map<std::string, ArgInfo>> GetFunctionArgInfoFromDIEs(
+      std::string_view function_symbol_name);
+  StatusOr<RetValInfo> GetFunctionRetValInfoFromDIEs(std::string_view function_symbol_name);
 
   // Detects the source language of the dwarf content being read.
   Status DetectSourceLanguage();
@@ -321,11 +380,17 @@ class DwarfReader {
   llvm::dwarf::SourceLanguage source_language_;
   std::string compiler_;
 
+  std::filesystem::path path_;
+
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer_;
   std::unique_ptr<llvm::DWARFContext> dwarf_context_;
 
   // Nested map: [tag][symbol_name] -> DWARFDie
   absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, llvm::DWARFDie>> die_map_;
+
+  // Only set when created with CreateWithPersistentIndex().
+  std::unique_ptr<DwarfIndex> index_;
+  std::filesystem::path index_path_;
 };
 
 }  // namespace obj_tools
@@ -19,6 +19,7 @@
 #include <benchmark/benchmark.h>
 
 #include "src/common/base/base.h"
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
 
@@ -105,5 +106,59 @@ static void BM_indexed(benchmark::State& state) {
   }
 }
 
+// Cold: the persistent index does not exist yet, so it is built and written out.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_persistent_index_cold(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    px::testing::TempDir index_dir;
+    state.ResumeTiming();
+
+    SymAddrs symaddrs;
+
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateWithPersistentIndex(kBinary, index_dir.path()));
+
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      GetSymAddrs(dwarf_reader.get(), &symaddrs);
+      benchmark::DoNotOptimize(symaddrs);
+    }
+
+    PL_CHECK_OK(dwarf_reader->PersistIndex());
+  }
+}
+
+// Warm: the persistent index was written by a previous reader (e.g. another process, or before
+// a restart), so no DWARF information is read.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_persistent_index_warm(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+
+  px::testing::TempDir index_dir;
+  {
+    SymAddrs symaddrs;
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateWithPersistentIndex(kBinary, index_dir.path()));
+    GetSymAddrs(dwarf_reader.get(), &symaddrs);
+    PL_CHECK_OK(dwarf_reader->PersistIndex());
+  }
+
+  for (auto _ : state) {
+    SymAddrs symaddrs;
+
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateWithPersistentIndex(kBinary, index_dir.path()));
+
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      GetSymAddrs(dwarf_reader.get(), &symaddrs);
+      benchmark::DoNotOptimize(symaddrs);
+    }
+  }
+}
+
 BENCHMARK(BM_noindex)->RangeMultiplier(2)->Range(1, 16);
 BENCHMARK(BM_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_persistent_index_cold)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_persistent_index_warm)->RangeMultiplier(2)->Range(1, 16);
@@ -771,6 +771,38 @@ TEST_P(DwarfReaderTest, GoFunctionVarLocationConsistency) {
   }
 }
 
+TEST_F(DwarfReaderTest, PersistentIndex) {
+  px::testing::TempDir index_dir;
+
+  // Cold: no index file yet, so lookups read the DWARF information and are recorded.
+  std::map<std::string, ArgInfo> arg_info;
+  {
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                         DwarfReader::CreateWithPersistentIndex(kGo1_16BinaryPath,
+                                                                index_dir.path()));
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("main.Vertex", "Y"), 8);
+    EXPECT_NOT_OK(dwarf_reader->GetStructMemberOffset("main.Vertex", "bogus"));
+    ASSERT_OK_AND_ASSIGN(arg_info, dwarf_reader->GetFunctionArgInfo("main.MixedArgTypes"));
+    ASSERT_OK(dwarf_reader->PersistIndex());
+  }
+
+  // Warm: lookups are served from the mapped index file, including recorded errors.
+  {
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                         DwarfReader::CreateWithPersistentIndex(kGo1_16BinaryPath,
+                                                                index_dir.path()));
+    EXPECT_TRUE(dwarf_reader->IsValid());
+    EXPECT_EQ(dwarf_reader->source_language(), llvm::dwarf::DW_LANG_Go);
+    EXPECT_THAT(dwarf_reader->compiler(), ::testing::HasSubstr("go"));
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("main.Vertex", "Y"), 8);
+    EXPECT_NOT_OK(dwarf_reader->GetStructMemberOffset("main.Vertex", "bogus"));
+    EXPECT_OK_AND_EQ(dwarf_reader->GetFunctionArgInfo("main.MixedArgTypes"), arg_info);
+
+    // A lookup that misses the index falls back to the DWARF information.
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("main.Vertex", "X"), 0);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(DwarfReaderParameterizedTest, DwarfReaderTest,
                          ::testing::Values(DwarfReaderTestParam{true},
                                            DwarfReaderTestParam{false}));
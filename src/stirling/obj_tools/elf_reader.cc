@@ -24,6 +24,9 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_set.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <set>
 #include <utility>
 
@@ -31,6 +34,7 @@
 #include "src/common/base/utils.h"
 #include "src/common/fs/fs_wrapper.h"
 #include "src/stirling/obj_tools/init.h"
+#include "src/stirling/obj_tools/mapped_symbolizer.h"
 
 namespace px {
 namespace stirling {
@@ -194,6 +198,90 @@ StatusOr<std::unique_ptr<ElfReader>> ElfReader::Create(
   return elf_reader;
 }
 
+StatusOr<std::string> ElfReader::ReadBuildID(const std::filesystem::path& binary_path) {
+  // Only 64-bit little-endian ELF files are supported, like the rest of this file.
+  // Offsets below are from the ELF64 specification.
+  constexpr size_t kEhdrSize = 64;
+  constexpr size_t kPhOffPos = 0x20;
+  constexpr size_t kPhEntSizePos = 0x36;
+  constexpr size_t kPhNumPos = 0x38;
+  constexpr size_t kPhdrSize = 56;
+  constexpr size_t kPhdrOffsetPos = 8;
+  constexpr size_t kPhdrFileSzPos = 32;
+  constexpr uint32_t kPTNote = 4;
+  constexpr uint32_t kNTGNUBuildID = 3;
+  constexpr uint32_t kNTGoBuildID = 4;
+  // Build-ID notes are tiny; don't read huge note segments.
+  constexpr uint64_t kMaxNoteSegmentSize = 64 * 1024;
+
+  std::ifstream ifs(binary_path, std::ios::binary);
+  if (!ifs.good()) {
+    return error::Internal("Failed to open binary=$0", binary_path.string());
+  }
+
+  auto read_at = [&ifs](uint64_t offset, size_t size) -> StatusOr<std::string> {
+    std::string buf(size, '\0');
+    if (!ifs.seekg(offset) || !ifs.read(buf.data(), size)) {
+      return error::Internal("Failed to read size=$0 bytes from offset=$1", size, offset);
+    }
+    return buf;
+  };
+
+  PL_ASSIGN_OR_RETURN(std::string ehdr, read_at(0, kEhdrSize));
+  if (ehdr.compare(0, 4, "\x7f" "ELF") != 0 || ehdr[4] != ELFIO::ELFCLASS64 ||
+      ehdr[5] != ELFIO::ELFDATA2LSB) {
+    return error::Internal("Not a 64-bit little-endian ELF file: $0", binary_path.string());
+  }
+  std::string_view ehdr_view = ehdr;
+  const auto phoff = utils::LEndianBytesToInt<uint64_t>(ehdr_view.substr(kPhOffPos));
+  const auto phentsize = utils::LEndianBytesToInt<uint16_t>(ehdr_view.substr(kPhEntSizePos));
+  const auto phnum = utils::LEndianBytesToInt<uint16_t>(ehdr_view.substr(kPhNumPos));
+  // The fields read below must lie within each program header.
+  if (phnum != 0 && phentsize < kPhdrSize) {
+    return error::Internal("Invalid program header size $0 in binary=$1", phentsize,
+                           binary_path.string());
+  }
+
+  std::string gnu_build_id;
+  std::string go_build_id;
+  for (uint16_t i = 0; i < phnum; ++i) {
+    PL_ASSIGN_OR_RETURN(std::string phdr, read_at(phoff + i * phentsize, phentsize));
+    std::string_view phdr_view = phdr;
+    if (utils::LEndianBytesToInt<uint32_t>(phdr_view) != kPTNote) {
+      continue;
+    }
+    const auto offset = utils::LEndianBytesToInt<uint64_t>(phdr_view.substr(kPhdrOffsetPos));
+    const auto filesz = utils::LEndianBytesToInt<uint64_t>(phdr_view.substr(kPhdrFileSzPos));
+    PL_ASSIGN_OR_RETURN(std::string notes,
+                        read_at(offset, std::min<uint64_t>(filesz, kMaxNoteSegmentSize)));
+
+    // Same structure as described in LocateDebugSymbols(), with 4-byte aligned name and desc.
+    std::string_view notes_view = notes;
+    while (notes_view.size() >= 3 * sizeof(uint32_t)) {
+      const auto name_size = utils::LEndianBytesToInt<uint32_t>(notes_view);
+      const auto desc_size = utils::LEndianBytesToInt<uint32_t>(notes_view.substr(4));
+      const auto type = utils::LEndianBytesToInt<uint32_t>(notes_view.substr(8));
+      const size_t name_pos = 3 * sizeof(uint32_t);
+      // Computed in size_t, so that huge sizes don't wrap around.
+      const size_t desc_pos = name_pos + ((size_t{name_size} + 3) & ~size_t{3});
+      const size_t next_pos = desc_pos + ((size_t{desc_size} + 3) & ~size_t{3});
+      if (next_pos > notes_view.size()) {
+        break;
+      }
+      std::string_view name = notes_view.substr(name_pos, name_size);
+      std::string_view desc = notes_view.substr(desc_pos, desc_size);
+      if (type == kNTGNUBuildID && name == std::string_view("GNU\0", 4)) {
+        gnu_build_id = BytesToString<LowercaseHex>(desc);
+      } else if (type == kNTGoBuildID && name == std::string_view("Go\0\0", 4)) {
+        go_build_id = BytesToString<LowercaseHex>(desc);
+      }
+      notes_view.remove_prefix(next_pos);
+    }
+  }
+
+  return gnu_build_id.empty() ? go_build_id : gnu_build_id;
+}
+
 StatusOr<ELFIO::section*> ElfReader::SymtabSection() {
   ELFIO::section* symtab_section = nullptr;
   for (int i = 0; i < elf_reader_.sections.size(); ++i) {
@@ -398,6 +486,31 @@ std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
   return symbol_str;
 }
 
+Status ElfReader::Symbolizer::Persist(const std::filesystem::path& path) const {
+  std::string strtab;
+  std::vector<SymbolTableFileEntry> entries;
+  entries.reserve(symbols_.size());
+  for (const auto& [addr, info] : symbols_) {
+    entries.push_back(SymbolTableFileEntry{addr, info.size, strtab.size(), info.name.size()});
+    strtab.append(info.name);
+  }
+
+  SymbolTableFileHeader header = {};
+  std::memcpy(header.magic, SymbolTableFileHeader::kMagic, sizeof(header.magic));
+  header.version = SymbolTableFileHeader::kVersion;
+  header.num_entries = entries.size();
+  header.strtab_size = strtab.size();
+
+  std::string contents;
+  contents.reserve(sizeof(header) + entries.size() * sizeof(SymbolTableFileEntry) + strtab.size());
+  contents.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  contents.append(reinterpret_cast<const char*>(entries.data()),
+                  entries.size() * sizeof(SymbolTableFileEntry));
+  contents.append(strtab);
+
+  return fs::WriteFileAtomically(path, contents);
+}
+
 namespace {
 
 /**
@@ -449,7 +562,9 @@ std::vector<uint64_t> FindRetInsts(utils::u8string_view byte_code) {
 
   // TODO(yzhao): This is a short-term quick way to avoid unnecessary overheads.
   // We should create LLVMDisasmContext object inside SocketTraceConnector and pass it around.
-  static const LLVMDisasmContext kLLVMDisasmContext;
+  // The context is per-thread, because binaries may be analyzed concurrently during uprobe
+  // deployment, and LLVM disassembler contexts are not thread-safe.
+  static thread_local const LLVMDisasmContext kLLVMDisasmContext;
 
   // Size of the buffer to hold disassembled assembly code. Since we do not really use the assembly
   // code, we just provide a small buffer.
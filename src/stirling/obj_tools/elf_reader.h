@@ -48,6 +48,16 @@ class ElfReader {
       const std::string& binary_path,
       const std::filesystem::path& debug_file_dir = "/usr/lib/debug");
 
+  /**
+   * Reads only the build-ID notes of a binary, without loading its sections.
+   * Much cheaper than Create(), so it can be used to identify a binary before deciding
+   * whether to analyze it. Handles both GNU build-IDs and Go build IDs (GNU takes precedence).
+   *
+   * @param binary_path Path to the binary to read.
+   * @return The build-ID as a lowercase hex string, or empty if the binary has none.
+   */
+  static StatusOr<std::string> ReadBuildID(const std::filesystem::path& binary_path);
+
   std::filesystem::path& debug_symbols_path() { return debug_symbols_path_; }
 
   struct SymbolInfo {
@@ -129,6 +139,15 @@ class ElfReader {
      */
     std::string_view Lookup(uintptr_t addr) const;
 
+    size_t num_entries() const { return symbols_.size(); }
+
+    /**
+     * Writes the symbol table to the specified path, in the format read by MappedSymbolizer.
+     * The file is written to a temporary location and then renamed into place, so concurrent
+     * readers never observe a partially written file.
+     */
+    Status Persist(const std::filesystem::path& path) const;
+
    private:
     struct SymbolAddrInfo {
       size_t size;
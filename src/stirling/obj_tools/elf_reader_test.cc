@@ -19,8 +19,11 @@
 #include "src/stirling/obj_tools/elf_reader.h"
 
 #include "src/common/exec/exec.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/common/testing/testing.h"
+#include "src/stirling/obj_tools/mapped_symbolizer.h"
 #include "src/stirling/obj_tools/testdata/cc/test_exe_fixture.h"
 
 namespace px {
@@ -182,6 +185,31 @@ TEST(ElfReaderTest, InstrAddrToSymbol) {
   }
 }
 
+TEST(ElfReaderTest, PersistedSymbolizer) {
+  const std::string path = kTestExeFixture.Path().string();
+  const std::string kSymbolName = "CanYouFindThis";
+  ASSERT_OK_AND_ASSIGN(const int64_t kSymbolAddr, NmSymbolNameToAddr(path, kSymbolName));
+
+  ASSERT_OK_AND_ASSIGN(std::string build_id, ElfReader::ReadBuildID(path));
+  EXPECT_FALSE(build_id.empty());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader::Symbolizer> symbolizer,
+                       elf_reader->GetSymbolizer());
+
+  const std::filesystem::path symtab_path =
+      SymbolTableFilePath(fs::TempDirectoryPath(), build_id);
+  ASSERT_OK(symbolizer->Persist(symtab_path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedSymbolizer> mapped_symbolizer,
+                       MappedSymbolizer::Open(symtab_path));
+
+  EXPECT_EQ(mapped_symbolizer->num_entries(), symbolizer->num_entries());
+  EXPECT_EQ(mapped_symbolizer->Lookup(kSymbolAddr), kSymbolName);
+  EXPECT_EQ(mapped_symbolizer->Lookup(kSymbolAddr + 4), kSymbolName);
+  EXPECT_EQ(mapped_symbolizer->Lookup(2), "0x0000000000000002");
+
+  ASSERT_OK(fs::Remove(symtab_path));
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
   const std::string stripped_bin =
       px::testing::TestFilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
@@ -195,6 +223,35 @@ TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
 
+TEST(ElfReaderTest, ReadBuildID) {
+  const std::string stripped_bin =
+      px::testing::TestFilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  EXPECT_OK_AND_EQ(ElfReader::ReadBuildID(stripped_bin), "7deb0e3f89deba61");
+
+  // Go binaries carry a Go build ID instead.
+  const std::string go_bin =
+      px::testing::BazelBinTestFilePath("src/stirling/obj_tools/testdata/go/test_go_1_16_binary");
+  ASSERT_OK_AND_ASSIGN(std::string go_build_id, ElfReader::ReadBuildID(go_bin));
+  EXPECT_FALSE(go_build_id.empty());
+
+  EXPECT_NOT_OK(ElfReader::ReadBuildID("/bogus"));
+}
+
+TEST(ElfReaderTest, ReadBuildIDInvalidProgramHeaderSize) {
+  const std::string stripped_bin =
+      px::testing::TestFilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  ASSERT_OK_AND_ASSIGN(std::string contents, ReadFileToString(stripped_bin));
+
+  // Shrink e_phentsize, so that the program headers no longer hold the fields that are read.
+  contents[0x36] = 8;
+  contents[0x37] = 0;
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path bad_bin = tmp_dir.path() / "bad_phentsize";
+  ASSERT_OK(WriteFileFromString(bad_bin, contents));
+
+  EXPECT_NOT_OK(ElfReader::ReadBuildID(bad_bin));
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsDebugLink) {
   const std::string stripped_bin =
       px::testing::BazelBinTestFilePath("src/stirling/obj_tools/testdata/cc/test_exe_debuglink");
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/mapped_symbolizer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+StatusOr<std::unique_ptr<MappedSymbolizer>> MappedSymbolizer::Open(
+    const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to open symbol table file $0 ($1)", path.string(),
+                           std::strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Failed to stat symbol table file $0 ($1)", path.string(),
+                           std::strerror(errno));
+  }
+  const size_t length = st.st_size;
+  if (length < sizeof(SymbolTableFileHeader)) {
+    return error::Internal("Symbol table file $0 is truncated", path.string());
+  }
+
+  void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Failed to mmap symbol table file $0 ($1)", path.string(),
+                           std::strerror(errno));
+  }
+
+  auto symbolizer = std::unique_ptr<MappedSymbolizer>(new MappedSymbolizer);
+  symbolizer->addr_ = addr;
+  symbolizer->length_ = length;
+
+  const auto* base = static_cast<const char*>(addr);
+  const auto* header = reinterpret_cast<const SymbolTableFileHeader*>(base);
+  if (std::memcmp(header->magic, SymbolTableFileHeader::kMagic, sizeof(header->magic)) != 0 ||
+      header->version != SymbolTableFileHeader::kVersion) {
+    return error::Internal("Symbol table file $0 has an unexpected format", path.string());
+  }
+
+  const size_t entries_bytes = header->num_entries * sizeof(SymbolTableFileEntry);
+  if (sizeof(SymbolTableFileHeader) + entries_bytes + header->strtab_size != length) {
+    return error::Internal("Symbol table file $0 has an inconsistent size", path.string());
+  }
+
+  symbolizer->entries_ =
+      reinterpret_cast<const SymbolTableFileEntry*>(base + sizeof(SymbolTableFileHeader));
+  symbolizer->num_entries_ = header->num_entries;
+  symbolizer->strtab_ = base + sizeof(SymbolTableFileHeader) + entries_bytes;
+
+  // Validate name references once here, so that Lookup() can stay branch-light.
+  for (size_t i = 0; i < symbolizer->num_entries_; ++i) {
+    const SymbolTableFileEntry& e = symbolizer->entries_[i];
+    if (e.name_offset > header->strtab_size || e.name_size > header->strtab_size - e.name_offset) {
+      return error::Internal("Symbol table file $0 has an out-of-range name at entry $1",
+                             path.string(), i);
+    }
+  }
+
+  return symbolizer;
+}
+
+MappedSymbolizer::~MappedSymbolizer() {
+  if (addr_ != nullptr) {
+    munmap(addr_, length_);
+  }
+}
+
+std::string_view MappedSymbolizer::Lookup(uintptr_t addr) const {
+  static std::string symbol_str;
+
+  const SymbolTableFileEntry* end = entries_ + num_entries_;
+
+  // Find the first symbol for which the address_range_start > addr.
+  const SymbolTableFileEntry* iter = std::upper_bound(
+      entries_, end, addr,
+      [](uintptr_t a, const SymbolTableFileEntry& entry) { return a < entry.addr; });
+
+  if (iter != entries_) {
+    --iter;
+    if (addr >= iter->addr && addr < iter->addr + iter->size) {
+      return std::string_view(strtab_ + iter->name_offset, iter->name_size);
+    }
+  }
+
+  // Couldn't find the address.
+  symbol_str = absl::StrFormat("0x%016llx", addr);
+  return symbol_str;
+}
+
+std::filesystem::path SymbolTableFilePath(const std::filesystem::path& cache_dir,
+                                          std::string_view build_id) {
+  return cache_dir / absl::StrCat(build_id, ".symtab");
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
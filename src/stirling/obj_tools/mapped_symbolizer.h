@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * On-disk layout of a persisted symbol table (see ElfReader::Symbolizer::Persist()).
+ *
+ *   SymbolTableFileHeader
+ *   SymbolTableFileEntry[num_entries]   (sorted by addr)
+ *   char[strtab_size]                   (symbol names, not null-terminated)
+ *
+ * All fields are in host byte order; the file is only meant to be read back on the same node.
+ */
+struct SymbolTableFileHeader {
+  static constexpr char kMagic[8] = {'P', 'X', 'S', 'Y', 'M', 'T', 'B', '\0'};
+  static constexpr uint32_t kVersion = 1;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t num_entries;
+  uint64_t strtab_size;
+};
+
+struct SymbolTableFileEntry {
+  uint64_t addr;
+  uint64_t size;
+  uint64_t name_offset;
+  uint64_t name_size;
+};
+
+/**
+ * A read-only symbolizer backed by a memory-mapped symbol table file.
+ *
+ * The file is produced by ElfReader::Symbolizer::Persist(), and is keyed by the build-ID of the
+ * binary, so a single file serves all processes running that binary, across restarts.
+ * Because the file is mapped read-only, its pages live in the page cache and are shared.
+ */
+class MappedSymbolizer : public NotCopyMoveable {
+ public:
+  static StatusOr<std::unique_ptr<MappedSymbolizer>> Open(const std::filesystem::path& path);
+
+  ~MappedSymbolizer();
+
+  /**
+   * Lookup the symbol for the specified address.
+   * Same semantics as ElfReader::Symbolizer::Lookup().
+   */
+  std::string_view Lookup(uintptr_t addr) const;
+
+  size_t num_entries() const { return num_entries_; }
+
+ private:
+  MappedSymbolizer() = default;
+
+  void* addr_ = nullptr;
+  size_t length_ = 0;
+
+  const SymbolTableFileEntry* entries_ = nullptr;
+  size_t num_entries_ = 0;
+  const char* strtab_ = nullptr;
+};
+
+/**
+ * Returns the location of the persisted symbol table for the binary with the given build-ID.
+ */
+std::filesystem::path SymbolTableFilePath(const std::filesystem::path& cache_dir,
+                                          std::string_view build_id);
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
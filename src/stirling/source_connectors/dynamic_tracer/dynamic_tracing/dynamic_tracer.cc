@@ -115,7 +115,8 @@ StatusOr<ObjInfo> Prepare(const ir::logical::TracepointDeployment& input_program
   const auto& debug_symbols_path = obj_info.elf_reader->debug_symbols_path().string();
 
   obj_info.dwarf_reader =
-      DwarfReader::CreateIndexingAll(debug_symbols_path).ConsumeValueOr(nullptr);
+      DwarfReader::CreateWithPersistentIndex(debug_symbols_path, FLAGS_stirling_dwarf_index_dir)
+          .ConsumeValueOr(nullptr);
 
   return obj_info;
 }
@@ -169,6 +170,11 @@ StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_pro
 
   PL_ASSIGN_OR_RETURN(std::string bcc_code, GenBCCProgram(physical_program));
 
+  if (obj_info.dwarf_reader != nullptr) {
+    Status s = obj_info.dwarf_reader->PersistIndex();
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to persist DWARF index: $0", s.msg());
+  }
+
   // --------------------------
   // Generate BCC Program Object
   // --------------------------
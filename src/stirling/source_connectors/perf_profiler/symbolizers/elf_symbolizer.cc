@@ -17,14 +17,22 @@
  */
 
 #include <memory>
+#include <string>
 
 #include <absl/functional/bind_front.h>
 
+#include "src/common/fs/fs_wrapper.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbolizer.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
+DEFINE_string(stirling_profiler_symbol_cache_dir, "",
+              "If non-empty, ELF symbol tables are persisted to this directory keyed by build-ID, "
+              "and are reused by processes running the same binary, including across restarts.");
+
 using ::px::stirling::obj_tools::ElfReader;
+using ::px::stirling::obj_tools::MappedSymbolizer;
+using ::px::stirling::obj_tools::SymbolTableFilePath;
 
 namespace px {
 namespace stirling {
@@ -35,20 +43,104 @@ StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
   return symbolizer;
 }
 
-void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
+void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
+    return;
+  }
+  const std::string build_id = iter->second != nullptr ? iter->second->build_id : "";
+  symbolizers_.erase(iter);
 
-StatusOr<std::unique_ptr<ElfReader::Symbolizer>> CreateUPIDSymbolizer(const struct upid_t& upid) {
+  // Drop the build-ID entry once the last UPID running that binary is gone.
+  auto build_id_iter = symbolizers_by_build_id_.find(build_id);
+  if (build_id_iter != symbolizers_by_build_id_.end() && build_id_iter->second.expired()) {
+    symbolizers_by_build_id_.erase(build_id_iter);
+  }
+}
+
+namespace {
+
+StatusOr<std::filesystem::path> GetUPIDExePath(const struct upid_t& upid) {
   PL_ASSIGN_OR_RETURN(std::unique_ptr<FilePathResolver> fp_resolver,
                       FilePathResolver::Create(upid.pid));
   // TODO(yzhao): Might need to check the start time.
   PL_ASSIGN_OR_RETURN(std::filesystem::path proc_exe,
                       system::ProcParser(system::Config::GetInstance()).GetExePath(upid.pid));
   PL_ASSIGN_OR_RETURN(std::filesystem::path host_proc_exe, fp_resolver->ResolvePath(proc_exe));
-  host_proc_exe = system::Config::GetInstance().ToHostPath(host_proc_exe);
-  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(host_proc_exe));
-  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader::Symbolizer> upid_symbolizer,
-                      elf_reader->GetSymbolizer());
-  return upid_symbolizer;
+  return system::Config::GetInstance().ToHostPath(host_proc_exe);
+}
+
+}  // namespace
+
+StatusOr<std::shared_ptr<ElfSymbolizer::BinarySymbols>> ElfSymbolizer::GetBinarySymbols(
+    const struct upid_t& upid) {
+  PL_ASSIGN_OR_RETURN(std::filesystem::path exe_path, GetUPIDExePath(upid));
+
+  // Only the build-ID notes are read here, so that processes running an already symbolized
+  // binary do not pay for loading its ELF sections.
+  StatusOr<std::string> build_id_or = ElfReader::ReadBuildID(exe_path);
+  if (!build_id_or.ok()) {
+    VLOG(1) << absl::Substitute("Failed to read build-ID of $0 [error=$1]", exe_path.string(),
+                                build_id_or.ToString());
+  }
+  const std::string build_id = build_id_or.ValueOr("");
+
+  // Another process running the same binary has already been symbolized.
+  if (!build_id.empty()) {
+    auto iter = symbolizers_by_build_id_.find(build_id);
+    if (iter != symbolizers_by_build_id_.end()) {
+      if (std::shared_ptr<BinarySymbols> binary_symbols = iter->second.lock()) {
+        return binary_symbols;
+      }
+    }
+  }
+
+  auto binary_symbols = std::make_shared<BinarySymbols>();
+  binary_symbols->build_id = build_id;
+
+  const bool persist = !build_id.empty() && !FLAGS_stirling_profiler_symbol_cache_dir.empty();
+  const std::filesystem::path cache_path =
+      persist ? SymbolTableFilePath(FLAGS_stirling_profiler_symbol_cache_dir, build_id) : "";
+
+  // A previous run (or another PEM on this node) may have persisted the symbols already.
+  if (persist && fs::Exists(cache_path)) {
+    StatusOr<std::unique_ptr<MappedSymbolizer>> mapped_or = MappedSymbolizer::Open(cache_path);
+    if (mapped_or.ok()) {
+      binary_symbols->mapped_symbolizer = mapped_or.ConsumeValueOrDie();
+    } else {
+      VLOG(1) << absl::Substitute("Ignoring symbol cache file $0 [error=$1]", cache_path.string(),
+                                  mapped_or.ToString());
+    }
+  }
+
+  if (binary_symbols->mapped_symbolizer == nullptr) {
+    PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(exe_path));
+    PL_ASSIGN_OR_RETURN(binary_symbols->symbolizer, elf_reader->GetSymbolizer());
+
+    if (persist) {
+      // Swap the in-memory table for the mapped one, so the memory is shared through the
+      // page cache. On any failure, keep using the in-memory table.
+      Status s = binary_symbols->symbolizer->Persist(cache_path);
+      if (s.ok()) {
+        StatusOr<std::unique_ptr<MappedSymbolizer>> mapped_or = MappedSymbolizer::Open(cache_path);
+        if (mapped_or.ok()) {
+          binary_symbols->mapped_symbolizer = mapped_or.ConsumeValueOrDie();
+          binary_symbols->symbolizer.reset();
+        } else {
+          s = mapped_or.status();
+        }
+      }
+      if (!s.ok()) {
+        VLOG(1) << absl::Substitute("Failed to persist symbols to $0 [error=$1]",
+                                    cache_path.string(), s.ToString());
+      }
+    }
+  }
+
+  if (!build_id.empty()) {
+    symbolizers_by_build_id_[build_id] = binary_symbols;
+  }
+  return binary_symbols;
 }
 
 std::string_view EmptySymbolizerFn(const uintptr_t addr) {
@@ -65,20 +157,22 @@ profiler::SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid)
     return profiler::SymbolizerFn(&(BogusKernelSymbolizerFn));
   }
 
-  std::unique_ptr<ElfReader::Symbolizer>& upid_symbolizer = symbolizers_[upid];
-  if (upid_symbolizer == nullptr) {
-    StatusOr<std::unique_ptr<ElfReader::Symbolizer>> upid_symbolizer_status =
-        CreateUPIDSymbolizer(upid);
-    if (!upid_symbolizer_status.ok()) {
+  std::shared_ptr<BinarySymbols>& upid_symbols = symbolizers_[upid];
+  if (upid_symbols == nullptr) {
+    StatusOr<std::shared_ptr<BinarySymbols>> upid_symbols_status = GetBinarySymbols(upid);
+    if (!upid_symbols_status.ok()) {
       VLOG(1) << absl::Substitute("Failed to create Symbolizer function for $0 [error=$1]",
-                                  upid.pid, upid_symbolizer_status.ToString());
+                                  upid.pid, upid_symbols_status.ToString());
       return profiler::SymbolizerFn(&(EmptySymbolizerFn));
     }
 
-    upid_symbolizer = upid_symbolizer_status.ConsumeValueOrDie();
+    upid_symbols = upid_symbols_status.ConsumeValueOrDie();
   }
 
-  return absl::bind_front(&ElfReader::Symbolizer::Lookup, upid_symbolizer.get());
+  if (upid_symbols->mapped_symbolizer != nullptr) {
+    return absl::bind_front(&MappedSymbolizer::Lookup, upid_symbols->mapped_symbolizer.get());
+  }
+  return absl::bind_front(&ElfReader::Symbolizer::Lookup, upid_symbols->symbolizer.get());
 }
 
 }  // namespace stirling
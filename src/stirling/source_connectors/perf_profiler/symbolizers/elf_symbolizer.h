@@ -19,14 +19,22 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
+#include "src/stirling/obj_tools/mapped_symbolizer.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
+DECLARE_string(stirling_profiler_symbol_cache_dir);
+
 namespace px {
 namespace stirling {
 
 /**
  * A Symbolizer using the ElfReader symbolization core.
+ *
+ * Symbol tables are keyed by the ELF build-ID of the executable, so all processes running the
+ * same binary share one table. If --stirling_profiler_symbol_cache_dir is set, tables are also
+ * persisted there and memory-mapped, so that restarts do not require re-reading the ELF symtab.
  */
 class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
  public:
@@ -40,10 +48,20 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
  private:
   ElfSymbolizer() = default;
 
-  // A symbolizer per UPID.
-  absl::flat_hash_map<struct upid_t,
-                      std::unique_ptr<px::stirling::obj_tools::ElfReader::Symbolizer>>
-      symbolizers_;
+  // The symbols of one binary. Exactly one of symbolizer or mapped_symbolizer is set.
+  struct BinarySymbols {
+    std::string build_id;
+    std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer;
+    std::unique_ptr<obj_tools::MappedSymbolizer> mapped_symbolizer;
+  };
+
+  StatusOr<std::shared_ptr<BinarySymbols>> GetBinarySymbols(const struct upid_t& upid);
+
+  // A symbolizer per UPID; UPIDs running the same binary share the same BinarySymbols.
+  absl::flat_hash_map<struct upid_t, std::shared_ptr<BinarySymbols>> symbolizers_;
+
+  // Binaries with live UPIDs, keyed by build-ID.
+  absl::flat_hash_map<std::string, std::weak_ptr<BinarySymbols>> symbolizers_by_build_id_;
 };
 
 }  // namespace stirling
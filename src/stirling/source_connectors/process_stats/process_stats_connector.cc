@@ -25,12 +25,14 @@
 
 #include "src/common/base/base.h"
 #include "src/common/system/proc_parser.h"
+#include "src/common/system/proc_pid_stats_reader.h"
 #include "src/shared/metadata/metadata.h"
 
 namespace px {
 namespace stirling {
 
 using system::ProcParser;
+using system::ProcPIDStatsReader;
 
 Status ProcessStatsConnector::InitImpl() {
   sampling_freq_mgr_.set_period(kSamplingPeriod);
@@ -42,36 +44,31 @@ Status ProcessStatsConnector::StopImpl() { return Status::OK(); }
 
 void ProcessStatsConnector::TransferProcessStatsTable(ConnectorContext* ctx,
                                                       DataTable* data_table) {
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
+  const absl::flat_hash_map<md::UPID, md::PIDInfoSPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
 
   int64_t timestamp = AdjustedSteadyClockNowNS();
 
+  pids_.clear();
+  upids_.clear();
   for (const auto& [upid, pid_info] : pid_info_by_upid) {
     // TODO(zasgar): Fix condition for dead pids after helper function is added.
     if (pid_info == nullptr || pid_info->stop_time_ns() > 0) {
       // PID has been stopped.
       continue;
     }
+    pids_.push_back(upid.pid());
+    upids_.push_back(upid);
+  }
 
-    ProcParser::ProcessStats stats;
-    int32_t pid = upid.pid();
-    // TODO(zasgar): We should double check the process start time to make sure it still the same
-    // PID.
-    auto s1 =
-        proc_parser_->ParseProcPIDStat(pid, system::Config::GetInstance().PageSizeBytes(),
-                                       system::Config::GetInstance().KernelTickTimeNS(), &stats);
-    if (!s1.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch cpu stat info for PID ($0). Error=\"$1\" skipping.", pid, s1.msg());
-      continue;
-    }
+  // TODO(zasgar): We should double check the process start time to make sure it still the same
+  // PID.
+  samples_.clear();
+  proc_reader_->ReadBatch(pids_, ProcPIDStatsReader::kStat | ProcPIDStatsReader::kIO, &samples_);
 
-    auto s2 = proc_parser_->ParseProcPIDStatIO(pid, &stats);
-    if (!s2.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch IO stat info for PID ($0). Error=\"$1\" skipping.", pid, s2.msg());
-      continue;
-    }
+  for (const ProcPIDStatsReader::Sample& sample : samples_) {
+    // Map by index rather than by PID, since a reused PID can belong to more than one UPID.
+    const md::UPID& upid = upids_[sample.index];
+    const ProcParser::ProcessStats& stats = sample.stats;
 
     DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, timestamp);
     // TODO(oazizi): Enable version below, once rest of the agent supports tabletization.
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/system/proc_pid_stats_reader.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/core/canonical_types.h"
@@ -58,13 +59,18 @@ class ProcessStatsConnector : public SourceConnector {
  protected:
   explicit ProcessStatsConnector(std::string_view source_name)
       : SourceConnector(source_name, kTables) {
-    proc_parser_ = std::make_unique<system::ProcParser>(sysconfig_);
+    proc_reader_ = std::make_unique<system::ProcPIDStatsReader>(sysconfig_);
   }
 
  private:
   void TransferProcessStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
-  std::unique_ptr<system::ProcParser> proc_parser_;
+  std::unique_ptr<system::ProcPIDStatsReader> proc_reader_;
+
+  // Reused across samples.
+  std::vector<int32_t> pids_;
+  std::vector<md::UPID> upids_;
+  std::vector<system::ProcPIDStatsReader::Sample> samples_;
 };
 
 }  // namespace stirling
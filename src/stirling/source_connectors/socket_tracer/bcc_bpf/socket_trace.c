@@ -57,6 +57,11 @@ BPF_PERF_OUTPUT(mmap_events);
 // There is a control map element for each protocol.
 BPF_PERCPU_ARRAY(control_map, uint64_t, kNumProtocols);
 
+// This sampling_map holds a mask for each protocol, which user-space sets when it is overloaded.
+// The data of a connection is only traced if its conn_sampling_hash() has none of the mask bits
+// set. A mask of zero traces the data of all connections.
+BPF_PERCPU_ARRAY(sampling_map, uint64_t, kNumProtocols);
+
 // Map from user-space file descriptors to the connections obtained from accept() syscall.
 // Tracks connection from accept() -> close().
 // Key is {tgid, fd}.
@@ -216,7 +221,12 @@ static __inline bool should_trace_protocol_data(const struct conn_info_t* conn_i
   uint32_t protocol = conn_info->protocol;
   uint64_t kZero = 0;
   uint64_t control = *control_map.lookup_or_init(&protocol, &kZero);
-  return control & conn_info->role;
+  if (!(control & conn_info->role)) {
+    return false;
+  }
+
+  uint64_t sampling_mask = *sampling_map.lookup_or_init(&protocol, &kZero);
+  return (conn_sampling_hash(&conn_info->conn_id) & sampling_mask) == 0;
 }
 
 static __inline bool is_stirling_tgid(const uint32_t tgid) {
@@ -81,6 +81,18 @@ struct conn_id_t {
   uint64_t tsid;
 };
 
+// Hashes a connection to decide whether it belongs to the sample of its protocol, when the
+// protocol is captured in sampled mode. Both BPF and user-space use this function, so that they
+// agree on which connections are sampled.
+static inline uint64_t conn_sampling_hash(const struct conn_id_t* conn_id) {
+  uint64_t h = ((uint64_t)conn_id->upid.tgid << 32) | (uint32_t)conn_id->fd;
+  h = h * 0x9e3779b97f4a7c15ULL ^ conn_id->tsid;
+  // The splitmix64 finalizer.
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
 // Specifies the corresponding indexes of the entries of a per-cpu array.
 enum control_value_index_t {
   // This specify one pid to monitor. This is used during test to eliminate noise.
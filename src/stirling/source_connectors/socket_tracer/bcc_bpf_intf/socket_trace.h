@@ -28,6 +28,7 @@
 
 const char kControlMapName[] = "control_map";
 const char kControlValuesArrayName[] = "control_values";
+const char kSamplingMapName[] = "sampling_map";
 
 const int64_t kTraceAllTGIDs = -1;
 
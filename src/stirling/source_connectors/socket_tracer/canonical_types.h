@@ -62,6 +62,15 @@ constexpr DataElement kLatencyNS = {
     types::PatternType::METRIC_GAUGE,
 };
 
+constexpr DataElement kSampleWeight = {
+    "sample_weight",
+    "Number of records this record stands for. Above 1 when the socket tracer was overloaded "
+    "and only captured a sample of the protocol's connections.",
+    types::DataType::INT64,
+    types::SemanticType::ST_NONE,
+    types::PatternType::METRIC_GAUGE,
+};
+
 constexpr DataElement kPXInfo = {
     "px_info_",
     "Pixie messages regarding the record (e.g. warnings)",
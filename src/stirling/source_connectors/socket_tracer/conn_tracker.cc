@@ -59,6 +59,7 @@ DEFINE_int64(stirling_untracked_upid_threshold_seconds, 0,
              "list of PIDs tracked by the context after the specified time period.");
 
 DECLARE_int32(test_only_socket_trace_target_pid);
+DECLARE_uint64(max_body_bytes);
 
 namespace px {
 namespace stirling {
@@ -299,7 +300,7 @@ void ConnTracker::AddHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> hdr) {
     return;
   }
 
-  half_stream_ptr->AddHeader(std::string(hdr->name), std::string(hdr->value));
+  half_stream_ptr->AddHeader(hdr->name, hdr->value);
   half_stream_ptr->UpdateTimestamp(hdr->attr.timestamp_ns);
 }
 
@@ -358,7 +359,7 @@ void ConnTracker::AddHTTP2Data(std::unique_ptr<HTTP2DataEvent> data) {
         ::ToString(data->attr.conn_id));
   }
 
-  half_stream_ptr->AddData(data->payload);
+  half_stream_ptr->AddData(data->payload, FLAGS_max_body_bytes);
   if (data->attr.end_stream) {
     half_stream_ptr->AddEndStream();
   }
@@ -588,6 +588,12 @@ class ConnTracker : NotCopyMoveable {
   void set_is_tracked_upid() { is_tracked_upid_ = true; }
   bool is_tracked_upid() const { return is_tracked_upid_; }
 
+  // The number of connections that this connection stands for, while its protocol is captured in
+  // sampled mode. It is set for each record transferred from this tracker, to the sampling ratio
+  // that applied when the record's data was captured, and records carry it as their sample weight.
+  void set_sampling_weight(uint32_t weight) { sampling_weight_ = weight; }
+  uint32_t sampling_weight() const { return sampling_weight_; }
+
   template <typename TProtocolTraits>
   size_t MemUsage() const {
     using TFrameType = typename TProtocolTraits::frame_type;
@@ -680,6 +686,8 @@ class ConnTracker : NotCopyMoveable {
   // Used to disable ConnTrackers that are not part of the context.
   bool is_tracked_upid_ = false;
 
+  uint32_t sampling_weight_ = 1;
+
   traffic_protocol_t protocol_ = kProtocolUnknown;
   endpoint_role_t role_ = kRoleUnknown;
   bool ssl_ = false;
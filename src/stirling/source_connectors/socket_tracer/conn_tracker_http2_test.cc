@@ -24,6 +24,8 @@
 #include "src/common/base/types.h"
 #include "src/stirling/source_connectors/socket_tracer/testing/http2_stream_generator.h"
 
+DECLARE_uint64(max_body_bytes);
+
 namespace px {
 namespace stirling {
 
@@ -108,6 +110,56 @@ TEST_F(ConnTrackerHTTP2Test, BasicHeader) {
   EXPECT_THAT(records[0].recv.headers(), UnorderedElementsAre(Pair(":status", "200")));
 }
 
+// Tests that header names and values remain valid after their events are released, and after the
+// records are copied.
+TEST_F(ConnTrackerHTTP2Test, HeadersOwnedByStream) {
+  const int kStreamID = 7;
+  auto frame_generator = testing::StreamEventGenerator(&mock_clock_, kConnID, kStreamID);
+
+  const std::string kLongValue(1000, 'x');
+  tracker_.AddHTTP2Header(frame_generator.GenHeader<kHeaderEventWrite>(":path", "/a.B/C"));
+  tracker_.AddHTTP2Header(frame_generator.GenHeader<kHeaderEventWrite>("x-custom", kLongValue));
+  tracker_.AddHTTP2Header(frame_generator.GenEndStreamHeader<kHeaderEventWrite>());
+  tracker_.AddHTTP2Header(frame_generator.GenHeader<kHeaderEventRead>(":status", "200"));
+  tracker_.AddHTTP2Header(frame_generator.GenEndStreamHeader<kHeaderEventRead>());
+
+  std::vector<http2::Record> records = tracker_.ProcessToRecords<http2::ProtocolTraits>();
+  ASSERT_EQ(records.size(), 1);
+
+  http2::Record record_copy = records[0];
+  records.clear();
+  EXPECT_THAT(record_copy.send.headers(),
+              UnorderedElementsAre(Pair(":path", "/a.B/C"), Pair("x-custom", kLongValue)));
+  EXPECT_EQ(record_copy.send.headers().ValueByKey(":path"), "/a.B/C");
+  EXPECT_EQ(record_copy.recv.headers().ValueByKey(":status"), "200");
+  EXPECT_EQ(record_copy.recv.headers().ValueByKey("grpc-status", "-1"), "-1");
+}
+
+TEST_F(ConnTrackerHTTP2Test, DataTruncatedAtMaxBodyBytes) {
+  PL_SET_FOR_SCOPE(FLAGS_max_body_bytes, 10);
+
+  const int kStreamID = 7;
+  auto frame_generator = testing::StreamEventGenerator(&mock_clock_, kConnID, kStreamID);
+
+  tracker_.AddHTTP2Header(frame_generator.GenHeader<kHeaderEventWrite>(":method", "post"));
+  tracker_.AddHTTP2Data(frame_generator.GenDataFrame<kDataFrameEventWrite>("Request0"));
+  tracker_.AddHTTP2Data(frame_generator.GenDataFrame<kDataFrameEventWrite>("Request1"));
+  tracker_.AddHTTP2Data(
+      frame_generator.GenDataFrame<kDataFrameEventWrite>("Request2", /* end_stream */ true));
+  tracker_.AddHTTP2Header(frame_generator.GenHeader<kHeaderEventRead>(":status", "200"));
+  tracker_.AddHTTP2Data(
+      frame_generator.GenDataFrame<kDataFrameEventRead>("Response", /* end_stream */ true));
+
+  std::vector<http2::Record> records = tracker_.ProcessToRecords<http2::ProtocolTraits>();
+
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0].send.data(), "Request0Re");
+  EXPECT_TRUE(records[0].send.data_truncated());
+  EXPECT_EQ(records[0].send.original_data_size(), 24);
+  EXPECT_EQ(records[0].recv.data(), "Response");
+  EXPECT_FALSE(records[0].recv.data_truncated());
+}
+
 // Tests that multiple data frames are exported to records.
 TEST_F(ConnTrackerHTTP2Test, MultipleDataFrames) {
   const int kStreamID = 7;
@@ -40,6 +40,7 @@ static constexpr DataElement kMuxElements[] = {
          types::SemanticType::ST_NONE,
          types::PatternType::GENERAL_ENUM},
         canonical_data_elements::kLatencyNS,
+        canonical_data_elements::kSampleWeight,
 #ifndef NDEBUG
         canonical_data_elements::kPXInfo,
 #endif
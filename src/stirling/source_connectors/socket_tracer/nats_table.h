@@ -40,6 +40,7 @@ constexpr DataElement kNATSElements[] = {
          types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::STRUCTURED},
         {"resp", "The response to the command. One of OK & ERR",
          types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+        canonical_data_elements::kSampleWeight,
 #ifndef NDEBUG
         canonical_data_elements::kPXInfo,
 #endif
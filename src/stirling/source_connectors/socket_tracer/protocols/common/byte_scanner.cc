@@ -0,0 +1,232 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scanner.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+// SSE2 is part of the x86-64 baseline, so the vectorized paths below need no extra build flags.
+// Other architectures use the scalar paths.
+
+//-----------------------------------------------------------------------------
+// ByteSetScanner
+//-----------------------------------------------------------------------------
+
+ByteSetScanner::ByteSetScanner(std::string_view bytes) {
+  for (char c : bytes) {
+    if (!Contains(c)) {
+      table_[static_cast<uint8_t>(c)] = true;
+      bytes_.push_back(c);
+    }
+  }
+}
+
+size_t ByteSetScanner::Find(std::string_view buf, size_t pos) const {
+  const size_t n = buf.size();
+  if (pos >= n) {
+    return std::string_view::npos;
+  }
+
+  if (bytes_.size() == 1) {
+    const void* p = std::memchr(buf.data() + pos, bytes_[0], n - pos);
+    return p == nullptr ? std::string_view::npos : static_cast<const char*>(p) - buf.data();
+  }
+
+  size_t i = pos;
+
+#ifdef __SSE2__
+  if (bytes_.size() <= kMaxVectorBytes) {
+    __m128i needles[kMaxVectorBytes];
+    for (size_t k = 0; k < bytes_.size(); ++k) {
+      needles[k] = _mm_set1_epi8(bytes_[k]);
+    }
+
+    for (; i + 16 <= n; i += 16) {
+      const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf.data() + i));
+      __m128i matches = _mm_setzero_si128();
+      for (size_t k = 0; k < bytes_.size(); ++k) {
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, needles[k]));
+      }
+      const int mask = _mm_movemask_epi8(matches);
+      if (mask != 0) {
+        return i + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+
+  for (; i < n; ++i) {
+    if (Contains(buf[i])) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+//-----------------------------------------------------------------------------
+// MultiLiteralScanner
+//-----------------------------------------------------------------------------
+
+std::string MultiLiteralScanner::FirstBytes(const std::vector<std::string_view>& literals) {
+  std::string first_bytes;
+  for (std::string_view literal : literals) {
+    DCHECK(!literal.empty());
+    first_bytes.push_back(literal.front());
+  }
+  return first_bytes;
+}
+
+MultiLiteralScanner::MultiLiteralScanner(const std::vector<std::string_view>& literals)
+    : literals_(literals.begin(), literals.end()), first_bytes_(FirstBytes(literals)) {
+  for (std::string_view literal : literals) {
+    if (literal.size() < 2) {
+      leading_pairs_.clear();
+      return;
+    }
+    std::array<char, 2> pair = {literal[0], literal[1]};
+    if (std::find(leading_pairs_.begin(), leading_pairs_.end(), pair) == leading_pairs_.end()) {
+      leading_pairs_.push_back(pair);
+    }
+  }
+  if (leading_pairs_.size() > kMaxLeadingPairs) {
+    leading_pairs_.clear();
+  }
+}
+
+bool MultiLiteralScanner::MatchesAt(std::string_view buf, size_t pos) const {
+  if (pos >= buf.size() || !first_bytes_.Contains(buf[pos])) {
+    return false;
+  }
+  std::string_view suffix = buf.substr(pos);
+  for (const std::string& literal : literals_) {
+    if (suffix.size() >= literal.size() &&
+        std::memcmp(suffix.data(), literal.data(), literal.size()) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef __SSE2__
+namespace {
+
+// Returns a bit mask of the offsets within buf[i, i+16) at which one of the leading pairs starts.
+// Requires buf[i, i+17) to be readable.
+inline int LeadingPairsMask(const char* data, const __m128i* firsts, const __m128i* seconds,
+                            size_t num_pairs) {
+  const __m128i block0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  const __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 1));
+  __m128i matches = _mm_setzero_si128();
+  for (size_t k = 0; k < num_pairs; ++k) {
+    matches = _mm_or_si128(matches, _mm_and_si128(_mm_cmpeq_epi8(block0, firsts[k]),
+                                                  _mm_cmpeq_epi8(block1, seconds[k])));
+  }
+  return _mm_movemask_epi8(matches);
+}
+
+}  // namespace
+#endif
+
+size_t MultiLiteralScanner::Find(std::string_view buf, size_t pos) const {
+  const size_t n = buf.size();
+  size_t i = pos;
+
+#ifdef __SSE2__
+  if (!leading_pairs_.empty()) {
+    __m128i firsts[kMaxLeadingPairs];
+    __m128i seconds[kMaxLeadingPairs];
+    for (size_t k = 0; k < leading_pairs_.size(); ++k) {
+      firsts[k] = _mm_set1_epi8(leading_pairs_[k][0]);
+      seconds[k] = _mm_set1_epi8(leading_pairs_[k][1]);
+    }
+
+    for (; i + 17 <= n; i += 16) {
+      int mask = LeadingPairsMask(buf.data() + i, firsts, seconds, leading_pairs_.size());
+      while (mask != 0) {
+        const size_t candidate = i + __builtin_ctz(mask);
+        if (MatchesAt(buf, candidate)) {
+          return candidate;
+        }
+        mask &= mask - 1;
+      }
+    }
+  }
+#endif
+
+  while ((i = first_bytes_.Find(buf, i)) != std::string_view::npos) {
+    if (MatchesAt(buf, i)) {
+      return i;
+    }
+    ++i;
+  }
+  return std::string_view::npos;
+}
+
+size_t MultiLiteralScanner::FindLast(std::string_view buf) const {
+  // Candidates are the positions before end, scanned from the back.
+  size_t end = buf.size();
+
+#ifdef __SSE2__
+  if (!leading_pairs_.empty() && end > 0) {
+    __m128i firsts[kMaxLeadingPairs];
+    __m128i seconds[kMaxLeadingPairs];
+    for (size_t k = 0; k < leading_pairs_.size(); ++k) {
+      firsts[k] = _mm_set1_epi8(leading_pairs_[k][0]);
+      seconds[k] = _mm_set1_epi8(leading_pairs_[k][1]);
+    }
+
+    // Every literal has at least two bytes, so the last byte cannot start an occurrence.
+    // That also keeps the block's second load within the buffer.
+    end -= 1;
+    for (; end >= 16; end -= 16) {
+      const size_t i = end - 16;
+      int mask = LeadingPairsMask(buf.data() + i, firsts, seconds, leading_pairs_.size());
+      while (mask != 0) {
+        const int bit = 31 - __builtin_clz(mask);
+        if (MatchesAt(buf, i + bit)) {
+          return i + bit;
+        }
+        mask &= ~(1 << bit);
+      }
+    }
+  }
+#endif
+
+  while (end > 0) {
+    --end;
+    if (MatchesAt(buf, end)) {
+      return end;
+    }
+  }
+  return std::string_view::npos;
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
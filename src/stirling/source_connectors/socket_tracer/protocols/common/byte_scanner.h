@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * Finds bytes that belong to a fixed set of byte values.
+ *
+ * Used by FindFrameBoundary() implementations to skip over offsets that cannot start a frame,
+ * instead of probing every offset. Small sets are matched 16 bytes at a time with SSE2,
+ * larger sets with a table lookup per byte.
+ */
+class ByteSetScanner {
+ public:
+  explicit ByteSetScanner(std::string_view bytes);
+
+  /**
+   * Returns the position of the first byte at or after pos that is in the set,
+   * or std::string_view::npos if there is none.
+   */
+  size_t Find(std::string_view buf, size_t pos = 0) const;
+
+  bool Contains(char c) const { return table_[static_cast<uint8_t>(c)]; }
+
+ private:
+  // Beyond this many distinct bytes, comparing against each byte costs more than a table lookup.
+  static constexpr size_t kMaxVectorBytes = 8;
+
+  std::array<bool, 256> table_ = {};
+  std::vector<char> bytes_;
+};
+
+/**
+ * Finds occurrences of any of a small set of literals, such as the methods that start an HTTP
+ * request. This is a simplified version of the Teddy algorithm: candidate positions are found
+ * by matching the first two bytes of every literal against 16 offsets at a time, and each
+ * candidate is then verified against the full literals.
+ *
+ * Only occurrences that are entirely contained in the searched buffer are reported.
+ */
+class MultiLiteralScanner {
+ public:
+  explicit MultiLiteralScanner(const std::vector<std::string_view>& literals);
+
+  /**
+   * Returns the position of the first occurrence of any literal at or after pos,
+   * or std::string_view::npos if there is none.
+   */
+  size_t Find(std::string_view buf, size_t pos = 0) const;
+
+  /**
+   * Returns the position of the last occurrence of any literal,
+   * or std::string_view::npos if there is none.
+   */
+  size_t FindLast(std::string_view buf) const;
+
+  /**
+   * Returns true if one of the literals occurs at pos.
+   */
+  bool MatchesAt(std::string_view buf, size_t pos) const;
+
+ private:
+  // The number of distinct leading byte pairs above which candidates are found from the
+  // first bytes only.
+  static constexpr size_t kMaxLeadingPairs = 16;
+
+  static std::string FirstBytes(const std::vector<std::string_view>& literals);
+
+  std::vector<std::string> literals_;
+  ByteSetScanner first_bytes_;
+
+  // Distinct first two bytes of the literals. Empty if a literal is shorter than two bytes,
+  // or there are more than kMaxLeadingPairs distinct pairs.
+  std::vector<std::array<char, 2>> leading_pairs_;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scanner.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+constexpr size_t kNPos = std::string_view::npos;
+
+TEST(ByteSetScannerTest, Find) {
+  ByteSetScanner scanner("*$:");
+
+  EXPECT_EQ(scanner.Find(""), kNPos);
+  EXPECT_EQ(scanner.Find("abc"), kNPos);
+  EXPECT_EQ(scanner.Find("abc$"), 3);
+  EXPECT_EQ(scanner.Find("abc$", 4), kNPos);
+  EXPECT_EQ(scanner.Find("abc$", 10), kNPos);
+
+  // Crosses the 16-byte block boundaries of the vectorized path.
+  std::string buf(40, 'x');
+  buf[17] = ':';
+  buf[38] = '*';
+  EXPECT_EQ(scanner.Find(buf), 17);
+  EXPECT_EQ(scanner.Find(buf, 18), 38);
+  EXPECT_EQ(scanner.Find(buf, 39), kNPos);
+}
+
+TEST(ByteSetScannerTest, SingleByteAndLargeSets) {
+  ByteSetScanner zero(std::string_view("\0", 1));
+  EXPECT_EQ(zero.Find(std::string_view("ab\0c", 4)), 2);
+  EXPECT_EQ(zero.Find("abc"), kNPos);
+
+  ByteSetScanner letters("abcdefghijklmnopqrstuvwxyz");
+  EXPECT_EQ(letters.Find("1234567890123456789q"), 19);
+  EXPECT_FALSE(letters.Contains('A'));
+  EXPECT_TRUE(letters.Contains('q'));
+}
+
+TEST(MultiLiteralScannerTest, FindAndFindLast) {
+  MultiLiteralScanner scanner({"GET ", "POST ", "PUT "});
+
+  EXPECT_EQ(scanner.Find(""), kNPos);
+  EXPECT_EQ(scanner.FindLast(""), kNPos);
+  EXPECT_EQ(scanner.Find("xxGET /"), 2);
+  EXPECT_EQ(scanner.Find("xxPOS"), kNPos);
+  EXPECT_EQ(scanner.Find("PUT a PUT b", 1), 6);
+  EXPECT_EQ(scanner.FindLast("PUT a POST b GET"), 6);
+  EXPECT_EQ(scanner.FindLast("PUT a POST b GET "), 13);
+  EXPECT_TRUE(scanner.MatchesAt("xPOST ", 1));
+  EXPECT_FALSE(scanner.MatchesAt("xPOST", 1));
+}
+
+TEST(MultiLiteralScannerTest, SingleByteLiteral) {
+  MultiLiteralScanner scanner({"+", "-ERR"});
+  EXPECT_EQ(scanner.Find("abc-ER+"), 6);
+  EXPECT_EQ(scanner.FindLast("+abc-ERR"), 4);
+}
+
+// Compares against a naive search on random buffers, to cover the block boundaries.
+TEST(MultiLiteralScannerTest, MatchesNaiveSearch) {
+  const std::vector<std::string_view> literals = {"ab", "ba ", "abc"};
+  MultiLiteralScanner scanner(literals);
+
+  std::mt19937 rng(37);
+  std::uniform_int_distribution<int> char_dist(0, 3);
+  for (int trial = 0; trial < 200; ++trial) {
+    std::string buf(rng() % 100, ' ');
+    for (char& c : buf) {
+      c = "ab x"[char_dist(rng)];
+    }
+
+    size_t expected_first = kNPos;
+    size_t expected_last = kNPos;
+    for (size_t i = 0; i < buf.size(); ++i) {
+      for (std::string_view literal : literals) {
+        if (std::string_view(buf).substr(i).substr(0, literal.size()) == literal) {
+          expected_first = std::min(expected_first, i);
+          expected_last = (expected_last == kNPos) ? i : std::max(expected_last, i);
+        }
+      }
+    }
+    EXPECT_EQ(scanner.Find(buf), expected_first) << buf;
+    EXPECT_EQ(scanner.FindLast(buf), expected_last) << buf;
+  }
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
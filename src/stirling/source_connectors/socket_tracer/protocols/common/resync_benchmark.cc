@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/kafka/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/kafka/test_data.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mysql/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/nats/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/redis/parse.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+// Measures FindFrameBoundary() when resyncing after lost data: the buffer starts with the
+// remainder of a message body, and the next frame only starts at its end.
+
+// Lowercase text, without the bytes that start a frame in any of the benchmarked protocols.
+constexpr std::string_view kBodyAlphabet = "abeghijklmoqrsuvwxyz ";
+
+std::string ResyncBuffer(size_t body_size, std::string_view frame) {
+  std::minstd_rand0 gen(0);
+  std::uniform_int_distribution<size_t> dist(0, kBodyAlphabet.size() - 1);
+
+  std::string buf(body_size, ' ');
+  for (char& c : buf) {
+    c = kBodyAlphabet[dist(gen)];
+  }
+  buf.append(frame);
+  return buf;
+}
+
+template <typename TFrameType, typename TStateType>
+// NOLINTNEXTLINE : runtime/references.
+void Resync(benchmark::State& state, message_type_t type, std::string_view frame) {
+  const size_t body_size = state.range(0);
+  const std::string buf = ResyncBuffer(body_size, frame);
+  TStateType parser_state = {};
+
+  for (auto _ : state) {
+    size_t pos = FindFrameBoundary<TFrameType, TStateType>(type, buf, 1, &parser_state);
+    CHECK_EQ(pos, body_size);
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(static_cast<uint64_t>(state.iterations()) * body_size);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ResyncHTTP(benchmark::State& state) {
+  Resync<http::Message, http::StateWrapper>(state, message_type_t::kRequest,
+                                            "GET /index.html HTTP/1.1\r\nHost: pixie\r\n\r\n");
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ResyncKafka(benchmark::State& state) {
+  Resync<kafka::Packet, kafka::StateWrapper>(
+      state, message_type_t::kRequest,
+      CreateStringView<char>(CharArrayStringView<uint8_t>(kafka::testdata::kProduceRequest)));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ResyncMySQL(benchmark::State& state) {
+  Resync<mysql::Packet, mysql::StateWrapper>(
+      state, message_type_t::kRequest, CreateStringView<char>("\x09\x00\x00\x00\x03SELECT 1"));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ResyncPGSQL(benchmark::State& state) {
+  Resync<pgsql::RegularMessage, pgsql::StateWrapper>(
+      state, message_type_t::kRequest, CreateStringView<char>("Q\x00\x00\x00\x0eSELECT 1;\x00"));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ResyncRedis(benchmark::State& state) {
+  Resync<redis::Message, NoState>(state, message_type_t::kRequest, "*1\r\n$4\r\nPING\r\n");
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ResyncNATS(benchmark::State& state) {
+  Resync<nats::Message, NoState>(state, message_type_t::kRequest, "PING\r\n");
+}
+
+BENCHMARK(BM_ResyncHTTP)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_ResyncKafka)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_ResyncMySQL)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_ResyncPGSQL)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_ResyncRedis)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_ResyncNATS)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -25,6 +25,8 @@
 #include <string>
 #include <utility>
 
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scanner.h"
+
 DEFINE_int32(http_body_limit_bytes, 1024,
              "The amount of an HTTP body that will be returned on a parse");
 
@@ -283,23 +285,18 @@ ParseState ParseFrame(message_type_t type, std::string_view* buf, Message* resul
 size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start_pos) {
   // List of all HTTP request methods. All HTTP requests start with one of these.
   // https://developer.mozilla.org/en-US/docs/Web/HTTP/Methods
-  static constexpr std::string_view kHTTPReqStartPatternArray[] = {
+  static const MultiLiteralScanner kHTTPReqStartPatterns({
       "GET ", "HEAD ", "POST ", "PUT ", "DELETE ", "CONNECT ", "OPTIONS ", "TRACE ", "PATCH ",
-  };
+  });
 
   // List of supported HTTP protocol versions. HTTP responses typically start with one of these.
   // https://developer.mozilla.org/en-US/docs/Web/HTTP/Messages
-  static constexpr std::string_view kHTTPRespStartPatternArray[] = {"HTTP/1.1 ", "HTTP/1.0 "};
-
-  static constexpr ArrayView<std::string_view> kHTTPReqStartPatterns =
-      ArrayView<std::string_view>(kHTTPReqStartPatternArray);
-  static constexpr ArrayView<std::string_view> kHTTPRespStartPatterns =
-      ArrayView<std::string_view>(kHTTPRespStartPatternArray);
+  static const MultiLiteralScanner kHTTPRespStartPatterns({"HTTP/1.1 ", "HTTP/1.0 "});
 
   static constexpr std::string_view kBoundaryMarker = "\r\n\r\n";
 
   // Choose the right set of patterns for request vs response.
-  const ArrayView<std::string_view>* start_patterns = nullptr;
+  const MultiLiteralScanner* start_patterns = nullptr;
   switch (type) {
     case message_type_t::kRequest:
       start_patterns = &kHTTPReqStartPatterns;
@@ -331,17 +328,9 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
 
     std::string_view buf_substr = buf.substr(start_pos, marker_pos - start_pos);
 
-    size_t substr_pos = std::string::npos;
-    for (auto& start_pattern : *start_patterns) {
-      size_t current_substr_pos = buf_substr.rfind(start_pattern);
-      if (current_substr_pos != std::string::npos) {
-        // Found a match. Check if it is closer to the marker than our previous match.
-        // We want to return the match that is closest to the marker, so we aren't
-        // matching to something in a previous message's body.
-        substr_pos = (substr_pos == std::string::npos) ? current_substr_pos
-                                                       : std::max(substr_pos, current_substr_pos);
-      }
-    }
+    // We want the match that is closest to the marker, so we aren't matching to something in
+    // a previous message's body. All patterns are searched for in a single backwards scan.
+    size_t substr_pos = start_patterns->FindLast(buf_substr);
 
     if (substr_pos != std::string::npos) {
       return start_pos + substr_pos;
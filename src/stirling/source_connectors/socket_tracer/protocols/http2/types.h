@@ -20,9 +20,13 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include <absl/strings/str_join.h>
 
@@ -45,6 +49,42 @@ constexpr char kGRPCEncoding[] = "grpc-encoding";
 constexpr char kContentTypeGRPC[] = "application/grpc";
 constexpr char kGZip[] = "gzip";
 
+// Header field names that appear in most HTTP2/gRPC requests and responses, sorted.
+// The index of a name in this table serves as its ID.
+inline constexpr std::string_view kWellKnownNames[] = {
+    ":authority",
+    ":method",
+    ":path",
+    ":scheme",
+    ":status",
+    "accept",
+    "accept-encoding",
+    "content-length",
+    "content-type",
+    "date",
+    "grpc-accept-encoding",
+    "grpc-encoding",
+    "grpc-message",
+    "grpc-status",
+    "grpc-timeout",
+    "server",
+    "te",
+    "user-agent",
+};
+
+/**
+ * Returns the ID of the name in kWellKnownNames, or -1 if the name is not well-known.
+ */
+inline int WellKnownNameID(std::string_view name) {
+  const auto* begin = std::begin(kWellKnownNames);
+  const auto* end = std::end(kWellKnownNames);
+  const auto* iter = std::lower_bound(begin, end, name);
+  if (iter == end || *iter != name) {
+    return -1;
+  }
+  return static_cast<int>(iter - begin);
+}
+
 }  // namespace headers
 
 // Note that NVMap keys (HTTP2 header field names) are assumed to be lowercase to match spec:
@@ -53,10 +93,38 @@ constexpr char kGZip[] = "gzip";
 // ... header field names MUST be converted to lowercase prior to their encoding in HTTP/2.
 // A request or response containing uppercase header field names MUST be treated as malformed.
 //
-// TODO(yzhao): Change to hold a std::map<> object instead of deriving from std::multiplemap<>.
-class NVMap : public std::multimap<std::string, std::string> {
+// Names and values are views: well-known names refer to headers::kWellKnownNames, and all other
+// names and values are copied into blocks owned by the NVMap, which are released with it.
+class NVMap : public std::multimap<std::string_view, std::string_view> {
  public:
-  std::string ValueByKey(const std::string& key, const std::string& default_value = "") const {
+  NVMap() = default;
+  NVMap(const NVMap& other) { *this = other; }
+  NVMap(NVMap&& other) { *this = std::move(other); }
+
+  NVMap& operator=(const NVMap& other) {
+    if (this != &other) {
+      clear();
+      for (const auto& [name, value] : other) {
+        Add(name, value);
+      }
+    }
+    return *this;
+  }
+
+  NVMap& operator=(NVMap&& other) {
+    std::multimap<std::string_view, std::string_view>::operator=(std::move(other));
+    blocks_ = std::move(other.blocks_);
+    block_pos_ = std::exchange(other.block_pos_, nullptr);
+    block_left_ = std::exchange(other.block_left_, 0);
+    return *this;
+  }
+
+  void Add(std::string_view name, std::string_view value) {
+    const int id = headers::WellKnownNameID(name);
+    emplace(id >= 0 ? headers::kWellKnownNames[id] : Store(name), Store(value));
+  }
+
+  std::string_view ValueByKey(std::string_view key, std::string_view default_value = "") const {
     const auto iter = find(key);
     if (iter != end()) {
       return iter->second;
@@ -73,9 +141,39 @@ class NVMap : public std::multimap<std::string, std::string> {
     return byte_size;
   }
 
-  bool HasKey(const std::string& key) const { return find(key) != end(); }
+  bool HasKey(std::string_view key) const { return find(key) != end(); }
 
   std::string ToString() const { return absl::StrJoin(*this, ", ", absl::PairFormatter(":")); }
+
+ private:
+  // Most header fields are short, so they are packed into shared blocks of this size.
+  static constexpr size_t kBlockSize = 256;
+
+  std::string_view Store(std::string_view s) {
+    if (s.empty()) {
+      return {};
+    }
+    char* dst;
+    if (s.size() > kBlockSize / 2) {
+      dst = blocks_.emplace_back(new char[s.size()]).get();
+    } else {
+      if (s.size() > block_left_) {
+        block_pos_ = blocks_.emplace_back(new char[kBlockSize]).get();
+        block_left_ = kBlockSize;
+      }
+      dst = block_pos_;
+      block_pos_ += s.size();
+      block_left_ -= s.size();
+    }
+    std::memcpy(dst, s.data(), s.size());
+    return {dst, s.size()};
+  }
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+
+  // The unused tail of the last shared block.
+  char* block_pos_ = nullptr;
+  size_t block_left_ = 0;
 };
 
 // This struct represents the frames of interest transmitted on an HTTP2 stream.
@@ -84,6 +182,8 @@ class NVMap : public std::multimap<std::string, std::string> {
 // both of which are on the same stream ID of the same connection.
 struct HalfStream {
  public:
+  static constexpr size_t kDefaultMaxBodyBytes = 512;
+
   const std::string& data() const { return data_; }
   std::string* mutable_data() { return &data_; }
   const NVMap& headers() const { return headers_; }
@@ -107,26 +207,24 @@ struct HalfStream {
     }
   }
 
-  void AddHeader(std::string key, std::string val) {
+  void AddHeader(std::string_view key, std::string_view val) {
     byte_size_ += key.size() + val.size();
-    headers_.emplace(std::move(key), std::move(val));
+    headers_.Add(key, val);
   }
 
-  void AddTrailer(std::string key, std::string val) {
+  void AddTrailer(std::string_view key, std::string_view val) {
     byte_size_ += key.size() + val.size();
-    trailers_.emplace(std::move(key), std::move(val));
+    trailers_.Add(key, val);
   }
 
-  void AddData(std::string_view val) {
-    // Only sample the head of the body, to save space.
-    constexpr size_t kMaxBodyBytes = 512;
-
+  // Only the head of the body, up to max_bytes, is kept, to save space.
+  void AddData(std::string_view val, size_t max_bytes = kDefaultMaxBodyBytes) {
     original_data_size_ += val.size();
 
     size_t size_to_add = val.size();
 
-    if (size_to_add + data_.size() > kMaxBodyBytes) {
-      size_to_add = kMaxBodyBytes - data_.size();
+    if (size_to_add + data_.size() > max_bytes) {
+      size_to_add = max_bytes - std::min(max_bytes, data_.size());
       data_truncated_ = true;
     }
 
@@ -298,6 +298,17 @@ inline bool IsFlexible(APIKey api_key, int16_t api_version) {
   return false;
 }
 
+// How much of a message body is decoded, from cheapest to most expensive.
+enum class DecodeDepth {
+  // Only the request/response header (api key, api version and correlation id).
+  kHeader,
+  // The body down to topics and partitions. Record batches are skipped by their length, so only
+  // the size of each message set is known.
+  kTopics,
+  // The full body, including every record batch.
+  kFull,
+};
+
 inline bool IsValidAPIKey(int16_t api_key) {
   std::optional<APIKey> api_key_type_option = magic_enum::enum_cast<APIKey>(api_key);
   if (!api_key_type_option.has_value()) {
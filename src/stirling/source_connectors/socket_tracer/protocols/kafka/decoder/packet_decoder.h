@@ -238,6 +238,9 @@ class PacketDecoder {
     is_flexible_ = IsFlexible(api_key, api_version);
   }
 
+  // Below kFull, message sets are skipped by their length instead of being decoded.
+  void set_decode_depth(DecodeDepth decode_depth) { decode_depth_ = decode_depth; }
+
  private:
   // Represents a sequence of characters. First the length N is given as an INT16. Then N
   // bytes follow which are the UTF-8 encoding of the character sequence.
@@ -308,6 +311,7 @@ class PacketDecoder {
   APIKey api_key_;
   int16_t api_version_ = 0;
   bool is_flexible_ = false;
+  DecodeDepth decode_depth_ = DecodeDepth::kFull;
 };
 
 }  // namespace kafka
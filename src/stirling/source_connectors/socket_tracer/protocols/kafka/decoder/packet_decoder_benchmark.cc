@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/kafka/decoder/packet_decoder.h"
+
+using ::px::CreateStringView;
+using ::px::utils::IntToBEndianBytes;
+using ::px::stirling::protocols::kafka::APIKey;
+using ::px::stirling::protocols::kafka::DecodeDepth;
+using ::px::stirling::protocols::kafka::FetchResp;
+using ::px::stirling::protocols::kafka::PacketDecoder;
+using ::px::stirling::protocols::kafka::ProduceReq;
+
+namespace {
+
+// A record batch holding a single record, as sent in a Produce request with api_version 8.
+const std::string_view kRecordBatch = CreateStringView<char>(
+    "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x46\xff\xff\xff\xff\x02\xa7\x88\x71\xd8\x00"
+    "\x00\x00\x00\x00\x00\x00\x00\x01\x7a\xb2\x0a\x70\x1d\x00\x00\x01\x7a\xb2\x0a\x70\x1d\xff"
+    "\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x00\x00\x00\x01\x28\x00\x00\x00\x01"
+    "\x1c\x4d\x79\x20\x66\x69\x72\x73\x74\x20\x65\x76\x65\x6e\x74\x00");
+
+constexpr std::string_view kTopic = "quickstart-events";
+
+template <size_t N>
+void AppendBEndian(int64_t num, std::string* buf) {
+  char bytes[N];
+  IntToBEndianBytes(num, bytes);
+  buf->append(bytes, N);
+}
+
+void AppendTopicName(std::string* buf) {
+  AppendBEndian<2>(kTopic.size(), buf);
+  buf->append(kTopic);
+}
+
+void AppendMessageSet(int num_record_batches, std::string* buf) {
+  AppendBEndian<4>(num_record_batches * kRecordBatch.size(), buf);
+  for (int i = 0; i < num_record_batches; ++i) {
+    buf->append(kRecordBatch);
+  }
+}
+
+// Body of a Produce request (api_version 8) to a single partition.
+std::string ProduceReqV8(int num_record_batches) {
+  std::string buf;
+  AppendBEndian<2>(-1, &buf);    // transactional_id
+  AppendBEndian<2>(1, &buf);     // acks
+  AppendBEndian<4>(1500, &buf);  // timeout_ms
+  AppendBEndian<4>(1, &buf);     // topics
+  AppendTopicName(&buf);
+  AppendBEndian<4>(1, &buf);  // partitions
+  AppendBEndian<4>(0, &buf);  // index
+  AppendMessageSet(num_record_batches, &buf);
+  return buf;
+}
+
+// Body of a Fetch response (api_version 4) from a single partition.
+std::string FetchRespV4(int num_record_batches) {
+  std::string buf;
+  AppendBEndian<4>(0, &buf);  // throttle_time_ms
+  AppendBEndian<4>(1, &buf);  // topics
+  AppendTopicName(&buf);
+  AppendBEndian<4>(1, &buf);  // partitions
+  AppendBEndian<4>(0, &buf);  // index
+  AppendBEndian<2>(0, &buf);  // error_code
+  AppendBEndian<8>(1, &buf);  // high_watermark
+  AppendBEndian<8>(1, &buf);  // last_stable_offset
+  AppendBEndian<4>(0, &buf);  // aborted_transactions
+  AppendMessageSet(num_record_batches, &buf);
+  return buf;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ExtractProduceReq(benchmark::State& state) {
+  const std::string buf = ProduceReqV8(state.range(0));
+  const auto decode_depth = static_cast<DecodeDepth>(state.range(1));
+
+  for (auto _ : state) {
+    PacketDecoder decoder(buf);
+    decoder.SetAPIInfo(APIKey::kProduce, 8);
+    decoder.set_decode_depth(decode_depth);
+    ProduceReq r = decoder.ExtractProduceReq().ConsumeValueOrDie();
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetBytesProcessed(state.iterations() * buf.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ExtractFetchResp(benchmark::State& state) {
+  const std::string buf = FetchRespV4(state.range(0));
+  const auto decode_depth = static_cast<DecodeDepth>(state.range(1));
+
+  for (auto _ : state) {
+    PacketDecoder decoder(buf);
+    decoder.SetAPIInfo(APIKey::kFetch, 4);
+    decoder.set_decode_depth(decode_depth);
+    FetchResp r = decoder.ExtractFetchResp().ConsumeValueOrDie();
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetBytesProcessed(state.iterations() * buf.size());
+}
+
+// Args: number of record batches, decode depth (1 = kTopics, 2 = kFull).
+BENCHMARK(BM_ExtractProduceReq)->RangeMultiplier(16)->Ranges({{1, 256}, {1, 2}});
+BENCHMARK(BM_ExtractFetchResp)->RangeMultiplier(16)->Ranges({{1, 256}, {1, 2}});
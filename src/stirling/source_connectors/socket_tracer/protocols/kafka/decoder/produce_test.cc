@@ -190,6 +190,28 @@ TEST(KafkaPacketDecoderTest, ExtractProduceReqV8) {
   EXPECT_OK_AND_EQ(decoder.ExtractProduceReq(), expected_result);
 }
 
+TEST(KafkaPacketDecoderTest, ExtractProduceReqV8SkipRecordBatches) {
+  const std::string_view input = CreateStringView<char>(
+      "\xff\xff\x00\x01\x00\x00\x05\xdc\x00\x00\x00\x01\x00\x11\x71\x75\x69\x63\x6b\x73\x74\x61"
+      "\x72\x74\x2d\x65\x76\x65\x6e\x74\x73\x00\x00\x00\x01\x00\x00\x00\x00\x00\x00\x00\x52\x00"
+      "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x46\xff\xff\xff\xff\x02\xa7\x88\x71\xd8\x00\x00"
+      "\x00\x00\x00\x00\x00\x00\x01\x7a\xb2\x0a\x70\x1d\x00\x00\x01\x7a\xb2\x0a\x70\x1d\xff\xff"
+      "\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x00\x00\x00\x01\x28\x00\x00\x00\x01\x1c"
+      "\x4d\x79\x20\x66\x69\x72\x73\x74\x20\x65\x76\x65\x6e\x74\x00");
+  MessageSet message_set{.size = 82, .record_batches = {}};
+  ProduceReqPartition partition{.index = 0, .message_set = message_set};
+  ProduceReqTopic topic{.name = "quickstart-events", .partitions = {partition}};
+  ProduceReq expected_result{
+      .transactional_id = "", .acks = 1, .timeout_ms = 1500, .topics = {topic}};
+  PacketDecoder decoder(input);
+  decoder.SetAPIInfo(APIKey::kProduce, 8);
+  decoder.set_decode_depth(DecodeDepth::kTopics);
+  ASSERT_OK_AND_ASSIGN(ProduceReq result, decoder.ExtractProduceReq());
+  EXPECT_EQ(result, expected_result);
+  EXPECT_EQ(result.topics[0].partitions[0].message_set.size, 82);
+  EXPECT_TRUE(decoder.eof());
+}
+
 TEST(KafkaPacketDecoderTest, ExtractProduceReqV9) {
   const std::string_view input = CreateStringView<char>(
       "\x00\x00\x01\x00\x00\x05\xdc\x02\x12\x71\x75\x69\x63\x6b\x73\x74\x61\x72\x74\x2d\x65"
@@ -25,6 +25,7 @@
 #include <utility>
 
 #include "src/common/base/byte_utils.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scanner.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/common/types.h"
 #include "src/stirling/utils/binary_decoder.h"
 #include "src/stirling/utils/parse_state.h"
@@ -111,7 +112,20 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
     return std::string::npos;
   }
 
+  // The packet length is a big-endian int32 that cannot exceed the buffer size. For buffers
+  // under 16MB, its most significant byte must then be zero, so only offsets holding a zero byte
+  // need to be probed.
+  static const ByteSetScanner kZeroByte(std::string_view("\0", 1));
+  const bool probe_zero_bytes_only = buf.size() < (1 << 24);
+
   for (size_t i = start_pos; i < buf.size() - min_length; ++i) {
+    if (probe_zero_bytes_only) {
+      i = kZeroByte.Find(buf, i);
+      if (i == std::string::npos || i >= buf.size() - min_length) {
+        break;
+      }
+    }
+
     std::string_view cur_buf = buf.substr(i);
     BinaryDecoder binary_decoder(cur_buf);
 
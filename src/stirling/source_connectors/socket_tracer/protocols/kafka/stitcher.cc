@@ -19,19 +19,67 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/stitcher.h"
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_split.h>
 #include <deque>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/common/types.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/decoder/packet_decoder.h"
 
+DEFINE_string(stirling_kafka_decode_depth, "Produce:Topics,Fetch:Topics",
+              "Comma-separated <api_key>:<depth> pairs that limit how much of a Kafka message body "
+              "is decoded. Depth is one of Header, Topics or Full, and api_key is an APIKey name "
+              "such as Produce or Fetch. API keys that are not listed are fully decoded.");
+
 namespace px {
 namespace stirling {
 namespace protocols {
 namespace kafka {
 
+StatusOr<absl::flat_hash_map<APIKey, DecodeDepth>> ParseDecodeDepths(std::string_view spec) {
+  absl::flat_hash_map<APIKey, DecodeDepth> decode_depths;
+  for (std::string_view entry : absl::StrSplit(spec, ',', absl::SkipWhitespace())) {
+    std::vector<std::string_view> fields =
+        absl::StrSplit(absl::StripAsciiWhitespace(entry), ':');
+    if (fields.size() != 2) {
+      return error::InvalidArgument("Expected <api_key>:<depth>, got '$0'", entry);
+    }
+    std::optional<APIKey> api_key = magic_enum::enum_cast<APIKey>(absl::StrCat("k", fields[0]));
+    if (!api_key.has_value()) {
+      return error::InvalidArgument("Unknown API key '$0'", fields[0]);
+    }
+    std::optional<DecodeDepth> depth =
+        magic_enum::enum_cast<DecodeDepth>(absl::StrCat("k", fields[1]));
+    if (!depth.has_value()) {
+      return error::InvalidArgument("Unknown decode depth '$0'", fields[1]);
+    }
+    decode_depths[api_key.value()] = depth.value();
+  }
+  return decode_depths;
+}
+
+namespace {
+
+DecodeDepth GetDecodeDepth(APIKey api_key) {
+  // Parse the flag on the first time only.
+  static const absl::flat_hash_map<APIKey, DecodeDepth> kDecodeDepths = [] {
+    auto decode_depths_or = ParseDecodeDepths(FLAGS_stirling_kafka_decode_depth);
+    LOG_IF(ERROR, !decode_depths_or.ok()) << absl::Substitute(
+        "Ignoring --stirling_kafka_decode_depth: $0", decode_depths_or.msg());
+    return decode_depths_or.ConsumeValueOr({});
+  }();
+
+  auto iter = kDecodeDepths.find(api_key);
+  return iter == kDecodeDepths.end() ? DecodeDepth::kFull : iter->second;
+}
+
+}  // namespace
+
 Status ProcessProduceReq(PacketDecoder* decoder, Request* req) {
   PL_ASSIGN_OR_RETURN(ProduceReq r, decoder->ExtractProduceReq());
 
@@ -94,6 +142,12 @@ Status ProcessReq(Packet* req_packet, Request* req) {
   // Extracts api_key, api_version, and correlation_id.
   PL_RETURN_IF_ERROR(decoder.ExtractReqHeader(req));
 
+  DecodeDepth decode_depth = GetDecodeDepth(req->api_key);
+  if (decode_depth == DecodeDepth::kHeader) {
+    return Status::OK();
+  }
+  decoder.set_decode_depth(decode_depth);
+
   // TODO(chengruizhe): Add support for more api keys.
   switch (req->api_key) {
     case APIKey::kProduce:
@@ -117,6 +171,12 @@ Status ProcessResp(Packet* resp_packet, Response* resp, APIKey api_key, int16_t
 
   PL_RETURN_IF_ERROR(decoder.ExtractRespHeader(resp));
 
+  DecodeDepth decode_depth = GetDecodeDepth(api_key);
+  if (decode_depth == DecodeDepth::kHeader) {
+    return Status::OK();
+  }
+  decoder.set_decode_depth(decode_depth);
+
   switch (api_key) {
     case APIKey::kProduce:
       return ProcessProduceResp(&decoder, resp);
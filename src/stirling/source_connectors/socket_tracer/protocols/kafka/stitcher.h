@@ -27,11 +27,19 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/interface.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/common/types.h"
 
+DECLARE_string(stirling_kafka_decode_depth);
+
 namespace px {
 namespace stirling {
 namespace protocols {
 namespace kafka {
 
+/**
+ * Parses the decode depth of each API key from a comma-separated list of <api_key>:<depth> pairs,
+ * e.g. "Produce:Header,Fetch:Topics". See --stirling_kafka_decode_depth.
+ */
+StatusOr<absl::flat_hash_map<APIKey, DecodeDepth>> ParseDecodeDepths(std::string_view spec);
+
 /**
  * StitchFrames is the entry point of the Kafka Stitcher.
  *
@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "src/common/testing/testing.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/common/types.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/stitcher.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/test_data.h"
@@ -28,6 +29,9 @@ namespace stirling {
 namespace protocols {
 namespace kafka {
 
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
 TEST(KafkaStitcherTest, BasicMatching) {
   std::deque<Packet> req_packets;
   std::deque<Packet> resp_packets;
@@ -65,6 +69,19 @@ TEST(KafkaStitcherTest, BasicMatching) {
             "\"record_errors\":[],\"error_message\":\"\"}]}],\"throttle_time_ms\":0}");
 }
 
+TEST(KafkaStitcherTest, ParseDecodeDepths) {
+  ASSERT_OK_AND_ASSIGN(auto decode_depths, ParseDecodeDepths("Produce:Header, Fetch:Topics"));
+  EXPECT_THAT(decode_depths, UnorderedElementsAre(Pair(APIKey::kProduce, DecodeDepth::kHeader),
+                                                  Pair(APIKey::kFetch, DecodeDepth::kTopics)));
+
+  ASSERT_OK_AND_ASSIGN(decode_depths, ParseDecodeDepths(""));
+  EXPECT_TRUE(decode_depths.empty());
+
+  EXPECT_NOT_OK(ParseDecodeDepths("Produce"));
+  EXPECT_NOT_OK(ParseDecodeDepths("Produce:Shallow"));
+  EXPECT_NOT_OK(ParseDecodeDepths("NoSuchKey:Full"));
+}
+
 }  // namespace kafka
 }  // namespace protocols
 }  // namespace stirling
@@ -24,6 +24,7 @@
 #include <utility>
 
 #include "src/common/base/byte_utils.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scanner.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/mysql/types.h"
 #include "src/stirling/utils/parse_state.h"
 
@@ -85,8 +86,21 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
     return std::string::npos;
   }
 
+  // Requests must have a sequence id of 0, so only offsets whose sequence id byte is zero
+  // need to be probed.
+  static const ByteSetScanner kZeroByte(std::string_view("\0", 1));
+
   // Need at least kPacketHeaderLength bytes + 1 command byte in buf.
   for (size_t i = start_pos; i < buf.size() - mysql::kPacketHeaderLength; ++i) {
+    size_t sequence_id_pos = kZeroByte.Find(buf, i + mysql::kPayloadLengthLength);
+    if (sequence_id_pos == std::string::npos) {
+      break;
+    }
+    i = sequence_id_pos - mysql::kPayloadLengthLength;
+    if (i >= buf.size() - mysql::kPacketHeaderLength) {
+      break;
+    }
+
     std::string_view cur_buf = buf.substr(i);
     int packet_length = utils::LEndianBytesToInt<int, mysql::kPayloadLengthLength>(cur_buf);
     uint8_t sequence_id = static_cast<uint8_t>(cur_buf[3]);
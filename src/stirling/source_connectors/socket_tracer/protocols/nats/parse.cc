@@ -32,6 +32,7 @@
 
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scanner.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/nats/types.h"
 #include "src/stirling/utils/binary_decoder.h"
 
@@ -49,18 +50,14 @@ constexpr std::string_view kMessageFieldDelimiters = " \t";
 
 size_t FindMessageBoundary(std::string_view buf, size_t start_pos) {
   // Based on https://github.com/nats-io/docs/blob/master/nats_protocol/nats-protocol.md.
-  const std::vector<std::string_view> kmessage_type_ts = {kInfo, kConnect, kPub,  kSub, kUnsub,
-                                                          kMsg,  kPing,    kPong, kOK,  kERR};
-  constexpr ssize_t kMinMsgSize = 3;
-  for (ssize_t i = start_pos; i < static_cast<ssize_t>(buf.size()) - kMinMsgSize; ++i) {
-    auto buf_substr = buf.substr(i);
-    for (auto msg_type : kmessage_type_ts) {
-      if (absl::StartsWith(buf_substr, msg_type)) {
-        return i;
-      }
-    }
+  static const MultiLiteralScanner kMessageTypes(
+      {kInfo, kConnect, kPub, kSub, kUnsub, kMsg, kPing, kPong, kOK, kERR});
+  constexpr size_t kMinMsgSize = 3;
+  size_t pos = kMessageTypes.Find(buf, start_pos);
+  if (pos == std::string_view::npos || pos + kMinMsgSize >= buf.size()) {
+    return std::string_view::npos;
   }
-  return std::string_view::npos;
+  return pos;
 }
 
 namespace {
@@ -28,6 +28,7 @@
 #include <magic_enum.hpp>
 
 #include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scanner.h"
 #include "src/stirling/utils/binary_decoder.h"
 
 namespace px {
@@ -98,12 +99,14 @@ Status ParseStartupMessage(std::string_view* buf, StartupMessage* msg) {
 }
 
 size_t FindFrameBoundary(std::string_view buf, size_t start) {
-  for (size_t i = start; i < buf.size(); ++i) {
-    if (magic_enum::enum_cast<Tag>(buf[i]).has_value()) {
-      return i;
+  static const ByteSetScanner kTags([] {
+    std::string tags;
+    for (Tag tag : magic_enum::enum_values<Tag>()) {
+      tags.push_back(static_cast<char>(tag));
     }
-  }
-  return std::string_view::npos;
+    return tags;
+  }());
+  return kTags.Find(buf, start);
 }
 
 Status ParseCmdCmpl(const RegularMessage& msg, CmdCmpl* cmd_cmpl) {
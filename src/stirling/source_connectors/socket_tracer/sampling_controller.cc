@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/sampling_controller.h"
+
+DEFINE_double(stirling_adaptive_sampling_max_busy_fraction, 0.5,
+              "The fraction of the sampling period that the socket tracer may spend on a tick "
+              "before it is considered overloaded, and starts sampling connections.");
+DEFINE_uint32(stirling_adaptive_sampling_max_ratio, 64,
+              "The highest sampling ratio that the socket tracer applies to a protocol's "
+              "connections when overloaded. Rounded down to a power of two.");
+DEFINE_uint32(stirling_adaptive_sampling_cooldown_ticks, 25,
+              "The number of consecutive sampling ticks without overload, before the socket "
+              "tracer lowers a sampling ratio.");
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+uint32_t FloorPowerOfTwo(uint32_t x) {
+  uint32_t p = 1;
+  while (p <= x / 2) {
+    p *= 2;
+  }
+  return p;
+}
+
+}  // namespace
+
+SamplingController::SamplingController(std::chrono::milliseconds sampling_period,
+                                       const Config& config)
+    : max_tick_duration_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          sampling_period * config.max_busy_fraction)),
+      max_ratio_(FloorPowerOfTwo(config.max_ratio)),
+      cooldown_ticks_(config.cooldown_ticks) {}
+
+void SamplingController::RecordParseCost(traffic_protocol_t protocol,
+                                         std::chrono::nanoseconds cost) {
+  tick_parse_costs_[protocol] += cost;
+}
+
+uint32_t SamplingController::ratio(traffic_protocol_t protocol) const {
+  auto iter = ratios_.find(protocol);
+  return iter == ratios_.end() ? 1 : iter->second;
+}
+
+void SamplingController::RatioApplied(traffic_protocol_t protocol, uint64_t timestamp_ns) {
+  constexpr size_t kMaxRatioChanges = 16;
+
+  RatioHistory& history = applied_ratios_[protocol];
+  history.changes.push_back({timestamp_ns, ratio(protocol)});
+  if (history.changes.size() > kMaxRatioChanges) {
+    history.initial_ratio = history.changes.front().ratio;
+    history.changes.pop_front();
+  }
+}
+
+uint32_t SamplingController::ratio_at(traffic_protocol_t protocol, uint64_t timestamp_ns) const {
+  auto iter = applied_ratios_.find(protocol);
+  if (iter == applied_ratios_.end()) {
+    return 1;
+  }
+  const RatioHistory& history = iter->second;
+  for (auto change = history.changes.rbegin(); change != history.changes.rend(); ++change) {
+    if (change->applied_ns <= timestamp_ns) {
+      return change->ratio;
+    }
+  }
+  return history.initial_ratio;
+}
+
+std::vector<traffic_protocol_t> SamplingController::Tick(std::chrono::nanoseconds tick_duration) {
+  std::vector<traffic_protocol_t> changed;
+
+  const bool overloaded = tick_data_loss_ > 0 || tick_duration > max_tick_duration_;
+
+  if (overloaded) {
+    quiet_ticks_ = 0;
+
+    // Sample the most expensive protocol that can still be sampled further.
+    traffic_protocol_t target = kProtocolUnknown;
+    std::chrono::nanoseconds target_cost = std::chrono::nanoseconds::zero();
+    for (const auto& [protocol, cost] : tick_parse_costs_) {
+      if (cost > target_cost && ratio(protocol) < max_ratio_) {
+        target = protocol;
+        target_cost = cost;
+      }
+    }
+
+    if (target != kProtocolUnknown) {
+      ratios_[target] = ratio(target) * 2;
+      changed.push_back(target);
+    }
+  } else if (!ratios_.empty() && ++quiet_ticks_ >= cooldown_ticks_) {
+    quiet_ticks_ = 0;
+
+    // Step back from the most aggressive sampling first.
+    auto target = ratios_.begin();
+    for (auto iter = ratios_.begin(); iter != ratios_.end(); ++iter) {
+      if (iter->second > target->second) {
+        target = iter;
+      }
+    }
+
+    traffic_protocol_t protocol = target->first;
+    target->second /= 2;
+    if (target->second == 1) {
+      ratios_.erase(target);
+    }
+    changed.push_back(protocol);
+  }
+
+  tick_parse_costs_.clear();
+  tick_data_loss_ = 0;
+
+  return changed;
+}
+
+}  // namespace stirling
+}  // namespace px
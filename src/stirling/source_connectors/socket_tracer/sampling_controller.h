@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
+
+DECLARE_double(stirling_adaptive_sampling_max_busy_fraction);
+DECLARE_uint32(stirling_adaptive_sampling_max_ratio);
+DECLARE_uint32(stirling_adaptive_sampling_cooldown_ticks);
+
+namespace px {
+namespace stirling {
+
+/**
+ * SamplingController decides which protocols the socket tracer captures in sampled mode, when it
+ * cannot keep up with the traffic.
+ *
+ * Every sampling tick, it is told how long each protocol took to parse and how many data events
+ * the perf buffer lost. A tick is overloaded if data was lost, or if it took more than a fraction
+ * of the sampling period. On each overloaded tick, the sampling ratio of the most expensive
+ * protocol doubles. After a number of quiet ticks, the highest ratio halves again.
+ *
+ * Ratios are powers of two: at ratio N, a connection is in the sample if the low log2(N) bits of
+ * its conn_sampling_hash() are zero. This keeps sampling deterministic per connection, and the
+ * connections sampled at a ratio are a subset of those sampled at any lower ratio.
+ */
+class SamplingController {
+ public:
+  struct Config {
+    // The fraction of the sampling period that a tick may take before it counts as overloaded.
+    double max_busy_fraction = 0.5;
+    // The highest sampling ratio. Rounded down to a power of two.
+    uint32_t max_ratio = 64;
+    // The number of consecutive ticks without overload before a sampling ratio is lowered.
+    uint32_t cooldown_ticks = 25;
+  };
+
+  SamplingController(std::chrono::milliseconds sampling_period, const Config& config);
+
+  /**
+   * Accounts time spent parsing and transferring data of the protocol during the current tick.
+   */
+  void RecordParseCost(traffic_protocol_t protocol, std::chrono::nanoseconds cost);
+
+  /**
+   * Accounts data events lost in the perf buffer during the current tick.
+   */
+  void RecordDataLoss(uint64_t lost) { tick_data_loss_ += lost; }
+
+  /**
+   * Ends the current tick, which took the given time, and adjusts the sampling ratios.
+   *
+   * @return The protocols whose sampling ratio changed.
+   */
+  std::vector<traffic_protocol_t> Tick(std::chrono::nanoseconds tick_duration);
+
+  /**
+   * Returns the sampling ratio of the protocol: 1 in ratio connections are captured.
+   */
+  uint32_t ratio(traffic_protocol_t protocol) const;
+
+  /**
+   * Records that data of the protocol captured from the given monotonic time on is sampled at the
+   * protocol's current ratio, i.e. that BPF applies it from then on.
+   */
+  void RatioApplied(traffic_protocol_t protocol, uint64_t timestamp_ns);
+
+  /**
+   * Returns the sampling ratio that applied to data of the protocol captured at the given
+   * monotonic time. This is the weight of the records built from that data. Records are
+   * transferred after they are captured, possibly after the ratio changed again.
+   */
+  uint32_t ratio_at(traffic_protocol_t protocol, uint64_t timestamp_ns) const;
+
+  /**
+   * Returns the mask that BPF applies to conn_sampling_hash() for the given sampling ratio.
+   */
+  static uint64_t SamplingMask(uint32_t ratio) { return ratio - 1; }
+
+  /**
+   * Returns true if the connection is captured at the given sampling ratio.
+   */
+  static bool InSample(const struct conn_id_t& conn_id, uint32_t ratio) {
+    return (conn_sampling_hash(&conn_id) & SamplingMask(ratio)) == 0;
+  }
+
+ private:
+  const std::chrono::nanoseconds max_tick_duration_;
+  const uint32_t max_ratio_;
+  const uint32_t cooldown_ticks_;
+
+  absl::flat_hash_map<traffic_protocol_t, uint32_t> ratios_;
+
+  // The latest ratio changes applied by BPF for each protocol. Data waits in the connection
+  // trackers for at most a few seconds, so only the last few changes are kept.
+  struct RatioChange {
+    uint64_t applied_ns;
+    uint32_t ratio;
+  };
+  struct RatioHistory {
+    // The ratio before the first of the changes.
+    uint32_t initial_ratio = 1;
+    std::deque<RatioChange> changes;
+  };
+  absl::flat_hash_map<traffic_protocol_t, RatioHistory> applied_ratios_;
+
+  // Per-tick inputs, reset by Tick().
+  absl::flat_hash_map<traffic_protocol_t, std::chrono::nanoseconds> tick_parse_costs_;
+  uint64_t tick_data_loss_ = 0;
+
+  uint32_t quiet_ticks_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
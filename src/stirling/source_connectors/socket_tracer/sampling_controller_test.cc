@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/sampling_controller.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+using std::chrono::milliseconds;
+
+constexpr milliseconds kSamplingPeriod{200};
+constexpr milliseconds kQuietTick{10};
+constexpr milliseconds kBusyTick{150};
+
+class SamplingControllerTest : public ::testing::Test {
+ protected:
+  SamplingControllerTest()
+      : controller_(kSamplingPeriod,
+                    {.max_busy_fraction = 0.5, .max_ratio = 4, .cooldown_ticks = 3}) {}
+
+  SamplingController controller_;
+};
+
+TEST_F(SamplingControllerTest, NoSamplingWithoutOverload) {
+  controller_.RecordParseCost(kProtocolHTTP, milliseconds{5});
+  EXPECT_THAT(controller_.Tick(kQuietTick), IsEmpty());
+  EXPECT_EQ(controller_.ratio(kProtocolHTTP), 1);
+}
+
+TEST_F(SamplingControllerTest, SamplesMostExpensiveProtocol) {
+  controller_.RecordParseCost(kProtocolHTTP, milliseconds{20});
+  controller_.RecordParseCost(kProtocolMySQL, milliseconds{100});
+  EXPECT_THAT(controller_.Tick(kBusyTick), ElementsAre(kProtocolMySQL));
+  EXPECT_EQ(controller_.ratio(kProtocolMySQL), 2);
+  EXPECT_EQ(controller_.ratio(kProtocolHTTP), 1);
+
+  controller_.RecordParseCost(kProtocolHTTP, milliseconds{20});
+  controller_.RecordParseCost(kProtocolMySQL, milliseconds{50});
+  EXPECT_THAT(controller_.Tick(kBusyTick), ElementsAre(kProtocolMySQL));
+  EXPECT_EQ(controller_.ratio(kProtocolMySQL), 4);
+
+  // MySQL is at the maximum ratio, so HTTP is sampled next.
+  controller_.RecordParseCost(kProtocolHTTP, milliseconds{20});
+  controller_.RecordParseCost(kProtocolMySQL, milliseconds{50});
+  EXPECT_THAT(controller_.Tick(kBusyTick), ElementsAre(kProtocolHTTP));
+  EXPECT_EQ(controller_.ratio(kProtocolMySQL), 4);
+  EXPECT_EQ(controller_.ratio(kProtocolHTTP), 2);
+}
+
+TEST_F(SamplingControllerTest, DataLossIsOverload) {
+  controller_.RecordParseCost(kProtocolRedis, milliseconds{1});
+  controller_.RecordDataLoss(10);
+  EXPECT_THAT(controller_.Tick(kQuietTick), ElementsAre(kProtocolRedis));
+  EXPECT_EQ(controller_.ratio(kProtocolRedis), 2);
+
+  // The loss is accounted to a single tick.
+  controller_.RecordParseCost(kProtocolRedis, milliseconds{1});
+  EXPECT_THAT(controller_.Tick(kQuietTick), IsEmpty());
+  EXPECT_EQ(controller_.ratio(kProtocolRedis), 2);
+}
+
+TEST_F(SamplingControllerTest, RecoversAfterCooldown) {
+  for (int i = 0; i < 2; ++i) {
+    controller_.RecordParseCost(kProtocolKafka, milliseconds{100});
+    controller_.Tick(kBusyTick);
+  }
+  ASSERT_EQ(controller_.ratio(kProtocolKafka), 4);
+
+  EXPECT_THAT(controller_.Tick(kQuietTick), IsEmpty());
+  EXPECT_THAT(controller_.Tick(kQuietTick), IsEmpty());
+  EXPECT_THAT(controller_.Tick(kQuietTick), ElementsAre(kProtocolKafka));
+  EXPECT_EQ(controller_.ratio(kProtocolKafka), 2);
+
+  // An overloaded tick restarts the cooldown.
+  controller_.Tick(kQuietTick);
+  controller_.RecordDataLoss(1);
+  controller_.Tick(kQuietTick);
+  EXPECT_EQ(controller_.ratio(kProtocolKafka), 2);
+
+  EXPECT_THAT(controller_.Tick(kQuietTick), IsEmpty());
+  EXPECT_THAT(controller_.Tick(kQuietTick), IsEmpty());
+  EXPECT_THAT(controller_.Tick(kQuietTick), ElementsAre(kProtocolKafka));
+  EXPECT_EQ(controller_.ratio(kProtocolKafka), 1);
+}
+
+TEST_F(SamplingControllerTest, RatioAtCaptureTime) {
+  controller_.RecordParseCost(kProtocolHTTP, milliseconds{100});
+  ASSERT_THAT(controller_.Tick(kBusyTick), ElementsAre(kProtocolHTTP));
+  // Until BPF applies it, the new ratio does not weight any data.
+  EXPECT_EQ(controller_.ratio_at(kProtocolHTTP, 1000), 1);
+
+  controller_.RatioApplied(kProtocolHTTP, 1000);
+  controller_.RecordParseCost(kProtocolHTTP, milliseconds{100});
+  ASSERT_THAT(controller_.Tick(kBusyTick), ElementsAre(kProtocolHTTP));
+  controller_.RatioApplied(kProtocolHTTP, 2000);
+
+  EXPECT_EQ(controller_.ratio_at(kProtocolHTTP, 999), 1);
+  EXPECT_EQ(controller_.ratio_at(kProtocolHTTP, 1000), 2);
+  EXPECT_EQ(controller_.ratio_at(kProtocolHTTP, 1999), 2);
+  EXPECT_EQ(controller_.ratio_at(kProtocolHTTP, 2000), 4);
+  EXPECT_EQ(controller_.ratio_at(kProtocolMySQL, 2000), 1);
+}
+
+TEST(SamplingControllerInSampleTest, SamplesAreNested) {
+  int sampled_at_2 = 0;
+  int sampled_at_8 = 0;
+  for (int fd = 0; fd < 4096; ++fd) {
+    struct conn_id_t conn_id = {};
+    conn_id.upid.tgid = 123;
+    conn_id.fd = fd;
+    conn_id.tsid = 1000 + fd;
+
+    EXPECT_TRUE(SamplingController::InSample(conn_id, 1));
+    if (SamplingController::InSample(conn_id, 8)) {
+      EXPECT_TRUE(SamplingController::InSample(conn_id, 2));
+      ++sampled_at_8;
+    }
+    if (SamplingController::InSample(conn_id, 2)) {
+      ++sampled_at_2;
+    }
+  }
+
+  // The hash spreads connections roughly evenly.
+  EXPECT_NEAR(sampled_at_2, 4096 / 2, 200);
+  EXPECT_NEAR(sampled_at_8, 4096 / 8, 100);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -22,7 +22,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <limits>
 #include <utility>
 
 #include <absl/container/flat_hash_map.h>
@@ -96,6 +98,11 @@ DEFINE_bool(stirling_enable_mux_tracing,
 DEFINE_bool(stirling_disable_self_tracing, true,
             "If true, stirling will not trace and process syscalls made by itself.");
 
+DEFINE_bool(stirling_enable_adaptive_sampling,
+            gflags::BoolFromEnv("PL_STIRLING_ENABLE_ADAPTIVE_SAMPLING", false),
+            "If true, stirling will only capture the data of a sample of connections for the "
+            "most expensive protocols, while the socket tracer is overloaded.");
+
 // Assume a moderate default network bandwidth peak of 100MiB/s across socket connections for data.
 DEFINE_uint32(stirling_socket_tracer_target_data_bw_percpu, 100 * 1024 * 1024,
               "Target bytes/sec of data per CPU");
@@ -154,7 +161,13 @@ constexpr size_t kMaxHTTPHeadersBytes = 8192;
 constexpr size_t kMaxPBStringLen = 64;
 
 SocketTraceConnector::SocketTraceConnector(std::string_view source_name)
-    : SourceConnector(source_name, kTables), conn_stats_(&conn_trackers_mgr_), uprobe_mgr_(this) {
+    : SourceConnector(source_name, kTables),
+      conn_stats_(&conn_trackers_mgr_),
+      uprobe_mgr_(this),
+      sampling_ctrl_(kSamplingPeriod,
+                     {.max_busy_fraction = FLAGS_stirling_adaptive_sampling_max_busy_fraction,
+                      .max_ratio = FLAGS_stirling_adaptive_sampling_max_ratio,
+                      .cooldown_ticks = FLAGS_stirling_adaptive_sampling_cooldown_ticks}) {
   proc_parser_ = std::make_unique<system::ProcParser>(system::Config::GetInstance());
   InitProtocolTransferSpecs();
 }
@@ -581,6 +594,9 @@ void SocketTraceConnector::UpdateTrackerTraceLevel(ConnTracker* tracker) {
 
 void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
                                             const std::vector<DataTable*>& data_tables) {
+  // Measured with the real clock, since now_fn_ may be mocked.
+  const auto iteration_start = std::chrono::steady_clock::now();
+
   set_iteration_time(now_fn_());
 
   UpdateCommonState(ctx);
@@ -641,7 +657,14 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
                                    socket_info_mgr_.get());
 
     if (transfer_spec.transfer_fn != nullptr) {
+      const auto transfer_start = std::chrono::steady_clock::now();
       transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
+      // HTTP2 data from Go uprobes does not pass through the BPF sampling,
+      // so HTTP2 is kept out of sampling decisions.
+      if (conn_tracker->protocol() != kProtocolHTTP2) {
+        sampling_ctrl_.RecordParseCost(conn_tracker->protocol(),
+                                       std::chrono::steady_clock::now() - transfer_start);
+      }
     } else {
       // If there's no transfer function, then the tracker should not be holding any data.
       // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
@@ -655,6 +678,25 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
 
   // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
   pids_to_trace_disable_.clear();
+
+  UpdateSampling(std::chrono::steady_clock::now() - iteration_start);
+}
+
+void SocketTraceConnector::UpdateSampling(std::chrono::nanoseconds iteration_duration) {
+  // Without BPF (e.g. in tests), there is nothing to sample.
+  if (!FLAGS_stirling_enable_adaptive_sampling || state() == State::kUninitialized) {
+    return;
+  }
+
+  // The new ratios take effect on data captured from now on.
+  for (traffic_protocol_t protocol : sampling_ctrl_.Tick(iteration_duration)) {
+    uint32_t ratio = sampling_ctrl_.ratio(protocol);
+    LOG(INFO) << absl::Substitute("Socket tracer sampling ratio for $0 is now 1/$1.",
+                                  magic_enum::enum_name(protocol), ratio);
+    ECHECK_OK(UpdateBPFProtocolSampling(protocol, ratio));
+    // Data captured from now on is weighted by the new ratio, whenever it is transferred.
+    sampling_ctrl_.RatioApplied(protocol, CurrentSteadyTimeNS());
+  }
 }
 
 Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t protocol,
@@ -664,6 +706,14 @@ Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t proto
                                            &control_map_handle);
 }
 
+Status SocketTraceConnector::UpdateBPFProtocolSampling(traffic_protocol_t protocol,
+                                                       uint32_t sampling_ratio) {
+  auto sampling_map_handle = GetPerCPUArrayTable<uint64_t>(kSamplingMapName);
+  return bpf_tools::UpdatePerCPUArrayValue(static_cast<int>(protocol),
+                                           SamplingController::SamplingMask(sampling_ratio),
+                                           &sampling_map_handle);
+}
+
 Status SocketTraceConnector::TestOnlySetTargetPID(int64_t pid) {
   if (pid != kTraceAllTGIDs) {
     LOG(WARNING) << absl::Substitute(
@@ -717,8 +767,9 @@ void SocketTraceConnector::HandleDataEvent(void* cb_cookie, void* data, int data
 
 void SocketTraceConnector::HandleDataEventLoss(void* cb_cookie, uint64_t lost) {
   DCHECK(cb_cookie != nullptr) << "Perf buffer callback not set-up properly. Missing cb_cookie.";
-  static_cast<SocketTraceConnector*>(cb_cookie)->stats_.Increment(StatKey::kLossSocketDataEvent,
-                                                                  lost);
+  auto* connector = static_cast<SocketTraceConnector*>(cb_cookie);
+  connector->stats_.Increment(StatKey::kLossSocketDataEvent, lost);
+  connector->sampling_ctrl_.RecordDataLoss(lost);
 }
 
 void SocketTraceConnector::HandleControlEvent(void* cb_cookie, void* data, int /*data_size*/) {
@@ -821,6 +872,11 @@ void SocketTraceConnector::AcceptDataEvent(std::unique_ptr<SocketDataEvent> even
   stats_.Increment(StatKey::kPollSocketDataEventAttrSize, sizeof(event->attr));
   stats_.Increment(StatKey::kPollSocketDataEventDataSize, event->msg.size());
 
+  // Encrypted traffic is captured by uprobes (OpenSSL, GoTLS).
+  if (event->attr.ssl) {
+    uprobe_mgr_.NotifyUProbeData(event->attr.conn_id.upid.pid);
+  }
+
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
   tracker.AddDataEvent(std::move(event));
 }
@@ -836,11 +892,13 @@ void SocketTraceConnector::AcceptConnStatsEvent(conn_stats_event_t event) {
 }
 
 void SocketTraceConnector::AcceptHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> event) {
+  uprobe_mgr_.NotifyUProbeData(event->attr.conn_id.upid.pid);
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
   tracker.AddHTTP2Header(std::move(event));
 }
 
 void SocketTraceConnector::AcceptHTTP2Data(std::unique_ptr<HTTP2DataEvent> event) {
+  uprobe_mgr_.NotifyUProbeData(event->attr.conn_id.upid.pid);
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
   tracker.AddHTTP2Data(std::move(event));
 }
@@ -910,6 +968,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(resp_message.body), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(req_message.timestamp_ns, resp_message.timestamp_ns));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -942,8 +1001,6 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   md::UPID upid(ctx->GetASID(), conn_tracker.conn_id().upid.pid,
                 conn_tracker.conn_id().upid.start_time_ticks);
 
-  std::string path = req_stream->headers().ValueByKey(protocols::http2::headers::kPath);
-
   HTTPContentType content_type = HTTPContentType::kUnknown;
   if (record.HasGRPCContentType()) {
     content_type = HTTPContentType::kGRPC;
@@ -964,8 +1021,9 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("content_type")>(static_cast<uint64_t>(content_type));
   r.Append<r.ColIndex("resp_headers")>(ToJSONString(resp_stream->headers()), kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("req_method")>(
-      req_stream->headers().ValueByKey(protocols::http2::headers::kMethod));
-  r.Append<r.ColIndex("req_path")>(req_stream->headers().ValueByKey(":path"));
+      std::string(req_stream->headers().ValueByKey(protocols::http2::headers::kMethod)));
+  r.Append<r.ColIndex("req_path")>(
+      std::string(req_stream->headers().ValueByKey(protocols::http2::headers::kPath)));
   r.Append<r.ColIndex("resp_status")>(resp_status);
   // TODO(yzhao): Populate the following field from headers.
   r.Append<r.ColIndex("resp_message")>("OK");
@@ -981,6 +1039,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   // TODO(yzhao): Remove once http2::Record::bpf_timestamp_ns is removed.
   LOG_IF_EVERY_N(WARNING, latency_ns < 0, 100)
       << absl::Substitute("Negative latency found in HTTP2 records, record=$0", record.ToString());
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1004,6 +1063,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(entry.resp.msg), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1027,6 +1087,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(entry.resp.msg), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1050,6 +1111,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(entry.resp.msg);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1072,6 +1134,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
   r.Append<r.ColIndex("req_cmd")>(ToString(entry.req.tag, /* is_req */ true));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1092,6 +1155,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("req_type")>(entry.req.type);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1136,6 +1200,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp")>(std::string(entry.resp.payload));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1157,6 +1222,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("cmd")>(record.req.command);
   r.Append<r.ColIndex("body")>(record.req.options);
   r.Append<r.ColIndex("resp")>(record.resp.command);
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1183,6 +1249,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp")>(std::move(record.resp.msg), kMaxKafkaBodyBytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(record.req.timestamp_ns, record.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_weight")>(conn_tracker.sampling_weight());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1262,9 +1329,31 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
     // ProcessToRecords() parses raw events and produces messages in format that are expected by
     // table store. But those messages are not cached inside ConnTracker.
     auto records = tracker->ProcessToRecords<TProtocolTraits>();
+
+    // Convert the timestamps of all records as one batch, since they are mostly in order.
+    // Each record is weighted by the sampling ratio that applied when its data was captured, so
+    // its earliest timestamp is kept before conversion.
+    std::vector<uint64_t> timestamps;
+    std::vector<uint64_t> capture_times;
+    capture_times.reserve(records.size());
+    for (auto& record : records) {
+      uint64_t capture_time = std::numeric_limits<uint64_t>::max();
+      TProtocolTraits::ConvertTimestamps(&record, [&](uint64_t mono_time) {
+        timestamps.push_back(mono_time);
+        capture_time = std::min(capture_time, mono_time);
+        return mono_time;
+      });
+      capture_times.push_back(capture_time);
+    }
+    ConvertToRealTime(absl::MakeSpan(timestamps));
+
+    auto timestamp_iter = timestamps.begin();
+    auto capture_time_iter = capture_times.begin();
     for (auto& record : records) {
       TProtocolTraits::ConvertTimestamps(
-          &record, [&](uint64_t mono_time) { return ConvertToRealTime(mono_time); });
+          &record, [&](uint64_t /* mono_time */) { return *timestamp_iter++; });
+      tracker->set_sampling_weight(
+          sampling_ctrl_.ratio_at(tracker->protocol(), *capture_time_iter++));
       AppendMessage(ctx, *tracker, std::move(record), data_table);
     }
   }
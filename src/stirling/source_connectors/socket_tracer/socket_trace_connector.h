@@ -41,6 +41,7 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/sampling_controller.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
@@ -60,6 +61,7 @@ DECLARE_bool(stirling_enable_nats_tracing);
 DECLARE_bool(stirling_enable_kafka_tracing);
 DECLARE_bool(stirling_enable_mux_tracing);
 DECLARE_bool(stirling_disable_self_tracing);
+DECLARE_bool(stirling_enable_adaptive_sampling);
 DECLARE_string(stirling_role_to_trace);
 
 DECLARE_uint32(stirling_socket_tracer_target_data_bw_percpu);
@@ -119,6 +121,10 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // Role_mask a bit mask, and represents the endpoint_role_t roles that are allowed to transfer
   // data from inside BPF to user-space.
   Status UpdateBPFProtocolTraceRole(traffic_protocol_t protocol, uint64_t role_mask);
+
+  // Updates the sampling map value for protocol, so that BPF only transfers the data of 1 in
+  // sampling_ratio of the protocol's connections to user-space.
+  Status UpdateBPFProtocolSampling(traffic_protocol_t protocol, uint32_t sampling_ratio);
   Status TestOnlySetTargetPID(int64_t pid);
   Status DisableSelfTracing();
 
@@ -181,6 +187,10 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   void UpdateTrackerTraceLevel(ConnTracker* tracker);
 
+  // Feeds the cost of the current iteration to the sampling controller,
+  // and applies its sampling decisions to BPF.
+  void UpdateSampling(std::chrono::nanoseconds iteration_duration);
+
   template <typename TRecordType>
   static void AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker,
                             TRecordType record, DataTable* data_table);
@@ -243,6 +253,8 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   UProbeManager uprobe_mgr_;
 
+  SamplingController sampling_ctrl_;
+
   enum class StatKey {
     kLossSocketDataEvent,
     kLossSocketControlEvent,
@@ -887,6 +887,44 @@ TEST_F(SocketTraceConnectorTest, TrackedUPIDTransfersData) {
   EXPECT_THAT(record_batch, RecordBatchSizeIs(1));
 }
 
+TEST_F(SocketTraceConnectorTest, SampleWeight) {
+  constexpr int kHTTPSampleWeightIdx = kHTTPTable.ColIndex("sample_weight");
+
+  source_->AcceptControlEvent(event_gen_.InitConn());
+  source_->AcceptDataEvent(event_gen_.InitSendEvent<kProtocolHTTP>(kReq0));
+  source_->AcceptDataEvent(event_gen_.InitRecvEvent<kProtocolHTTP>(kResp0));
+  connector_->TransferData(ctx_.get(), data_tables_.tables());
+
+  // Without sampling, each record stands for itself.
+  {
+    std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+    ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+    EXPECT_THAT(ToIntVector<types::Int64Value>(records[kHTTPSampleWeightIdx]), ElementsAre(1));
+  }
+
+  // This request is captured before the sampling ratio changes, but transferred after.
+  source_->AcceptDataEvent(event_gen_.InitSendEvent<kProtocolHTTP>(kReq1));
+  source_->AcceptDataEvent(event_gen_.InitRecvEvent<kProtocolHTTP>(kResp1));
+
+  // Data loss makes the controller sample HTTP, the only protocol with a parse cost, at 1/2.
+  source_->sampling_ctrl()->RecordParseCost(kProtocolHTTP, std::chrono::milliseconds{1});
+  source_->sampling_ctrl()->RecordDataLoss(1);
+  ASSERT_THAT(source_->sampling_ctrl()->Tick(std::chrono::milliseconds{1}),
+              ElementsAre(kProtocolHTTP));
+  source_->sampling_ctrl()->RatioApplied(kProtocolHTTP, mock_clock_.now());
+
+  source_->AcceptDataEvent(event_gen_.InitSendEvent<kProtocolHTTP>(kReq2));
+  source_->AcceptDataEvent(event_gen_.InitRecvEvent<kProtocolHTTP>(kResp2));
+  connector_->TransferData(ctx_.get(), data_tables_.tables());
+
+  // Each record is weighted by the ratio that applied when it was captured.
+  {
+    std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+    ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+    EXPECT_THAT(ToIntVector<types::Int64Value>(records[kHTTPSampleWeightIdx]), ElementsAre(1, 2));
+  }
+}
+
 TEST_F(SocketTraceConnectorTest, UntrackedUPIDDoesNotTransferData) {
   PL_SET_FOR_SCOPE(FLAGS_stirling_untracked_upid_threshold_seconds, 1);
 
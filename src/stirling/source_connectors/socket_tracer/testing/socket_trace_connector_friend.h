@@ -69,6 +69,7 @@ class SocketTraceConnectorFriend : public SocketTraceConnector {
   void HandleHTTP2Data(go_grpc_data_event_t* data, int data_size) {
     SocketTraceConnector::HandleHTTP2Event(this, data, data_size);
   }
+  SamplingController* sampling_ctrl() { return &sampling_ctrl_; }
 };
 
 }  // namespace stirling
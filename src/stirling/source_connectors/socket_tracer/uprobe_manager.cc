@@ -22,8 +22,11 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <map>
+#include <thread>
 
 #include "src/common/base/base.h"
 #include "src/common/base/utils.h"
@@ -42,6 +45,9 @@ DEFINE_bool(stirling_rescan_for_dlopen, false,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_int32(stirling_uprobe_deploy_threads, 4,
+             "Maximum number of threads used to analyze new binaries for uprobe deployment. "
+             "Each thread may hold the DWARF info of one binary in memory.");
 
 namespace px {
 namespace stirling {
@@ -78,14 +84,13 @@ void UProbeManager::NotifyMMapEvent(upid_t upid) {
   }
 }
 
-StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
-                                              const std::string& binary,
-                                              obj_tools::ElfReader* elf_reader) {
+StatusOr<std::vector<bpf_tools::UProbeSpec>> UProbeManager::ResolveUProbeTmpl(
+    const ArrayView<UProbeTmpl>& probe_tmpls, obj_tools::ElfReader* elf_reader) {
   using bpf_tools::BPFProbeAttachType;
 
-  int uprobe_count = 0;
+  std::vector<bpf_tools::UProbeSpec> specs;
   for (const auto& tmpl : probe_tmpls) {
-    bpf_tools::UProbeSpec spec = {binary,
+    bpf_tools::UProbeSpec spec = {/*binary_path*/ {},
                                   /*symbol*/ {},
                                   /*address*/ 0,    bpf_tools::UProbeSpec::kDefaultPID,
                                   tmpl.attach_type, std::string(tmpl.probe_fn)};
@@ -104,8 +109,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
         case BPFProbeAttachType::kEntry:
         case BPFProbeAttachType::kReturn: {
           spec.symbol = symbol_info.name;
-          PL_RETURN_IF_ERROR(bcc_->AttachUProbe(spec));
-          ++uprobe_count;
+          specs.push_back(spec);
           break;
         }
         case BPFProbeAttachType::kReturnInsts: {
@@ -122,8 +126,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
           for (const uint64_t& addr : ret_inst_addrs) {
             spec.attach_type = BPFProbeAttachType::kEntry;
             spec.address = addr;
-            PL_RETURN_IF_ERROR(bcc_->AttachUProbe(spec));
-            ++uprobe_count;
+            specs.push_back(spec);
           }
           break;
         }
@@ -132,48 +135,30 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
       }
     }
   }
-  return uprobe_count;
+  return specs;
 }
 
-Status UProbeManager::UpdateOpenSSLSymAddrs(std::filesystem::path libcrypto_path, uint32_t pid) {
-  PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs, OpenSSLSymAddrs(libcrypto_path));
-
-  openssl_symaddrs_map_->UpdateValue(pid, symaddrs);
-
-  return Status::OK();
-}
-
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                             const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_common_symaddrs_map_->UpdateValue(pid, symaddrs);
+StatusOr<int> UProbeManager::AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                               const std::string& binary) {
+  for (bpf_tools::UProbeSpec spec : specs) {
+    spec.binary_path = binary;
+    PL_RETURN_IF_ERROR(bcc_->AttachUProbe(spec));
   }
-
-  return Status::OK();
+  return specs.size();
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                            const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_http2_symaddrs_map_->UpdateValue(pid, symaddrs);
-  }
-
-  return Status::OK();
+StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
+                                              const std::string& binary,
+                                              obj_tools::ElfReader* elf_reader) {
+  PL_ASSIGN_OR_RETURN(std::vector<bpf_tools::UProbeSpec> specs,
+                      ResolveUProbeTmpl(probe_tmpls, elf_reader));
+  return AttachUProbeSpecs(specs, binary);
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                          const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
+Status UProbeManager::UpdateOpenSSLSymAddrs(std::filesystem::path libcrypto_path, uint32_t pid) {
+  PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs, OpenSSLSymAddrs(libcrypto_path));
 
-  for (auto& pid : pids) {
-    go_tls_symaddrs_map_->UpdateValue(pid, symaddrs);
-  }
+  openssl_symaddrs_map_->UpdateValue(pid, symaddrs);
 
   return Status::OK();
 }
@@ -390,65 +375,207 @@ void UProbeManager::SetupGOIDMaps(const std::string& binary, const std::vector<i
   }
 }
 
-StatusOr<int> UProbeManager::AttachGoRuntimeUProbes(const std::string& binary,
-                                                    obj_tools::ElfReader* elf_reader,
-                                                    obj_tools::DwarfReader* /* dwarf_reader */,
-                                                    const std::vector<int32_t>& /* pids */) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  // TODO(oazizi): Implement this piece.
+const std::string& UProbeManager::BinaryKey(const std::string& binary) {
+  auto [iter, inserted] = binary_keys_.try_emplace(binary);
+  if (inserted) {
+    StatusOr<std::string> build_id_status = ElfReader::ReadBuildID(binary);
+    if (build_id_status.ok() && !build_id_status.ValueOrDie().empty()) {
+      iter->second = build_id_status.ConsumeValueOrDie();
+    } else {
+      iter->second = binary;
+    }
+  }
+  return iter->second;
+}
 
-  // Step 2: Deploy uprobes on all new binaries.
-  auto result = go_probed_binaries_.insert(binary);
-  if (!result.second) {
-    // This is not a new binary, so nothing more to do.
-    return 0;
+UProbeManager::GoBinaryProbes UProbeManager::ResolveGoBinaryProbes(const std::string& binary,
+                                                                   bool enable_http2_tracing) {
+  GoBinaryProbes probes;
+
+  // Read binary's symbols.
+  StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
+  if (!elf_reader_status.ok()) {
+    LOG(WARNING) << absl::Substitute(
+        "Cannot analyze binary $0 for uprobe deployment. "
+        "If file is under /var/lib, container may have terminated. "
+        "Message = $1",
+        binary, elf_reader_status.msg());
+    probes.failure_time = std::chrono::steady_clock::now();
+    return probes;
   }
-  return AttachUProbeTmpl(kGoRuntimeUProbeTmpls, binary, elf_reader);
+  std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+
+  // Avoid going past this point if not a golang program.
+  // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
+  if (!IsGoExecutable(elf_reader.get())) {
+    return probes;
+  }
+
+  StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
+      DwarfReader::CreateWithPersistentIndex(binary, FLAGS_stirling_dwarf_index_dir);
+  if (!dwarf_reader_status.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
+        "Message = $1",
+        binary, dwarf_reader_status.msg());
+    probes.failure_time = std::chrono::steady_clock::now();
+    return probes;
+  }
+  std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+  // Record the lookups below, so that the next process running this binary, or the next restart,
+  // does not have to read its DWARF information again.
+  DEFER({
+    Status s = dwarf_reader->PersistIndex();
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to persist DWARF index of $0: $1", binary,
+                                                 s.msg());
+  });
+
+  StatusOr<struct go_common_symaddrs_t> common_symaddrs_status =
+      GoCommonSymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (!common_symaddrs_status.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+    return probes;
+  }
+  probes.is_go = true;
+  probes.common_symaddrs = common_symaddrs_status.ConsumeValueOrDie();
+
+  // Go Runtime Probes.
+  StatusOr<std::vector<bpf_tools::UProbeSpec>> specs_status =
+      ResolveUProbeTmpl(kGoRuntimeUProbeTmpls, elf_reader.get());
+  if (specs_status.ok()) {
+    probes.runtime_probes = specs_status.ConsumeValueOrDie();
+  } else {
+    LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to resolve Go Runtime Uprobes for $0: $1",
+                                                 binary, specs_status.ToString());
+  }
+
+  // GoTLS Probes. A binary without the mandatory symbols does not use Go TLS;
+  // it is not of interest to probe.
+  StatusOr<struct go_tls_symaddrs_t> tls_symaddrs_status =
+      GoTLSSymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (tls_symaddrs_status.ok()) {
+    specs_status = ResolveUProbeTmpl(kGoTLSUProbeTmpls, elf_reader.get());
+    if (specs_status.ok()) {
+      probes.tls_symaddrs = tls_symaddrs_status.ConsumeValueOrDie();
+      probes.tls_probes = specs_status.ConsumeValueOrDie();
+    } else {
+      LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to resolve GoTLS Uprobes for $0: $1",
+                                                   binary, specs_status.ToString());
+    }
+  }
+
+  // Go HTTP2 Probes.
+  if (enable_http2_tracing) {
+    StatusOr<struct go_http2_symaddrs_t> http2_symaddrs_status =
+        GoHTTP2SymAddrs(elf_reader.get(), dwarf_reader.get());
+    if (http2_symaddrs_status.ok()) {
+      specs_status = ResolveUProbeTmpl(kHTTP2ProbeTmpls, elf_reader.get());
+      if (specs_status.ok()) {
+        probes.http2_symaddrs = http2_symaddrs_status.ConsumeValueOrDie();
+        probes.http2_probes = specs_status.ConsumeValueOrDie();
+      } else {
+        LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to resolve HTTP2 Uprobes for $0: $1",
+                                                     binary, specs_status.ToString());
+      }
+    }
+  }
+
+  return probes;
 }
 
-StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
-                                                const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
-    // Doesn't appear to be a binary with the mandatory symbols.
-    // Might not even be a golang binary.
-    // Either way, not of interest to probe.
-    return 0;
+void UProbeManager::ResolveGoBinaries(
+    const std::vector<std::pair<std::string, std::string>>& key_binaries) {
+  if (key_binaries.empty()) {
+    return;
   }
 
-  // Step 2: Deploy uprobes on all new binaries.
-  auto result = go_tls_probed_binaries_.insert(binary);
-  if (!result.second) {
-    // This is not a new binary, so nothing more to do.
-    return 0;
+  // Each worker claims the next unresolved binary. The results are only published to
+  // go_binary_probes_ after all workers are done, so the workers share no mutable state.
+  std::vector<GoBinaryProbes> results(key_binaries.size());
+  std::atomic<size_t> next_idx = 0;
+  auto worker = [&]() {
+    for (size_t i = next_idx++; i < key_binaries.size(); i = next_idx++) {
+      results[i] = ResolveGoBinaryProbes(key_binaries[i].second, cfg_enable_http2_tracing_);
+    }
+  };
+
+  const size_t num_threads = std::clamp<size_t>(FLAGS_stirling_uprobe_deploy_threads, 1,
+                                                key_binaries.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < key_binaries.size(); ++i) {
+    go_binary_probes_[key_binaries[i].first] = std::move(results[i]);
   }
-  return AttachUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
 }
 
-// TODO(oazizi/yzhao): Should HTTP uprobes use a different set of perf buffers than the kprobes?
-// That allows the BPF code and companion user-space code for uprobe & kprobe be separated
-// cleanly. For example, right now, enabling uprobe & kprobe simultaneously can crash Stirling,
-// because of the mixed & duplicate data events from these 2 sources.
-StatusOr<int> UProbeManager::AttachGoHTTP2Probes(const std::string& binary,
-                                                 obj_tools::ElfReader* elf_reader,
-                                                 obj_tools::DwarfReader* dwarf_reader,
-                                                 const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
-    return 0;
+namespace {
+// How long a binary whose analysis failed is left untraced before it is analyzed again.
+constexpr std::chrono::minutes kGoBinaryRetryInterval{5};
+}  // namespace
+
+bool UProbeManager::NeedsGoBinaryResolution(const std::string& key) const {
+  auto iter = go_binary_probes_.find(key);
+  if (iter == go_binary_probes_.end()) {
+    return true;
   }
+  const std::optional<std::chrono::steady_clock::time_point>& failure_time =
+      iter->second.failure_time;
+  return failure_time.has_value() &&
+         std::chrono::steady_clock::now() - *failure_time >= kGoBinaryRetryInterval;
+}
+
+int UProbeManager::AttachGoUProbes(const std::string& binary, const GoBinaryProbes& probes,
+                                   const std::vector<int32_t>& pids) {
+  int uprobe_count = 0;
+
+  // Step 1: Update BPF symaddrs maps on all new PIDs. This is required even when the binary has
+  // already been probed, since the maps are keyed by PID.
+  for (const auto& pid : pids) {
+    go_common_symaddrs_map_->UpdateValue(pid, probes.common_symaddrs.value());
+    if (probes.tls_symaddrs.has_value()) {
+      go_tls_symaddrs_map_->UpdateValue(pid, probes.tls_symaddrs.value());
+    }
+    if (probes.http2_symaddrs.has_value()) {
+      go_http2_symaddrs_map_->UpdateValue(pid, probes.http2_symaddrs.value());
+    }
+  }
+
+  // Setup thread to GOID mapping.
+  SetupGOIDMaps(binary, pids);
 
   // Step 2: Deploy uprobes on all new binaries.
-  auto result = go_http2_probed_binaries_.insert(binary);
-  if (!result.second) {
-    // This is not a new binary, so nothing more to do.
-    return 0;
+  auto attach = [this, &binary, &uprobe_count](absl::flat_hash_set<std::string>* probed_binaries,
+                                                const std::vector<bpf_tools::UProbeSpec>& specs,
+                                                std::string_view probe_type) {
+    if (specs.empty() || !probed_binaries->insert(binary).second) {
+      // Nothing to attach, or not a new binary, so nothing more to do.
+      return;
+    }
+    StatusOr<int> attach_status = AttachUProbeSpecs(specs, binary);
+    if (!attach_status.ok()) {
+      LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach $0 Uprobes to $1: $2",
+                                                   probe_type, binary, attach_status.ToString());
+    } else {
+      uprobe_count += attach_status.ValueOrDie();
+    }
+  };
+  attach(&go_probed_binaries_, probes.runtime_probes, "Go Runtime");
+  if (probes.tls_symaddrs.has_value()) {
+    attach(&go_tls_probed_binaries_, probes.tls_probes, "GoTLS");
+  }
+  if (probes.http2_symaddrs.has_value()) {
+    attach(&go_http2_probed_binaries_, probes.http2_probes, "HTTP2");
   }
-  return AttachUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader);
+
+  return uprobe_count;
 }
 
 namespace {
@@ -491,14 +618,24 @@ std::map<std::string, std::vector<int32_t>> ConvertPIDsListToMap(
 std::thread UProbeManager::RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids) {
   // Increment before starting thread to avoid race in case thread starts late.
   ++num_deploy_uprobes_threads_;
-  return std::thread([this, pids]() {
-    DeployUProbes(pids);
+  const auto handoff_time = std::chrono::steady_clock::now();
+  return std::thread([this, pids, handoff_time]() {
+    DeployUProbes(pids, handoff_time);
     --num_deploy_uprobes_threads_;
   });
   return {};
 }
 
 void UProbeManager::CleanupPIDMaps(const absl::flat_hash_set<md::UPID>& deleted_upids) {
+  {
+    // Processes that exit before producing any data are no longer waited on.
+    const std::lock_guard<std::mutex> lock(first_traced_byte_mutex_);
+    for (const auto& pid : deleted_upids) {
+      awaiting_first_traced_byte_.erase(pid.pid());
+    }
+    num_awaiting_first_traced_byte_ = awaiting_first_traced_byte_.size();
+  }
+
   for (const auto& pid : deleted_upids) {
     openssl_symaddrs_map_->RemoveValue(pid.pid());
     go_common_symaddrs_map_->RemoveValue(pid.pid());
@@ -522,6 +659,9 @@ int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pid
     auto count_or = AttachOpenSSLUProbesOnDynamicLib(pid.pid());
     if (count_or.ok()) {
       uprobe_count += count_or.ValueOrDie();
+      if (count_or.ValueOrDie() != 0) {
+        TrackFirstTracedByte({static_cast<int32_t>(pid.pid())});
+      }
       VLOG(1) << absl::Substitute(
           "Attaching OpenSSL uprobes on dynamic library succeeded for PID $0: $1 probes", pid.pid(),
           count_or.ValueOrDie());
@@ -534,6 +674,9 @@ int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pid
     count_or = AttachNodeJsOpenSSLUprobes(pid.pid());
     if (count_or.ok()) {
       uprobe_count += count_or.ValueOrDie();
+      if (count_or.ValueOrDie() != 0) {
+        TrackFirstTracedByte({static_cast<int32_t>(pid.pid())});
+      }
       VLOG(1) << absl::Substitute(
           "Attaching OpenSSL uprobes on executable statically linked OpenSSL library succeeded for "
           "PID $0: $1 probes",
@@ -554,93 +697,43 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
   static int32_t kPID = getpid();
 
-  for (const auto& [binary, pid_vec] : ConvertPIDsListToMap(pids, &fp_resolver_)) {
-    // Don't bother rescanning binaries that have been scanned before to avoid unnecessary work.
-    if (!scanned_binaries_.insert(binary).second) {
-      continue;
-    }
+  std::map<std::string, std::vector<int32_t>> binary_pids =
+      ConvertPIDsListToMap(pids, &fp_resolver_);
 
-    if (cfg_disable_self_probing_) {
-      // Don't try to attach uprobes to self.
-      // This speeds up stirling_wrapper initialization significantly.
+  if (cfg_disable_self_probing_) {
+    // Don't try to attach uprobes to self.
+    // This speeds up stirling_wrapper initialization significantly.
+    for (auto iter = binary_pids.begin(); iter != binary_pids.end();) {
+      const std::vector<int32_t>& pid_vec = iter->second;
       if (pid_vec.size() == 1 && pid_vec[0] == kPID) {
-        continue;
+        iter = binary_pids.erase(iter);
+      } else {
+        ++iter;
       }
     }
+  }
 
-    // Read binary's symbols.
-    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
-    if (!elf_reader_status.ok()) {
-      LOG(WARNING) << absl::Substitute(
-          "Cannot analyze binary $0 for uprobe deployment. "
-          "If file is under /var/lib, container may have terminated. "
-          "Message = $1",
-          binary, elf_reader_status.msg());
-      continue;
-    }
-    std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
-
-    // Avoid going past this point if not a golang program.
-    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
-    if (!IsGoExecutable(elf_reader.get())) {
-      continue;
+  // Find the binaries that have never been analyzed, or whose analysis failed a while ago.
+  // Copies of the same binary (e.g. the same image running in many pods) are analyzed only once.
+  std::vector<std::pair<std::string, std::string>> key_binaries;
+  absl::flat_hash_set<std::string> keys_to_resolve;
+  for (const auto& [binary, pid_vec] : binary_pids) {
+    const std::string& key = BinaryKey(binary);
+    if (NeedsGoBinaryResolution(key) && keys_to_resolve.insert(key).second) {
+      key_binaries.emplace_back(key, binary);
     }
+  }
+  ResolveGoBinaries(key_binaries);
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
-      continue;
-    }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
-
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+  for (const auto& [binary, pid_vec] : binary_pids) {
+    const GoBinaryProbes& probes = go_binary_probes_[BinaryKey(binary)];
+    if (!probes.is_go) {
       continue;
     }
-
-    // Setup thread to GOID mapping.
-    SetupGOIDMaps(binary, pid_vec);
-
-    // Go Runtime Probes.
-    {
-      StatusOr<int> attach_status =
-          AttachGoRuntimeUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
-      if (!attach_status.ok()) {
-        LOG_FIRST_N(WARNING, 10) << absl::Substitute(
-            "Failed to attach Go Runtime Uprobes to $0: $1", binary, attach_status.ToString());
-      } else {
-        uprobe_count += attach_status.ValueOrDie();
-      }
-    }
-
-    // GoTLS Probes.
-    {
-      StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
-      if (!attach_status.ok()) {
-        LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach GoTLS Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
-      } else {
-        uprobe_count += attach_status.ValueOrDie();
-      }
-    }
-
-    // Go HTTP2 Probes.
-    if (cfg_enable_http2_tracing_) {
-      StatusOr<int> attach_status =
-          AttachGoHTTP2Probes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
-      if (!attach_status.ok()) {
-        LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach HTTP2 Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
-      } else {
-        uprobe_count += attach_status.ValueOrDie();
-      }
+    uprobe_count += AttachGoUProbes(binary, probes, pid_vec);
+    // Processes with only the Go runtime probes never produce traced data.
+    if (probes.has_data_probes()) {
+      TrackFirstTracedByte(pid_vec);
     }
   }
 
@@ -693,13 +786,89 @@ absl::flat_hash_set<md::UPID> UProbeManager::PIDsToRescanForUProbes() {
   return upids_to_rescan;
 }
 
-void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
+namespace {
+
+// How long to wait for the first traced byte of a process, before giving up on it.
+// Processes with data uprobes may simply not communicate.
+constexpr std::chrono::minutes kFirstTracedByteTimeout{10};
+
+}  // namespace
+
+void UProbeManager::SetDiscoveryTimes(const absl::flat_hash_set<md::UPID>& new_upids,
+                                      std::chrono::steady_clock::time_point handoff_time) {
+  discovery_times_.clear();
+  if (!last_handoff_time_.has_value()) {
+    // The processes of the first call were all running before tracing started.
+    last_handoff_time_ = handoff_time;
+    return;
+  }
+
+  // A process that is new to this call was discovered after the previous hand-off, and not before
+  // it started. Both process start times and steady_clock count from boot.
+  const int64_t tick_ns = system::Config::GetInstance().KernelTickTimeNS();
+  for (const auto& upid : new_upids) {
+    const std::chrono::steady_clock::time_point start_time(
+        std::chrono::nanoseconds(upid.start_ts() * tick_ns));
+    discovery_times_[upid.pid()] = std::clamp(start_time, *last_handoff_time_, handoff_time);
+  }
+  last_handoff_time_ = handoff_time;
+}
+
+void UProbeManager::TrackFirstTracedByte(const std::vector<int32_t>& pids) {
+  const std::lock_guard<std::mutex> lock(first_traced_byte_mutex_);
+  for (const auto& pid : pids) {
+    // PIDs that are not new, e.g. rescanned for dlopen(), were discovered by the hand-off.
+    auto iter = discovery_times_.find(pid);
+    awaiting_first_traced_byte_.try_emplace(
+        pid, iter != discovery_times_.end() ? iter->second : last_handoff_time_.value());
+  }
+  num_awaiting_first_traced_byte_ = awaiting_first_traced_byte_.size();
+}
+
+void UProbeManager::ExpireFirstTracedByte() {
+  const auto now = std::chrono::steady_clock::now();
+  const std::lock_guard<std::mutex> lock(first_traced_byte_mutex_);
+  for (auto iter = awaiting_first_traced_byte_.begin();
+       iter != awaiting_first_traced_byte_.end();) {
+    if (now - iter->second > kFirstTracedByteTimeout) {
+      VLOG(1) << absl::Substitute("No traced data from pid=$0 since its uprobes were deployed",
+                                  iter->first);
+      awaiting_first_traced_byte_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  num_awaiting_first_traced_byte_ = awaiting_first_traced_byte_.size();
+}
+
+void UProbeManager::NotifyUProbeData(uint32_t pid) {
+  if (num_awaiting_first_traced_byte_ == 0) {
+    return;
+  }
+
+  const std::lock_guard<std::mutex> lock(first_traced_byte_mutex_);
+  auto iter = awaiting_first_traced_byte_.find(pid);
+  if (iter == awaiting_first_traced_byte_.end()) {
+    return;
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - iter->second;
+  VLOG(1) << absl::Substitute(
+      "Time to first traced byte for pid=$0: $1 ms", pid,
+      std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+  awaiting_first_traced_byte_.erase(iter);
+  num_awaiting_first_traced_byte_ = awaiting_first_traced_byte_.size();
+}
+
+void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids,
+                                  std::chrono::steady_clock::time_point handoff_time) {
   const std::lock_guard<std::mutex> lock(deploy_uprobes_mutex_);
 
   proc_tracker_.Update(pids);
+  SetDiscoveryTimes(proc_tracker_.new_upids(), handoff_time);
 
   // Before deploying new probes, clean-up map entries for old processes that are now dead.
   CleanupPIDMaps(proc_tracker_.deleted_upids());
+  ExpireFirstTracedByte();
 
   // Refresh our file path resolver so it is aware of all new mounts.
   fp_resolver_.Refresh();
@@ -18,8 +18,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -39,6 +41,7 @@
 
 DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
+DECLARE_int32(stirling_uprobe_deploy_threads);
 
 namespace px {
 namespace stirling {
@@ -134,7 +137,43 @@ class UProbeManager {
    */
   bool ThreadsRunning() { return num_deploy_uprobes_threads_ != 0; }
 
+  /**
+   * Notify uprobe manager that data captured by uprobes was received for a process.
+   * The first such notification for a newly probed process reports its time-to-first-traced-byte,
+   * measured from when the process was discovered. Processes that produce no data within ten
+   * minutes of discovery are no longer waited on.
+   * Cheap when there are no newly probed processes.
+   * @param pid PID of the process from which the data was captured.
+   */
+  void NotifyUProbeData(uint32_t pid);
+
  private:
+  // Everything required to deploy Go uprobes on a binary. Resolving this requires the expensive
+  // ELF and DWARF analysis, so it is done once per unique binary, and reused for all copies of
+  // the binary (e.g. the same image running in many pods).
+  struct GoBinaryProbes {
+    bool is_go = false;
+    std::optional<struct go_common_symaddrs_t> common_symaddrs;
+    std::optional<struct go_tls_symaddrs_t> tls_symaddrs;
+    std::optional<struct go_http2_symaddrs_t> http2_symaddrs;
+
+    // Probes with an empty binary_path, which is filled in for each copy of the binary.
+    std::vector<bpf_tools::UProbeSpec> runtime_probes;
+    std::vector<bpf_tools::UProbeSpec> tls_probes;
+    std::vector<bpf_tools::UProbeSpec> http2_probes;
+
+    // Set when the binary could not be read, e.g. because its process exited, or its ELF or DWARF
+    // information failed to load. Unlike a definite result, such a failure may not happen for the
+    // next process running the binary, so it is analyzed again after a while.
+    std::optional<std::chrono::steady_clock::time_point> failure_time;
+
+    // Whether any of the probes capture traced data, as opposed to only supporting others.
+    bool has_data_probes() const {
+      return (tls_symaddrs.has_value() && !tls_probes.empty()) ||
+             (http2_symaddrs.has_value() && !http2_probes.empty());
+    }
+  };
+
   // Probes on Golang crypto/tls library.
   inline static const auto kGoRuntimeUProbeTmpls = MakeArray<UProbeTmpl>({
       UProbeTmpl{
@@ -367,8 +406,10 @@ class UProbeManager {
   /**
    * Deploys all available uprobe types (HTTP2, OpenSSL, etc.) on new processes.
    * @param pids The list of pids to analyze and instrument with uprobes, if appropriate.
+   * @param handoff_time When the pids were handed to RunDeployUProbesThread().
    */
-  void DeployUProbes(const absl::flat_hash_set<md::UPID>& pids);
+  void DeployUProbes(const absl::flat_hash_set<md::UPID>& pids,
+                     std::chrono::steady_clock::time_point handoff_time);
 
   /**
    * Deploys all OpenSSL uprobes on new processes.
@@ -393,53 +434,47 @@ class UProbeManager {
   void SetupGOIDMaps(const std::string& binary, const std::vector<int32_t>& pids);
 
   /**
-   * Attaches the required probes for general Go tracing to the specified binary, if it is a
-   * compatible Go binary.
+   * Returns a key that identifies the contents of the binary: its build-ID if it has one,
+   * otherwise its path. Results are memoized per path.
+   */
+  const std::string& BinaryKey(const std::string& binary);
+
+  /**
+   * Performs the ELF/DWARF analysis of a binary required for Go tracing.
+   * Does not touch any BPF state, so it is safe to call concurrently on different binaries.
    *
-   * @param binary The path to the binary on which to deploy Go probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
-   * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
-   *             addresses.
-   * @return The number of uprobes deployed, or error. It is not an error if the binary
-   *         is not a Go binary; instead the return value will be zero.
+   * @param binary The path to the binary to analyze.
+   * @param enable_http2_tracing Whether to resolve the Go HTTP2 symbols and probes.
+   * @return The resolved probes. If the binary is not a Go binary, or cannot be analyzed,
+   *         is_go is false. If it cannot be read, failure_time is set as well.
    */
-  StatusOr<int> AttachGoRuntimeUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                       obj_tools::DwarfReader* dwarf_reader,
-                                       const std::vector<int32_t>& new_pids);
+  static GoBinaryProbes ResolveGoBinaryProbes(const std::string& binary,
+                                              bool enable_http2_tracing);
 
   /**
-   * Attaches the required probes for Go HTTP2 tracing to the specified binary, if it is a
-   * compatible Go binary.
+   * Resolves the given binaries, in parallel, and stores the results in go_binary_probes_.
    *
-   * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
-   * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
-   *             addresses.
-   * @return The number of uprobes deployed, or error. It is not considered an error if the binary
-   *         is not a Go binary or doesn't use a Go HTTP2 library; instead the return value will be
-   *         zero.
+   * @param key_binaries Pairs of binary key and binary path. Keys must be unique.
    */
-  StatusOr<int> AttachGoHTTP2Probes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                    obj_tools::DwarfReader* dwarf_reader,
-                                    const std::vector<int32_t>& pids);
+  void ResolveGoBinaries(const std::vector<std::pair<std::string, std::string>>& key_binaries);
 
   /**
-   * Attaches the required probes for GoTLS tracing to the specified binary, if it is a compatible
-   * Go binary.
+   * Whether the binary with the given key has to be analyzed, because it never was, or because its
+   * last analysis failed long enough ago.
+   */
+  bool NeedsGoBinaryResolution(const std::string& key) const;
+
+  /**
+   * Attaches the pre-resolved probes of a Go binary to the specified binary, and populates the
+   * symbol address maps for its PIDs.
    *
-   * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
-   * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
-   *             addresses.
-   * @return The number of uprobes deployed, or error. It is not an error if the binary
-   *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
+   * @param binary The path to the binary on which to deploy Go probes.
+   * @param probes The resolved probes for the binary.
+   * @param pids The list of PIDs that are new instances of the binary.
+   * @return The number of uprobes deployed.
    */
-  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
-                                   const std::vector<int32_t>& new_pids);
+  int AttachGoUProbes(const std::string& binary, const GoBinaryProbes& probes,
+                      const std::vector<int32_t>& pids);
 
   /**
    * Attaches the required probes for OpenSSL tracing to the specified PID, if it uses OpenSSL.
@@ -475,21 +510,37 @@ class UProbeManager {
   StatusOr<int> AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
                                  const std::string& binary, obj_tools::ElfReader* elf_reader);
 
+  /**
+   * Finds the symbol matches of the probe templates, and returns one UProbeSpec per attach point.
+   * The binary_path of the returned specs is left empty.
+   */
+  static StatusOr<std::vector<bpf_tools::UProbeSpec>> ResolveUProbeTmpl(
+      const ArrayView<UProbeTmpl>& probe_tmpls, obj_tools::ElfReader* elf_reader);
+
+  /**
+   * Attaches the given specs to the binary.
+   * @return Number of uprobes deployed, or error if uprobes failed to deploy.
+   */
+  StatusOr<int> AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                  const std::string& binary);
+
   // Returns set of PIDs that have had mmap called on them since the last call.
   absl::flat_hash_set<md::UPID> PIDsToRescanForUProbes();
 
   Status UpdateOpenSSLSymAddrs(std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
-                                const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
-                               const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
-                             const std::vector<int32_t>& pids);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
 
+  // Records when the new processes of the DeployUProbes() call in progress were discovered.
+  void SetDiscoveryTimes(const absl::flat_hash_set<md::UPID>& new_upids,
+                         std::chrono::steady_clock::time_point handoff_time);
+
+  // Marks PIDs whose data uprobes were deployed, to measure their time-to-first-traced-byte.
+  void TrackFirstTracedByte(const std::vector<int32_t>& pids);
+
+  // Stops waiting on PIDs that produced no traced data for too long.
+  void ExpireFirstTracedByte();
+
   // Clean-up various BPF maps used to communicate symbol addresses per PID.
   // Once the PID has terminated, the information is not required anymore.
   // Note that BPF maps can fill up if this is not done.
@@ -525,12 +576,29 @@ class UProbeManager {
   // TODO(oazizi): How should these sets be cleaned up of old binaries, once they are deleted?
   //               Without clean-up, these could consume more-and-more memory.
   absl::flat_hash_set<std::string> openssl_probed_binaries_;
-  absl::flat_hash_set<std::string> scanned_binaries_;
   absl::flat_hash_set<std::string> go_probed_binaries_;
   absl::flat_hash_set<std::string> go_http2_probed_binaries_;
   absl::flat_hash_set<std::string> go_tls_probed_binaries_;
   absl::flat_hash_set<std::string> nodejs_binaries_;
 
+  // Binary path to BinaryKey(), and BinaryKey() to the resolved Go probes of that binary.
+  // TODO(oazizi): Same clean-up concern as above.
+  absl::flat_hash_map<std::string, std::string> binary_keys_;
+  absl::flat_hash_map<std::string, GoBinaryProbes> go_binary_probes_;
+
+  // When the pids of the latest DeployUProbes() call were handed to RunDeployUProbesThread().
+  std::optional<std::chrono::steady_clock::time_point> last_handoff_time_;
+
+  // When the new processes of the DeployUProbes() call in progress were discovered.
+  absl::flat_hash_map<uint32_t, std::chrono::steady_clock::time_point> discovery_times_;
+
+  // PIDs with newly deployed data uprobes that have not produced data yet, and when they were
+  // discovered. Written by the deploy thread and read by the main thread, hence the mutex.
+  // The atomic count keeps NotifyUProbeData() cheap when there is nothing to track.
+  std::mutex first_traced_byte_mutex_;
+  absl::flat_hash_map<uint32_t, std::chrono::steady_clock::time_point> awaiting_first_traced_byte_;
+  std::atomic<int> num_awaiting_first_traced_byte_ = 0;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct openssl_symaddrs_t>>
       openssl_symaddrs_map_;
@@ -263,6 +263,9 @@ class StirlingImpl final : public Stirling {
   AgentMetadataCallback agent_metadata_callback_ = nullptr;
   AgentMetadataType agent_metadata_;
 
+  // Tracks the processes on the system for the standalone context, used when there is no agent.
+  ProcUPIDScanner proc_scanner_;
+
   absl::base_internal::SpinLock dynamic_trace_status_map_lock_;
   absl::flat_hash_map<sole::uuid, StatusOr<stirlingpb::Publish>> dynamic_trace_status_map_
       ABSL_GUARDED_BY(dynamic_trace_status_map_lock_);
@@ -395,7 +398,7 @@ std::unique_ptr<ConnectorContext> StirlingImpl::GetContext() {
   if (agent_metadata_callback_ != nullptr) {
     return std::unique_ptr<ConnectorContext>(new AgentContext(agent_metadata_callback_()));
   }
-  return std::unique_ptr<ConnectorContext>(new SystemWideStandaloneContext());
+  return std::unique_ptr<ConnectorContext>(new SystemWideStandaloneContext(&proc_scanner_));
 }
 
 namespace {
@@ -774,7 +777,7 @@ void StirlingImpl::RunCore() {
 
     // Update the context/state on each iteration.
     // Note that if no changes are present, the same pointer will be returned back.
-    // TODO(oazizi): If context constructor does a lot of work (e.g. ListUPIDs()),
+    // TODO(oazizi): If context constructor does a lot of work (e.g. scanning /proc),
     //               then there might be an inefficiency here, since we don't know if
     //               mgr->SamplingRequired() will be true for any manager.
     std::unique_ptr<ConnectorContext> ctx = GetContext();
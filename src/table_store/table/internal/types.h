@@ -42,6 +42,9 @@ using RowID = int64_t;
 using RowIDInterval = std::pair<RowID, RowID>;
 using BatchID = int64_t;
 
+// A hot batch transferred from Stirling (Table::TransferRecordBatch) that is kept in its
+// ColumnWrapper form, because some of its columns (e.g. strings) can't be handed over to arrow
+// without a copy. Its columns are only converted when read, or copied into cold by compaction.
 struct RecordBatchWithCache {
   RecordBatchPtr record_batch;
   // Whenever we have to convert a hot batch to an arrow array, we store the arrow array in
@@ -243,12 +243,33 @@ Status Table::TransferRecordBatch(
     return Status::OK();
   }
 
-  auto record_batch_w_cache = internal::RecordBatchWithCache{
-      std::move(record_batch),
-      std::vector<ArrowArrayPtr>(rel_.NumColumns()),
-      std::vector<bool>(rel_.NumColumns(), false),
-  };
-  internal::RecordOrRowBatch record_or_row_batch(std::move(record_batch_w_cache));
+  // Batches whose columns can all be handed over to arrow without a copy are stored as arrow
+  // right away, so reads of the hot store don't have to convert and cache them. This only covers
+  // batches of int64, float64 and time64 columns. Most Stirling tables have a UINT128 upid or
+  // STRING columns, so their batches are converted lazily as before: a read of the hot batch
+  // converts its columns into the cache, and compaction copies them into the cold arrow arrays.
+  // Converting them here would add a copy for batches that are compacted before being read.
+  bool move_to_arrow = std::all_of(
+      record_batch->begin(), record_batch->end(), [](const types::SharedColumnWrapper& col) {
+        return col.use_count() == 1 && types::MovesToArrowWithoutCopy(col->data_type());
+      });
+  if (!move_to_arrow) {
+    auto record_batch_w_cache = internal::RecordBatchWithCache{
+        std::move(record_batch),
+        std::vector<ArrowArrayPtr>(rel_.NumColumns()),
+        std::vector<bool>(rel_.NumColumns(), false),
+    };
+    PL_RETURN_IF_ERROR(WriteHot(internal::RecordOrRowBatch(std::move(record_batch_w_cache))));
+    return Status::OK();
+  }
+
+  schema::RowBatch rb(schema::RowDescriptor(rel_.col_types()), record_batch->at(0)->Size());
+  for (auto& col : *record_batch) {
+    PL_RETURN_IF_ERROR(rb.AddColumn(col->MoveToArrow(arrow::default_memory_pool())));
+  }
+  record_batch.reset();
+
+  internal::RecordOrRowBatch record_or_row_batch(std::move(rb));
 
   PL_RETURN_IF_ERROR(WriteHot(std::move(record_or_row_batch)));
   return Status::OK();
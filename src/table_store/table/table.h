@@ -261,6 +261,9 @@ class Table : public NotCopyable {
 
   /**
    * Transfers the given record batch (from Stirling) into the Table.
+   * If all of its columns can be moved into arrow without a copy (int64, float64 and time64), the
+   * batch is stored in the hot store as arrow arrays. Otherwise, e.g. for batches with string or
+   * uint128 columns, it is stored as is and its columns are converted lazily.
    *
    * @param record_batch the record batch to be appended to the Table.
    * @return status
@@ -498,6 +498,60 @@ TEST(TableTest, hot_batches_w_compaction_test) {
   EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+// Batches whose columns are all numeric and not referenced elsewhere are moved into arrow when
+// they are transferred. The batches below hold the only reference to their columns.
+TEST(TableTest, hot_batches_moved_to_arrow_w_compaction_test) {
+  schema::Relation rel(
+      {types::DataType::TIME64NS, types::DataType::INT64, types::DataType::FLOAT64},
+      {"time_", "col1", "col2"});
+
+  std::vector<types::Time64NSValue> time_in1 = {1, 2, 3};
+  std::vector<types::Int64Value> col1_in1 = {4, 5, 6};
+  std::vector<types::Float64Value> col2_in1 = {0.5, 1.5, 2.5};
+  std::vector<types::Time64NSValue> time_in2 = {4, 5};
+  std::vector<types::Int64Value> col1_in2 = {7, 8};
+  std::vector<types::Float64Value> col2_in2 = {3.5, 4.5};
+
+  auto make_batch = [](const std::vector<types::Time64NSValue>& time,
+                       const std::vector<types::Int64Value>& col1,
+                       const std::vector<types::Float64Value>& col2) {
+    auto batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    batch->push_back(std::make_shared<types::Time64NSValueColumnWrapper>(time));
+    batch->push_back(std::make_shared<types::Int64ValueColumnWrapper>(col1));
+    batch->push_back(std::make_shared<types::Float64ValueColumnWrapper>(col2));
+    return batch;
+  };
+  int64_t rb1_size = 3 * sizeof(int64_t) + 3 * sizeof(int64_t) + 3 * sizeof(double);
+  int64_t rb2_size = 2 * sizeof(int64_t) + 2 * sizeof(int64_t) + 2 * sizeof(double);
+
+  Table table("test_table", rel, 128 * 1024, rb1_size);
+
+  EXPECT_OK(table.TransferRecordBatch(make_batch(time_in1, col1_in1, col2_in1)));
+  EXPECT_EQ(table.GetTableStats().bytes, rb1_size);
+  EXPECT_OK(table.TransferRecordBatch(make_batch(time_in2, col1_in2, col2_in2)));
+  EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size);
+
+  Table::Cursor cursor(&table);
+  auto rb1 = cursor.GetNextRowBatch({0, 1, 2}).ConsumeValueOrDie();
+  EXPECT_TRUE(rb1->ColumnAt(0)->Equals(types::ToArrow(time_in1, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb1->ColumnAt(1)->Equals(types::ToArrow(col1_in1, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb1->ColumnAt(2)->Equals(types::ToArrow(col2_in1, arrow::default_memory_pool())));
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size);
+
+  auto rb2 = cursor.GetNextRowBatch({0, 1, 2}).ConsumeValueOrDie();
+  ASSERT_NE(rb2, nullptr);
+  EXPECT_TRUE(rb2->ColumnAt(0)->Equals(types::ToArrow(time_in2, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col1_in2, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb2->ColumnAt(2)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
+
+  // Reading from the start again returns the compacted cold batch.
+  Table::Cursor cold_cursor(&table);
+  auto cold_rb = cold_cursor.GetNextRowBatch({1}).ConsumeValueOrDie();
+  EXPECT_TRUE(cold_rb->ColumnAt(0)->Equals(types::ToArrow(col1_in1, arrow::default_memory_pool())));
+}
+
 TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal) {
   schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
                        std::vector<std::string>({"time_"}));